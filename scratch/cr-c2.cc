@@ -1,11 +1,13 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <fstream>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <map>
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/enum.h"
@@ -41,6 +43,7 @@
 #include "ns3/udp-server.h"
 #include "ns3/spectrum-analyzer-helper.h"
 #include "ns3/cr-mmwave-helper.h"
+#include "ns3/mmwave-channel-helper.h"
 #include "ns3/mmwave-spectrum-value-helper.h"
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/propagation-loss-model.h"
@@ -66,6 +69,11 @@ private:
     uint32_t m_size;
     double m_totalTime;
     bool m_tracing;
+    bool m_binaryTracing;
+    double m_statsInterval;
+    std::string m_summaryFile;
+    std::string m_profile;
+    bool m_transmitFilter;
     AsciiTraceHelper m_ascii;
     NodeContainer m_nodes;
     NodeContainer m_spectrumAnalyzerNodes;
@@ -90,7 +98,12 @@ private:
 CrMmWaveExample::CrMmWaveExample () :
         m_size (7),
         m_totalTime (150),
-        m_tracing (true)
+        m_tracing (true),
+        m_binaryTracing (false),
+        m_statsInterval (0),
+        m_summaryFile (""),
+        m_profile (""),
+        m_transmitFilter (false)
 {
 }
 
@@ -99,7 +112,12 @@ CrMmWaveExample::Configure (int argc, char **argv)
 {
     CommandLine cmd;
     cmd.AddValue ("tracing", "Write traces.", m_tracing);
+    cmd.AddValue ("binaryTracing", "Write the PHY trace in the binary format (see scratch/mmwave-trace-csv).", m_binaryTracing);
+    cmd.AddValue ("stats", "Write the MAC and PHY statistics of the nodes to cr-2c.stats.bin every <stats> s (see scratch/mmwave-trace-csv); 0 disables them.", m_statsInterval);
     cmd.AddValue ("time", "Simulation time, s.", m_totalTime);
+    cmd.AddValue ("profile", "Write the profile of the mmWave events to <profile>.txt and a Chrome trace of them to <profile>.json.", m_profile);
+    cmd.AddValue ("summary", "File to write the number of events and the wall time of the run to.", m_summaryFile);
+    cmd.AddValue ("transmitFilter", "Skip the receivers tuned to another channel before the propagation loss; faster, but the results differ for the same seed.", m_transmitFilter);
     cmd.Parse (argc, argv);
 
     return true;
@@ -116,7 +134,18 @@ CrMmWaveExample::Run ()
 
     NS_LOG_INFO ("Run Simulation.");
     Simulator::Stop (Seconds (m_totalTime));
+    if (!m_profile.empty ())
+    {
+        EventProfiler::Enable (m_profile + ".txt", m_profile + ".json");
+    }
+    auto wallStart = std::chrono::steady_clock::now ();
     Simulator::Run ();
+    double wallTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    if (!m_summaryFile.empty ())
+    {
+        std::ofstream summary (m_summaryFile.c_str ());
+        summary << Simulator::GetEventCount () << " " << wallTime << std::endl;
+    }
     Simulator::Destroy ();
     NS_LOG_INFO ("Done.");
 }
@@ -229,6 +258,10 @@ CrMmWaveExample::CreateChannels ()
     m_spectrumChannel = CreateObject<MultiModelSpectrumChannel> ();
     m_spectrumChannel->SetPropagationDelayModel (delayModel);
     m_spectrumChannel->AddPropagationLossModel (m_lossModel);
+    if (m_transmitFilter)
+    {
+        MmWaveChannelHelper::AddTransmitFilter (m_spectrumChannel);
+    }
 }
 
 void
@@ -257,11 +290,19 @@ CrMmWaveExample::CreateDevices ()
     ipv4.SetBase ("10.1.1.0", "255.255.255.0");
     m_interfaces = ipv4.Assign (m_devices);
 
-    if (m_tracing)
+    if (m_tracing && m_binaryTracing)
+    {
+        phyHelper.EnableBinaryAll (Create<MmWaveBinaryTraceFile> ("cr-2c.phy.bin"));
+    }
+    else if (m_tracing)
     {
         Ptr<OutputStreamWrapper> osw = m_ascii.CreateFileStream ( "cr-2c.tr");
         phyHelper.EnableAsciiAll (osw);
     }
+    if (m_statsInterval > 0)
+    {
+        helper.EnableStats (Create<MmWaveStatsCollector> ("cr-2c.stats.bin", Seconds (m_statsInterval)), m_devices);
+    }
 }
 
 void
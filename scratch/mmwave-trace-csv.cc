@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Converts a binary PHY trace written by the EnableBinary helpers, or a
+ * statistics file written by CrMmWaveHelper::EnableStats, to CSV.
+ *
+ *     ./waf --run "mmwave-trace-csv --input=cr-c1.phy.bin --output=cr-c1.phy.csv"
+ *     ./waf --run "mmwave-trace-csv --input=cr-c1.stats.bin --output=cr-c1.stats.csv"
+ */
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "ns3/command-line.h"
+#include "ns3/mmwave-binary-trace.h"
+#include "ns3/mmwave-stats-collector.h"
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+    std::string input;
+    std::string output;
+
+    CommandLine cmd;
+    cmd.AddValue ("input", "Binary trace or statistics file.", input);
+    cmd.AddValue ("output", "CSV file, standard output if empty.", output);
+    cmd.Parse (argc, argv);
+
+    std::ofstream file;
+    if (!output.empty ())
+    {
+        file.open (output.c_str ());
+    }
+    std::ostream &os = output.empty () ? std::cout : file;
+    // nothing is written until the header of the input is recognized
+    bool ok = MmWaveBinaryTraceFile::ReadCsv (input, os)
+              || MmWaveStatsCollector::ReadCsv (input, os);
+    if (!ok)
+    {
+        std::cerr << "Cannot read binary trace or statistics file " << input << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,291 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Runs a parameter sweep of the cr-c1, cr-c2 and v2x-1 scenarios.
+ *
+ * The grid file lists one parameter per line, followed by its values:
+ *
+ *     # scenarios to run, paths of the built programs
+ *     program = build/scratch/cr-c1 build/scratch/v2x-1
+ *     time = 10 20
+ *     ns3::MmWaveMacQueue::MaxSize = 100p 1000p
+ *     RngRun = 1:16
+ *
+ * Every combination of the values is one run. Each parameter other than
+ * "program" is passed to the scenario as --name=value, so both the options of
+ * the scenario and the attribute defaults can be swept; "first:last" expands
+ * to the integers in between (typically used for RngRun). The runs are
+ * independent processes started on a pool of --jobs workers, each in its own
+ * directory under --outDir so that their traces do not collide. One CSV line
+ * is appended to --output as each run completes, with the wall time of the
+ * process and the number of events and events/s reported by the scenario.
+ * The header line is only written when --output is new or empty, so the
+ * results of successive sweeps with the same parameters accumulate in one file.
+ *
+ *     ./waf --run "sweep --grid=nightly.grid --jobs=8 --output=nightly.csv"
+ */
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <climits>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+NS_LOG_COMPONENT_DEFINE ("ScenarioSweep");
+
+using namespace ns3;
+
+/// a parameter of the grid and the values it takes
+struct SweepParameter
+{
+    std::string name;
+    std::vector<std::string> values;
+};
+
+/// a run of the sweep being executed
+struct SweepRun
+{
+    uint32_t index;
+    std::string program;
+    std::vector<std::string> values; //!< value of each parameter other than "program"
+    std::string directory;
+    std::chrono::steady_clock::time_point start;
+};
+
+static std::string
+Trim (const std::string &s)
+{
+    std::size_t first = s.find_first_not_of (" \t\r");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    return s.substr (first, s.find_last_not_of (" \t\r") - first + 1);
+}
+
+static std::vector<SweepParameter>
+ReadGrid (const std::string &fileName)
+{
+    std::ifstream file (fileName.c_str ());
+    NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot open grid file " << fileName);
+    std::vector<SweepParameter> grid;
+    std::string line;
+    while (std::getline (file, line))
+    {
+        line = Trim (line.substr (0, line.find ('#')));
+        if (line.empty ())
+        {
+            continue;
+        }
+        std::size_t equal = line.find ('=');
+        NS_ABORT_MSG_IF (equal == std::string::npos, "Malformed grid line: " << line);
+        SweepParameter parameter;
+        parameter.name = Trim (line.substr (0, equal));
+        std::istringstream values (line.substr (equal + 1));
+        std::string value;
+        while (values >> value)
+        {
+            std::size_t colon = value.find (':');
+            if (colon != std::string::npos && value.find_first_not_of ("0123456789:") == std::string::npos)
+            {
+                uint64_t first = std::stoull (value.substr (0, colon));
+                uint64_t last = std::stoull (value.substr (colon + 1));
+                for (uint64_t v = first; v <= last; v++)
+                {
+                    parameter.values.push_back (std::to_string (v));
+                }
+            }
+            else
+            {
+                parameter.values.push_back (value);
+            }
+        }
+        NS_ABORT_MSG_IF (parameter.name.empty () || parameter.values.empty (), "Malformed grid line: " << line);
+        grid.push_back (parameter);
+    }
+    return grid;
+}
+
+/// \return the absolute path of a program, so that runs can change their directory
+static std::string
+GetAbsolutePath (const std::string &path)
+{
+    char resolved[PATH_MAX];
+    NS_ABORT_MSG_UNLESS (realpath (path.c_str (), resolved), "Cannot find program " << path);
+    return resolved;
+}
+
+static pid_t
+StartRun (const SweepRun &run, const std::vector<SweepParameter> &parameters)
+{
+    mkdir (run.directory.c_str (), 0755);
+    std::vector<std::string> args;
+    args.push_back (run.program);
+    for (std::size_t i = 0; i < parameters.size (); i++)
+    {
+        args.push_back ("--" + parameters[i].name + "=" + run.values[i]);
+    }
+    args.push_back ("--summary=summary");
+
+    pid_t pid = fork ();
+    NS_ABORT_MSG_IF (pid < 0, "fork failed: " << std::strerror (errno));
+    if (pid == 0)
+    {
+        std::vector<char *> argv;
+        for (auto &arg : args)
+        {
+            argv.push_back (&arg[0]);
+        }
+        argv.push_back (0);
+        if (chdir (run.directory.c_str ()) == 0)
+        {
+            // the output of the scenario is kept next to its traces
+            if (freopen ("stdout", "w", stdout) && freopen ("stderr", "w", stderr))
+            {
+                execv (argv[0], argv.data ());
+            }
+        }
+        _exit (127);
+    }
+    return pid;
+}
+
+int
+main (int argc, char *argv[])
+{
+    std::string gridFile;
+    std::string output = "sweep.csv";
+    std::string outDir = "sweep";
+    uint32_t jobs = std::thread::hardware_concurrency ();
+
+    CommandLine cmd;
+    cmd.AddValue ("grid", "Parameter grid file.", gridFile);
+    cmd.AddValue ("output", "CSV file the results are appended to.", output);
+    cmd.AddValue ("outDir", "Directory holding the working directory of each run.", outDir);
+    cmd.AddValue ("jobs", "Number of runs executed concurrently, default one per core.", jobs);
+    cmd.Parse (argc, argv);
+    NS_ABORT_MSG_IF (gridFile.empty (), "No grid file given (--grid)");
+    if (jobs == 0)
+    {
+        jobs = 1;
+    }
+
+    std::vector<SweepParameter> grid = ReadGrid (gridFile);
+    std::vector<std::string> programs;
+    std::vector<SweepParameter> parameters;
+    for (auto &parameter : grid)
+    {
+        if (parameter.name == "program")
+        {
+            for (auto &program : parameter.values)
+            {
+                programs.push_back (GetAbsolutePath (program));
+            }
+        }
+        else
+        {
+            parameters.push_back (parameter);
+        }
+    }
+    NS_ABORT_MSG_IF (programs.empty (), "The grid file has no program line");
+
+    uint64_t nRuns = programs.size ();
+    for (auto &parameter : parameters)
+    {
+        nRuns *= parameter.values.size ();
+    }
+    NS_LOG_INFO ("Sweep of " << nRuns << " runs on " << jobs << " workers");
+    mkdir (outDir.c_str (), 0755);
+
+    // the results of earlier sweeps are kept, the header is only written to a new file
+    struct stat outputStat;
+    bool newOutput = stat (output.c_str (), &outputStat) != 0 || outputStat.st_size == 0;
+    std::ofstream csv (output.c_str (), std::ios::app);
+    NS_ABORT_MSG_UNLESS (csv.is_open (), "Cannot open " << output);
+    if (newOutput)
+    {
+        csv << "run,program";
+        for (auto &parameter : parameters)
+        {
+            csv << "," << parameter.name;
+        }
+        csv << ",status,wall_s,events,run_wall_s,events_per_s" << std::endl;
+    }
+
+    std::map<pid_t, SweepRun> running;
+    uint32_t failed = 0;
+    for (uint64_t next = 0; next < nRuns || !running.empty (); )
+    {
+        while (next < nRuns && running.size () < jobs)
+        {
+            // the last parameter varies fastest
+            SweepRun run;
+            run.index = next;
+            uint64_t rest = next;
+            run.values.resize (parameters.size ());
+            for (std::size_t i = parameters.size (); i-- > 0; )
+            {
+                run.values[i] = parameters[i].values[rest % parameters[i].values.size ()];
+                rest /= parameters[i].values.size ();
+            }
+            run.program = programs[rest];
+            run.directory = outDir + "/run-" + std::to_string (next);
+            run.start = std::chrono::steady_clock::now ();
+            running[StartRun (run, parameters)] = run;
+            next++;
+        }
+
+        int status;
+        pid_t pid = waitpid (-1, &status, 0);
+        if (pid < 0)
+        {
+            NS_ABORT_MSG_IF (errno != EINTR, "waitpid failed: " << std::strerror (errno));
+            continue;
+        }
+        auto it = running.find (pid);
+        if (it == running.end ())
+        {
+            continue;
+        }
+        const SweepRun &run = it->second;
+        double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - run.start).count ();
+        int exitCode = WIFEXITED (status) ? WEXITSTATUS (status) : -1;
+        uint64_t events = 0;
+        double runWall = 0;
+        std::ifstream summary ((run.directory + "/summary").c_str ());
+        if (!(summary >> events >> runWall))
+        {
+            events = 0;
+            runWall = 0;
+        }
+        if (exitCode != 0)
+        {
+            failed++;
+        }
+
+        csv << run.index << "," << run.program;
+        for (auto &value : run.values)
+        {
+            csv << "," << value;
+        }
+        csv << "," << exitCode << "," << wall << "," << events << "," << runWall << ","
+            << (runWall > 0 ? events / runWall : 0) << std::endl;
+        NS_LOG_INFO ("Run " << run.index << " done in " << wall << " s, status " << exitCode);
+        running.erase (it);
+    }
+
+    std::cout << nRuns << " runs, " << failed << " failed, results in " << output << std::endl;
+    return failed == 0 ? 0 : 1;
+}
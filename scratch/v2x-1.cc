@@ -1,11 +1,13 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <fstream>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <map>
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/enum.h"
@@ -41,6 +43,7 @@
 #include "ns3/udp-server.h"
 #include "ns3/spectrum-analyzer-helper.h"
 #include "ns3/v2x-mmwave-helper.h"
+#include "ns3/mmwave-channel-helper.h"
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/channel-condition-model.h"
@@ -65,6 +68,10 @@ private:
     uint32_t m_size;
     double m_totalTime;
     bool m_tracing;
+    bool m_binaryTracing;
+    std::string m_summaryFile;
+    std::string m_profile;
+    bool m_transmitFilter;
     AsciiTraceHelper m_ascii;
     NodeContainer m_nodes;
     NodeContainer m_spectrumAnalyzerNodes;
@@ -91,7 +98,11 @@ private:
 V2xMmWaveExample::V2xMmWaveExample () :
         m_size (7),
         m_totalTime (150),
-        m_tracing (true)
+        m_tracing (true),
+        m_binaryTracing (false),
+        m_summaryFile (""),
+        m_profile (""),
+        m_transmitFilter (false)
 {
 }
 
@@ -100,7 +111,11 @@ V2xMmWaveExample::Configure (int argc, char **argv)
 {
     CommandLine cmd;
     cmd.AddValue ("tracing", "Write traces.", m_tracing);
+    cmd.AddValue ("binaryTracing", "Write the PHY trace in the binary format (see scratch/mmwave-trace-csv).", m_binaryTracing);
     cmd.AddValue ("time", "Simulation time, s.", m_totalTime);
+    cmd.AddValue ("profile", "Write the profile of the mmWave events to <profile>.txt and a Chrome trace of them to <profile>.json.", m_profile);
+    cmd.AddValue ("summary", "File to write the number of events and the wall time of the run to.", m_summaryFile);
+    cmd.AddValue ("transmitFilter", "Skip the receivers tuned to another channel before the propagation loss; faster, but the results differ for the same seed.", m_transmitFilter);
     cmd.Parse (argc, argv);
 
     return true;
@@ -118,7 +133,18 @@ V2xMmWaveExample::Run ()
 
     NS_LOG_INFO ("Run Simulation.");
     Simulator::Stop (Seconds (m_totalTime));
+    if (!m_profile.empty ())
+    {
+        EventProfiler::Enable (m_profile + ".txt", m_profile + ".json");
+    }
+    auto wallStart = std::chrono::steady_clock::now ();
     Simulator::Run ();
+    double wallTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    if (!m_summaryFile.empty ())
+    {
+        std::ofstream summary (m_summaryFile.c_str ());
+        summary << Simulator::GetEventCount () << " " << wallTime << std::endl;
+    }
     Simulator::Destroy ();
     NS_LOG_INFO ("Done.");
 }
@@ -231,6 +257,10 @@ V2xMmWaveExample::CreateChannels ()
     m_spectrumChannel_6G = CreateObject<MultiModelSpectrumChannel> ();
     m_spectrumChannel_6G->SetPropagationDelayModel (delayModel);
     m_spectrumChannel_6G->AddPropagationLossModel (m_lossModel_6G);
+    if (m_transmitFilter)
+    {
+        MmWaveChannelHelper::AddTransmitFilter (m_spectrumChannel_6G);
+    }
 
 
     frequency = 60e9;
@@ -253,6 +283,10 @@ V2xMmWaveExample::CreateChannels ()
     m_spectrumChannel_mmWave = CreateObject<MultiModelSpectrumChannel> ();
     m_spectrumChannel_mmWave->SetPropagationDelayModel (delayModel);
     m_spectrumChannel_mmWave->AddPropagationLossModel (m_lossModel_mmWave);
+    if (m_transmitFilter)
+    {
+        MmWaveChannelHelper::AddTransmitFilter (m_spectrumChannel_mmWave);
+    }
 }
 
 void
@@ -288,7 +322,11 @@ V2xMmWaveExample::CreateDevices ()
     ipv4.SetBase ("10.1.1.0", "255.255.255.0");
     m_interfaces = ipv4.Assign (m_devices);
 
-    if (m_tracing)
+    if (m_tracing && m_binaryTracing)
+    {
+        dataPhyHelper.EnableBinaryAll (Create<MmWaveBinaryTraceFile> ("v2x-1.phy.bin"));
+    }
+    else if (m_tracing)
     {
         Ptr<OutputStreamWrapper> osw = m_ascii.CreateFileStream ( "v2x-1.tr");
         dataPhyHelper.EnableAsciiAll (osw);
@@ -0,0 +1,600 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-config.h"
+#include "ns3/command-line.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-trace.h"
+#include "ns3/abort.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/scheduler.h"
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup scheduler
+ * Benchmark of the Scheduler implementations.
+ *
+ * The schedulers are driven directly, without the simulator, by one of
+ * two workloads:
+ *
+ * - an event trace recorded by a simulation run with the
+ *   ns3::DefaultSimulatorImpl::EventTraceFile attribute set, replayed
+ *   exactly: the events are inserted, removed and cancelled as in the
+ *   simulation, and removed in the order the simulation ran them;
+ *
+ * - otherwise, the event pattern of the mmWave MAC: every node has a
+ *   slot tick which cancels and rearms an access timer, as
+ *   CrDynamicChannelAccessManager does with its request access event, a
+ *   fraction of the timers expire, and a few long timers (beacons,
+ *   traffic) land far in the future.
+ *
+ * In both cases the cancelled events stay in the queue, as with
+ * Simulator::Cancel. For each scheduler the time per operation, the
+ * peak of the heap memory allocated during the run and, on Linux when
+ * the kernel allows it, the hardware cache misses are reported.
+ *
+ * \code
+ *   ./waf --run "scratch/cr-c1 --ns3::DefaultSimulatorImpl::EventTraceFile=cr-c1.evt"
+ *   ./waf --run "bench-scheduler --trace=cr-c1.evt"
+ *   ./waf --run "bench-scheduler --nodes=50 --ops=2000000"
+ * \endcode
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** Number of bytes allocated on the heap and not yet released. */
+std::size_t g_heapLive = 0;
+/** Highest value of g_heapLive since the last reset. */
+std::size_t g_heapPeak = 0;
+
+/** Size of the header recording the size of an allocation. */
+const std::size_t HEAP_HEADER = 16;
+
+} // unnamed namespace
+
+// Count the heap memory of the whole program.
+
+void *
+operator new (std::size_t size)
+{
+  char *block = static_cast<char *> (std::malloc (size + HEAP_HEADER));
+  if (block == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  *reinterpret_cast<std::size_t *> (block) = size;
+  g_heapLive += size;
+  if (g_heapLive > g_heapPeak)
+    {
+      g_heapPeak = g_heapLive;
+    }
+  return block + HEAP_HEADER;
+}
+
+void *
+operator new (std::size_t size, const std::nothrow_t &) noexcept
+{
+  try
+    {
+      return operator new (size);
+    }
+  catch (...)
+    {
+      return 0;
+    }
+}
+
+void *
+operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void *
+operator new[] (std::size_t size, const std::nothrow_t &tag) noexcept
+{
+  return operator new (size, tag);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  if (p == 0)
+    {
+      return;
+    }
+  char *block = reinterpret_cast<char *> (reinterpret_cast<uintptr_t> (p) - HEAP_HEADER);
+  g_heapLive -= *reinterpret_cast<std::size_t *> (block);
+  std::free (block);
+}
+
+void
+operator delete (void *p, std::size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete (void *p, const std::nothrow_t &) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, std::size_t) noexcept
+{
+  operator delete (p);
+}
+
+void
+operator delete[] (void *p, const std::nothrow_t &) noexcept
+{
+  operator delete (p);
+}
+
+namespace {
+
+/** Kinds of the benchmark events. */
+enum Kind
+{
+  SLOT,   //!< slot tick of a node
+  TIMER,  //!< access timer of a node
+  LONG    //!< far future event
+};
+
+/** A benchmark event: it only records what it stands for. */
+class BenchEvent : public EventImpl
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] kind The kind of the event.
+   * \param [in] node The node of the event.
+   */
+  BenchEvent (Kind kind, uint32_t node)
+    : kind (kind),
+      node (node)
+  {}
+  Kind kind;      //!< kind of the event
+  uint32_t node;  //!< node of the event
+private:
+  virtual void Notify (void)
+  {}
+};
+
+/** Result of a benchmark run. */
+struct Result
+{
+  uint64_t calls;        //!< number of calls to Insert, Remove and RemoveNext
+  uint64_t cancelled;    //!< cancelled events returned by RemoveNext
+  uint64_t dropped;      //!< cancelled events released by the scheduler
+  double seconds;        //!< wall clock time
+  std::size_t heapPeak;  //!< peak of the heap memory allocated during the run
+  int64_t cacheMisses;   //!< hardware cache misses, -1 if not available
+};
+
+/**
+ * Measure the time, the heap memory and the cache misses of a run.
+ */
+class Probe
+{
+public:
+  /** Constructor: open the cache miss counter, if possible. */
+  Probe ();
+  /** Destructor. */
+  ~Probe ();
+  /** Start the measure. */
+  void Start (void);
+  /**
+   * Stop the measure.
+   * \param [out] result The result of the run.
+   */
+  void Stop (Result &result);
+
+private:
+  std::chrono::steady_clock::time_point m_start; //!< start of the run
+  std::size_t m_heapStart;                       //!< heap memory at the start of the run
+  int m_fd;                                      //!< perf_event counter, or -1
+};
+
+Probe::Probe ()
+  : m_heapStart (0),
+    m_fd (-1)
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+  struct perf_event_attr attr;
+  std::memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // fails without a hardware counter or with a restrictive perf_event_paranoid
+  m_fd = syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+Probe::~Probe ()
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+  if (m_fd >= 0)
+    {
+      close (m_fd);
+    }
+#endif
+}
+
+void
+Probe::Start (void)
+{
+  m_heapStart = g_heapLive;
+  g_heapPeak = g_heapLive;
+#ifdef HAVE_LINUX_PERF_EVENT_H
+  if (m_fd >= 0)
+    {
+      ioctl (m_fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl (m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  m_start = std::chrono::steady_clock::now ();
+}
+
+void
+Probe::Stop (Result &result)
+{
+  result.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count ();
+  result.heapPeak = g_heapPeak - m_heapStart;
+  result.cacheMisses = -1;
+#ifdef HAVE_LINUX_PERF_EVENT_H
+  uint64_t count;
+  if (m_fd >= 0)
+    {
+      ioctl (m_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read (m_fd, &count, sizeof (count)) == sizeof (count))
+        {
+          result.cacheMisses = count;
+        }
+    }
+#endif
+}
+
+/**
+ * Run the mmWave MAC workload against a scheduler.
+ * \param [in] scheduler The scheduler.
+ * \param [in] nodes The number of nodes.
+ * \param [in] ops The number of Insert and RemoveNext to do.
+ * \param [in] cancel The probability to cancel, rather than let expire, a timer.
+ * \return The result.
+ */
+Result
+Bench (Ptr<Scheduler> scheduler, uint32_t nodes, uint64_t ops, double cancel)
+{
+  const uint64_t slot = 125000;        // 125 us
+  const uint64_t longDelay = 100000000; // 100 ms
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  Result result = { 0, 0, 0, 0, 0, -1 };
+  uint32_t uid = 0;
+  // the pending access timer of each node, referenced as by an EventId
+  std::vector<BenchEvent *> timers (nodes, 0);
+  auto insert = [&] (BenchEvent *event, uint64_t ts)
+    {
+      Scheduler::Event ev;
+      ev.impl = event;
+      ev.key.m_ts = ts;
+      ev.key.m_uid = uid++;
+      ev.key.m_context = event->node;
+      scheduler->Insert (ev);
+      result.calls++;
+    };
+
+  Probe probe;
+  probe.Start ();
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      insert (new BenchEvent (SLOT, i), random->GetInteger (0, slot - 1));
+    }
+  while (result.calls < ops && !scheduler->IsEmpty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      result.calls++;
+      BenchEvent *event = static_cast<BenchEvent *> (ev.impl);
+      uint64_t now = ev.key.m_ts;
+      if (event->IsCancelled ())
+        {
+          result.cancelled++;
+        }
+      else if (event->kind == SLOT)
+        {
+          uint32_t node = event->node;
+          insert (new BenchEvent (SLOT, node), now + slot);
+          if (timers[node] != 0)
+            {
+              if (random->GetValue () < cancel)
+                {
+                  timers[node]->Cancel ();
+                }
+              timers[node]->Unref ();
+            }
+          timers[node] = new BenchEvent (TIMER, node);
+          timers[node]->Ref ();
+          insert (timers[node], now + random->GetInteger (1, 4 * slot));
+          if (random->GetValue () < 0.01)
+            {
+              insert (new BenchEvent (LONG, node), now + random->GetInteger (0, longDelay));
+            }
+        }
+      event->Unref ();
+    }
+  probe.Stop (result);
+
+  result.dropped = scheduler->GetDroppedCount ();
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ().impl->Unref ();
+    }
+  for (BenchEvent *timer : timers)
+    {
+      if (timer != 0)
+        {
+          timer->Unref ();
+        }
+    }
+  return result;
+}
+
+/** An event trace, decoded once for all the schedulers. */
+struct Trace
+{
+  /** An operation of the trace. */
+  struct Operation
+  {
+    uint32_t uid;                  //!< unique id of the event
+    EventTraceOperation operation; //!< the operation
+  };
+  std::vector<Operation> operations;      //!< the operations
+  std::vector<Scheduler::EventKey> keys;  //!< the keys of the events, by uid
+  std::vector<uint64_t> kindCounts;       //!< number of inserted events, by kind
+  std::vector<std::string> kindNames;     //!< names of the kinds
+};
+
+/**
+ * Read an event trace.
+ * \param [in] filename The name of the file.
+ * \param [out] trace The trace.
+ */
+void
+ReadTrace (std::string filename, Trace &trace)
+{
+  EventTraceReader reader (filename);
+  EventTraceReader::Record record;
+  while (reader.Read (record))
+    {
+      Trace::Operation operation = { record.uid, record.operation };
+      trace.operations.push_back (operation);
+      if (record.operation == EVENT_TRACE_INSERT)
+        {
+          if (record.uid >= trace.keys.size ())
+            {
+              trace.keys.resize (record.uid + 1);
+            }
+          Scheduler::EventKey &key = trace.keys[record.uid];
+          key.m_ts = record.ts;
+          key.m_uid = record.uid;
+          key.m_context = record.context;
+          if (record.kind >= trace.kindCounts.size ())
+            {
+              trace.kindCounts.resize (record.kind + 1);
+            }
+          trace.kindCounts[record.kind]++;
+        }
+    }
+  for (uint32_t i = 0; i < reader.GetKindCount (); i++)
+    {
+      trace.kindNames.push_back (reader.GetKindName (i));
+    }
+}
+
+/**
+ * Replay an event trace against a scheduler.
+ * \param [in] scheduler The scheduler.
+ * \param [in] trace The trace.
+ * \return The result.
+ */
+Result
+Replay (Ptr<Scheduler> scheduler, const Trace &trace)
+{
+  Result result = { 0, 0, 0, 0, 0, -1 };
+  // the pending events, referenced as by an EventId
+  std::vector<EventImpl *> events (trace.keys.size (), 0);
+
+  Probe probe;
+  probe.Start ();
+  for (const Trace::Operation &operation : trace.operations)
+    {
+      uint32_t uid = operation.uid;
+      EventImpl *impl = uid < events.size () ? events[uid] : 0;
+      switch (operation.operation)
+        {
+        case EVENT_TRACE_INSERT:
+          {
+            Scheduler::Event ev;
+            ev.impl = new BenchEvent (TIMER, trace.keys[uid].m_context);
+            ev.impl->Ref ();
+            ev.key = trace.keys[uid];
+            events[uid] = ev.impl;
+            scheduler->Insert (ev);
+            result.calls++;
+          }
+          break;
+        case EVENT_TRACE_CANCEL:
+          if (impl != 0)
+            {
+              impl->Cancel ();
+              impl->Unref ();
+              events[uid] = 0;
+            }
+          break;
+        case EVENT_TRACE_REMOVE:
+          if (impl != 0)
+            {
+              Scheduler::Event ev;
+              ev.impl = impl;
+              ev.key = trace.keys[uid];
+              scheduler->Remove (ev);
+              result.calls++;
+              impl->Unref ();
+              impl->Unref ();
+              events[uid] = 0;
+            }
+          break;
+        case EVENT_TRACE_REMOVE_NEXT:
+          // the removal of a cancelled event, if the scheduler kept it,
+          // is done with the next removal of a pending event
+          if (impl != 0)
+            {
+              Scheduler::Event ev = scheduler->RemoveNext ();
+              result.calls++;
+              while (ev.impl->IsCancelled ())
+                {
+                  result.cancelled++;
+                  ev.impl->Unref ();
+                  ev = scheduler->RemoveNext ();
+                  result.calls++;
+                }
+              NS_ABORT_MSG_UNLESS (ev.key.m_uid == uid, "Event " << ev.key.m_uid
+                                   << " removed instead of " << uid);
+              impl->Unref ();
+              impl->Unref ();
+              events[uid] = 0;
+            }
+          break;
+        default:
+          break;
+        }
+    }
+  probe.Stop (result);
+
+  result.dropped = scheduler->GetDroppedCount ();
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ().impl->Unref ();
+    }
+  for (EventImpl *impl : events)
+    {
+      if (impl != 0)
+        {
+          impl->Unref ();
+        }
+    }
+  return result;
+}
+
+} // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 50;
+  uint64_t ops = 1000000;
+  double cancel = 0.8;
+  std::string traceFile;
+  bool kinds = false;
+  std::string schedulers = "ns3::MapScheduler,ns3::HeapScheduler,ns3::ListScheduler,"
+    "ns3::CalendarScheduler,ns3::PriorityQueueScheduler,ns3::LadderScheduler";
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("trace", "Event trace file to replay, instead of the mmWave MAC workload", traceFile);
+  cmd.AddValue ("kinds", "Print the number of events of each kind of the trace", kinds);
+  cmd.AddValue ("nodes", "Number of nodes of the mmWave MAC workload", nodes);
+  cmd.AddValue ("ops", "Number of scheduler operations of the mmWave MAC workload", ops);
+  cmd.AddValue ("cancel", "Probability to cancel an access timer in the mmWave MAC workload", cancel);
+  cmd.AddValue ("schedulers", "Comma separated list of the schedulers to run", schedulers);
+  cmd.Parse (argc, argv);
+
+  Trace trace;
+  if (!traceFile.empty ())
+    {
+      ReadTrace (traceFile, trace);
+      std::cout << traceFile << ": " << trace.operations.size () << " operations, "
+                << trace.kindNames.size () << " event kinds" << std::endl;
+      for (std::size_t i = 0; kinds && i < trace.kindNames.size (); i++)
+        {
+          std::cout << std::setw (12) << trace.kindCounts[i] << "  " << trace.kindNames[i] << std::endl;
+        }
+    }
+
+  std::cout << std::left << std::setw (28) << "scheduler"
+            << std::right << std::setw (10) << "ns/op"
+            << std::setw (12) << "peak KiB"
+            << std::setw (14) << "cache misses"
+            << std::setw (12) << "cancelled"
+            << std::setw (12) << "dropped" << std::endl;
+  std::istringstream list (schedulers);
+  std::string type;
+  while (std::getline (list, type, ','))
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (type);
+      Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+      Result result = traceFile.empty () ? Bench (scheduler, nodes, ops, cancel) : Replay (scheduler, trace);
+      std::cout << std::left << std::setw (28) << type
+                << std::right << std::setw (10) << std::fixed << std::setprecision (1)
+                << result.seconds * 1e9 / result.calls
+                << std::setw (12) << result.heapPeak / 1024
+                << std::setw (14);
+      if (result.cacheMisses < 0)
+        {
+          std::cout << "n/a";
+        }
+      else
+        {
+          std::cout << result.cacheMisses;
+        }
+      std::cout << std::setw (12) << result.cancelled
+                << std::setw (12) << result.dropped << std::endl;
+    }
+  return 0;
+}
@@ -22,9 +22,11 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-trace.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
@@ -53,6 +55,14 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventTraceFile",
+                   "The file the operations on the event queue are recorded to, "
+                   "to replay them with the bench-scheduler example; "
+                   "empty for none.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventTraceFile,
+                                       &DefaultSimulatorImpl::GetEventTraceFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -74,11 +84,13 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self ();
+  m_eventTrace = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_eventTrace;
 }
 
 void
@@ -93,6 +105,7 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  SetEventTraceFile ("");
   SimulatorImpl::DoDispose ();
 }
 void
@@ -124,10 +137,31 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
           Scheduler::Event next = m_events->RemoveNext ();
           scheduler->Insert (next);
         }
+      // the events released by the old scheduler will not be run
+      m_unscheduledEvents -= m_events->GetDroppedCount ();
     }
   m_events = scheduler;
 }
 
+void
+DefaultSimulatorImpl::SetEventTraceFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  delete m_eventTrace;
+  m_eventTrace = 0;
+  m_eventTraceFile = filename;
+  if (!filename.empty ())
+    {
+      m_eventTrace = new EventTraceWriter (filename);
+    }
+}
+
+std::string
+DefaultSimulatorImpl::GetEventTraceFile (void) const
+{
+  return m_eventTraceFile;
+}
+
 // System ID for non-distributed simulation is always zero
 uint32_t
 DefaultSimulatorImpl::GetSystemId (void) const
@@ -139,6 +173,10 @@ void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
   Scheduler::Event next = m_events->RemoveNext ();
+  if (m_eventTrace != 0)
+    {
+      m_eventTrace->RemoveNext (next);
+    }
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
@@ -187,6 +225,10 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      if (m_eventTrace != 0)
+        {
+          m_eventTrace->Insert (ev);
+        }
     }
 }
 
@@ -206,7 +248,7 @@ DefaultSimulatorImpl::Run (void)
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == (int) m_events->GetDroppedCount ());
 }
 
 void
@@ -243,6 +285,10 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_eventTrace != 0)
+    {
+      m_eventTrace->Insert (ev);
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -262,6 +308,10 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      if (m_eventTrace != 0)
+        {
+          m_eventTrace->Insert (ev);
+        }
     }
   else
     {
@@ -291,6 +341,10 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_eventTrace != 0)
+    {
+      m_eventTrace->Insert (ev);
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -351,6 +405,10 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
   m_events->Remove (event);
+  if (m_eventTrace != 0)
+    {
+      m_eventTrace->Remove (event.key.m_uid);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
@@ -364,6 +422,11 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      // the destroy events are not in the event queue
+      if (m_eventTrace != 0 && id.GetUid () != 2)
+        {
+          m_eventTrace->Cancel (id.GetUid ());
+        }
     }
 }
 
@@ -30,6 +30,7 @@
 #include "ptr.h"
 
 #include <list>
+#include <string>
 
 /**
  * \file
@@ -39,10 +40,17 @@
 
 namespace ns3 {
 
+class EventTraceWriter;
+
 /**
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the EventTraceFile attribute is set, the operations on the event
+ * queue are recorded to that file, see EventTraceWriter; a recorded
+ * simulation can then be replayed against each Scheduler, see the
+ * bench-scheduler example.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -86,6 +94,13 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /**
+   * Start or stop recording the event queue operations.
+   * \param [in] filename The event trace file, empty to stop.
+   */
+  void SetEventTraceFile (std::string filename);
+  /** \return The event trace file, empty if none. */
+  std::string GetEventTraceFile (void) const;
 
   /** Wrap an event with its execution context. */
   struct EventWithContext
@@ -136,6 +151,11 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The name of the event trace file. */
+  std::string m_eventTraceFile;
+  /** The recorder of the event queue operations, or 0. */
+  EventTraceWriter *m_eventTrace;
 };
 
 } // namespace ns3
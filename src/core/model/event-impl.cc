@@ -21,6 +21,8 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +33,124 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the size classes of the event free lists, in bytes. */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes; larger events are allocated from the heap. */
+const std::size_t EVENT_POOL_CLASSES = 16;
+/** Beyond this, the released events of a size class go back to the heap. */
+const uint32_t EVENT_POOL_MAX_BLOCKS = 4096;
+
+/** A released block, linked in the free list of its size class. */
+struct EventBlock
+{
+  EventBlock *next;   //!< next released block
+};
+
+/**
+ * Free lists of event blocks of one thread.
+ */
+class EventPool
+{
+public:
+  EventPool ()
+    : allocations (0),
+      heapAllocations (0)
+  {
+    for (std::size_t i = 0; i < EVENT_POOL_CLASSES; i++)
+      {
+        blocks[i] = 0;
+        nBlocks[i] = 0;
+      }
+  }
+  ~EventPool ()
+  {
+    for (std::size_t i = 0; i < EVENT_POOL_CLASSES; i++)
+      {
+        while (blocks[i] != 0)
+          {
+            EventBlock *block = blocks[i];
+            blocks[i] = block->next;
+            ::operator delete (block);
+          }
+      }
+    destroyed = true;
+  }
+
+  /** Events released after the pool is gone go back to the heap. */
+  static thread_local bool destroyed;
+  EventBlock *blocks[EVENT_POOL_CLASSES];   //!< blocks ready for reuse, per size class
+  uint32_t nBlocks[EVENT_POOL_CLASSES];     //!< number of blocks of each free list
+  uint64_t allocations;                     //!< events allocated
+  uint64_t heapAllocations;                 //!< events allocated from the heap
+};
+
+thread_local bool EventPool::destroyed = false;
+/** The blocks of the events released by the thread. */
+thread_local EventPool g_eventPool;
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (EventPool::destroyed)
+    {
+      return ::operator new (size);
+    }
+  EventPool &pool = g_eventPool;
+  pool.allocations++;
+  if (sizeClass >= EVENT_POOL_CLASSES)
+    {
+      pool.heapAllocations++;
+      return ::operator new (size);
+    }
+  EventBlock *block = pool.blocks[sizeClass];
+  if (block == 0)
+    {
+      pool.heapAllocations++;
+      return ::operator new ((sizeClass + 1) * EVENT_POOL_GRANULARITY);
+    }
+  pool.blocks[sizeClass] = block->next;
+  pool.nBlocks[sizeClass]--;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *block, std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (EventPool::destroyed || sizeClass >= EVENT_POOL_CLASSES)
+    {
+      ::operator delete (block);
+      return;
+    }
+  EventPool &pool = g_eventPool;
+  if (pool.nBlocks[sizeClass] >= EVENT_POOL_MAX_BLOCKS)
+    {
+      ::operator delete (block);
+      return;
+    }
+  EventBlock *released = static_cast<EventBlock *> (block);
+  released->next = pool.blocks[sizeClass];
+  pool.blocks[sizeClass] = released;
+  pool.nBlocks[sizeClass]++;
+}
+
+uint64_t
+EventImpl::GetAllocationCount (void)
+{
+  return EventPool::destroyed ? 0 : g_eventPool.allocations;
+}
+
+uint64_t
+EventImpl::GetHeapAllocationCount (void)
+{
+  return EventPool::destroyed ? 0 : g_eventPool.heapAllocations;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
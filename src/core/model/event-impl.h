@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,13 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The memory of the events comes from per-thread free lists, one per
+ * size class of 16 bytes up to 256 bytes: the arguments bound by
+ * MakeEvent are stored in the event itself, so scheduling an event
+ * usually reuses the block of an event which has already run, and
+ * releasing the last reference to an event returns its block to the
+ * free list instead of the heap.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +74,28 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the memory of an event from the free list of its size class.
+   * \param [in] size The size of the event.
+   * \returns The memory block.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the memory of an event to the free list of its size class.
+   * \param [in] block The memory block.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *block, std::size_t size);
+  /**
+   * \returns The number of events allocated by the calling thread.
+   */
+  static uint64_t GetAllocationCount (void);
+  /**
+   * \returns The number of events allocated by the calling thread whose
+   * memory came from the heap rather than from a free list.
+   */
+  static uint64_t GetHeapAllocationCount (void);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,400 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+#include "event-profiler.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+bool EventProfiler::m_enabled = false;
+
+namespace {
+
+/** The clock used to measure the events. */
+typedef std::chrono::steady_clock ProfilerClock;
+
+/** A registered tag. */
+struct ProfilerTag
+{
+  std::string name;   //!< Class::Method
+  std::string layer;  //!< Class
+};
+
+/** The statistics of the events of one tag on one node. */
+struct ProfilerStats
+{
+  uint64_t count = 0; //!< number of executed events
+  int64_t wallNs = 0; //!< wall time spent in the events, in ns
+  int64_t maxNs = 0;  //!< longest event, in ns
+};
+
+/** An executed event kept for the Chrome trace. */
+struct ProfilerRecord
+{
+  uint32_t tag;       //!< the tag of the event
+  uint32_t context;   //!< the node
+  int64_t startNs;    //!< start, in ns since the profiler was enabled
+  int64_t wallNs;     //!< duration, in ns
+};
+
+/** The state of the profiler. */
+struct ProfilerState
+{
+  std::vector<ProfilerTag> tags;                     //!< the registered tags
+  std::map<std::string, uint32_t> tagIndex;          //!< tag of each name
+  std::map<std::pair<uint32_t, uint32_t>, ProfilerStats> stats; //!< stats per (tag, context)
+  std::vector<ProfilerRecord> records;               //!< events of the Chrome trace
+  uint32_t maxRecords = 0;                           //!< maximum size of records
+  ProfilerClock::time_point origin;                  //!< when the profiler was enabled
+  std::string profileFile;                           //!< the flat profile output
+  std::string traceFile;                             //!< the Chrome trace output
+};
+
+/** \returns The state of the profiler. */
+ProfilerState &
+GetState (void)
+{
+  static ProfilerState state;
+  return state;
+}
+
+/**
+ * An event measuring the execution of the event it wraps.
+ */
+class ProfiledEventImpl : public EventImpl
+{
+public:
+  /**
+   * \param [in] tag The tag of the event.
+   * \param [in] event The wrapped event, whose reference is taken over.
+   */
+  ProfiledEventImpl (uint32_t tag, EventImpl *event)
+    : m_tag (tag),
+      m_event (event)
+  {}
+  virtual ~ProfiledEventImpl ()
+  {
+    m_event->Unref ();
+  }
+
+private:
+  virtual void Notify (void)
+  {
+    ProfilerClock::time_point start = ProfilerClock::now ();
+    m_event->Invoke ();
+    ProfilerClock::time_point end = ProfilerClock::now ();
+    if (!EventProfiler::IsEnabled ())
+      {
+        return;
+      }
+    ProfilerState &state = GetState ();
+    uint32_t context = Simulator::GetContext ();
+    int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count ();
+    ProfilerStats &stats = state.stats[std::make_pair (m_tag, context)];
+    stats.count++;
+    stats.wallNs += wallNs;
+    stats.maxNs = std::max (stats.maxNs, wallNs);
+    if (state.records.size () < state.maxRecords)
+      {
+        int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds> (start - state.origin).count ();
+        state.records.push_back ({m_tag, context, startNs, wallNs});
+      }
+  }
+
+  uint32_t m_tag;       //!< the tag of the event
+  EventImpl *m_event;   //!< the wrapped event
+};
+
+/**
+ * Add the statistics of some events to others.
+ * \param [in,out] to The statistics to update.
+ * \param [in] from The statistics to add.
+ */
+void
+Accumulate (ProfilerStats &to, const ProfilerStats &from)
+{
+  to.count += from.count;
+  to.wallNs += from.wallNs;
+  to.maxNs = std::max (to.maxNs, from.maxNs);
+}
+
+/**
+ * Print a context, the nodes being numbered from 0.
+ * \param [in,out] os The output stream.
+ * \param [in] context The context.
+ */
+void
+PrintContext (std::ostream &os, uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      os << "-";
+    }
+  else
+    {
+      os << context;
+    }
+}
+
+} // unnamed namespace
+
+void
+EventProfiler::Enable (std::string profileFile, std::string traceFile, uint32_t maxTraceEvents)
+{
+  NS_LOG_FUNCTION (profileFile << traceFile << maxTraceEvents);
+  ProfilerState &state = GetState ();
+  state.stats.clear ();
+  state.records.clear ();
+  state.maxRecords = traceFile.empty () ? 0 : maxTraceEvents;
+  state.origin = ProfilerClock::now ();
+  state.profileFile = profileFile;
+  state.traceFile = traceFile;
+  if (!m_enabled)
+    {
+      Simulator::ScheduleDestroy (&EventProfiler::Write);
+    }
+  m_enabled = true;
+}
+
+void
+EventProfiler::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ProfilerState &state = GetState ();
+  state.stats.clear ();
+  state.records.clear ();
+  state.profileFile = "";
+  state.traceFile = "";
+  m_enabled = false;
+}
+
+bool
+EventProfiler::IsEnabled (void)
+{
+  return m_enabled;
+}
+
+uint32_t
+EventProfiler::Register (std::string name)
+{
+  NS_LOG_FUNCTION (name);
+  name.erase (0, name.find_first_not_of ("& "));
+  ProfilerState &state = GetState ();
+  auto it = state.tagIndex.find (name);
+  if (it != state.tagIndex.end ())
+    {
+      return it->second;
+    }
+  ProfilerTag tag;
+  tag.name = name;
+  std::size_t separator = name.rfind ("::");
+  tag.layer = (separator == std::string::npos) ? "" : name.substr (0, separator);
+  uint32_t index = state.tags.size ();
+  state.tags.push_back (tag);
+  state.tagIndex[name] = index;
+  return index;
+}
+
+EventImpl *
+EventProfiler::Wrap (uint32_t tag, EventImpl *event)
+{
+  return new ProfiledEventImpl (tag, event);
+}
+
+uint64_t
+EventProfiler::GetCount (std::string name, uint32_t context)
+{
+  ProfilerState &state = GetState ();
+  auto tag = state.tagIndex.find (name);
+  if (tag == state.tagIndex.end ())
+    {
+      return 0;
+    }
+  auto it = state.stats.find (std::make_pair (tag->second, context));
+  return (it == state.stats.end ()) ? 0 : it->second.count;
+}
+
+uint64_t
+EventProfiler::GetLayerCount (std::string layer, uint32_t context)
+{
+  ProfilerState &state = GetState ();
+  uint64_t count = 0;
+  for (auto &it : state.stats)
+    {
+      if (it.first.second == context && state.tags[it.first.first].layer == layer)
+        {
+          count += it.second.count;
+        }
+    }
+  return count;
+}
+
+void
+EventProfiler::Print (std::ostream &os)
+{
+  ProfilerState &state = GetState ();
+  std::vector<ProfilerStats> perTag (state.tags.size ());
+  std::map<std::string, ProfilerStats> perLayer;
+  std::map<std::pair<uint32_t, std::string>, ProfilerStats> perNodeLayer;
+  int64_t totalNs = 0;
+  for (auto &it : state.stats)
+    {
+      const std::string &layer = state.tags[it.first.first].layer;
+      Accumulate (perTag[it.first.first], it.second);
+      Accumulate (perLayer[layer], it.second);
+      Accumulate (perNodeLayer[std::make_pair (it.first.second, layer)], it.second);
+      totalNs += it.second.wallNs;
+    }
+  std::vector<uint32_t> tags;
+  for (uint32_t i = 0; i < perTag.size (); i++)
+    {
+      if (perTag[i].count > 0)
+        {
+          tags.push_back (i);
+        }
+    }
+  std::sort (tags.begin (), tags.end (), [&perTag] (uint32_t a, uint32_t b)
+             { return perTag[a].wallNs > perTag[b].wallNs; });
+
+  os << std::fixed << std::setprecision (3);
+  os << "% time    wall (ms)      events    mean (us)    max (us)  event" << std::endl;
+  for (uint32_t tag : tags)
+    {
+      const ProfilerStats &stats = perTag[tag];
+      os << std::setw (6) << (totalNs > 0 ? 100.0 * stats.wallNs / totalNs : 0.0)
+         << std::setw (13) << stats.wallNs / 1e6
+         << std::setw (12) << stats.count
+         << std::setw (13) << stats.wallNs / 1e3 / stats.count
+         << std::setw (12) << stats.maxNs / 1e3
+         << "  " << state.tags[tag].name << std::endl;
+    }
+
+  std::vector<std::pair<std::string, ProfilerStats> > layers (perLayer.begin (), perLayer.end ());
+  std::sort (layers.begin (), layers.end (), [] (const std::pair<std::string, ProfilerStats> &a,
+                                                 const std::pair<std::string, ProfilerStats> &b)
+             { return a.second.wallNs > b.second.wallNs; });
+  os << std::endl << "% time    wall (ms)      events    mean (us)    max (us)  layer" << std::endl;
+  for (auto &it : layers)
+    {
+      const ProfilerStats &stats = it.second;
+      os << std::setw (6) << (totalNs > 0 ? 100.0 * stats.wallNs / totalNs : 0.0)
+         << std::setw (13) << stats.wallNs / 1e6
+         << std::setw (12) << stats.count
+         << std::setw (13) << stats.wallNs / 1e3 / stats.count
+         << std::setw (12) << stats.maxNs / 1e3
+         << "  " << it.first << std::endl;
+    }
+
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, ProfilerStats> > perNode (state.stats.begin (), state.stats.end ());
+  std::sort (perNode.begin (), perNode.end (), [] (const std::pair<std::pair<uint32_t, uint32_t>, ProfilerStats> &a,
+                                                   const std::pair<std::pair<uint32_t, uint32_t>, ProfilerStats> &b)
+             { return a.second.wallNs > b.second.wallNs; });
+  os << std::endl << "node    wall (ms)      events  event" << std::endl;
+  for (auto &it : perNode)
+    {
+      os << std::setw (4);
+      PrintContext (os, it.first.second);
+      os << std::setw (13) << it.second.wallNs / 1e6
+         << std::setw (12) << it.second.count
+         << "  " << state.tags[it.first.first].name << std::endl;
+    }
+
+  std::vector<std::pair<std::pair<uint32_t, std::string>, ProfilerStats> > nodeLayers (perNodeLayer.begin (), perNodeLayer.end ());
+  std::sort (nodeLayers.begin (), nodeLayers.end (), [] (const std::pair<std::pair<uint32_t, std::string>, ProfilerStats> &a,
+                                                         const std::pair<std::pair<uint32_t, std::string>, ProfilerStats> &b)
+             { return a.second.wallNs > b.second.wallNs; });
+  os << std::endl << "node    wall (ms)      events  layer" << std::endl;
+  for (auto &it : nodeLayers)
+    {
+      os << std::setw (4);
+      PrintContext (os, it.first.first);
+      os << std::setw (13) << it.second.wallNs / 1e6
+         << std::setw (12) << it.second.count
+         << "  " << it.first.second << std::endl;
+    }
+  os << std::defaultfloat;
+}
+
+void
+EventProfiler::PrintChromeTrace (std::ostream &os)
+{
+  ProfilerState &state = GetState ();
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto &record : state.records)
+    {
+      const ProfilerTag &tag = state.tags[record.tag];
+      os << (first ? "\n" : ",\n")
+         << "{\"name\":\"" << tag.name << "\",\"cat\":\"" << tag.layer
+         << "\",\"ph\":\"X\",\"pid\":0,\"tid\":";
+      if (record.context == Simulator::NO_CONTEXT)
+        {
+          os << -1;
+        }
+      else
+        {
+          os << record.context;
+        }
+      os << std::fixed << std::setprecision (3)
+         << ",\"ts\":" << record.startNs / 1e3 << ",\"dur\":" << record.wallNs / 1e3 << "}"
+         << std::defaultfloat;
+      first = false;
+    }
+  os << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+}
+
+void
+EventProfiler::Write (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (!m_enabled)
+    {
+      return;
+    }
+  ProfilerState &state = GetState ();
+  if (!state.profileFile.empty ())
+    {
+      std::ofstream os (state.profileFile.c_str ());
+      Print (os);
+    }
+  if (!state.traceFile.empty ())
+    {
+      std::ofstream os (state.traceFile.c_str ());
+      PrintChromeTrace (os);
+    }
+  if (state.records.size () == state.maxRecords && state.maxRecords > 0)
+    {
+      NS_LOG_WARN ("The Chrome trace holds only the first " << state.maxRecords << " events");
+    }
+  Disable ();
+}
+
+} // namespace ns3
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+#include "simulator.h"
+#include "make-event.h"
+#include "event-impl.h"
+#include "nstime.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * @ingroup simulator
+ *
+ * @brief Opt-in wall-clock profiler of the events of selected models.
+ *
+ * Events scheduled through NS_PROFILE_SCHEDULE or
+ * NS_PROFILE_SCHEDULE_WITH_CONTEXT are tagged with the name of the
+ * member function they invoke, e.g. \c "MmWavePhy::EndReceive", whose
+ * class is taken as the layer of the event. While the profiler is
+ * enabled, the host wall time spent in each tagged event is measured
+ * with \c std::chrono::steady_clock and accumulated per node (the
+ * simulation context the event runs in) and per tag, and summed per
+ * layer. While it is
+ * disabled the macros schedule the plain event, at the cost of one
+ * test.
+ *
+ * The profile is written when the simulator is destroyed:
+ * a flat profile sorted by decreasing total wall time and, optionally,
+ * a trace in the Chrome trace-event JSON format (one complete event per
+ * executed event, the node as thread id) that can be loaded in
+ * chrome://tracing or Perfetto.
+ *
+ * \code
+ *   EventProfiler::Enable ("profile.txt", "profile.json");
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ * \endcode
+ */
+class EventProfiler
+{
+public:
+  /**
+   * Start profiling the tagged events.
+   *
+   * \param [in] profileFile The file the flat profile is written to when
+   *             the simulator is destroyed, empty for none.
+   * \param [in] traceFile The file the Chrome trace is written to when
+   *             the simulator is destroyed, empty for none.
+   * \param [in] maxTraceEvents The maximum number of events kept for the
+   *             Chrome trace, the later ones are only counted.
+   */
+  static void Enable (std::string profileFile, std::string traceFile = "",
+                      uint32_t maxTraceEvents = 1000000);
+  /** Stop profiling and drop the statistics collected so far. */
+  static void Disable (void);
+  /** \returns \c true if the tagged events are profiled. */
+  static bool IsEnabled (void);
+
+  /**
+   * Register a tag.
+   *
+   * \param [in] name The name of the tag, \c "Class::Method"; a leading
+   *             \c '&' is dropped, and the part before the last \c "::"
+   *             is the layer.
+   * \returns The identifier of the tag.
+   */
+  static uint32_t Register (std::string name);
+
+  /**
+   * Schedule a tagged event, see Simulator::Schedule.
+   *
+   * \tparam FUNC \deduced The type of the function to invoke.
+   * \tparam Ts \deduced Argument types.
+   * \param [in] tag The tag of the event.
+   * \param [in] delay The relative expiration time of the event.
+   * \param [in] f The function to invoke.
+   * \param [in] args Arguments to pass to MakeEvent.
+   * \returns The id for the scheduled event.
+   */
+  template <typename FUNC, typename... Ts>
+  static EventId Schedule (uint32_t tag, Time const &delay, FUNC f, Ts&&... args);
+
+  /**
+   * Schedule a tagged event with the given context, see
+   * Simulator::ScheduleWithContext.
+   *
+   * \tparam FUNC \deduced The type of the function to invoke.
+   * \tparam Ts \deduced Argument types.
+   * \param [in] tag The tag of the event.
+   * \param [in] context The context of the event.
+   * \param [in] delay The relative expiration time of the event.
+   * \param [in] f The function to invoke.
+   * \param [in] args Arguments to pass to MakeEvent.
+   */
+  template <typename FUNC, typename... Ts>
+  static void ScheduleWithContext (uint32_t tag, uint32_t context, Time const &delay, FUNC f, Ts&&... args);
+
+  /**
+   * \param [in] name The name of a tag.
+   * \param [in] context The node.
+   * \returns The number of events of the tag executed on the node.
+   */
+  static uint64_t GetCount (std::string name, uint32_t context);
+  /**
+   * \param [in] layer The layer of some tags, e.g. \c "MmWavePhy".
+   * \param [in] context The node.
+   * \returns The number of events of the tags of the layer executed on
+   *          the node.
+   */
+  static uint64_t GetLayerCount (std::string layer, uint32_t context);
+
+  /**
+   * Print the flat profile: the events per tag, per layer, per node and
+   * tag, then per node and layer, each sorted by decreasing wall time.
+   * \param [in,out] os The output stream.
+   */
+  static void Print (std::ostream &os);
+  /**
+   * Print the executed events in the Chrome trace-event format.
+   * \param [in,out] os The output stream.
+   */
+  static void PrintChromeTrace (std::ostream &os);
+
+private:
+  /**
+   * Wrap an event to measure its execution.
+   * \param [in] tag The tag of the event.
+   * \param [in] event The event, whose reference is taken over.
+   * \returns The event to schedule instead.
+   */
+  static EventImpl * Wrap (uint32_t tag, EventImpl *event);
+  /** Write the profile files, at the destruction of the simulator. */
+  static void Write (void);
+
+  static bool m_enabled; //!< whether the tagged events are profiled
+};
+
+/**
+ * @ingroup simulator
+ * \returns The identifier of the tag of the member function \p f,
+ * registered once per call site.
+ * \param [in] f The member function, e.g. \c &MmWavePhy::EndReceive.
+ */
+#define NS_PROFILE_TAG(f)                                               \
+  ([] () { static const uint32_t tag = ns3::EventProfiler::Register (#f); return tag; } ())
+
+/**
+ * @ingroup simulator
+ * Simulator::Schedule of an event profiled by EventProfiler.
+ * \param [in] delay The relative expiration time of the event.
+ * \param [in] f The member function to invoke.
+ */
+#define NS_PROFILE_SCHEDULE(delay, f, ...)                              \
+  ns3::EventProfiler::Schedule (NS_PROFILE_TAG (f), delay, f, __VA_ARGS__)
+
+/**
+ * @ingroup simulator
+ * Simulator::ScheduleWithContext of an event profiled by EventProfiler.
+ * \param [in] context The context of the event.
+ * \param [in] delay The relative expiration time of the event.
+ * \param [in] f The member function to invoke.
+ */
+#define NS_PROFILE_SCHEDULE_WITH_CONTEXT(context, delay, f, ...)        \
+  ns3::EventProfiler::ScheduleWithContext (NS_PROFILE_TAG (f), context, delay, f, __VA_ARGS__)
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename FUNC, typename... Ts>
+EventId
+EventProfiler::Schedule (uint32_t tag, Time const &delay, FUNC f, Ts&&... args)
+{
+  EventImpl *event = MakeEvent (f, std::forward<Ts> (args)...);
+  if (m_enabled)
+    {
+      event = Wrap (tag, event);
+    }
+  return Simulator::Schedule (delay, Ptr<EventImpl> (event, false));
+}
+
+template <typename FUNC, typename... Ts>
+void
+EventProfiler::ScheduleWithContext (uint32_t tag, uint32_t context, Time const &delay, FUNC f, Ts&&... args)
+{
+  EventImpl *event = MakeEvent (f, std::forward<Ts> (args)...);
+  if (m_enabled)
+    {
+      event = Wrap (tag, event);
+    }
+  Simulator::ScheduleWithContext (context, delay, event);
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
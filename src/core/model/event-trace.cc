@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-trace.h"
+#include "event-impl.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+
+#include <cstring>
+#include <typeinfo>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventTraceWriter and ns3::EventTraceReader implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventTrace");
+
+namespace {
+
+/** The first bytes of an event trace file. */
+const char EVENT_TRACE_MAGIC[8] = { 'N', 'S', '3', 'E', 'V', 'T', 'R', '1' };
+/** Size of the blocks written to the trace file. */
+const std::size_t EVENT_TRACE_BLOCK = 64 * 1024;
+
+} // unnamed namespace
+
+EventTraceWriter::EventTraceWriter (std::string filename)
+  : m_os (filename.c_str (), std::ios::binary),
+    m_lastUid (0),
+    m_now (0)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (!m_os.is_open ())
+    {
+      NS_FATAL_ERROR ("Can not open event trace file " << filename);
+    }
+  m_os.write (EVENT_TRACE_MAGIC, sizeof (EVENT_TRACE_MAGIC));
+  m_buffer.reserve (EVENT_TRACE_BLOCK + 64);
+}
+
+EventTraceWriter::~EventTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+}
+
+void
+EventTraceWriter::Flush (void)
+{
+  m_os.write (reinterpret_cast<const char *> (m_buffer.data ()), m_buffer.size ());
+  m_buffer.clear ();
+}
+
+void
+EventTraceWriter::WriteOperation (EventTraceOperation operation)
+{
+  // a record is shorter than the slack reserved past the block size
+  if (m_buffer.size () >= EVENT_TRACE_BLOCK)
+    {
+      Flush ();
+    }
+  m_buffer.push_back (static_cast<uint8_t> (operation));
+}
+
+void
+EventTraceWriter::WriteValue (uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      m_buffer.push_back (static_cast<uint8_t> (value | 0x80));
+      value >>= 7;
+    }
+  m_buffer.push_back (static_cast<uint8_t> (value));
+}
+
+uint32_t
+EventTraceWriter::GetKind (const EventImpl *event)
+{
+  std::type_index type (typeid (*event));
+  std::unordered_map<std::type_index, uint32_t>::const_iterator i = m_kinds.find (type);
+  if (i != m_kinds.end ())
+    {
+      return i->second;
+    }
+  uint32_t kind = m_kinds.size ();
+  m_kinds[type] = kind;
+  const char *name = type.name ();
+  std::size_t length = std::strlen (name);
+  WriteOperation (EVENT_TRACE_KIND);
+  WriteValue (kind);
+  WriteValue (length);
+  Flush ();
+  m_os.write (name, length);
+  return kind;
+}
+
+void
+EventTraceWriter::Insert (const Scheduler::Event &ev)
+{
+  NS_ASSERT (ev.key.m_uid > m_lastUid && ev.key.m_ts >= m_now);
+  uint32_t kind = GetKind (ev.impl);
+  WriteOperation (EVENT_TRACE_INSERT);
+  WriteValue (ev.key.m_uid - m_lastUid);
+  WriteValue (ev.key.m_ts - m_now);
+  // Simulator::NO_CONTEXT is encoded as 0
+  WriteValue (static_cast<uint32_t> (ev.key.m_context + 1));
+  WriteValue (kind);
+  m_lastUid = ev.key.m_uid;
+}
+
+void
+EventTraceWriter::RemoveNext (const Scheduler::Event &ev)
+{
+  NS_ASSERT (ev.key.m_ts >= m_now);
+  WriteOperation (EVENT_TRACE_REMOVE_NEXT);
+  WriteValue (m_lastUid - ev.key.m_uid);
+  WriteValue (ev.key.m_ts - m_now);
+  m_now = ev.key.m_ts;
+}
+
+void
+EventTraceWriter::Remove (uint32_t uid)
+{
+  WriteOperation (EVENT_TRACE_REMOVE);
+  WriteValue (m_lastUid - uid);
+}
+
+void
+EventTraceWriter::Cancel (uint32_t uid)
+{
+  WriteOperation (EVENT_TRACE_CANCEL);
+  WriteValue (m_lastUid - uid);
+}
+
+EventTraceReader::EventTraceReader (std::string filename)
+  : m_filename (filename),
+    m_is (filename.c_str (), std::ios::binary),
+    m_lastUid (0),
+    m_now (0)
+{
+  NS_LOG_FUNCTION (this << filename);
+  char magic[sizeof (EVENT_TRACE_MAGIC)];
+  if (!m_is.read (magic, sizeof (magic))
+      || std::memcmp (magic, EVENT_TRACE_MAGIC, sizeof (magic)) != 0)
+    {
+      NS_FATAL_ERROR ("Not an event trace file: " << filename);
+    }
+}
+
+uint64_t
+EventTraceReader::ReadValue (void)
+{
+  uint64_t value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      int byte = m_is.get ();
+      if (byte == std::char_traits<char>::eof ())
+        {
+          NS_FATAL_ERROR ("Truncated event trace file: " << m_filename);
+        }
+      value |= static_cast<uint64_t> (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        {
+          return value;
+        }
+    }
+  NS_FATAL_ERROR ("Corrupted event trace file: " << m_filename);
+  return value;
+}
+
+bool
+EventTraceReader::Read (Record &record)
+{
+  int operation;
+  while ((operation = m_is.get ()) == EVENT_TRACE_KIND)
+    {
+      uint32_t kind = ReadValue ();
+      std::string name (ReadValue (), '\0');
+      m_is.read (&name[0], name.size ());
+      if (kind != m_kinds.size () || !m_is)
+        {
+          NS_FATAL_ERROR ("Corrupted event trace file: " << m_filename);
+        }
+      m_kinds.push_back (name);
+    }
+  record.operation = static_cast<EventTraceOperation> (operation);
+  record.ts = 0;
+  record.context = 0;
+  record.kind = 0;
+  switch (operation)
+    {
+    case std::char_traits<char>::eof ():
+      return false;
+    case EVENT_TRACE_INSERT:
+      m_lastUid += ReadValue ();
+      record.uid = m_lastUid;
+      record.ts = m_now + ReadValue ();
+      record.context = static_cast<uint32_t> (ReadValue ()) - 1;
+      record.kind = ReadValue ();
+      if (record.kind >= m_kinds.size ())
+        {
+          NS_FATAL_ERROR ("Corrupted event trace file: " << m_filename);
+        }
+      break;
+    case EVENT_TRACE_REMOVE_NEXT:
+      record.uid = m_lastUid - ReadValue ();
+      m_now += ReadValue ();
+      record.ts = m_now;
+      break;
+    case EVENT_TRACE_REMOVE:
+    case EVENT_TRACE_CANCEL:
+      record.uid = m_lastUid - ReadValue ();
+      break;
+    default:
+      NS_FATAL_ERROR ("Corrupted event trace file: " << m_filename);
+    }
+  return true;
+}
+
+std::string
+EventTraceReader::GetKindName (uint32_t kind) const
+{
+  NS_ASSERT (kind < m_kinds.size ());
+  return m_kinds[kind];
+}
+
+uint32_t
+EventTraceReader::GetKindCount (void) const
+{
+  return m_kinds.size ();
+}
+
+} // namespace ns3
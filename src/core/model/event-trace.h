@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventTraceWriter and ns3::EventTraceReader declarations.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * The operations of the event queue recorded in an event trace.
+ *
+ * An event trace file starts with the 8 bytes \c "NS3EVTR1", followed by
+ * records made of an operation byte and of unsigned LEB128 integers:
+ *
+ * Operation  | Fields
+ * :--------- | :-----
+ * Kind       | kind, name length, name
+ * Insert     | uid - previous inserted uid, ts - now, context + 1, kind
+ * RemoveNext | last inserted uid - uid, ts - now
+ * Remove     | last inserted uid - uid
+ * Cancel     | last inserted uid - uid
+ *
+ * \c now is the time stamp of the last event removed by RemoveNext, i.e.
+ * the current simulation time when the operation happened. The kind of
+ * an event is the dynamic type of its EventImpl, which is named by a Kind
+ * record before its first use.
+ */
+enum EventTraceOperation
+{
+  EVENT_TRACE_KIND = 0,
+  EVENT_TRACE_INSERT = 1,
+  EVENT_TRACE_REMOVE_NEXT = 2,
+  EVENT_TRACE_REMOVE = 3,
+  EVENT_TRACE_CANCEL = 4
+};
+
+/**
+ * \ingroup simulator
+ *
+ * Record the operations of an event queue to an event trace file.
+ *
+ * The records are encoded in memory and written by blocks of 64 KiB.
+ */
+class EventTraceWriter
+{
+public:
+  /**
+   * Create the trace file.
+   * \param [in] filename The name of the file.
+   */
+  EventTraceWriter (std::string filename);
+  /** Write the last records and close the file. */
+  ~EventTraceWriter ();
+
+  /**
+   * Record the insertion of an event.
+   * \param [in] ev The event.
+   */
+  void Insert (const Scheduler::Event &ev);
+  /**
+   * Record the removal of the next event; its time stamp becomes the
+   * current time.
+   * \param [in] ev The event.
+   */
+  void RemoveNext (const Scheduler::Event &ev);
+  /**
+   * Record the removal of an event before its expiration.
+   * \param [in] uid The unique id of the event.
+   */
+  void Remove (uint32_t uid);
+  /**
+   * Record the cancellation of an event.
+   * \param [in] uid The unique id of the event.
+   */
+  void Cancel (uint32_t uid);
+
+private:
+  /**
+   * \param [in] event An event implementation.
+   * \return The kind of the event, recorded on first use.
+   */
+  uint32_t GetKind (const EventImpl *event);
+  /**
+   * Encode an operation.
+   * \param [in] operation The operation.
+   */
+  void WriteOperation (EventTraceOperation operation);
+  /**
+   * Encode an unsigned LEB128 integer.
+   * \param [in] value The value.
+   */
+  void WriteValue (uint64_t value);
+  /** Write the encoded records to the file. */
+  void Flush (void);
+
+  std::ofstream m_os;            //!< the trace file
+  std::vector<uint8_t> m_buffer; //!< the records not yet written
+  uint32_t m_lastUid;            //!< uid of the last inserted event
+  uint64_t m_now;                //!< time stamp of the last removed event
+  /** The kinds, by dynamic type of the events. */
+  std::unordered_map<std::type_index, uint32_t> m_kinds;
+};
+
+/**
+ * \ingroup simulator
+ *
+ * Read the operations of an event trace file.
+ */
+class EventTraceReader
+{
+public:
+  /** A decoded operation. */
+  struct Record
+  {
+    EventTraceOperation operation; //!< the operation, never EVENT_TRACE_KIND
+    uint32_t uid;                  //!< unique id of the event
+    uint64_t ts;                   //!< time stamp of the event, for Insert and RemoveNext
+    uint32_t context;              //!< context of the event, for Insert
+    uint32_t kind;                 //!< kind of the event, for Insert
+  };
+
+  /**
+   * Open a trace file.
+   * \param [in] filename The name of the file.
+   */
+  EventTraceReader (std::string filename);
+
+  /**
+   * Read the next operation.
+   * \param [out] record The operation.
+   * \return \c false at the end of the trace.
+   */
+  bool Read (Record &record);
+  /**
+   * \param [in] kind A kind.
+   * \return The name of the dynamic type of the events of the kind.
+   */
+  std::string GetKindName (uint32_t kind) const;
+  /** \return The number of kinds read so far. */
+  uint32_t GetKindCount (void) const;
+
+private:
+  /**
+   * Decode an unsigned LEB128 integer.
+   * \return The value.
+   */
+  uint64_t ReadValue (void);
+
+  std::string m_filename;          //!< the name of the trace file
+  std::ifstream m_is;              //!< the trace file
+  uint32_t m_lastUid;              //!< uid of the last inserted event
+  uint64_t m_now;                  //!< time stamp of the last removed event
+  std::vector<std::string> m_kinds; //!< the names of the kinds
+};
+
+} // namespace ns3
+
+#endif /* EVENT_TRACE_H */
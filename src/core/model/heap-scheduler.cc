@@ -150,10 +150,10 @@ HeapScheduler::IsEmpty (void) const
 }
 
 void
-HeapScheduler::BottomUp (void)
+HeapScheduler::BottomUp (std::size_t start)
 {
-  NS_LOG_FUNCTION (this);
-  std::size_t index = Last ();
+  NS_LOG_FUNCTION (this << start);
+  std::size_t index = start;
   while (!IsRoot (index)
          && IsLessStrictly (index, Parent (index)))
     {
@@ -203,7 +203,7 @@ HeapScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   m_heap.push_back (ev);
-  BottomUp ();
+  BottomUp (Last ());
 }
 
 Scheduler::Event
@@ -236,7 +236,15 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          // the former Last item may belong above or below entry i
+          if (!IsBottom (i) && !IsRoot (i) && IsLessStrictly (i, Parent (i)))
+            {
+              BottomUp (i);
+            }
+          else
+            {
+              TopDown (i);
+            }
           return;
         }
     }
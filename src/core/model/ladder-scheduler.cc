@@ -0,0 +1,379 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "double.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/** A bucket with more events is spread over a finer rung. */
+const std::size_t LADDER_BUCKET_THRESHOLD = 50;
+/** Maximum number of rungs. */
+const uint32_t LADDER_MAX_RUNGS = 8;
+/** Minimum number of removed events between two compactions. */
+const uint32_t LADDER_COMPACTION_MIN_REMOVED = 1024;
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("CompactionThreshold",
+                   "The fraction of cancelled events among the removed events "
+                   "beyond which the cancelled events of the whole queue are released; "
+                   "1 disables the compaction.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&LadderScheduler::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (std::numeric_limits<uint64_t>::max ()),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_size (0),
+    m_compactionThreshold (0.25),
+    m_removed (0),
+    m_removedCancelled (0),
+    m_dropped (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::AddRung (uint64_t start, uint64_t end, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << start << end << n);
+  NS_ASSERT (m_nRungs < LADDER_MAX_RUNGS && end > start);
+  if (m_nRungs == m_rungs.size ())
+    {
+      m_rungs.push_back (Rung ());
+    }
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  uint64_t span = end - start;
+  n = std::max<std::size_t> (n, 1);
+  rung.start = start;
+  rung.width = std::max<uint64_t> ((span + n - 1) / n, 1);
+  rung.current = 0;
+  // the buckets of a used rung are all empty, and keep their memory
+  rung.buckets.resize ((span + rung.width - 1) / rung.width);
+  return rung;
+}
+
+void
+LadderScheduler::Drop (const Scheduler::Event &ev)
+{
+  ev.impl->Unref ();
+  m_size--;
+  m_dropped++;
+}
+
+void
+LadderScheduler::Spread (Rung &rung, const std::vector<Scheduler::Event> &events)
+{
+  for (const Scheduler::Event &ev : events)
+    {
+      if (ev.impl->IsCancelled ())
+        {
+          Drop (ev);
+          continue;
+        }
+      std::size_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+      NS_ASSERT (bucket < rung.buckets.size ());
+      rung.buckets[bucket].push_back (ev);
+    }
+}
+
+void
+LadderScheduler::MoveToBottom (std::vector<Scheduler::Event> &events)
+{
+  NS_ASSERT (m_bottom.empty ());
+  for (const Scheduler::Event &ev : events)
+    {
+      if (ev.impl->IsCancelled ())
+        {
+          Drop (ev);
+        }
+      else
+        {
+          m_bottom.push_back (ev);
+        }
+    }
+  events.clear ();
+  std::sort (m_bottom.begin (), m_bottom.end (), std::greater<Scheduler::Event> ());
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottom.empty () && m_size > 0)
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          Rung &rung = AddRung (m_topMin, m_topMax + 1, m_top.size ());
+          m_topStart = m_topMax + 1;
+          m_topMin = std::numeric_limits<uint64_t>::max ();
+          m_topMax = 0;
+          Spread (rung, m_top);
+          m_top.clear ();
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.buckets.size () && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.buckets.size ())
+        {
+          m_nRungs--;
+          continue;
+        }
+      uint64_t bucketStart = GetCurrentStart (rung);
+      uint64_t width = rung.width;
+      Bucket &bucket = rung.buckets[rung.current];
+      rung.current++;
+      if (bucket.size () > LADDER_BUCKET_THRESHOLD && width > 1 && m_nRungs < LADDER_MAX_RUNGS)
+        {
+          // AddRung may reallocate the rungs and their buckets
+          Bucket events;
+          events.swap (bucket);
+          Rung &child = AddRung (bucketStart, bucketStart + width, events.size ());
+          Spread (child, events);
+        }
+      else
+        {
+          MoveToBottom (bucket);
+        }
+    }
+}
+
+void
+LadderScheduler::SpreadBottom (void)
+{
+  NS_LOG_FUNCTION (this << m_bottom.size ());
+  uint64_t start = m_bottom.back ().key.m_ts;
+  uint64_t end = (m_nRungs > 0) ? GetCurrentStart (m_rungs[m_nRungs - 1]) : m_topStart;
+  if (m_nRungs == LADDER_MAX_RUNGS || end - start < 2)
+    {
+      return;
+    }
+  std::vector<Scheduler::Event> events;
+  events.swap (m_bottom);
+  Rung &rung = AddRung (start, end, events.size ());
+  Spread (rung, events);
+  events.clear ();
+  // keep the memory of Bottom
+  m_bottom.swap (events);
+}
+
+void
+LadderScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this << m_size);
+  auto cancelled = [this] (const Scheduler::Event &ev)
+    {
+      if (ev.impl->IsCancelled ())
+        {
+          Drop (ev);
+          return true;
+        }
+      return false;
+    };
+  m_top.erase (std::remove_if (m_top.begin (), m_top.end (), cancelled), m_top.end ());
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      for (std::size_t j = rung.current; j < rung.buckets.size (); j++)
+        {
+          Bucket &bucket = rung.buckets[j];
+          bucket.erase (std::remove_if (bucket.begin (), bucket.end (), cancelled), bucket.end ());
+        }
+    }
+  m_bottom.erase (std::remove_if (m_bottom.begin (), m_bottom.end (), cancelled), m_bottom.end ());
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  m_size++;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= GetCurrentStart (rung))
+        {
+          std::size_t bucket = (ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.buckets.size ());
+          rung.buckets[bucket].push_back (ev);
+          return;
+        }
+    }
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev,
+                                     std::greater<Scheduler::Event> ()),
+                   ev);
+  if (m_bottom.size () > LADDER_BUCKET_THRESHOLD)
+    {
+      SpreadBottom ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // moving a bucket to Bottom may release the last events
+  if (m_bottom.empty () && m_size > 0)
+    {
+      const_cast<LadderScheduler *> (this)->Refill ();
+    }
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_bottom.empty ())
+    {
+      const_cast<LadderScheduler *> (this)->Refill ();
+    }
+  NS_ASSERT (!m_bottom.empty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  NS_ASSERT (!m_bottom.empty ());
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+
+  m_removed++;
+  if (ev.impl->IsCancelled ())
+    {
+      m_removedCancelled++;
+    }
+  if (m_removed >= std::max (LADDER_COMPACTION_MIN_REMOVED, m_size / 4))
+    {
+      if (m_removedCancelled > m_compactionThreshold * m_removed)
+        {
+          Compact ();
+        }
+      m_removed = 0;
+      m_removedCancelled = 0;
+    }
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *events = &m_bottom;
+  if (ts >= m_topStart)
+    {
+      events = &m_top;
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_nRungs; i++)
+        {
+          Rung &rung = m_rungs[i];
+          if (ts >= GetCurrentStart (rung))
+            {
+              events = &rung.buckets[(ts - rung.start) / rung.width];
+              break;
+            }
+        }
+    }
+  if (events == &m_bottom)
+    {
+      Bucket::iterator it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev,
+                                              std::greater<Scheduler::Event> ());
+      NS_ASSERT_MSG (it != m_bottom.end () && *it == ev, "Event not found");
+      m_bottom.erase (it);
+    }
+  else
+    {
+      Bucket::iterator it = std::find (events->begin (), events->end (), ev);
+      NS_ASSERT_MSG (it != events->end (), "Event not found");
+      *it = events->back ();
+      events->pop_back ();
+    }
+  m_size--;
+}
+
+uint64_t
+LadderScheduler::GetDroppedCount (void) const
+{
+  return m_dropped;
+}
+
+} // namespace ns3
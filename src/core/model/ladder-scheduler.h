@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are kept in three tiers. The far future events are
+ * appended, unsorted, to \c Top. When the near future is exhausted, \c Top
+ * is spread over the buckets of a rung of the \c Ladder, with about one
+ * event per bucket; a bucket which holds more than 50 events when it is
+ * reached is spread over a finer rung, up to 8 rungs. The next bucket is
+ * then sorted into \c Bottom, from which the events are removed. A new
+ * event goes to the tier and bucket which covers its time stamp, so that
+ * the near future events of the MAC timers only touch one small bucket
+ * or \c Bottom; a \c Bottom which grows beyond 50 events is spread over a
+ * new rung.
+ *
+ * Cancelled events are released by the scheduler itself: when a bucket
+ * is moved to a lower tier, and, when the fraction of cancelled events
+ * among the removed ones exceeds CompactionThreshold, by a pass over the
+ * whole queue done at most once per quarter of the queue size removals.
+ * Such events are never returned by RemoveNext, see
+ * Scheduler::GetDroppedCount.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | Constant        | Append to \c Top or a bucket
+ * IsEmpty()    | Constant        | Counter
+ * PeekNext()   | Constant        | Last element of \c Bottom
+ * Remove()     | Linear          | Search of \c Top or of a bucket
+ * RemoveNext() | Constant        | Buckets of bounded size sorted into \c Bottom
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                              | Reason
+ * :-------- | :---------------------------------- | :-----
+ * Overhead  | 9 x 24 bytes + 24 bytes per bucket  | `std::vector` of the tiers and buckets
+ * Per Event | 0                                   | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+  virtual uint64_t GetDroppedCount (void) const;
+
+private:
+  /** A bucket of a rung: unsorted events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               //!< time stamp of the first bucket
+    uint64_t width;               //!< time span of a bucket
+    uint32_t current;             //!< first bucket not yet moved to a lower tier
+    std::vector<Bucket> buckets;  //!< the buckets
+  };
+
+  /**
+   * \param [in] rung A rung.
+   * \return The lowest time stamp the rung accepts.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /**
+   * Set up the next rung, to cover a time span with \c n buckets.
+   * \param [in] start The beginning of the time span.
+   * \param [in] end The end of the time span, excluded.
+   * \param [in] n The number of events of the time span.
+   * \return The rung.
+   */
+  Rung &AddRung (uint64_t start, uint64_t end, std::size_t n);
+  /**
+   * Spread events over the buckets of a rung, releasing the cancelled ones.
+   * \param [in] rung The rung.
+   * \param [in] events The events.
+   */
+  void Spread (Rung &rung, const std::vector<Scheduler::Event> &events);
+  /**
+   * Move events to Bottom, sorted, releasing the cancelled ones.
+   * \param [in] events The events.
+   */
+  void MoveToBottom (std::vector<Scheduler::Event> &events);
+  /**
+   * Release an event instead of returning it from RemoveNext.
+   * \param [in] ev The cancelled event.
+   */
+  void Drop (const Scheduler::Event &ev);
+  /** Spread a too large Bottom over a new rung, if possible. */
+  void SpreadBottom (void);
+  /** Move events to Bottom until it is not empty or the queue is. */
+  void Refill (void);
+  /** Release the cancelled events of all the tiers. */
+  void Compact (void);
+
+  /** Unsorted far future events. */
+  std::vector<Scheduler::Event> m_top;
+  /** Lowest time stamp of Top. */
+  uint64_t m_topMin;
+  /** Highest time stamp of Top. */
+  uint64_t m_topMax;
+  /** Lowest time stamp Top accepts. */
+  uint64_t m_topStart;
+  /** The rungs; the first \c m_nRungs are used, the others keep their memory. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs used. */
+  uint32_t m_nRungs;
+  /** Sorted near future events, the earliest last. */
+  std::vector<Scheduler::Event> m_bottom;
+  /** Number of events. */
+  uint32_t m_size;
+
+  /** Ratio of cancelled removed events which triggers a compaction. */
+  double m_compactionThreshold;
+  /** Number of events removed since the last compaction. */
+  uint32_t m_removed;
+  /** Number of cancelled events removed since the last compaction. */
+  uint32_t m_removedCancelled;
+  /** Number of cancelled events released by the scheduler. */
+  uint64_t m_dropped;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -160,6 +160,8 @@ RealtimeSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
             Scheduler::Event next = m_events->RemoveNext ();
             scheduler->Insert (next);
           }
+        // the events released by the old scheduler will not be run
+        m_unscheduledEvents -= m_events->GetDroppedCount ();
       }
     m_events = scheduler;
   }
@@ -474,7 +476,7 @@ RealtimeSimulatorImpl::Run (void)
   {
     CriticalSection cs (m_mutex);
 
-    NS_ASSERT_MSG (m_events->IsEmpty () == false || m_unscheduledEvents == 0,
+    NS_ASSERT_MSG (m_events->IsEmpty () == false || m_unscheduledEvents == (int) m_events->GetDroppedCount (),
                    "RealtimeSimulatorImpl::Run(): Empty queue and unprocessed events");
   }
 
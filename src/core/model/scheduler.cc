@@ -49,4 +49,10 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+uint64_t
+Scheduler::GetDroppedCount (void) const
+{
+  return 0;
+}
+
 } // namespace ns3
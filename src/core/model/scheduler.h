@@ -110,6 +110,14 @@ class EventImpl;
  *      <td class="markdownTableBodyLeft"> 0 </td>
  * </tr>
  * <tr class="markdownTableBody">
+ *      <td class="markdownTableBodyLeft"> LadderScheduler </td>
+ *      <td class="markdownTableBodyLeft"> Ladder of `std::vector` buckets </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> 240 bytes </td>
+ *      <td class="markdownTableBodyLeft"> 0 </td>
+ * </tr>
+ * <tr class="markdownTableBody">
  *      <td class="markdownTableBodyLeft"> ListScheduler </td>
  *      <td class="markdownTableBodyLeft"> `std::list` </td>
  *      <td class="markdownTableBodyLeft"> Linear </td>
@@ -224,6 +232,16 @@ public:
    * \param [in] ev The event to remove
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * Get the number of cancelled events the scheduler released itself.
+   *
+   * A scheduler may release cancelled events (calling SimpleRefCount::Unref)
+   * instead of returning them from RemoveNext; the simulator neither runs
+   * nor counts them.
+   *
+   * \return The number of events released since the scheduler was created.
+   */
+  virtual uint64_t GetDroppedCount (void) const;
 };
 
 /**
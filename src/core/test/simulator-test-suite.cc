@@ -17,6 +17,9 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <algorithm>
+#include <sstream>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/simulator.h"
 #include "ns3/list-scheduler.h"
@@ -24,6 +27,13 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-trace.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/string.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/event-profiler.h"
 
 using namespace ns3;
 
@@ -465,6 +475,329 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorProfilerTestCase : public TestCase
+{
+public:
+  SimulatorProfilerTestCase ();
+private:
+  virtual void DoRun (void);
+  void Tick (int remaining);
+  void Cancelled (void);
+  uint32_t m_ticks;
+};
+
+SimulatorProfilerTestCase::SimulatorProfilerTestCase ()
+  : TestCase ("Check the event profiler"),
+    m_ticks (0)
+{
+}
+
+void
+SimulatorProfilerTestCase::Tick (int remaining)
+{
+  m_ticks++;
+  if (remaining > 0)
+    {
+      NS_PROFILE_SCHEDULE (MicroSeconds (1), &SimulatorProfilerTestCase::Tick, this, remaining - 1);
+    }
+}
+
+void
+SimulatorProfilerTestCase::Cancelled (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "A cancelled profiled event ran");
+}
+
+void
+SimulatorProfilerTestCase::DoRun (void)
+{
+  // disabled: the events run but are not counted
+  NS_PROFILE_SCHEDULE (MicroSeconds (1), &SimulatorProfilerTestCase::Tick, this, 2);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 3, "Profiled events did not run");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetCount ("SimulatorProfilerTestCase::Tick", Simulator::NO_CONTEXT), 0, "Events counted while disabled");
+
+  EventProfiler::Enable ("");
+  NS_PROFILE_SCHEDULE_WITH_CONTEXT (7, MicroSeconds (1), &SimulatorProfilerTestCase::Tick, this, 4);
+  EventId id = NS_PROFILE_SCHEDULE (MicroSeconds (1), &SimulatorProfilerTestCase::Cancelled, this);
+  id.Cancel ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 8, "Profiled events did not run");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetCount ("SimulatorProfilerTestCase::Tick", 7), 5, "Wrong number of profiled events");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetCount ("SimulatorProfilerTestCase::Cancelled", Simulator::NO_CONTEXT), 0, "Cancelled event profiled");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetLayerCount ("SimulatorProfilerTestCase", 7), 5, "Wrong number of profiled events of the layer");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetLayerCount ("SimulatorProfilerTestCase", Simulator::NO_CONTEXT), 0, "Events of the layer counted on the wrong node");
+
+  std::ostringstream profile;
+  EventProfiler::Print (profile);
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("SimulatorProfilerTestCase::Tick"), std::string::npos, "Event missing from the profile");
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("  layer\n"), std::string::npos, "Layer section missing from the profile");
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("5  SimulatorProfilerTestCase\n"), std::string::npos, "Node and layer line missing from the profile");
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::IsEnabled (), false, "Profiler not disabled by Simulator::Destroy");
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+private:
+  virtual void DoRun (void);
+  void Tick (int remaining, uint64_t a, uint64_t b);
+  uint32_t m_ticks;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the memory of the events is reused"),
+    m_ticks (0)
+{
+}
+
+void
+SimulatorEventPoolTestCase::Tick (int remaining, uint64_t a, uint64_t b)
+{
+  m_ticks++;
+  if (remaining > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Tick, this, remaining - 1, a + 1, b);
+      EventId id = Simulator::Schedule (MicroSeconds (2), &SimulatorEventPoolTestCase::Tick, this, 0, a, b);
+      id.Cancel ();
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  uint64_t allocations = EventImpl::GetAllocationCount ();
+  uint64_t heapAllocations = EventImpl::GetHeapAllocationCount ();
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Tick, this, 1000, 0, 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 1001, "Events did not run");
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetAllocationCount () - allocations, 2001, "Wrong number of allocated events");
+  NS_TEST_EXPECT_MSG_LT (EventImpl::GetHeapAllocationCount () - heapAllocations, 10, "Events not allocated from the free list");
+}
+
+class HeapSchedulerRemoveTestCase : public TestCase
+{
+public:
+  HeapSchedulerRemoveTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HeapSchedulerRemoveTestCase::HeapSchedulerRemoveTestCase ()
+  : TestCase ("Check the order of the events after removals from the HeapScheduler")
+{
+}
+
+void
+HeapSchedulerRemoveTestCase::DoRun (void)
+{
+  Ptr<HeapScheduler> heap = CreateObject<HeapScheduler> ();
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  std::vector<Scheduler::Event> pending;
+  for (uint32_t uid = 0; uid < 1000; uid++)
+    {
+      Scheduler::Event ev;
+      ev.impl = 0;
+      ev.key.m_ts = random->GetInteger (0, 10000);
+      ev.key.m_uid = uid;
+      ev.key.m_context = 0;
+      heap->Insert (ev);
+      pending.push_back (ev);
+    }
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint32_t j = random->GetInteger (0, pending.size () - 1);
+      heap->Remove (pending[j]);
+      pending[j] = pending.back ();
+      pending.pop_back ();
+    }
+  Scheduler::Event last = heap->RemoveNext ();
+  for (uint32_t i = 1; i < 500; i++)
+    {
+      Scheduler::Event next = heap->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ ((last < next), true, "Events out of order");
+      last = next;
+    }
+  NS_TEST_EXPECT_MSG_EQ (heap->IsEmpty (), true, "Events left");
+}
+
+class LadderSchedulerTestCase : public TestCase
+{
+public:
+  LadderSchedulerTestCase ();
+private:
+  virtual void DoRun (void);
+  /** An event which does nothing. */
+  class NullEvent : public EventImpl
+  {
+    virtual void Notify (void)
+    {}
+  };
+};
+
+LadderSchedulerTestCase::LadderSchedulerTestCase ()
+  : TestCase ("Check the order of the events and the cancelled events of the LadderScheduler")
+{
+}
+
+void
+LadderSchedulerTestCase::DoRun (void)
+{
+  // MAC like workload: short timers, most of them cancelled, some long ones
+  Ptr<LadderScheduler> ladder = CreateObject<LadderScheduler> ();
+  Ptr<MapScheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  std::vector<Scheduler::Event> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  uint32_t removed = 0;
+  uint32_t cancelled = 0;
+  uint32_t cancelledRemoved = 0;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      uint32_t choice = random->GetInteger (0, 9);
+      if (choice < 5 || pending.empty ())
+        {
+          Scheduler::Event ev;
+          ev.impl = new NullEvent ();
+          // one reference for each scheduler
+          ev.impl->Ref ();
+          ev.key.m_ts = now + (choice == 0 ? random->GetInteger (0, 10000000) : random->GetInteger (0, 1000));
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          ladder->Insert (ev);
+          reference->Insert (ev);
+          pending.push_back (ev);
+        }
+      else if (choice < 7)
+        {
+          // the schedulers release the cancelled events, forget them
+          uint32_t j = random->GetInteger (0, pending.size () - 1);
+          pending[j].impl->Cancel ();
+          cancelled++;
+          pending[j] = pending.back ();
+          pending.pop_back ();
+        }
+      else if (choice < 8)
+        {
+          uint32_t j = random->GetInteger (0, pending.size () - 1);
+          Scheduler::Event ev = pending[j];
+          ladder->Remove (ev);
+          reference->Remove (ev);
+          ev.impl->Unref ();
+          ev.impl->Unref ();
+          pending[j] = pending.back ();
+          pending.pop_back ();
+        }
+      else
+        {
+          // skip the cancelled events of the reference
+          while (!reference->IsEmpty () && reference->PeekNext ().impl->IsCancelled ())
+            {
+              Scheduler::Event ev = reference->RemoveNext ();
+              ev.impl->Unref ();
+            }
+          if (reference->IsEmpty ())
+            {
+              continue;
+            }
+          Scheduler::Event expected = reference->RemoveNext ();
+          Scheduler::Event ev = ladder->RemoveNext ();
+          while (ev.impl->IsCancelled ())
+            {
+              cancelledRemoved++;
+              ev.impl->Unref ();
+              ev = ladder->RemoveNext ();
+            }
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.key.m_uid, "Wrong event order");
+          now = ev.key.m_ts;
+          removed++;
+          ev.impl->Unref ();
+          expected.impl->Unref ();
+          pending.erase (std::find (pending.begin (), pending.end (), ev));
+        }
+    }
+  while (!ladder->IsEmpty ())
+    {
+      Scheduler::Event ev = ladder->RemoveNext ();
+      if (ev.impl->IsCancelled ())
+        {
+          cancelledRemoved++;
+        }
+      ev.impl->Unref ();
+    }
+  while (!reference->IsEmpty ())
+    {
+      Scheduler::Event ev = reference->RemoveNext ();
+      ev.impl->Unref ();
+    }
+  NS_TEST_EXPECT_MSG_GT (removed, 0, "No event removed");
+  NS_TEST_EXPECT_MSG_GT (ladder->GetDroppedCount (), 0, "No cancelled event released");
+  NS_TEST_EXPECT_MSG_EQ (ladder->GetDroppedCount () + cancelledRemoved, cancelled, "Cancelled events lost");
+}
+
+class SimulatorEventTraceTestCase : public TestCase
+{
+public:
+  SimulatorEventTraceTestCase ();
+private:
+  virtual void DoRun (void);
+  void Event (void);
+};
+
+SimulatorEventTraceTestCase::SimulatorEventTraceTestCase ()
+  : TestCase ("Check the recording of the event queue operations")
+{
+}
+
+void
+SimulatorEventTraceTestCase::Event (void)
+{
+}
+
+void
+SimulatorEventTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("simulator.evt");
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::DefaultSimulatorImpl");
+  factory.Set ("EventTraceFile", StringValue (filename));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventTraceTestCase::Event, this);
+  EventId cancelled = Simulator::Schedule (MicroSeconds (2), &SimulatorEventTraceTestCase::Event, this);
+  EventId removed = Simulator::Schedule (MicroSeconds (3), &SimulatorEventTraceTestCase::Event, this);
+  Simulator::ScheduleWithContext (5, MicroSeconds (1), &SimulatorEventTraceTestCase::Event, this);
+  cancelled.Cancel ();
+  Simulator::Remove (removed);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  EventTraceReader reader (filename);
+  EventTraceReader::Record record;
+  EventTraceOperation operations[] = {
+    EVENT_TRACE_INSERT, EVENT_TRACE_INSERT, EVENT_TRACE_INSERT, EVENT_TRACE_INSERT,
+    EVENT_TRACE_CANCEL, EVENT_TRACE_REMOVE,
+    EVENT_TRACE_REMOVE_NEXT, EVENT_TRACE_REMOVE_NEXT, EVENT_TRACE_REMOVE_NEXT
+  };
+  uint32_t uids[] = { 4, 5, 6, 7, 5, 6, 4, 7, 5 };
+  uint64_t ts[] = { 1000, 2000, 3000, 1000, 0, 0, 1000, 1000, 2000 };
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing operation " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.operation, operations[i], "Wrong operation " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.uid, uids[i], "Wrong uid " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.ts, ts[i], "Wrong time stamp " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Too many operations");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetKindCount (), 1, "Wrong number of event kinds");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -483,5 +816,12 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorProfilerTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new HeapSchedulerRemoveTestCase (), TestCase::QUICK);
+    AddTestCase (new LadderSchedulerTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorEventTraceTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -29,6 +29,9 @@
 #include "ns3/cr-mac.h"
 #include "ns3/cr-net-device.h"
 #include "ns3/mmwave-phy.h"
+#include "ns3/mmwave-phy-state-helper.h"
+#include "ns3/cr-txop.h"
+#include "ns3/cr-dynamic-channel-access-manager.h"
 #include "cr-mmwave-helper.h"
 
 namespace ns3 {
@@ -295,6 +298,57 @@ namespace ns3 {
         Config::Connect (oss.str (), MakeBoundCallback (&AsciiPhyTxWithContext, stream));
     }
 
+    void
+    CrPhyHelper::EnableBinary (Ptr<MmWaveBinaryTraceFile> file, NetDeviceContainer d)
+    {
+        for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+        {
+            EnableBinaryInternal (file, *i);
+        }
+    }
+
+    void
+    CrPhyHelper::EnableBinaryAll (Ptr<MmWaveBinaryTraceFile> file)
+    {
+        NodeContainer nodes = NodeContainer::GetGlobal ();
+        for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+        {
+            for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+            {
+                EnableBinaryInternal (file, (*i)->GetDevice (j));
+            }
+        }
+    }
+
+    void
+    CrPhyHelper::EnableBinaryInternal (Ptr<MmWaveBinaryTraceFile> file, Ptr<NetDevice> nd)
+    {
+        Ptr<CrMmWaveNetDevice> device = nd->GetObject<CrMmWaveNetDevice> ();
+        if (device == 0)
+        {
+            NS_LOG_INFO ("EnableBinaryInternal(): Device " << device << " not of type ns3::CrMmWaveNetDevice");
+            return;
+        }
+        // unlike the ASCII traces, the records do not need packet printing
+        uint32_t nodeid = nd->GetNode ()->GetId ();
+        uint32_t deviceid = nd->GetIfIndex ();
+        std::ostringstream oss;
+        uint32_t source;
+        source = file->AddSource (nodeid, deviceid, MmWaveBinaryTraceFile::CR_INTRA_GROUP);
+        oss.str ("");
+        oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid << "/$ns3::CrMmWaveNetDevice/PhyIntraGroup/State/";
+        Config::ConnectWithoutContext (oss.str () + "Tx", MakeBoundCallback (&MmWaveBinaryTraceFile::MmWaveTxSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxOk", MakeBoundCallback (&MmWaveBinaryTraceFile::MmWaveRxOkSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxError", MakeBoundCallback (&MmWaveBinaryTraceFile::RxErrorSink, file, source));
+
+        source = file->AddSource (nodeid, deviceid, MmWaveBinaryTraceFile::CR_INTER_GROUP);
+        oss.str ("");
+        oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid << "/$ns3::CrMmWaveNetDevice/PhyInterGroup/State/";
+        Config::ConnectWithoutContext (oss.str () + "Tx", MakeBoundCallback (&MmWaveBinaryTraceFile::MmWaveTxSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxOk", MakeBoundCallback (&MmWaveBinaryTraceFile::MmWaveRxOkSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxError", MakeBoundCallback (&MmWaveBinaryTraceFile::RxErrorSink, file, source));
+    }
+
     CrMacHelper::CrMacHelper ()
     {
         SetType ("ns3::CrMmWaveMac");
@@ -528,4 +582,61 @@ namespace ns3 {
         }
         return (currentStream - stream);
     }
+
+    void
+    CrMmWaveHelper::EnableStats (Ptr<MmWaveStatsCollector> stats, NetDeviceContainer d)
+    {
+        for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+        {
+            EnableStatsInternal (stats, *i);
+        }
+    }
+
+    void
+    CrMmWaveHelper::EnableStatsAll (Ptr<MmWaveStatsCollector> stats)
+    {
+        NodeContainer nodes = NodeContainer::GetGlobal ();
+        for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+        {
+            for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+            {
+                EnableStatsInternal (stats, (*i)->GetDevice (j));
+            }
+        }
+    }
+
+    void
+    CrMmWaveHelper::EnableStatsInternal (Ptr<MmWaveStatsCollector> stats, Ptr<NetDevice> nd)
+    {
+        Ptr<CrMmWaveNetDevice> device = nd->GetObject<CrMmWaveNetDevice> ();
+        if (device == 0 || device->GetMac () == 0)
+        {
+            NS_LOG_INFO ("EnableStatsInternal(): Device " << device << " not of type ns3::CrMmWaveNetDevice");
+            return;
+        }
+        uint32_t nodeid = nd->GetNode ()->GetId ();
+        Ptr<CrMmWaveMac> mac = device->GetMac ();
+        stats->AddNode (nodeid);
+
+        Ptr<CrMmWaveTxop> txop = mac->GetTxop ();
+        txop->TraceConnectWithoutContext ("BulkAck", MakeBoundCallback (&MmWaveStatsCollector::BulkAckSink, stats, nodeid));
+        txop->TraceConnectWithoutContext ("MissedBulkAck", MakeBoundCallback (&MmWaveStatsCollector::MissedBulkAckSink, stats, nodeid));
+        txop->GetMacQueue ()->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&MmWaveStatsCollector::QueueDequeueSink, stats, nodeid));
+        txop->GetMacQueue ()->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&MmWaveStatsCollector::QueueDropSink, stats, nodeid));
+        mac->TraceConnectWithoutContext ("MacRx", MakeBoundCallback (&MmWaveStatsCollector::MacRxSink, stats, nodeid));
+        mac->TraceConnectWithoutContext ("MacTxDrop", MakeBoundCallback (&MmWaveStatsCollector::MacTxDropSink, stats, nodeid));
+        for (TypeOfGroup group : {INTRA_GROUP, INTER_GROUP, PROBE_GROUP})
+        {
+            mac->GetChannelAccessManager (group)->TraceConnectWithoutContext ("AccessGranted",
+                                                                             MakeBoundCallback (&MmWaveStatsCollector::AccessGrantedSink, stats, nodeid));
+        }
+        // like the binary traces, the probe PHY is left out: its channel sweeps are not data airtime
+        for (TypeOfGroup group : {INTRA_GROUP, INTER_GROUP})
+        {
+            Ptr<MmWavePhy> phy = mac->GetPhy (group);
+            uint32_t source = stats->AddPhy (nodeid, phy);
+            phy->GetState ()->TraceConnectWithoutContext ("State", MakeBoundCallback (&MmWaveStatsCollector::PhyStateSink, stats, source));
+            phy->GetState ()->TraceConnectWithoutContext ("RxError", MakeBoundCallback (&MmWaveStatsCollector::PhyRxErrorSink, stats, nodeid));
+        }
+    }
 }
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include "ns3/node-container.h"
 #include "ns3/net-device-container.h"
 #include "ns3/cr-mac.h"
+#include "ns3/mmwave-binary-trace.h"
+#include "ns3/mmwave-stats-collector.h"
 namespace ns3 {
     class CrPhyHelper : public AsciiTraceHelperForDevice
     {
@@ -66,6 +68,18 @@ namespace ns3 {
                                         std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
                                         std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
         void EnableAsciiInternal (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
+        /**
+         * Store the TX and RX events of the PHYs of the devices in a binary trace file.
+         * \param file the binary trace file
+         * \param d the devices
+         */
+        void EnableBinary (Ptr<MmWaveBinaryTraceFile> file, NetDeviceContainer d);
+        /**
+         * Store the TX and RX events of the PHYs of all the devices in a binary trace file.
+         * \param file the binary trace file
+         */
+        void EnableBinaryAll (Ptr<MmWaveBinaryTraceFile> file);
+        void EnableBinaryInternal (Ptr<MmWaveBinaryTraceFile> file, Ptr<NetDevice> nd);
     protected:
         Ptr<SpectrumChannel> m_channel;
         Ptr<AntennaModel> m_antenna;
@@ -109,6 +123,18 @@ namespace ns3 {
         static void EnableLogComponents ();
         void SetSatandard (MmWaveStandard standard);
         int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
+        /**
+         * Collect the MAC and PHY statistics of the devices.
+         * \param stats the statistics collector
+         * \param d the devices
+         */
+        void EnableStats (Ptr<MmWaveStatsCollector> stats, NetDeviceContainer d);
+        /**
+         * Collect the MAC and PHY statistics of all the devices.
+         * \param stats the statistics collector
+         */
+        void EnableStatsAll (Ptr<MmWaveStatsCollector> stats);
+        void EnableStatsInternal (Ptr<MmWaveStatsCollector> stats, Ptr<NetDevice> nd);
 
         NetDeviceContainer Install (const CrPhyHelper &phyHelper,
                                     const CrMacHelper &macHelper,
@@ -0,0 +1,271 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "mmwave-binary-trace.h"
+
+namespace ns3 {
+    NS_LOG_COMPONENT_DEFINE ("MmWaveBinaryTrace");
+
+    static_assert (sizeof (MmWaveBinaryTraceRecord) == 32, "MmWaveBinaryTraceRecord must stay 32 bytes");
+
+    /// header of a binary trace file
+    struct MmWaveBinaryTraceHeader
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t recordSize;
+        uint64_t nRecords; //!< 0 until the file is closed
+    };
+
+    static_assert (sizeof (MmWaveBinaryTraceHeader) == 16, "MmWaveBinaryTraceHeader must stay 16 bytes");
+
+    const uint16_t MMWAVE_BINARY_TRACE_VERSION = 1;
+
+    MmWaveBinaryTraceFile::MmWaveBinaryTraceFile (std::string filename, uint32_t chunkRecords)
+            : m_map (0),
+              m_records (0),
+              m_nRecords (0),
+              m_capacity (0),
+              m_chunkRecords (chunkRecords > 0 ? chunkRecords : 1)
+    {
+        NS_LOG_FUNCTION (this << filename << chunkRecords);
+        m_fd = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        NS_ABORT_MSG_IF (m_fd < 0, "Cannot create binary trace file " << filename << ": " << std::strerror (errno));
+        Grow ();
+        MmWaveBinaryTraceHeader header;
+        std::memcpy (header.magic, "MMWT", 4);
+        header.version = MMWAVE_BINARY_TRACE_VERSION;
+        header.recordSize = sizeof (MmWaveBinaryTraceRecord);
+        header.nRecords = 0;
+        std::memcpy (m_map, &header, sizeof (header));
+        // the event keeps the file alive until the simulator is destroyed
+        Simulator::ScheduleDestroy (&MmWaveBinaryTraceFile::Close, Ptr<MmWaveBinaryTraceFile> (this));
+    }
+
+    MmWaveBinaryTraceFile::~MmWaveBinaryTraceFile ()
+    {
+        NS_LOG_FUNCTION (this);
+        Close ();
+    }
+
+    void
+    MmWaveBinaryTraceFile::Grow ()
+    {
+        NS_LOG_FUNCTION (this << m_capacity);
+        std::size_t oldLength = sizeof (MmWaveBinaryTraceHeader) + m_capacity * sizeof (MmWaveBinaryTraceRecord);
+        m_capacity += m_chunkRecords;
+        std::size_t length = sizeof (MmWaveBinaryTraceHeader) + m_capacity * sizeof (MmWaveBinaryTraceRecord);
+        NS_ABORT_MSG_IF (ftruncate (m_fd, length) != 0, "Cannot extend binary trace file: " << std::strerror (errno));
+        if (m_map)
+        {
+            munmap (m_map, oldLength);
+        }
+        void *map = mmap (0, length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        NS_ABORT_MSG_IF (map == MAP_FAILED, "Cannot map binary trace file: " << std::strerror (errno));
+        m_map = static_cast<uint8_t *> (map);
+        m_records = reinterpret_cast<MmWaveBinaryTraceRecord *> (m_map + sizeof (MmWaveBinaryTraceHeader));
+    }
+
+    uint32_t
+    MmWaveBinaryTraceFile::AddSource (uint32_t nodeId, uint32_t deviceId, PhyGroup group)
+    {
+        NS_LOG_FUNCTION (this << nodeId << deviceId << group);
+        Source source;
+        source.nodeId = nodeId;
+        source.deviceId = static_cast<uint8_t> (deviceId);
+        source.group = static_cast<uint8_t> (group);
+        m_sources.push_back (source);
+        return m_sources.size () - 1;
+    }
+
+    void
+    MmWaveBinaryTraceFile::Write (uint32_t source, MmWaveBinaryTraceRecord &record)
+    {
+        if (m_fd < 0)
+        {
+            return;
+        }
+        if (m_nRecords == m_capacity)
+        {
+            Grow ();
+        }
+        const Source &s = m_sources[source];
+        record.timeNs = Simulator::Now ().GetNanoSeconds ();
+        record.nodeId = s.nodeId;
+        record.deviceId = s.deviceId;
+        record.phyGroup = s.group;
+        record.reserved[0] = 0;
+        record.reserved[1] = 0;
+        m_records[m_nRecords++] = record;
+    }
+
+    void
+    MmWaveBinaryTraceFile::Close ()
+    {
+        NS_LOG_FUNCTION (this);
+        if (m_fd < 0)
+        {
+            return;
+        }
+        reinterpret_cast<MmWaveBinaryTraceHeader *> (m_map)->nRecords = m_nRecords;
+        munmap (m_map, sizeof (MmWaveBinaryTraceHeader) + m_capacity * sizeof (MmWaveBinaryTraceRecord));
+        if (ftruncate (m_fd, sizeof (MmWaveBinaryTraceHeader) + m_nRecords * sizeof (MmWaveBinaryTraceRecord)) != 0)
+        {
+            NS_LOG_WARN ("Cannot truncate binary trace file: " << std::strerror (errno));
+        }
+        close (m_fd);
+        m_fd = -1;
+        m_map = 0;
+        m_records = 0;
+    }
+
+    uint64_t
+    MmWaveBinaryTraceFile::GetNRecords () const
+    {
+        return m_nRecords;
+    }
+
+    bool
+    MmWaveBinaryTraceFile::ReadCsv (std::string filename, std::ostream &os)
+    {
+        std::ifstream file (filename.c_str (), std::ios::binary);
+        MmWaveBinaryTraceHeader header;
+        if (!file.read (reinterpret_cast<char *> (&header), sizeof (header))
+            || std::memcmp (header.magic, "MMWT", 4) != 0
+            || header.version != MMWAVE_BINARY_TRACE_VERSION
+            || header.recordSize != sizeof (MmWaveBinaryTraceRecord))
+        {
+            return false;
+        }
+        static const char *types[] = {"t", "r", "e"};
+        static const char *groups[] = {"intra", "inter", "data", "ctrl"};
+        os << "time_ns,event,node,device,phy_group,channel,frequency_mhz,width_mhz,mcs,tx_level,size,snr" << std::endl;
+        MmWaveBinaryTraceRecord record;
+        uint64_t n = 0;
+        // the records of a file that was not closed are read up to the first hole
+        while ((header.nRecords == 0 || n < header.nRecords)
+               && file.read (reinterpret_cast<char *> (&record), sizeof (record)))
+        {
+            if (header.nRecords == 0 && record.timeNs == 0 && record.size == 0 && record.nodeId == 0)
+            {
+                break;
+            }
+            os << record.timeNs << "," << (record.type <= RX_ERROR ? types[record.type] : "?") << ","
+               << record.nodeId << "," << +record.deviceId << ","
+               << (record.phyGroup <= V2X_CTRL ? groups[record.phyGroup] : "?") << ","
+               << +record.channelNum << "," << record.channelFreq << "," << record.channelWidth << ",";
+            if (record.mcs != 0xff)
+            {
+                os << +record.mcs;
+            }
+            os << "," << +record.txLevel << "," << record.size << "," << record.snr << "\n";
+            n++;
+        }
+        os.flush ();
+        return true;
+    }
+
+    void
+    MmWaveBinaryTraceFile::MmWaveTxSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, MmWaveMode mode, MmWavePreamble preamble, uint8_t txLevel,
+                                         uint8_t channelNum, uint16_t channelFreq, uint16_t channelWidth)
+    {
+        MmWaveBinaryTraceRecord record;
+        record.size = p->GetSize ();
+        record.snr = 0;
+        record.channelFreq = channelFreq;
+        record.channelWidth = channelWidth;
+        record.type = TX;
+        record.channelNum = channelNum;
+        record.mcs = (mode.GetModulationClass () == MMWAVE_MOD_CLASS_OFDM) ? mode.GetMcsValue () : 0xff;
+        record.txLevel = txLevel;
+        file->Write (source, record);
+    }
+
+    void
+    MmWaveBinaryTraceFile::MmWaveRxOkSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, double snr, MmWaveMode mode, MmWavePreamble preamble,
+                                           uint8_t channelNum, uint16_t channelFreq, uint16_t channelWidth)
+    {
+        MmWaveBinaryTraceRecord record;
+        record.size = p->GetSize ();
+        record.snr = static_cast<float> (snr);
+        record.channelFreq = channelFreq;
+        record.channelWidth = channelWidth;
+        record.type = RX_OK;
+        record.channelNum = channelNum;
+        record.mcs = (mode.GetModulationClass () == MMWAVE_MOD_CLASS_OFDM) ? mode.GetMcsValue () : 0xff;
+        record.txLevel = 0;
+        file->Write (source, record);
+    }
+
+    /**
+     * \param mode a Wi-Fi mode
+     * \return the MCS of the mode, 0xff for the modes without one
+     */
+    static uint8_t
+    GetWifiMcs (WifiMode mode)
+    {
+        switch (mode.GetModulationClass ())
+        {
+            case WIFI_MOD_CLASS_HT:
+            case WIFI_MOD_CLASS_VHT:
+            case WIFI_MOD_CLASS_HE:
+                return mode.GetMcsValue ();
+            default:
+                return 0xff;
+        }
+    }
+
+    void
+    MmWaveBinaryTraceFile::WifiTxSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, WifiMode mode, WifiPreamble preamble, uint8_t txLevel)
+    {
+        MmWaveBinaryTraceRecord record;
+        record.size = p->GetSize ();
+        record.snr = 0;
+        record.channelFreq = 0;
+        record.channelWidth = 0;
+        record.type = TX;
+        record.channelNum = 0;
+        record.mcs = GetWifiMcs (mode);
+        record.txLevel = txLevel;
+        file->Write (source, record);
+    }
+
+    void
+    MmWaveBinaryTraceFile::WifiRxOkSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, double snr, WifiMode mode, WifiPreamble preamble)
+    {
+        MmWaveBinaryTraceRecord record;
+        record.size = p->GetSize ();
+        record.snr = static_cast<float> (snr);
+        record.channelFreq = 0;
+        record.channelWidth = 0;
+        record.type = RX_OK;
+        record.channelNum = 0;
+        record.mcs = GetWifiMcs (mode);
+        record.txLevel = 0;
+        file->Write (source, record);
+    }
+
+    void
+    MmWaveBinaryTraceFile::RxErrorSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, double snr)
+    {
+        MmWaveBinaryTraceRecord record;
+        record.size = p->GetSize ();
+        record.snr = static_cast<float> (snr);
+        record.channelFreq = 0;
+        record.channelWidth = 0;
+        record.type = RX_ERROR;
+        record.channelNum = 0;
+        record.mcs = 0xff;
+        record.txLevel = 0;
+        file->Write (source, record);
+    }
+
+}
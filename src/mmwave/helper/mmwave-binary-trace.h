@@ -0,0 +1,145 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MMWAVE_BINARY_TRACE_H
+#define MMWAVE_BINARY_TRACE_H
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/packet.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/mmwave-mode.h"
+#include "ns3/mmwave.h"
+
+namespace ns3 {
+
+    /**
+     * One TX or RX event of a PHY, as stored in a binary trace file.
+     *
+     * The records have a fixed size and are stored in the byte order of the
+     * host that wrote the file.
+     */
+    struct MmWaveBinaryTraceRecord
+    {
+        int64_t timeNs;        //!< simulation time, ns
+        uint32_t nodeId;       //!< node of the PHY
+        uint32_t size;         //!< packet size, bytes
+        float snr;             //!< SNR of a reception (linear), 0 for a transmission
+        uint16_t channelFreq;  //!< channel center frequency, MHz
+        uint16_t channelWidth; //!< channel width, MHz
+        uint8_t type;          //!< MmWaveBinaryTraceFile::EventType
+        uint8_t phyGroup;      //!< MmWaveBinaryTraceFile::PhyGroup
+        uint8_t channelNum;    //!< channel number
+        uint8_t mcs;           //!< MCS, 0xff if the mode has none
+        uint8_t deviceId;      //!< device index on the node
+        uint8_t txLevel;       //!< TX power level of a transmission
+        uint8_t reserved[2];
+    };
+
+    /**
+     * Binary trace file of the TX and RX events of mmWave and V2X PHYs.
+     *
+     * This is the compact alternative to the ASCII traces of the PHY helpers:
+     * every event is stored as one fixed-size MmWaveBinaryTraceRecord instead of
+     * a line of text, and the records are written into a memory-mapped file that
+     * grows by chunks. The file starts with a 16 bytes header (magic "MMWT",
+     * version, record size, number of records once the file is closed).
+     *
+     * The PHY helpers connect their devices through EnableBinary and
+     * EnableBinaryAll; several helpers can share one file. The file is
+     * completed when Close is called or the simulator is destroyed, and
+     * ReadCsv converts it to text.
+     */
+    class MmWaveBinaryTraceFile : public SimpleRefCount<MmWaveBinaryTraceFile>
+    {
+    public:
+        enum EventType
+        {
+            TX = 0,
+            RX_OK,
+            RX_ERROR
+        };
+
+        enum PhyGroup
+        {
+            CR_INTRA_GROUP = 0,
+            CR_INTER_GROUP,
+            V2X_DATA,
+            V2X_CTRL
+        };
+
+        /**
+         * \param filename the file to create
+         * \param chunkRecords the number of records the file grows by
+         */
+        MmWaveBinaryTraceFile (std::string filename, uint32_t chunkRecords = 65536);
+        ~MmWaveBinaryTraceFile ();
+
+        /**
+         * Register a PHY whose events are stored in the file.
+         * \param nodeId the node of the PHY
+         * \param deviceId the index of the device on the node
+         * \param group the PHY group of the device
+         * \return the source to bind to the sinks
+         */
+        uint32_t AddSource (uint32_t nodeId, uint32_t deviceId, PhyGroup group);
+        /**
+         * Store an event of a source.
+         * \param source the source returned by AddSource
+         * \param record the event; the node, the device and the group are filled in
+         */
+        void Write (uint32_t source, MmWaveBinaryTraceRecord &record);
+        /**
+         * Truncate the file to the records written and unmap it; later events are dropped.
+         */
+        void Close ();
+        /**
+         * \return the number of records written
+         */
+        uint64_t GetNRecords () const;
+
+        /**
+         * Convert a binary trace file to CSV, one line per record.
+         * \param filename the binary trace file
+         * \param os the output
+         * \return false if the file cannot be read
+         */
+        static bool ReadCsv (std::string filename, std::ostream &os);
+
+        /// sink of the Tx trace of MmWavePhyStateHelper
+        static void MmWaveTxSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, MmWaveMode mode, MmWavePreamble preamble, uint8_t txLevel,
+                                  uint8_t channelNum, uint16_t channelFreq, uint16_t channelWidth);
+        /// sink of the RxOk trace of MmWavePhyStateHelper
+        static void MmWaveRxOkSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, double snr, MmWaveMode mode, MmWavePreamble preamble,
+                                    uint8_t channelNum, uint16_t channelFreq, uint16_t channelWidth);
+        /// sink of the Tx trace of WifiPhyStateHelper
+        static void WifiTxSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, WifiMode mode, WifiPreamble preamble, uint8_t txLevel);
+        /// sink of the RxOk trace of WifiPhyStateHelper
+        static void WifiRxOkSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, double snr, WifiMode mode, WifiPreamble preamble);
+        /// sink of the RxError traces of MmWavePhyStateHelper and WifiPhyStateHelper
+        static void RxErrorSink (Ptr<MmWaveBinaryTraceFile> file, uint32_t source, Ptr<const Packet> p, double snr);
+
+    private:
+        /// map a larger file once the records fill the current one
+        void Grow ();
+
+        struct Source
+        {
+            uint32_t nodeId;
+            uint8_t deviceId;
+            uint8_t group;
+        };
+
+        int m_fd; //!< the file, -1 once closed
+        uint8_t *m_map; //!< the mapped file
+        MmWaveBinaryTraceRecord *m_records; //!< the records in the mapped file
+        uint64_t m_nRecords; //!< number of records written
+        uint64_t m_capacity; //!< number of records the mapped file holds
+        uint32_t m_chunkRecords; //!< number of records the file grows by
+        std::vector<Source> m_sources; //!< the registered PHYs
+    };
+
+}
+#endif //MMWAVE_BINARY_TRACE_H
@@ -3,6 +3,7 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/object.h"
+#include "ns3/mmwave-spectrum-transmit-filter.h"
 #include "ns3/mmwave-channel-helper.h"
 namespace ns3 {
     NS_LOG_COMPONENT_DEFINE ("MmWaveChannelHelper");
@@ -10,6 +11,7 @@ namespace ns3 {
     MmWaveChannelHelper::MmWaveChannelHelper ()
     {
         m_frequency = 60e9;
+        m_transmitFilter = false;
     }
 
     MmWaveChannelHelper::~MmWaveChannelHelper ()
@@ -22,6 +24,12 @@ namespace ns3 {
         m_frequency = frequency;
     }
 
+    void
+    MmWaveChannelHelper::SetTransmitFilter (bool enable)
+    {
+        m_transmitFilter = enable;
+    }
+
     Ptr<MultiModelSpectrumChannel>
     MmWaveChannelHelper::CreateSpectrumChannel ()
     {
@@ -31,6 +39,20 @@ namespace ns3 {
         lossModel->SetFrequency (m_frequency);
         spectrumChannel->AddPropagationLossModel (lossModel);
         spectrumChannel->SetPropagationDelayModel (delayModel);
+        if (m_transmitFilter)
+        {
+            AddTransmitFilter (spectrumChannel);
+        }
         return spectrumChannel;
     }
+
+    void
+    MmWaveChannelHelper::AddTransmitFilter (Ptr<SpectrumChannel> channel)
+    {
+        if (channel == 0 || DynamicCast<MmWaveSpectrumTransmitFilter> (channel->GetSpectrumTransmitFilter ()) != 0)
+        {
+            return;
+        }
+        channel->AddSpectrumTransmitFilter (CreateObject<MmWaveSpectrumTransmitFilter> ());
+    }
 }
\ No newline at end of file
@@ -12,9 +12,25 @@ namespace ns3 {
         MmWaveChannelHelper ();
         ~MmWaveChannelHelper ();
         void SetFrequency (double frequency);
+        /**
+         * \param enable whether CreateSpectrumChannel adds the transmit filter, off by default
+         */
+        void SetTransmitFilter (bool enable);
         Ptr<MultiModelSpectrumChannel> CreateSpectrumChannel ();
+        /**
+         * Make the channel skip the mmWave receivers that are not tuned to the channel
+         * of a signal before computing the propagation loss for them. Does nothing if
+         * the filter was already added.
+         *
+         * The deliveries are the same, but the loss models are no longer called for
+         * the skipped links: the models which draw random numbers or create state per
+         * link on first use, such as the ThreeGpp ones, then give other results for
+         * the same seed.
+         */
+        static void AddTransmitFilter (Ptr<SpectrumChannel> channel);
     protected:
         double m_frequency;
+        bool m_transmitFilter; //!< whether CreateSpectrumChannel adds the transmit filter
     };
 }
 
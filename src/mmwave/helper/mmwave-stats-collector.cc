@@ -0,0 +1,367 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/mmwave-phy.h"
+#include "mmwave-stats-collector.h"
+
+namespace ns3 {
+    NS_LOG_COMPONENT_DEFINE ("MmWaveStatsCollector");
+
+    /// header of a statistics file
+    struct MmWaveStatsHeader
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t nNodes;
+        uint32_t nColumns;
+    };
+
+    static_assert (sizeof (MmWaveStatsHeader) == 16, "MmWaveStatsHeader must stay 16 bytes");
+
+    const uint16_t MMWAVE_STATS_VERSION = 1;
+
+    /// names of the counters, in the order of MmWaveStatsCollector::Counter
+    static const char *mmWaveStatsCounterNames[MmWaveStatsCollector::N_COUNTERS] = {
+            "tx_mpdu_ok", "tx_mpdu_failed", "tx_bytes_ok", "bulk_ack_ok", "bulk_ack_missed",
+            "mac_rx_packets", "mac_rx_bytes", "mac_tx_drops",
+            "queue_dequeued", "queue_drops", "queue_sojourn_ns",
+            "access_granted", "access_delay_ns", "phy_rx_errors", "channel_switches"
+    };
+
+    /// names of the histograms, in the order of MmWaveStatsCollector::Histogram
+    static const char *mmWaveStatsHistogramNames[MmWaveStatsCollector::N_HISTOGRAMS] = {
+            "queue_sojourn_ns", "access_delay_ns"
+    };
+
+    MmWaveStatsCollector::MmWaveStatsCollector (std::string filename, Time interval)
+            : m_file (filename.c_str (), std::ios::binary | std::ios::trunc),
+              m_interval (interval),
+              m_closed (false),
+              m_nNodes (0),
+              m_nChannels (0),
+              m_nSnapshots (0)
+    {
+        NS_LOG_FUNCTION (this << filename << interval);
+        NS_ABORT_MSG_IF (!m_file.is_open (), "Cannot create statistics file " << filename);
+        NS_ABORT_MSG_IF (!interval.IsStrictlyPositive (), "The statistics interval must be positive");
+        for (const auto & i : mmWaveChannelToFrequency)
+        {
+            m_nChannels = std::max<uint32_t> (m_nChannels, i.first.first.first);
+        }
+        m_nColumns = N_COUNTERS + 2 * m_nChannels + N_HISTOGRAMS * HISTOGRAM_BINS;
+        // the events keep the collector alive until the simulator is destroyed
+        m_flushEvent = Simulator::Schedule (m_interval, &MmWaveStatsCollector::Flush, Ptr<MmWaveStatsCollector> (this));
+        Simulator::ScheduleDestroy (&MmWaveStatsCollector::Close, Ptr<MmWaveStatsCollector> (this));
+    }
+
+    MmWaveStatsCollector::~MmWaveStatsCollector ()
+    {
+        NS_LOG_FUNCTION (this);
+        Close ();
+    }
+
+    void
+    MmWaveStatsCollector::AddNode (uint32_t nodeId)
+    {
+        NS_LOG_FUNCTION (this << nodeId);
+        if (nodeId < m_nNodes)
+        {
+            return;
+        }
+        NS_ABORT_MSG_IF (m_nSnapshots > 0, "Node " << nodeId << " added to the statistics after the first snapshot");
+        uint32_t nNodes = nodeId + 1;
+        std::vector<uint64_t> values (static_cast<std::size_t> (m_nColumns) * nNodes, 0);
+        for (uint32_t c = 0; c < m_nColumns; c++)
+        {
+            std::copy_n (m_values.begin () + static_cast<std::size_t> (c) * m_nNodes, m_nNodes,
+                         values.begin () + static_cast<std::size_t> (c) * nNodes);
+        }
+        m_values.swap (values);
+        m_nNodes = nNodes;
+    }
+
+    uint32_t
+    MmWaveStatsCollector::AddPhy (uint32_t nodeId, Ptr<MmWavePhy> phy)
+    {
+        NS_LOG_FUNCTION (this << nodeId << phy);
+        AddNode (nodeId);
+        Phy source;
+        source.nodeId = nodeId;
+        source.phy = PeekPointer (phy);
+        m_phys.push_back (source);
+        return m_phys.size () - 1;
+    }
+
+    uint64_t &
+    MmWaveStatsCollector::At (uint32_t column, uint32_t nodeId)
+    {
+        NS_ASSERT (column < m_nColumns && nodeId < m_nNodes);
+        return m_values[static_cast<std::size_t> (column) * m_nNodes + nodeId];
+    }
+
+    uint32_t
+    MmWaveStatsCollector::GetHistogramColumn (Histogram histogram) const
+    {
+        return AIRTIME_COLUMN + 2 * m_nChannels + histogram * HISTOGRAM_BINS;
+    }
+
+    void
+    MmWaveStatsCollector::AddToHistogram (Histogram histogram, uint32_t nodeId, uint64_t value)
+    {
+        uint32_t bin = 0;
+        while (value > 1 && bin < HISTOGRAM_BINS - 1)
+        {
+            value >>= 1;
+            bin++;
+        }
+        At (GetHistogramColumn (histogram) + bin, nodeId)++;
+    }
+
+    void
+    MmWaveStatsCollector::WriteHeader ()
+    {
+        MmWaveStatsHeader header;
+        std::memcpy (header.magic, "MMWS", 4);
+        header.version = MMWAVE_STATS_VERSION;
+        header.reserved = 0;
+        header.nNodes = m_nNodes;
+        header.nColumns = m_nColumns;
+        std::vector<std::string> names (mmWaveStatsCounterNames, mmWaveStatsCounterNames + N_COUNTERS);
+        for (const char *direction : {"tx", "rx"})
+        {
+            for (uint32_t c = 1; c <= m_nChannels; c++)
+            {
+                std::ostringstream oss;
+                oss << direction << "_airtime_ns_ch" << c;
+                names.push_back (oss.str ());
+            }
+        }
+        for (uint32_t h = 0; h < N_HISTOGRAMS; h++)
+        {
+            for (uint32_t b = 0; b < HISTOGRAM_BINS; b++)
+            {
+                std::ostringstream oss;
+                oss << mmWaveStatsHistogramNames[h] << "_log2_" << b;
+                names.push_back (oss.str ());
+            }
+        }
+        NS_ASSERT (names.size () == m_nColumns);
+        m_file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+        for (const auto & name : names)
+        {
+            uint8_t length = static_cast<uint8_t> (name.size ());
+            m_file.put (static_cast<char> (length));
+            m_file.write (name.data (), length);
+        }
+    }
+
+    void
+    MmWaveStatsCollector::WriteSnapshot ()
+    {
+        NS_LOG_FUNCTION (this << m_nSnapshots);
+        if (m_nSnapshots == 0)
+        {
+            WriteHeader ();
+        }
+        int64_t timeNs = Simulator::Now ().GetNanoSeconds ();
+        m_file.write (reinterpret_cast<const char *> (&timeNs), sizeof (timeNs));
+        m_file.write (reinterpret_cast<const char *> (m_values.data ()), m_values.size () * sizeof (uint64_t));
+        m_nSnapshots++;
+    }
+
+    void
+    MmWaveStatsCollector::Flush ()
+    {
+        if (m_closed)
+        {
+            return;
+        }
+        WriteSnapshot ();
+        m_file.flush ();
+        m_flushEvent.Cancel ();
+        m_flushEvent = Simulator::Schedule (m_interval, &MmWaveStatsCollector::Flush, Ptr<MmWaveStatsCollector> (this));
+    }
+
+    void
+    MmWaveStatsCollector::Close ()
+    {
+        NS_LOG_FUNCTION (this);
+        if (m_closed)
+        {
+            return;
+        }
+        m_closed = true;
+        WriteSnapshot ();
+        m_file.close ();
+        m_flushEvent.Cancel ();
+    }
+
+    uint64_t
+    MmWaveStatsCollector::GetCounter (uint32_t nodeId, Counter counter) const
+    {
+        NS_ASSERT (nodeId < m_nNodes);
+        return m_values[static_cast<std::size_t> (counter) * m_nNodes + nodeId];
+    }
+
+    Time
+    MmWaveStatsCollector::GetTxAirtime (uint32_t nodeId, uint8_t channelNumber) const
+    {
+        NS_ASSERT (nodeId < m_nNodes && channelNumber >= 1 && channelNumber <= m_nChannels);
+        return NanoSeconds (m_values[static_cast<std::size_t> (AIRTIME_COLUMN + channelNumber - 1) * m_nNodes + nodeId]);
+    }
+
+    Time
+    MmWaveStatsCollector::GetRxAirtime (uint32_t nodeId, uint8_t channelNumber) const
+    {
+        NS_ASSERT (nodeId < m_nNodes && channelNumber >= 1 && channelNumber <= m_nChannels);
+        return NanoSeconds (m_values[static_cast<std::size_t> (AIRTIME_COLUMN + m_nChannels + channelNumber - 1) * m_nNodes + nodeId]);
+    }
+
+    uint64_t
+    MmWaveStatsCollector::GetHistogramCount (uint32_t nodeId, Histogram histogram, uint32_t bin) const
+    {
+        NS_ASSERT (nodeId < m_nNodes && bin < HISTOGRAM_BINS);
+        return m_values[static_cast<std::size_t> (GetHistogramColumn (histogram) + bin) * m_nNodes + nodeId];
+    }
+
+    uint32_t
+    MmWaveStatsCollector::GetNSnapshots () const
+    {
+        return m_nSnapshots;
+    }
+
+    bool
+    MmWaveStatsCollector::ReadCsv (std::string filename, std::ostream &os)
+    {
+        std::ifstream file (filename.c_str (), std::ios::binary);
+        MmWaveStatsHeader header;
+        if (!file.read (reinterpret_cast<char *> (&header), sizeof (header))
+            || std::memcmp (header.magic, "MMWS", 4) != 0
+            || header.version != MMWAVE_STATS_VERSION)
+        {
+            return false;
+        }
+        os << "time_ns,node";
+        for (uint32_t c = 0; c < header.nColumns; c++)
+        {
+            int length = file.get ();
+            std::string name (length > 0 ? length : 0, '\0');
+            if (length == std::char_traits<char>::eof () || !file.read (&name[0], name.size ()))
+            {
+                return false;
+            }
+            os << "," << name;
+        }
+        os << std::endl;
+        std::vector<uint64_t> values (static_cast<std::size_t> (header.nColumns) * header.nNodes);
+        int64_t timeNs;
+        // a snapshot cut short by the end of the file is ignored
+        while (file.read (reinterpret_cast<char *> (&timeNs), sizeof (timeNs))
+               && file.read (reinterpret_cast<char *> (values.data ()), values.size () * sizeof (uint64_t)))
+        {
+            for (uint32_t n = 0; n < header.nNodes; n++)
+            {
+                os << timeNs << "," << n;
+                for (uint32_t c = 0; c < header.nColumns; c++)
+                {
+                    os << "," << values[static_cast<std::size_t> (c) * header.nNodes + n];
+                }
+                os << "\n";
+            }
+        }
+        os.flush ();
+        return true;
+    }
+
+    void
+    MmWaveStatsCollector::BulkAckSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, uint32_t acked, uint32_t failed, uint32_t ackedBytes)
+    {
+        stats->At (TX_MPDU_OK, nodeId) += acked;
+        stats->At (TX_MPDU_FAILED, nodeId) += failed;
+        stats->At (TX_BYTES_OK, nodeId) += ackedBytes;
+        stats->At (BULK_ACK_OK, nodeId)++;
+    }
+
+    void
+    MmWaveStatsCollector::MissedBulkAckSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, uint32_t failed)
+    {
+        stats->At (TX_MPDU_FAILED, nodeId) += failed;
+        stats->At (BULK_ACK_MISSED, nodeId)++;
+    }
+
+    void
+    MmWaveStatsCollector::MacRxSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const Packet> p)
+    {
+        stats->At (MAC_RX_PACKETS, nodeId)++;
+        stats->At (MAC_RX_BYTES, nodeId) += p->GetSize ();
+    }
+
+    void
+    MmWaveStatsCollector::MacTxDropSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const Packet> p)
+    {
+        stats->At (MAC_TX_DROPS, nodeId)++;
+    }
+
+    void
+    MmWaveStatsCollector::QueueDequeueSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const MmWaveMacQueueItem> item)
+    {
+        int64_t sojourn = (Simulator::Now () - item->GetTimeStamp ()).GetNanoSeconds ();
+        stats->At (QUEUE_DEQUEUED, nodeId)++;
+        stats->At (QUEUE_SOJOURN_NS, nodeId) += sojourn;
+        stats->AddToHistogram (QUEUE_SOJOURN, nodeId, sojourn);
+    }
+
+    void
+    MmWaveStatsCollector::QueueDropSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const MmWaveMacQueueItem> item)
+    {
+        stats->At (QUEUE_DROPS, nodeId)++;
+    }
+
+    void
+    MmWaveStatsCollector::AccessGrantedSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Time delay)
+    {
+        stats->At (ACCESS_GRANTED, nodeId)++;
+        stats->At (ACCESS_DELAY_NS, nodeId) += delay.GetNanoSeconds ();
+        stats->AddToHistogram (ACCESS_DELAY, nodeId, delay.GetNanoSeconds ());
+    }
+
+    void
+    MmWaveStatsCollector::PhyRxErrorSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const Packet> p, double snr)
+    {
+        stats->At (PHY_RX_ERRORS, nodeId)++;
+    }
+
+    void
+    MmWaveStatsCollector::PhyStateSink (Ptr<MmWaveStatsCollector> stats, uint32_t source, Time start, Time duration, MmWavePhyState state)
+    {
+        const Phy &phy = stats->m_phys[source];
+        uint32_t channel = phy.phy->GetChannelNumber ();
+        switch (state)
+        {
+            case MMWAVE_TX:
+                if (channel >= 1 && channel <= stats->m_nChannels)
+                {
+                    stats->At (AIRTIME_COLUMN + channel - 1, phy.nodeId) += duration.GetNanoSeconds ();
+                }
+                break;
+            case MMWAVE_RX:
+                if (channel >= 1 && channel <= stats->m_nChannels)
+                {
+                    stats->At (AIRTIME_COLUMN + stats->m_nChannels + channel - 1, phy.nodeId) += duration.GetNanoSeconds ();
+                }
+                break;
+            case MMWAVE_SWITCHING:
+                stats->At (CHANNEL_SWITCHES, phy.nodeId)++;
+                break;
+            default:
+                break;
+        }
+    }
+
+}
@@ -0,0 +1,204 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MMWAVE_STATS_COLLECTOR_H
+#define MMWAVE_STATS_COLLECTOR_H
+#include <stdint.h>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/packet.h"
+#include "ns3/mmwave.h"
+#include "ns3/mmwave-mac-queue-item.h"
+#include "ns3/mmwave-phy-state-helper.h"
+
+namespace ns3 {
+
+    class MmWavePhy;
+
+    /**
+     * Per-node statistics of the MAC and PHY of cognitive radio devices, written
+     * periodically to a columnar file.
+     *
+     * The sinks only increment integers in fixed arrays, indexed by node id: the
+     * counters of the Counter enum, the TX and RX airtime of each channel and the
+     * log2 histograms of the Histogram enum. Every interval the arrays are written
+     * as one snapshot: the time, then every column as the contiguous values of
+     * all the nodes. The values are cumulative since the start of the simulation.
+     *
+     * The file starts with a 16 bytes header (magic "MMWS", version, number of
+     * nodes and of columns) followed by the names of the columns, each prefixed
+     * by its length; a histogram bin is one column. All the integers are in the
+     * byte order of the host that wrote the file.
+     * CrMmWaveHelper::EnableStats connects the devices; the nodes must all be
+     * connected before the first snapshot. The last snapshot is written when
+     * Close is called or the simulator is destroyed, and ReadCsv converts the
+     * file to text.
+     */
+    class MmWaveStatsCollector : public SimpleRefCount<MmWaveStatsCollector>
+    {
+    public:
+        enum Counter
+        {
+            TX_MPDU_OK = 0,   //!< MPDUs acknowledged by a bulk ack
+            TX_MPDU_FAILED,   //!< MPDUs not acknowledged
+            TX_BYTES_OK,      //!< bytes of the MPDUs acknowledged
+            BULK_ACK_OK,      //!< bulk acks received
+            BULK_ACK_MISSED,  //!< bulk acks missed
+            MAC_RX_PACKETS,   //!< packets forwarded up by the MAC
+            MAC_RX_BYTES,     //!< bytes of the packets forwarded up by the MAC
+            MAC_TX_DROPS,     //!< packets dropped by the MAC before transmission
+            QUEUE_DEQUEUED,   //!< MPDUs removed from the MAC queue, including the drops
+            QUEUE_DROPS,      //!< MPDUs dropped by the MAC queue, e.g. expired
+            QUEUE_SOJOURN_NS, //!< total time spent by the MPDUs in the MAC queue
+            ACCESS_GRANTED,   //!< channel accesses granted
+            ACCESS_DELAY_NS,  //!< total time between the access requests and grants
+            PHY_RX_ERRORS,    //!< frames received with errors
+            CHANNEL_SWITCHES, //!< channel switches of the PHYs
+            N_COUNTERS
+        };
+
+        enum Histogram
+        {
+            QUEUE_SOJOURN = 0, //!< time spent by the MPDUs in the MAC queue, ns
+            ACCESS_DELAY,      //!< time between the access requests and grants, ns
+            N_HISTOGRAMS
+        };
+
+        /// bin i of a histogram counts the values v with 2^i <= v < 2^(i+1); bin 0 holds 0 and the last bin the larger values
+        static const uint32_t HISTOGRAM_BINS = 32;
+
+        /**
+         * \param filename the file to create
+         * \param interval the time between two snapshots
+         */
+        MmWaveStatsCollector (std::string filename, Time interval);
+        ~MmWaveStatsCollector ();
+
+        /**
+         * Allocate the statistics of a node.
+         * \param nodeId the node
+         */
+        void AddNode (uint32_t nodeId);
+        /**
+         * Register a PHY whose airtime and channel switches are counted.
+         * \param nodeId the node of the PHY
+         * \param phy the PHY; it must outlive the collection
+         * \return the source to bind to the PHY sinks
+         */
+        uint32_t AddPhy (uint32_t nodeId, Ptr<MmWavePhy> phy);
+        /**
+         * Write a snapshot now; the next one follows after an interval.
+         */
+        void Flush ();
+        /**
+         * Write the last snapshot and close the file; no snapshot is written afterwards.
+         */
+        void Close ();
+        /**
+         * \param nodeId a node
+         * \param counter a counter
+         * \return the value of the counter of the node
+         */
+        uint64_t GetCounter (uint32_t nodeId, Counter counter) const;
+        /**
+         * \param nodeId a node
+         * \param channelNumber a channel
+         * \return the time the PHYs of the node spent transmitting on the channel
+         */
+        Time GetTxAirtime (uint32_t nodeId, uint8_t channelNumber) const;
+        /**
+         * \param nodeId a node
+         * \param channelNumber a channel
+         * \return the time the PHYs of the node spent receiving on the channel
+         */
+        Time GetRxAirtime (uint32_t nodeId, uint8_t channelNumber) const;
+        /**
+         * \param nodeId a node
+         * \param histogram a histogram
+         * \param bin a bin
+         * \return the number of values of the bin of the histogram of the node
+         */
+        uint64_t GetHistogramCount (uint32_t nodeId, Histogram histogram, uint32_t bin) const;
+        /**
+         * \return the number of snapshots written
+         */
+        uint32_t GetNSnapshots () const;
+
+        /**
+         * Convert a statistics file to CSV, one line per node and snapshot.
+         * \param filename the statistics file
+         * \param os the output
+         * \return false if the file cannot be read
+         */
+        static bool ReadCsv (std::string filename, std::ostream &os);
+
+        /// sink of the BulkAck trace of CrMmWaveTxop
+        static void BulkAckSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, uint32_t acked, uint32_t failed, uint32_t ackedBytes);
+        /// sink of the MissedBulkAck trace of CrMmWaveTxop
+        static void MissedBulkAckSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, uint32_t failed);
+        /// sink of the MacRx trace of MmWaveMac
+        static void MacRxSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const Packet> p);
+        /// sink of the MacTxDrop trace of MmWaveMac
+        static void MacTxDropSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const Packet> p);
+        /// sink of the Dequeue trace of MmWaveMacQueue
+        static void QueueDequeueSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const MmWaveMacQueueItem> item);
+        /// sink of the Drop trace of MmWaveMacQueue
+        static void QueueDropSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const MmWaveMacQueueItem> item);
+        /// sink of the AccessGranted trace of CrDynamicChannelAccessManager
+        static void AccessGrantedSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Time delay);
+        /// sink of the RxError trace of MmWavePhyStateHelper
+        static void PhyRxErrorSink (Ptr<MmWaveStatsCollector> stats, uint32_t nodeId, Ptr<const Packet> p, double snr);
+        /// sink of the State trace of MmWavePhyStateHelper
+        static void PhyStateSink (Ptr<MmWaveStatsCollector> stats, uint32_t source, Time start, Time duration, MmWavePhyState state);
+
+    private:
+        /// column of the TX airtime of the first channel; the RX airtime follows the TX airtime of all the channels
+        static const uint32_t AIRTIME_COLUMN = N_COUNTERS;
+
+        /**
+         * \param column a column
+         * \param nodeId a node
+         * \return the value of the column for the node
+         */
+        uint64_t &At (uint32_t column, uint32_t nodeId);
+        /**
+         * Count a value in a histogram.
+         * \param histogram the histogram
+         * \param nodeId the node
+         * \param value the value
+         */
+        void AddToHistogram (Histogram histogram, uint32_t nodeId, uint64_t value);
+        /**
+         * \param histogram a histogram
+         * \return the column of the first bin of the histogram
+         */
+        uint32_t GetHistogramColumn (Histogram histogram) const;
+        /// write the header and the column names
+        void WriteHeader ();
+        /// write the current values as a snapshot
+        void WriteSnapshot ();
+
+        struct Phy
+        {
+            uint32_t nodeId;
+            const MmWavePhy *phy; //!< not a Ptr: the PHY holds the collector through its trace sinks
+        };
+
+        std::ofstream m_file; //!< the statistics file
+        Time m_interval; //!< the time between two snapshots
+        EventId m_flushEvent; //!< the next snapshot
+        bool m_closed; //!< whether Close was called
+        uint32_t m_nNodes; //!< number of nodes of the columns
+        uint32_t m_nChannels; //!< number of channels of the airtime columns
+        uint32_t m_nColumns; //!< number of columns
+        uint32_t m_nSnapshots; //!< number of snapshots written
+        std::vector<uint64_t> m_values; //!< the columns, each made of the values of all the nodes
+        std::vector<Phy> m_phys; //!< the registered PHYs
+    };
+
+}
+#endif //MMWAVE_STATS_COLLECTOR_H
@@ -281,6 +281,50 @@ namespace ns3 {
         Config::Connect (oss.str (), MakeBoundCallback (&AsciiPhyTransmitSinkWithContext, stream));
     }
 
+    void
+    V2xCtrlPhyHelper::EnableBinary (Ptr<MmWaveBinaryTraceFile> file, NetDeviceContainer d)
+    {
+        for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+        {
+            EnableBinaryInternal (file, *i);
+        }
+    }
+
+    void
+    V2xCtrlPhyHelper::EnableBinaryAll (Ptr<MmWaveBinaryTraceFile> file)
+    {
+        NodeContainer nodes = NodeContainer::GetGlobal ();
+        for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+        {
+            for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+            {
+                EnableBinaryInternal (file, (*i)->GetDevice (j));
+            }
+        }
+    }
+
+    void
+    V2xCtrlPhyHelper::EnableBinaryInternal (Ptr<MmWaveBinaryTraceFile> file, Ptr<NetDevice> nd)
+    {
+        Ptr<V2xMmWaveNetDevice> device = nd->GetObject<V2xMmWaveNetDevice> ();
+        if (device == 0)
+        {
+            NS_LOG_INFO ("EnableBinaryInternal(): Device " << device << " not of type ns3::V2xMmWaveNetDevice");
+            return;
+        }
+        // unlike the ASCII traces, the records do not need packet printing
+        uint32_t nodeid = nd->GetNode ()->GetId ();
+        uint32_t deviceid = nd->GetIfIndex ();
+        std::ostringstream oss;
+        uint32_t source;
+        source = file->AddSource (nodeid, deviceid, MmWaveBinaryTraceFile::V2X_CTRL);
+        oss.str ("");
+        oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid << "/$ns3::V2xMmWaveNetDevice/CtrlPhyEntities/*/$ns3::WifiPhy/State/";
+        Config::ConnectWithoutContext (oss.str () + "Tx", MakeBoundCallback (&MmWaveBinaryTraceFile::WifiTxSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxOk", MakeBoundCallback (&MmWaveBinaryTraceFile::WifiRxOkSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxError", MakeBoundCallback (&MmWaveBinaryTraceFile::RxErrorSink, file, source));
+    }
+
     V2xDataPhyHelper::V2xDataPhyHelper ()
             : m_channel (0)
     {
@@ -535,6 +579,50 @@ namespace ns3 {
         Config::Connect (oss.str (), MakeBoundCallback (&AsciiPhyTransmitSinkWithContext, stream));
     }
 
+    void
+    V2xDataPhyHelper::EnableBinary (Ptr<MmWaveBinaryTraceFile> file, NetDeviceContainer d)
+    {
+        for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+        {
+            EnableBinaryInternal (file, *i);
+        }
+    }
+
+    void
+    V2xDataPhyHelper::EnableBinaryAll (Ptr<MmWaveBinaryTraceFile> file)
+    {
+        NodeContainer nodes = NodeContainer::GetGlobal ();
+        for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+        {
+            for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+            {
+                EnableBinaryInternal (file, (*i)->GetDevice (j));
+            }
+        }
+    }
+
+    void
+    V2xDataPhyHelper::EnableBinaryInternal (Ptr<MmWaveBinaryTraceFile> file, Ptr<NetDevice> nd)
+    {
+        Ptr<V2xMmWaveNetDevice> device = nd->GetObject<V2xMmWaveNetDevice> ();
+        if (device == 0)
+        {
+            NS_LOG_INFO ("EnableBinaryInternal(): Device " << device << " not of type ns3::V2xMmWaveNetDevice");
+            return;
+        }
+        // unlike the ASCII traces, the records do not need packet printing
+        uint32_t nodeid = nd->GetNode ()->GetId ();
+        uint32_t deviceid = nd->GetIfIndex ();
+        std::ostringstream oss;
+        uint32_t source;
+        source = file->AddSource (nodeid, deviceid, MmWaveBinaryTraceFile::V2X_DATA);
+        oss.str ("");
+        oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid << "/$ns3::V2xMmWaveNetDevice/DataPhy/State/";
+        Config::ConnectWithoutContext (oss.str () + "Tx", MakeBoundCallback (&MmWaveBinaryTraceFile::MmWaveTxSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxOk", MakeBoundCallback (&MmWaveBinaryTraceFile::MmWaveRxOkSink, file, source));
+        Config::ConnectWithoutContext (oss.str () + "RxError", MakeBoundCallback (&MmWaveBinaryTraceFile::RxErrorSink, file, source));
+    }
+
     V2xCtrlMacHelper::V2xCtrlMacHelper ()
     {
         SetType ("ns3::V2xCtrlMac", "QosSupported", BooleanValue (false));
@@ -22,6 +22,7 @@
 #include "ns3/mmwave-phy.h"
 #include "ns3/v2x-data-mac.h"
 #include "ns3/v2x-ctrl-mac.h"
+#include "ns3/mmwave-binary-trace.h"
 #include "ns3/net-device.h"
 namespace ns3 {
     class V2xCtrlPhyHelper : public AsciiTraceHelperForDevice
@@ -69,6 +70,18 @@ namespace ns3 {
                                         std::string n5 = "", const AttributeValue &v5 = EmptyAttributeValue (),
                                         std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
                                         std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
+        /**
+         * Store the TX and RX events of the PHYs of the devices in a binary trace file.
+         * \param file the binary trace file
+         * \param d the devices
+         */
+        void EnableBinary (Ptr<MmWaveBinaryTraceFile> file, NetDeviceContainer d);
+        /**
+         * Store the TX and RX events of the PHYs of all the devices in a binary trace file.
+         * \param file the binary trace file
+         */
+        void EnableBinaryAll (Ptr<MmWaveBinaryTraceFile> file);
+        void EnableBinaryInternal (Ptr<MmWaveBinaryTraceFile> file, Ptr<NetDevice> nd);
     protected:
         void EnableAsciiInternal (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
         Ptr<SpectrumChannel> m_channel;
@@ -129,6 +142,18 @@ namespace ns3 {
                                         std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
                                         std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
         void EnableAsciiInternal (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
+        /**
+         * Store the TX and RX events of the PHYs of the devices in a binary trace file.
+         * \param file the binary trace file
+         * \param d the devices
+         */
+        void EnableBinary (Ptr<MmWaveBinaryTraceFile> file, NetDeviceContainer d);
+        /**
+         * Store the TX and RX events of the PHYs of all the devices in a binary trace file.
+         * \param file the binary trace file
+         */
+        void EnableBinaryAll (Ptr<MmWaveBinaryTraceFile> file);
+        void EnableBinaryInternal (Ptr<MmWaveBinaryTraceFile> file, Ptr<NetDevice> nd);
     protected:
         Ptr<SpectrumChannel> m_channel;
         Ptr<AntennaModel> m_antenna;
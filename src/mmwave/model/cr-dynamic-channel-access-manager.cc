@@ -3,6 +3,7 @@
 #include <cmath>
 #include <utility>
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
 #include "ns3/nstime.h"
 #include "mmwave-phy-listener.h"
 #include "mmwave-spectrum-repository.h"
@@ -74,7 +75,8 @@ namespace ns3 {
     };
 
     CrDynamicChannelAccessManager::CrDynamicChannelAccessManager ()
-            : m_lastAckTimeoutEnd (Seconds (0.0)),
+            : m_accessRequestStart (Seconds (0.0)),
+              m_lastAckTimeoutEnd (Seconds (0.0)),
               m_lastCtsTimeoutEnd (Seconds (0.0)),
               m_lastBulkTimeoutEnd (Seconds (0.0)),
               m_lastNavStart (Seconds (0.0)),
@@ -111,7 +113,10 @@ namespace ns3 {
         static TypeId tid = TypeId("ns3::CrDynamicChannelAccessManager")
                 .SetParent<Object>()
                 .SetGroupName("MmWave")
-                .AddConstructor<CrDynamicChannelAccessManager> ();
+                .AddConstructor<CrDynamicChannelAccessManager> ()
+                .AddTraceSource("AccessGranted", "The channel access was granted; the delay since the access was requested.",
+                                MakeTraceSourceAccessor(&CrDynamicChannelAccessManager::m_accessGrantedTrace),
+                                "ns3::CrDynamicChannelAccessManager::AccessGrantedTracedCallback");
         return tid;
     }
 
@@ -520,6 +525,7 @@ namespace ns3 {
     {
         if (!m_requestAccess.IsRunning ())
         {
+            m_accessRequestStart = Simulator::Now ();
             ResetRotationFactor ();
         }
         RequestAccess (typeOfAccess);
@@ -541,7 +547,7 @@ namespace ns3 {
                         m_typeOfAccessMode = typeOfAccess;
                         delay = Simulator::GetDelayLeft (m_requestAccess);
                         m_requestAccess.Cancel ();
-                        m_requestAccess = Simulator::Schedule (delay, &CrDynamicChannelAccessManager::RequestAccessCallback, this, m_typeOfAccessMode);
+                        m_requestAccess = NS_PROFILE_SCHEDULE (delay, &CrDynamicChannelAccessManager::RequestAccessCallback, this, m_typeOfAccessMode);
                     }
                     break;
                 case BEACON_ACCESS:
@@ -550,7 +556,7 @@ namespace ns3 {
                         m_typeOfAccessMode = typeOfAccess;
                         delay = Simulator::GetDelayLeft (m_requestAccess);
                         m_requestAccess.Cancel ();
-                        m_requestAccess = Simulator::Schedule (delay, &CrDynamicChannelAccessManager::RequestAccessCallback, this, m_typeOfAccessMode);
+                        m_requestAccess = NS_PROFILE_SCHEDULE (delay, &CrDynamicChannelAccessManager::RequestAccessCallback, this, m_typeOfAccessMode);
                     }
                     break;
                 case DETECTION_ACCESS:
@@ -578,7 +584,7 @@ namespace ns3 {
                     break;
             }
             m_typeOfAccessMode = typeOfAccess;
-            m_requestAccess = Simulator::Schedule (delay, &CrDynamicChannelAccessManager::RequestAccessCallback, this, m_typeOfAccessMode);
+            m_requestAccess = NS_PROFILE_SCHEDULE (delay, &CrDynamicChannelAccessManager::RequestAccessCallback, this, m_typeOfAccessMode);
         }
     }
 
@@ -592,6 +598,7 @@ namespace ns3 {
         else
         {
             NS_ASSERT (m_phy->IsStateIdle ());
+            m_accessGrantedTrace (Simulator::Now () - m_accessRequestStart);
             switch (typeOfAccess)
             {
                 case DETECTION_ACCESS:
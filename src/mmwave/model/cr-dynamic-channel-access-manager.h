@@ -4,6 +4,7 @@
 #include "ns3/object.h"
 #include "ns3/vector.h"
 #include "ns3/simulator.h"
+#include "ns3/traced-callback.h"
 #include "mmwave.h"
 #include "cr-txop.h"
 #include "mmwave-spectrum-repository.h"
@@ -56,7 +57,14 @@ namespace ns3 {
         Time GetBeifs ();
         Time GetBuifs ();
 
+        /**
+         * TracedCallback signature for a granted channel access.
+         * \param delay the time since the access was requested
+         */
+        typedef void (* AccessGrantedTracedCallback)(Time delay);
+
         EventId m_requestAccess;
+        Time m_accessRequestStart;    //!< the time the running access request started
         Time m_lastAckTimeoutEnd;     //!< the last Ack timeout end time
         Time m_lastCtsTimeoutEnd;     //!< the last CTS timeout end time
         Time m_lastBulkTimeoutEnd;    //!< the last bulk access request timeout end time
@@ -82,6 +90,7 @@ namespace ns3 {
         uint32_t m_gamma_init;
         uint32_t m_gamma;
         uint32_t m_k;
+        TracedCallback<Time> m_accessGrantedTrace; //!< the channel access was granted
     };
 }
 #endif //CR_CHANNEL_ACCESS_MANAGER_H
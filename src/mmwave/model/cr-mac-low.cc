@@ -1,6 +1,7 @@
 /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
 #include <cmath>
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
 #include "ns3/vector.h"
 #include "ns3/mobility-model.h"
 #include "mmwave-snr-tag.h"
@@ -352,7 +353,7 @@ namespace ns3 {
         NS_ASSERT (m_txBulkAccessInfo != 0);
         NS_ASSERT (m_txBulkAccessInfo->m_address.IsGroup ());
         NS_ASSERT (m_txBulkAccessInfo->m_txDuration.IsPositive ());
-        m_bulkAccess = Simulator::Schedule (m_txBulkAccessInfo->m_txDuration - GetSifs (), &CrMmWaveMacLow::EndBulkAccess, this);
+        m_bulkAccess = NS_PROFILE_SCHEDULE (m_txBulkAccessInfo->m_txDuration - GetSifs (), &CrMmWaveMacLow::EndBulkAccess, this);
         m_txop->SetAccessBuffer (GetTypeOfGroup (), m_txBulkAccessInfo->m_address, m_txBulkAccessInfo->m_txDuration);
 
         NS_ASSERT (GetMacLowState() == INTRA_TRANSMISSION || GetMacLowState() == INTER_TRANSMISSION);
@@ -795,13 +796,13 @@ namespace ns3 {
         {
             m_bulkResponseTimeout.Cancel ();
             NotifyBulkTimeoutResetNow ();
-            m_bulkResponseTimeout = Simulator::Schedule (psduDuration + NanoSeconds (400), &CrMmWaveMacLow::BulkTimeout, this);
+            m_bulkResponseTimeout = NS_PROFILE_SCHEDULE (psduDuration + NanoSeconds (400), &CrMmWaveMacLow::BulkTimeout, this);
         }
         else if (m_bulkAckTimeout.IsRunning ())
         {
             m_bulkAckTimeout.Cancel ();
             NotifyAckTimeoutResetNow ();
-            m_bulkAckTimeout = Simulator::Schedule (psduDuration + NanoSeconds (400), &CrMmWaveMacLow::BulkAckTimeout, this);
+            m_bulkAckTimeout = NS_PROFILE_SCHEDULE (psduDuration + NanoSeconds (400), &CrMmWaveMacLow::BulkAckTimeout, this);
         }
         else if (m_navCounterReset.IsRunning ())
         {
@@ -848,12 +849,12 @@ namespace ns3 {
         {
             txVector = GetDataTxVector (to);
             timerDelay = GetSifs () + GetBulkAckTxDuration (m_self) + GetSifs () + GetSlotTime () + GetPhyPreambleAndHeaderDuration (txVector);
-            m_bulkAckTimeout = Simulator::Schedule (timerDelay, &CrMmWaveMacLow::BulkAckTimeout, this);
+            m_bulkAckTimeout = NS_PROFILE_SCHEDULE (timerDelay, &CrMmWaveMacLow::BulkAckTimeout, this);
             NotifyAckTimeoutStartNow (timerDelay);
         }
         else
         {
-            m_waitIfsEvent = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
+            m_waitIfsEvent = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
         }
     }
 
@@ -889,7 +890,7 @@ namespace ns3 {
     {
         m_txop->MissedBulkResponse (GetTypeOfGroup ());
         NS_ASSERT (m_waitIfsEvent.IsExpired ());
-        m_waitIfsEvent = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
+        m_waitIfsEvent = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
     }
 
     void
@@ -897,7 +898,7 @@ namespace ns3 {
     {
         m_txop->MissedBulkAck (GetTypeOfGroup ());
         NS_ASSERT (m_waitIfsEvent.IsExpired ());
-        m_waitIfsEvent = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
+        m_waitIfsEvent = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
     }
 
     void
@@ -1041,19 +1042,19 @@ namespace ns3 {
                 NS_LOG_DEBUG ("-------------------INTRA_GROUP:" << next);
                 SetMacLowState (INTRA_SWITCH);
                 m_phy->SetChannelNumber (next.first.first);
-                m_stateSwitching = Simulator::Schedule (m_phy->GetChannelSwitchDelay (), &CrMmWaveMacLow::ToTransmission, this);
+                m_stateSwitching = NS_PROFILE_SCHEDULE (m_phy->GetChannelSwitchDelay (), &CrMmWaveMacLow::ToTransmission, this);
                 break;
             case INTER_GROUP:
                 NS_LOG_DEBUG ("-------------------INTER_GROUP:" << next);
                 SetMacLowState (INTER_SWITCH);
                 m_phy->SetChannelNumber (next.first.first);
-                m_stateSwitching = Simulator::Schedule (m_phy->GetChannelSwitchDelay (), &CrMmWaveMacLow::ToTransmission, this);
+                m_stateSwitching = NS_PROFILE_SCHEDULE (m_phy->GetChannelSwitchDelay (), &CrMmWaveMacLow::ToTransmission, this);
                 break;
             case PROBE_GROUP:
                 NS_LOG_DEBUG ("-------------------PROBE_GROUP:" << next);
                 SetMacLowState (PROBE_SWITCH);
                 m_phy->SetChannelNumber (next.first.first);
-                m_stateSwitching = Simulator::Schedule (m_phy->GetChannelSwitchDelay (), &CrMmWaveMacLow::ToDetection, this);
+                m_stateSwitching = NS_PROFILE_SCHEDULE (m_phy->GetChannelSwitchDelay (), &CrMmWaveMacLow::ToDetection, this);
                 break;
             default:
                 NS_FATAL_ERROR ("TypeOfGroup is error");
@@ -1072,10 +1073,10 @@ namespace ns3 {
         {
             case INTRA_GROUP:
                 SetMacLowState (INTRA_TRANSMISSION);
-                m_beaconEvent = Simulator::Schedule (rngDelay, &CrMmWaveMacLow::StartBeacon, this);
+                m_beaconEvent = NS_PROFILE_SCHEDULE (rngDelay, &CrMmWaveMacLow::StartBeacon, this);
                 if (mac->GetAccessMode () == MMWAVE_MULTI_CHANNEL)
                 {
-                    m_detectionEvent = Simulator::Schedule (rngDelay + mac->GetDetectionInterval (), &CrMmWaveMacLow::StartDetection, this);
+                    m_detectionEvent = NS_PROFILE_SCHEDULE (rngDelay + mac->GetDetectionInterval (), &CrMmWaveMacLow::StartDetection, this);
                 }
                 break;
             case INTER_GROUP:
@@ -1108,12 +1109,12 @@ namespace ns3 {
             case INTRA_GROUP:
                 SetMacLowState (INTRA_DETECTION);
                 StartDetectionChannel (mac->GetFastDetectionDuration ());
-                m_stateDetection = Simulator::Schedule (mac->GetFastDetectionDuration (), &CrMmWaveMacLow::StopDetectionChannel, this);
+                m_stateDetection = NS_PROFILE_SCHEDULE (mac->GetFastDetectionDuration (), &CrMmWaveMacLow::StopDetectionChannel, this);
                 break;
             case PROBE_GROUP:
                 SetMacLowState (PROBE_DETECTION);
                 StartDetectionChannel (mac->GetFineDetectionDuration ());
-                m_stateDetection = Simulator::Schedule (mac->GetFineDetectionDuration (), &CrMmWaveMacLow::StopDetectionChannel, this);
+                m_stateDetection = NS_PROFILE_SCHEDULE (mac->GetFineDetectionDuration (), &CrMmWaveMacLow::StopDetectionChannel, this);
                 break;
             case INTER_GROUP:
             default:
@@ -1140,7 +1141,7 @@ namespace ns3 {
         NS_ASSERT (GetTypeOfGroup () == INTRA_GROUP);
         EndChannelAccess ();
         Ptr<CrMmWaveMac> mac = DynamicCast<CrMmWaveMac> (m_mac);
-        m_detectionEvent = Simulator::Schedule (mac->GetDetectionInterval (), &CrMmWaveMacLow::StartDetection, this);
+        m_detectionEvent = NS_PROFILE_SCHEDULE (mac->GetDetectionInterval (), &CrMmWaveMacLow::StartDetection, this);
         ToDetection ();
     }
 
@@ -1156,11 +1157,11 @@ namespace ns3 {
         }
 
         Ptr<CrMmWaveMac> mac = DynamicCast<CrMmWaveMac> (m_mac);
-        m_beaconEvent = Simulator::Schedule (mac->GetBeaconInterval (), &CrMmWaveMacLow::StartBeacon, this);
+        m_beaconEvent = NS_PROFILE_SCHEDULE (mac->GetBeaconInterval (), &CrMmWaveMacLow::StartBeacon, this);
         if (m_txop->HasAnyAccessRequest (GetTypeOfGroup()))
         {
             NS_ASSERT (m_waitIfsEvent.IsExpired ());
-            m_waitIfsEvent = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::SendBulkAccessRequest, this);
+            m_waitIfsEvent = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::SendBulkAccessRequest, this);
         }
     }
 
@@ -1277,27 +1278,27 @@ namespace ns3 {
             NS_ASSERT (m_waitIfsEvent.IsExpired ());
             if (m_txop->HasNextFragment (GetTypeOfGroup ()))
             {
-                m_waitIfsEvent = Simulator::Schedule (txDuration + GetSifs (), &CrMmWaveMacLow::WaitIfsAfterEndTxFragment, this);
+                m_waitIfsEvent = NS_PROFILE_SCHEDULE (txDuration + GetSifs (), &CrMmWaveMacLow::WaitIfsAfterEndTxFragment, this);
             }
             else if (m_txop->HasNextPacket (GetTypeOfGroup ()))
             {
-                m_waitIfsEvent = Simulator::Schedule (txDuration + GetSifs (), &CrMmWaveMacLow::WaitIfsAfterEndTxPacket, this);
+                m_waitIfsEvent = NS_PROFILE_SCHEDULE (txDuration + GetSifs (), &CrMmWaveMacLow::WaitIfsAfterEndTxPacket, this);
             }
         }
         else if (m_currentPacket->GetHeader ().IsBeacon ())
         {
-            m_txPacket = Simulator::Schedule (txDuration, &CrMmWaveMacLow::BeaconTxEnd, this);
+            m_txPacket = NS_PROFILE_SCHEDULE (txDuration, &CrMmWaveMacLow::BeaconTxEnd, this);
         }
         else if (m_currentPacket->GetHeader ().IsDetectRequest ())
         {
-            m_txPacket = Simulator::Schedule (txDuration, &CrMmWaveMacLow::DetectionTxEnd, this);
+            m_txPacket = NS_PROFILE_SCHEDULE (txDuration, &CrMmWaveMacLow::DetectionTxEnd, this);
         }
         else if (m_currentPacket->GetHeader ().IsBulkRequest ())
         {
             NS_ASSERT (m_bulkResponseTimeout.IsExpired ());
             Time timerDelay = txDuration + GetBulkResponseTimeout (m_self);
             NotifyBulkTimeoutStartNow (timerDelay);
-            m_bulkResponseTimeout = Simulator::Schedule (timerDelay, &CrMmWaveMacLow::BulkTimeout, this);
+            m_bulkResponseTimeout = NS_PROFILE_SCHEDULE (timerDelay, &CrMmWaveMacLow::BulkTimeout, this);
         }
     }
 
@@ -1361,13 +1362,13 @@ namespace ns3 {
                         m_rxBulkAccessInfo->m_numOfReceived = 0;
 
                         NS_ASSERT (m_txPacket.IsExpired ());
-                        m_txPacket = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::SendBulkResponseAfterRequest, this, m_rxBulkAccessInfo->m_address, m_rxBulkAccessInfo->m_txDuration);
+                        m_txPacket = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::SendBulkResponseAfterRequest, this, m_rxBulkAccessInfo->m_address, m_rxBulkAccessInfo->m_txDuration);
                         timerDelay = GetSifs ()
                                      + GetBulkResponseTxDuration (from)
                                      + m_rxBulkAccessInfo->m_txDuration
                                      + GetSifs ();
                         NS_ASSERT (m_sendBulkAck.IsExpired ());
-                        m_sendBulkAck = Simulator::Schedule (timerDelay, &CrMmWaveMacLow::ReadySendAckAfterData, this);
+                        m_sendBulkAck = NS_PROFILE_SCHEDULE (timerDelay, &CrMmWaveMacLow::ReadySendAckAfterData, this);
 
                         NS_LOG_DEBUG ("rx bulk request from=" << from << ", txDuration=" << m_rxBulkAccessInfo->m_txDuration << ", send bulk ack timer=" << timerDelay);
                     }
@@ -1388,12 +1389,12 @@ namespace ns3 {
                         NS_ASSERT (m_bulkAccess.IsExpired ());
                         NS_ASSERT (m_txBulkAccessInfo != 0);
 
-                        m_bulkAccess = Simulator::Schedule (m_txBulkAccessInfo->m_txDuration, &CrMmWaveMacLow::EndBulkAccess, this);
+                        m_bulkAccess = NS_PROFILE_SCHEDULE (m_txBulkAccessInfo->m_txDuration, &CrMmWaveMacLow::EndBulkAccess, this);
                         NS_ASSERT (m_txBulkAccessInfo->m_txDuration.IsPositive ());
                         m_txop->SetAccessBuffer (GetTypeOfGroup (), m_txBulkAccessInfo->m_address, m_txBulkAccessInfo->m_txDuration);
 
                         NS_ASSERT (m_waitIfsEvent.IsExpired ());
-                        m_waitIfsEvent = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::WaitIfsAfterEndTxPacket, this);
+                        m_waitIfsEvent = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::WaitIfsAfterEndTxPacket, this);
 
                         NS_LOG_DEBUG ("rx bulk response from=" << from << ", txDuration=" << m_txBulkAccessInfo->m_txDuration);
                     }
@@ -1412,7 +1413,7 @@ namespace ns3 {
 
                         m_txop->GotBulkAck (GetTypeOfGroup (), ackHeader.GetStartingSequenceControl (), ackHeader.GetBitmap ());
                         NS_ASSERT (m_waitIfsEvent.IsExpired ());
-                        m_waitIfsEvent = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
+                        m_waitIfsEvent = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::StartNewBulkAccess, this);
                         NS_LOG_DEBUG ("rx bulk ack from=" << from);
                     }
                 }
@@ -1458,7 +1459,7 @@ namespace ns3 {
                             if (m_rxBulkAccessInfo->m_numOfPackets == m_rxBulkAccessInfo->m_numOfReceived)
                             {
                                 m_sendBulkAck.Cancel ();
-                                m_sendBulkAck = Simulator::Schedule (GetSifs (), &CrMmWaveMacLow::SendAckAfterData, this);
+                                m_sendBulkAck = NS_PROFILE_SCHEDULE (GetSifs (), &CrMmWaveMacLow::SendAckAfterData, this);
                             }
                         }
                     }
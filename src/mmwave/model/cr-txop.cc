@@ -31,6 +31,12 @@ namespace ns3 {
                               PointerValue(),
                               MakePointerAccessor(&CrMmWaveTxop::GetMacQueue),
                               MakePointerChecker<MmWaveMacQueue>())
+                .AddTraceSource("BulkAck", "A bulk ack acknowledged some of the MPDUs of a bulk transmission.",
+                                MakeTraceSourceAccessor(&CrMmWaveTxop::m_bulkAckTrace),
+                                "ns3::CrMmWaveTxop::BulkAckTracedCallback")
+                .AddTraceSource("MissedBulkAck", "The bulk ack of a bulk transmission was missed.",
+                                MakeTraceSourceAccessor(&CrMmWaveTxop::m_missedBulkAckTrace),
+                                "ns3::CrMmWaveTxop::MissedBulkAckTracedCallback")
         ;
         return tid;
     }
@@ -504,6 +510,9 @@ namespace ns3 {
         NS_LOG_FUNCTION (this << typeOfGroup);
         uint16_t seq;
         uint64_t flag;
+        uint32_t acked = 0;
+        uint32_t failed = 0;
+        uint32_t ackedBytes = 0;
         std::vector<uint16_t> seqVector;
         for (uint16_t i = 1; i <= 64; i++)
         {
@@ -524,10 +533,13 @@ namespace ns3 {
                     auto f = std::find (seqVector.begin (), seqVector.end (), seq);
                     if (f != seqVector.end ())
                     {
+                        acked++;
+                        ackedBytes += i->GetPacket ()->GetSize ();
                         TxOk (i->GetHeader ());
                     }
                     else
                     {
+                        failed++;
                         TxFailed (i->GetHeader (), i->GetPacket ()->GetSize ());
                     }
                 }
@@ -540,10 +552,13 @@ namespace ns3 {
                     auto f = std::find (seqVector.begin (), seqVector.end (), seq);
                     if (f != seqVector.end ())
                     {
+                        acked++;
+                        ackedBytes += i->GetPacket ()->GetSize ();
                         TxOk (i->GetHeader ());
                     }
                     else
                     {
+                        failed++;
                         TxFailed (i->GetHeader (), i->GetPacket ()->GetSize ());
                     }
                 }
@@ -554,6 +569,7 @@ namespace ns3 {
                 NS_FATAL_ERROR("TypeOfGroup is error");
                 break;
         }
+        m_bulkAckTrace (acked, failed, ackedBytes);
     }
 
     void
@@ -584,6 +600,7 @@ namespace ns3 {
         switch (typeOfGroup)
         {
             case INTRA_GROUP:
+                m_missedBulkAckTrace (m_recordsOfIntraGroup.size ());
                 for (auto & i : m_recordsOfIntraGroup)
                 {
                     TxFailed (i->GetHeader (), i->GetPacket ()->GetSize ());
@@ -591,6 +608,7 @@ namespace ns3 {
                 m_recordsOfIntraGroup.clear ();
                 break;
             case INTER_GROUP:
+                m_missedBulkAckTrace (m_recordsOfInterGroup.size ());
                 for (auto & i : m_recordsOfInterGroup)
                 {
                     TxFailed (i->GetHeader (), i->GetPacket ()->GetSize ());
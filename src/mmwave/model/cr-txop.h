@@ -10,6 +10,7 @@
 #include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/traced-callback.h"
 #include "mmwave.h"
 #include "mmwave-mac-low-parameters.h"
 #include "mmwave-mac-header.h"
@@ -63,6 +64,19 @@ namespace ns3 {
         MmWaveChannelNumberStandardPair GetCurrentChannel (TypeOfGroup typeOfGroup);
         Ptr<Packet> GetFragmentPacket (TypeOfGroup typeOfGroup, MmWaveMacHeader *hdr);
         Ptr<MmWaveMacQueue> GetMacQueue () const;
+
+        /**
+         * TracedCallback signature for the outcome of a bulk transmission.
+         * \param acked the number of MPDUs acknowledged
+         * \param failed the number of MPDUs not acknowledged
+         * \param ackedBytes the size of the MPDUs acknowledged, bytes
+         */
+        typedef void (* BulkAckTracedCallback)(uint32_t acked, uint32_t failed, uint32_t ackedBytes);
+        /**
+         * TracedCallback signature for a missed bulk ack.
+         * \param failed the number of MPDUs not acknowledged
+         */
+        typedef void (* MissedBulkAckTracedCallback)(uint32_t failed);
     protected:
         Callback <void, const MmWaveMacHeader&> m_txOkCallback;
         Callback <void, const MmWaveMacHeader&> m_txFailedCallback;
@@ -87,6 +101,9 @@ namespace ns3 {
         uint8_t m_fragmentNumberOfIntraGroup;
         uint8_t m_fragmentNumberOfInterGroup;
         uint32_t m_bufferSize;
+
+        TracedCallback<uint32_t, uint32_t, uint32_t> m_bulkAckTrace; //!< a bulk ack was received
+        TracedCallback<uint32_t> m_missedBulkAckTrace;               //!< a bulk ack was missed
     };
 }
 #endif //CR_TXOP_H
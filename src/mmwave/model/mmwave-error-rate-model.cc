@@ -44,4 +44,19 @@ namespace ns3 {
         return DoGetChunkSuccessRate (mode, txVector, snr, nbits);
     }
 
+    void
+    MmWaveErrorRateModel::GetChunkSuccessRates (MmWaveMode mode, MmWaveTxVector txVector, const double *snrs, const uint64_t *nbits, double *csrs, std::size_t n) const
+    {
+        DoGetChunkSuccessRates (mode, txVector, snrs, nbits, csrs, n);
+    }
+
+    void
+    MmWaveErrorRateModel::DoGetChunkSuccessRates (MmWaveMode mode, MmWaveTxVector txVector, const double *snrs, const uint64_t *nbits, double *csrs, std::size_t n) const
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            csrs[i] = DoGetChunkSuccessRate (mode, txVector, snrs[i], nbits[i]);
+        }
+    }
+
 } //namespace ns3
\ No newline at end of file
@@ -14,9 +14,19 @@ namespace ns3 {
         static TypeId GetTypeId (void);
         double CalculateSnr (MmWaveTxVector txVector, double ber) const;
         double GetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const;
+        /**
+         * Compute the success rates of n chunks sent with the same mode in one call.
+         *
+         * \param snrs the SNR of each chunk
+         * \param nbits the number of bits of each chunk
+         * \param csrs receives the success rate of each chunk
+         */
+        void GetChunkSuccessRates (MmWaveMode mode, MmWaveTxVector txVector, const double *snrs, const uint64_t *nbits, double *csrs, std::size_t n) const;
 
     private:
         virtual double DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const = 0;
+        /// Compute the chunks one by one unless a model overrides it
+        virtual void DoGetChunkSuccessRates (MmWaveMode mode, MmWaveTxVector txVector, const double *snrs, const uint64_t *nbits, double *csrs, std::size_t n) const;
     };
 
 } //namespace ns3
@@ -3,19 +3,174 @@
 #include <algorithm>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
-#include "ns3/packet.h"
 #include "mmwave-error-rate-model.h"
 #include "mmwave-interference-helper.h"
 #include "mmwave-phy.h"
 #include "mmwave-ppdu.h"
-#include "mmwave-psdu.h"
 
 namespace ns3 {
 
     NS_LOG_COMPONENT_DEFINE ("MmWaveInterferenceHelper");
 
-    MmWaveEvent::MmWaveEvent (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPower)
-            : m_ppdu (ppdu),
+    void
+    MmWaveBandLayout::AddBand (MmWaveSpectrumBand band)
+    {
+        NS_ASSERT_MSG (m_index.find (band) == m_index.end (), "Band [" << band.first << ";" << band.second << "] has already been added");
+        NS_ASSERT_MSG (m_bands.size () < MMWAVE_MAX_NUM_BANDS, "Too many bands");
+        m_index.insert ({band, m_bands.size ()});
+        m_bands.push_back (band);
+    }
+
+    std::size_t
+    MmWaveBandLayout::GetNBands () const
+    {
+        return m_bands.size ();
+    }
+
+    MmWaveSpectrumBand
+    MmWaveBandLayout::GetBand (std::size_t index) const
+    {
+        NS_ASSERT (index < m_bands.size ());
+        return m_bands[index];
+    }
+
+    std::size_t
+    MmWaveBandLayout::GetIndex (MmWaveSpectrumBand band) const
+    {
+        auto it = m_index.find (band);
+        NS_ASSERT_MSG (it != m_index.end (), "Band [" << band.first << ";" << band.second << "] has not been added");
+        return it->second;
+    }
+
+    MmWaveRxPowers::MmWaveRxPowers (Ptr<const MmWaveBandLayout> layout)
+            : m_layout (layout),
+              m_nBands (static_cast<uint8_t> (layout->GetNBands ()))
+    {
+        std::fill (m_powerW, m_powerW + m_nBands, 0.0);
+    }
+
+    MmWaveRxPowers::MmWaveRxPowers (const MmWaveRxPowers &o)
+            : m_layout (o.m_layout),
+              m_nBands (o.m_nBands)
+    {
+        // only the bands in use are copied
+        std::copy (o.m_powerW, o.m_powerW + m_nBands, m_powerW);
+    }
+
+    MmWaveRxPowers &
+    MmWaveRxPowers::operator= (const MmWaveRxPowers &o)
+    {
+        m_layout = o.m_layout;
+        m_nBands = o.m_nBands;
+        std::copy (o.m_powerW, o.m_powerW + m_nBands, m_powerW);
+        return *this;
+    }
+
+    Ptr<const MmWaveBandLayout>
+    MmWaveRxPowers::GetLayout () const
+    {
+        return m_layout;
+    }
+
+    std::size_t
+    MmWaveRxPowers::GetNBands () const
+    {
+        return m_nBands;
+    }
+
+    double
+    MmWaveRxPowers::Get (std::size_t index) const
+    {
+        NS_ASSERT (index < m_nBands);
+        return m_powerW[index];
+    }
+
+    double
+    MmWaveRxPowers::Get (MmWaveSpectrumBand band) const
+    {
+        return m_powerW[m_layout->GetIndex (band)];
+    }
+
+    void
+    MmWaveRxPowers::Set (std::size_t index, double powerW)
+    {
+        NS_ASSERT (index < m_nBands);
+        m_powerW[index] = powerW;
+    }
+
+    double *
+    MmWaveRxPowers::GetData ()
+    {
+        return m_powerW;
+    }
+
+    double
+    MmWaveRxPowers::GetMax () const
+    {
+        NS_ASSERT (m_nBands > 0);
+        return *std::max_element (m_powerW, m_powerW + m_nBands);
+    }
+
+    /**
+     * Free list of MmWaveEvent blocks
+     */
+    class MmWaveEventPool
+    {
+    public:
+        ~MmWaveEventPool ()
+        {
+            for (void *block : m_blocks)
+            {
+                ::operator delete (block);
+            }
+            m_blocks.clear ();
+            m_destroyed = true;
+        }
+
+        static bool m_destroyed;       //!< events released after the pool is gone go back to the heap
+        std::vector<void *> m_blocks;  //!< blocks ready for reuse
+    };
+
+    bool MmWaveEventPool::m_destroyed = false;
+    static MmWaveEventPool g_mmWaveEventPool; ///< blocks of the released events
+    /// beyond this, released events go back to the heap
+    static const std::size_t MMWAVE_EVENT_POOL_MAX_BLOCKS = 4096;
+
+    void *
+    MmWaveEvent::operator new (std::size_t size)
+    {
+        NS_ASSERT (size == sizeof (MmWaveEvent));
+        if (MmWaveEventPool::m_destroyed || g_mmWaveEventPool.m_blocks.empty ())
+        {
+            return ::operator new (size);
+        }
+        void *block = g_mmWaveEventPool.m_blocks.back ();
+        g_mmWaveEventPool.m_blocks.pop_back ();
+        return block;
+    }
+
+    void
+    MmWaveEvent::operator delete (void *block)
+    {
+        if (MmWaveEventPool::m_destroyed || g_mmWaveEventPool.m_blocks.size () >= MMWAVE_EVENT_POOL_MAX_BLOCKS)
+        {
+            ::operator delete (block);
+            return;
+        }
+        g_mmWaveEventPool.m_blocks.push_back (block);
+    }
+
+    uint64_t MmWaveEvent::m_uidCounter = 0;
+
+    uint64_t
+    MmWaveEvent::AllocateUid ()
+    {
+        return ++m_uidCounter;
+    }
+
+    MmWaveEvent::MmWaveEvent (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, const MmWaveRxPowers &rxPower)
+            : m_uid (AllocateUid ()),
+              m_ppdu (ppdu),
               m_txVector (txVector),
               m_startTime (Simulator::Now ()),
               m_endTime (m_startTime + duration),
@@ -54,23 +209,16 @@ namespace ns3 {
     double
     MmWaveEvent::GetRxPowerW () const
     {
-        NS_ASSERT (m_rxPowerW.size () > 0);
-        auto it = std::max_element (m_rxPowerW.begin (), m_rxPowerW.end (),
-                                    [] (const std::pair<MmWaveSpectrumBand, double>& p1, const std::pair<MmWaveSpectrumBand, double>& p2) {
-                                        return p1.second < p2.second;
-                                    });
-        return it->second;
+        return m_rxPowerW.GetMax ();
     }
 
     double
     MmWaveEvent::GetRxPowerW (MmWaveSpectrumBand band) const
     {
-        auto it = m_rxPowerW.find (band);
-        NS_ASSERT (it != m_rxPowerW.end ());
-        return it->second;
+        return m_rxPowerW.Get (band);
     }
 
-    RxPowerWattPerChannelBand
+    const MmWaveRxPowers &
     MmWaveEvent::GetRxPowerWPerBand () const
     {
         return m_rxPowerW;
@@ -82,6 +230,18 @@ namespace ns3 {
         return m_txVector;
     }
 
+    uint64_t
+    MmWaveEvent::GetUid () const
+    {
+        return m_uid;
+    }
+
+    std::vector<MmWaveNiTimeline> &
+    MmWaveEvent::GetNiTimelines () const
+    {
+        return m_niTimelines;
+    }
+
     std::ostream & operator << (std::ostream &os, const MmWaveEvent &event)
     {
         os << "start=" << event.GetStartTime () << ", end=" << event.GetEndTime ()
@@ -91,10 +251,17 @@ namespace ns3 {
         return os;
     }
 
-    MmWaveInterferenceHelper::NiChange::NiChange (double power, Ptr<MmWaveEvent> event)
-            : m_power (power),
-              m_event (event)
+    MmWaveInterferenceHelper::NiChange::NiChange (Time moment, double power, uint64_t eventUid)
+            : m_time (moment),
+              m_power (power),
+              m_eventUid (eventUid)
+    {
+    }
+
+    Time
+    MmWaveInterferenceHelper::NiChange::GetTime () const
     {
+        return m_time;
     }
 
     double
@@ -109,16 +276,119 @@ namespace ns3 {
         m_power += power;
     }
 
-    Ptr<MmWaveEvent>
-    MmWaveInterferenceHelper::NiChange::GetEvent () const
+    uint64_t
+    MmWaveInterferenceHelper::NiChange::GetEventUid () const
+    {
+        return m_eventUid;
+    }
+
+    MmWaveInterferenceHelper::NiChanges::NiChanges ()
+            : m_firstPower (0.0),
+              m_head (0)
+    {
+        Clear ();
+    }
+
+    void
+    MmWaveInterferenceHelper::NiChanges::Clear ()
+    {
+        m_changes.clear ();
+        m_head = 0;
+        // Always have a zero power noise event in the list
+        m_changes.push_back (NiChange (Time (0), 0.0, 0));
+        m_firstPower = 0.0;
+    }
+
+    std::size_t
+    MmWaveInterferenceHelper::NiChanges::Begin () const
+    {
+        return m_head;
+    }
+
+    std::size_t
+    MmWaveInterferenceHelper::NiChanges::End () const
+    {
+        return m_changes.size ();
+    }
+
+    const MmWaveInterferenceHelper::NiChange &
+    MmWaveInterferenceHelper::NiChanges::At (std::size_t index) const
+    {
+        NS_ASSERT (index >= m_head && index < m_changes.size ());
+        return m_changes[index];
+    }
+
+    std::size_t
+    MmWaveInterferenceHelper::NiChanges::LowerBound (Time moment) const
+    {
+        auto it = std::lower_bound (m_changes.begin () + m_head, m_changes.end (), moment,
+                                    [] (const NiChange &change, Time t) { return change.GetTime () < t; });
+        return it - m_changes.begin ();
+    }
+
+    std::size_t
+    MmWaveInterferenceHelper::NiChanges::UpperBound (Time moment) const
+    {
+        auto it = std::upper_bound (m_changes.begin () + m_head, m_changes.end (), moment,
+                                    [] (Time t, const NiChange &change) { return t < change.GetTime (); });
+        return it - m_changes.begin ();
+    }
+
+    std::size_t
+    MmWaveInterferenceHelper::NiChanges::Insert (NiChange change)
+    {
+        std::size_t index = UpperBound (change.GetTime ());
+        m_changes.insert (m_changes.begin () + index, change);
+        return index;
+    }
+
+    void
+    MmWaveInterferenceHelper::NiChanges::AddPower (std::size_t first, std::size_t last, double power)
+    {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            m_changes[i].AddPower (power);
+        }
+    }
+
+    void
+    MmWaveInterferenceHelper::NiChanges::PruneBefore (std::size_t index)
+    {
+        // drop the changes strictly between the sentinel and index by moving the sentinel up
+        if (index <= m_head + 1)
+        {
+            return;
+        }
+        m_changes[index - 1] = m_changes[m_head];
+        m_head = index - 1;
+        if (m_head >= 32 && 2 * m_head >= m_changes.size ())
+        {
+            m_changes.erase (m_changes.begin (), m_changes.begin () + m_head);
+            m_head = 0;
+        }
+    }
+
+    double
+    MmWaveInterferenceHelper::NiChanges::GetFirstPower () const
     {
-        return m_event;
+        return m_firstPower;
     }
 
+    void
+    MmWaveInterferenceHelper::NiChanges::SetFirstPower (double power)
+    {
+        m_firstPower = power;
+    }
+
+    /// last version given to the NI changes of an interference helper
+    static uint64_t g_mmWaveNiVersion = 0;
+
     MmWaveInterferenceHelper::MmWaveInterferenceHelper ()
             : m_errorRateModel (0),
               m_numRxAntennas (1),
-              m_rxing (false)
+              m_bandLayout (Create<MmWaveBandLayout> ()),
+              m_rxing (false),
+              m_niVersion (++g_mmWaveNiVersion)
     {
     }
 
@@ -129,20 +399,19 @@ namespace ns3 {
     }
 
     Ptr<MmWaveEvent>
-    MmWaveInterferenceHelper::Add (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPowerW)
+    MmWaveInterferenceHelper::Add (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, const MmWaveRxPowers &rxPowerW)
     {
         Ptr<MmWaveEvent> event = Create<MmWaveEvent> (ppdu, txVector, duration, rxPowerW);
-        AppendEvent (event);
+        AppendSignal (event->GetStartTime (), event->GetEndTime (), event->GetUid (), event->GetRxPowerWPerBand ());
         return event;
     }
 
     void
-    MmWaveInterferenceHelper::AddForeignSignal (Time duration, RxPowerWattPerChannelBand rxPowerW)
+    MmWaveInterferenceHelper::AddForeignSignal (Time duration, const MmWaveRxPowers &rxPowerW)
     {
-        MmWaveMacHeader hdr;
-        hdr.SetType (MMWAVE_MAC_DATA);
-        Ptr<MmWavePpdu> fakePpdu = Create<MmWavePpdu> (Create<MmWavePsdu> (Create<Packet> (0), hdr), MmWaveTxVector (), duration, MMWAVE_PHY_BAND_UNSPECIFIED);
-        Add (fakePpdu, MmWaveTxVector (), duration, rxPowerW);
+        // nobody decodes a foreign signal, only its energy is recorded
+        Time now = Simulator::Now ();
+        AppendSignal (now, now + duration, MmWaveEvent::AllocateUid (), rxPowerW);
     }
 
     void
@@ -150,18 +419,24 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this);
         m_niChangesPerBand.clear ();
-        m_firstPowerPerBand.clear ();
+        NotifyNiChangesModified ();
+        // events still refer to the previous layout, so it is replaced rather than cleared
+        m_bandLayout = Create<MmWaveBandLayout> ();
     }
 
     void
     MmWaveInterferenceHelper::AddBand (MmWaveSpectrumBand band)
     {
         NS_LOG_FUNCTION (this << band.first << band.second);
-        NS_ASSERT (m_niChangesPerBand.find (band) == m_niChangesPerBand.end ());
-        NiChanges niChanges;
-        m_niChangesPerBand.insert ({band, niChanges});
-        AddNiChangeEvent (Time (0), NiChange (0.0, 0), band);
-        m_firstPowerPerBand.insert ({band, 0.0});
+        m_bandLayout->AddBand (band);
+        m_niChangesPerBand.push_back (NiChanges ());
+        NotifyNiChangesModified ();
+    }
+
+    Ptr<const MmWaveBandLayout>
+    MmWaveInterferenceHelper::GetBandLayout () const
+    {
+        return m_bandLayout;
     }
 
     void
@@ -192,14 +467,14 @@ namespace ns3 {
     MmWaveInterferenceHelper::GetEnergyDuration (double energyW, MmWaveSpectrumBand band) const
     {
         Time now = Simulator::Now ();
-        auto i = GetPreviousPosition (now, band);
-        Time end = i->first;
-        auto ni_it = m_niChangesPerBand.find (band);
-        NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-        for (; i != ni_it->second.end (); ++i)
+        const NiChanges &niChanges = m_niChangesPerBand[m_bandLayout->GetIndex (band)];
+        // There is always an NiChange at time 0, before now.
+        std::size_t i = niChanges.UpperBound (now) - 1;
+        Time end = niChanges.At (i).GetTime ();
+        for (; i != niChanges.End (); ++i)
         {
-            double noiseInterferenceW = i->second.GetPower ();
-            end = i->first;
+            double noiseInterferenceW = niChanges.At (i).GetPower ();
+            end = niChanges.At (i).GetTime ();
             if (noiseInterferenceW < energyW)
             {
                 break;
@@ -209,30 +484,24 @@ namespace ns3 {
     }
 
     void
-    MmWaveInterferenceHelper::AppendEvent (Ptr<MmWaveEvent> event)
+    MmWaveInterferenceHelper::AppendSignal (Time start, Time end, uint64_t uid, const MmWaveRxPowers &rxPowerW)
     {
-        NS_LOG_FUNCTION (this);
-        RxPowerWattPerChannelBand rxPowerWattPerChannelBand = event->GetRxPowerWPerBand ();
-        for (auto const& it : rxPowerWattPerChannelBand)
+        NS_LOG_FUNCTION (this << start << end << uid);
+        NS_ASSERT_MSG (rxPowerW.GetLayout () == m_bandLayout, "RX powers were measured on other bands");
+        NotifyNiChangesModified ();
+        for (std::size_t k = 0; k < rxPowerW.GetNBands (); ++k)
         {
-            MmWaveSpectrumBand band = it.first;
-            auto ni_it = m_niChangesPerBand.find (band);
-            NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-            double previousPowerStart = 0;
-            double previousPowerEnd = 0;
-            previousPowerStart = GetPreviousPosition (event->GetStartTime (), band)->second.GetPower ();
-            previousPowerEnd = GetPreviousPosition (event->GetEndTime (), band)->second.GetPower ();
+            NiChanges &niChanges = m_niChangesPerBand[k];
+            double previousPowerStart = niChanges.At (niChanges.UpperBound (start) - 1).GetPower ();
+            double previousPowerEnd = niChanges.At (niChanges.UpperBound (end) - 1).GetPower ();
             if (!m_rxing)
             {
-                m_firstPowerPerBand.find (band)->second = previousPowerStart;
-                ni_it->second.erase (++(ni_it->second.begin ()), GetNextPosition (event->GetStartTime (), band));
-            }
-            auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event), band);
-            auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), band);
-            for (auto i = first; i != last; ++i)
-            {
-                i->second.AddPower (it.second);
+                niChanges.SetFirstPower (previousPowerStart);
+                niChanges.PruneBefore (niChanges.UpperBound (start));
             }
+            std::size_t first = niChanges.Insert (NiChange (start, previousPowerStart, uid));
+            std::size_t last = niChanges.Insert (NiChange (end, previousPowerEnd, uid));
+            niChanges.AddPower (first, last, rxPowerW.Get (k));
         }
     }
 
@@ -257,138 +526,194 @@ namespace ns3 {
         return snr;
     }
 
-    double
-    MmWaveInterferenceHelper::CalculateNoiseInterferenceW (Ptr<MmWaveEvent> event, NiChangesPerBand *nis, MmWaveSpectrumBand band) const
+    const MmWaveNiTimeline &
+    MmWaveInterferenceHelper::GetNiTimeline (Ptr<const MmWaveEvent> event, MmWaveSpectrumBand band) const
     {
         NS_LOG_FUNCTION (this << band.first << band.second);
-        auto firstPower_it = m_firstPowerPerBand.find (band);
-        NS_ASSERT (firstPower_it != m_firstPowerPerBand.end ());
-        double noiseInterferenceW = firstPower_it->second;
-        auto ni_it = m_niChangesPerBand.find (band);
-        NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-        auto it = ni_it->second.find (event->GetStartTime ());
-        for (; it != ni_it->second.end () && it->first < Simulator::Now (); ++it)
+        std::size_t bandIndex = m_bandLayout->GetIndex (band);
+        std::vector<MmWaveNiTimeline> &timelines = event->GetNiTimelines ();
+        MmWaveNiTimeline *ni = 0;
+        for (auto &timeline : timelines)
         {
-            noiseInterferenceW = it->second.GetPower () - event->GetRxPowerW (band);
+            if (timeline.bandIndex == bandIndex)
+            {
+                ni = &timeline;
+                break;
+            }
         }
-        it = ni_it->second.find (event->GetStartTime ());
-        NS_ASSERT (it != ni_it->second.end ());
-        for (; it != ni_it->second.end () && it->second.GetEvent () != event; ++it);
-        NiChanges ni;
-        ni.emplace (event->GetStartTime (), NiChange (0, event));
-        while (++it != ni_it->second.end () && it->second.GetEvent () != event)
+        if (ni && ni->version == m_niVersion)
         {
-            ni.insert (*it);
+            return *ni;
         }
-        ni.emplace (event->GetEndTime (), NiChange (0, event));
-        nis->insert ({band, ni});
-        NS_ASSERT_MSG (noiseInterferenceW >= 0, "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
-        return noiseInterferenceW;
+        if (!ni)
+        {
+            timelines.push_back (MmWaveNiTimeline ());
+            ni = &timelines.back ();
+            ni->bandIndex = bandIndex;
+        }
+        ni->version = m_niVersion;
+        ni->segments.clear ();
+
+        const NiChanges &niChanges = m_niChangesPerBand[bandIndex];
+        double eventPowerW = event->GetRxPowerW (band);
+        std::size_t i = niChanges.LowerBound (event->GetStartTime ());
+        NS_ASSERT (i != niChanges.End () && niChanges.At (i).GetTime () == event->GetStartTime ());
+        for (; i != niChanges.End () && niChanges.At (i).GetEventUid () != event->GetUid (); ++i);
+        NS_ASSERT (i != niChanges.End ());
+        std::size_t last = i + 1;
+        while (last != niChanges.End () && niChanges.At (last).GetEventUid () != event->GetUid ())
+        {
+            ++last;
+        }
+        ni->startNiW = niChanges.At (i).GetPower () - eventPowerW;
+        //each change of other signals strictly inside the event opens a segment, the event end closes the last one
+        Time previous = event->GetStartTime ();
+        double noiseInterferenceW = niChanges.GetFirstPower ();
+        for (std::size_t j = i + 1; j <= last; ++j)
+        {
+            Time current = (j != last) ? niChanges.At (j).GetTime () : event->GetEndTime ();
+            NS_ASSERT (current >= previous);
+            ni->segments.push_back ({previous, current, noiseInterferenceW});
+            noiseInterferenceW = ((j != last) ? niChanges.At (j).GetPower () : 0) - eventPowerW;
+            previous = current;
+        }
+        NS_LOG_DEBUG ("NI timeline of event " << event->GetUid () << " has " << ni->segments.size () << " segments");
+        return *ni;
     }
 
     double
-    MmWaveInterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, MmWaveMode mode, MmWaveTxVector txVector) const
+    MmWaveInterferenceHelper::CalculateNoiseInterferenceW (Ptr<const MmWaveEvent> event, const MmWaveNiTimeline &ni) const
     {
-        if (duration.IsZero ())
+        NS_LOG_FUNCTION (this << ni.bandIndex);
+        //the noise plus interference of the last change before now
+        Time now = Simulator::Now ();
+        double noiseInterferenceW = ni.segments.front ().niW;
+        if (now > event->GetEndTime ())
         {
-            return 1.0;
+            const NiChanges &niChanges = m_niChangesPerBand[ni.bandIndex];
+            double eventPowerW = event->GetRxPowerWPerBand ().Get (ni.bandIndex);
+            for (std::size_t i = niChanges.LowerBound (event->GetStartTime ()); i != niChanges.End () && niChanges.At (i).GetTime () < now; ++i)
+            {
+                noiseInterferenceW = niChanges.At (i).GetPower () - eventPowerW;
+            }
         }
-        uint64_t rate = mode.GetDataRate (txVector.GetChannelWidth ());
-        uint64_t nbits = static_cast<uint64_t> (rate * duration.GetSeconds ());
-        double csr = m_errorRateModel->GetChunkSuccessRate (mode, txVector, snir, nbits);
-        return csr;
+        else if (now > event->GetStartTime ())
+        {
+            auto segment = std::lower_bound (ni.segments.begin (), ni.segments.end (), now,
+                                             [] (const MmWaveNiTimeline::Segment &s, Time t) { return s.start < t; });
+            --segment;
+            noiseInterferenceW = (segment == ni.segments.begin ()) ? ni.startNiW : segment->niW;
+        }
+        NS_ASSERT_MSG (noiseInterferenceW >= 0, "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
+        return noiseInterferenceW;
     }
 
     double
-    MmWaveInterferenceHelper::CalculatePayloadChunkSuccessRate (double snir, Time duration, MmWaveTxVector txVector) const
+    MmWaveInterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, MmWaveMode mode, MmWaveTxVector txVector) const
     {
         if (duration.IsZero ())
         {
             return 1.0;
         }
-        MmWaveMode mode = txVector.GetMode ();
-        uint64_t rate = mode.GetDataRate (txVector);
+        uint64_t rate = mode.GetDataRate (txVector.GetChannelWidth ());
         uint64_t nbits = static_cast<uint64_t> (rate * duration.GetSeconds ());
-        nbits /= txVector.GetNss (); //divide effective number of bits by NSS to achieve same chunk error rate as SISO for AWGN
         double csr = m_errorRateModel->GetChunkSuccessRate (mode, txVector, snir, nbits);
         return csr;
     }
 
     double
-    MmWaveInterferenceHelper::CalculatePayloadPer (Ptr<const MmWaveEvent> event, uint16_t channelWidth, NiChangesPerBand *nis, MmWaveSpectrumBand band, std::pair<Time, Time> window) const
+    MmWaveInterferenceHelper::CalculatePayloadPer (Ptr<const MmWaveEvent> event, uint16_t channelWidth, const MmWaveNiTimeline &ni, double powerW, std::pair<Time, Time> window) const
     {
-        NS_LOG_FUNCTION (this << channelWidth << band.first << band.second << window.first << window.second);
+        NS_LOG_FUNCTION (this << channelWidth << ni.bandIndex << window.first << window.second);
         const MmWaveTxVector txVector = event->GetTxVector ();
-        double psr = 1.0; /* Packet Success Rate */
-        auto ni_it = nis->find (band)->second;
-        auto j = ni_it.begin ();
-        Time previous = j->first;
         MmWaveMode payloadMode = txVector.GetMode ();
-        Time phyHeaderStart = j->first + MmWavePhy::GetPhyPreambleDuration (txVector); //PPDU start time + preamble
+        uint64_t rate = payloadMode.GetDataRate (txVector);
+        Time phyHeaderStart = event->GetStartTime () + MmWavePhy::GetPhyPreambleDuration (txVector); //PPDU start time + preamble
         Time phyPayloadStart = phyHeaderStart + MmWavePhy::GetPhyHeaderDuration (txVector); //PPDU start time + preamble + Header field
         Time windowStart = phyPayloadStart + window.first;
         Time windowEnd = phyPayloadStart + window.second;
-        double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
-        double powerW = event->GetRxPowerW (band);
-        while (++j != ni_it.end ())
+        //the segments ending before the window hold no chunk of it
+        auto segment = std::upper_bound (ni.segments.begin (), ni.segments.end (), windowStart,
+                                         [] (Time t, const MmWaveNiTimeline::Segment &s) { return t < s.end; });
+        // the chunks are collected first and handed to the error rate model in one call
+        std::size_t nChunks = 0;
+        std::size_t maxChunks = static_cast<std::size_t> (ni.segments.end () - segment);
+        if (m_chunkSnrs.size () < maxChunks)
+        {
+            m_chunkSnrs.resize (maxChunks);
+            m_chunkBits.resize (maxChunks);
+            m_chunkSuccessRates.resize (maxChunks);
+        }
+        for (; segment != ni.segments.end (); ++segment)
         {
-            Time current = j->first;
+            Time previous = segment->start;
+            Time current = segment->end;
             NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
-            NS_ASSERT (current >= previous);
-            double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, txVector.GetNss ());
+            double snr = CalculateSnr (powerW, segment->niW, channelWidth, txVector.GetNss ());
+            Time duration = Seconds (0);
             //Case 1: Both previous and current point to the windowed payload
             if (previous >= windowStart)
             {
-                psr *= CalculatePayloadChunkSuccessRate (snr, Min (windowEnd, current) - previous, txVector);
-                NS_LOG_DEBUG ("Both previous and current point to the windowed payload: mode=" << payloadMode << ", psr=" << psr);
+                duration = Min (windowEnd, current) - previous;
+                NS_LOG_DEBUG ("Both previous and current point to the windowed payload: mode=" << payloadMode << ", snr=" << snr);
             }
             //Case 2: previous is before windowed payload and current is in the windowed payload
             else if (current >= windowStart)
             {
-                psr *= CalculatePayloadChunkSuccessRate (snr, Min (windowEnd, current) - windowStart, txVector);
-                NS_LOG_DEBUG ("previous is before windowed payload and current is in the windowed payload: mode=" << payloadMode << ", psr=" << psr);
+                duration = Min (windowEnd, current) - windowStart;
+                NS_LOG_DEBUG ("previous is before windowed payload and current is in the windowed payload: mode=" << payloadMode << ", snr=" << snr);
+            }
+            if (duration.IsStrictlyPositive ())
+            {
+                m_chunkSnrs[nChunks] = snr;
+                //divide effective number of bits by NSS to achieve same chunk error rate as SISO for AWGN
+                m_chunkBits[nChunks] = static_cast<uint64_t> (rate * duration.GetSeconds ()) / txVector.GetNss ();
+                nChunks++;
             }
-            noiseInterferenceW = j->second.GetPower () - powerW;
-            previous = j->first;
-            if (previous > windowEnd)
+            if (current > windowEnd)
             {
-                NS_LOG_DEBUG ("Stop: new previous=" << previous << " after time window end=" << windowEnd);
+                NS_LOG_DEBUG ("Stop: new previous=" << current << " after time window end=" << windowEnd);
                 break;
             }
         }
+        double psr = 1.0; /* Packet Success Rate */
+        if (nChunks > 0)
+        {
+            m_errorRateModel->GetChunkSuccessRates (payloadMode, txVector, m_chunkSnrs.data (), m_chunkBits.data (), m_chunkSuccessRates.data (), nChunks);
+            for (std::size_t k = 0; k < nChunks; k++)
+            {
+                psr *= m_chunkSuccessRates[k];
+            }
+        }
+        NS_LOG_DEBUG ("psr=" << psr << " over " << nChunks << " chunks");
         double per = 1 - psr;
         return per;
     }
 
     double
-    MmWaveInterferenceHelper::CalculatePhyHeaderPer (Ptr<const MmWaveEvent> event, NiChangesPerBand *nis, MmWaveSpectrumBand band) const
+    MmWaveInterferenceHelper::CalculatePhyHeaderPer (Ptr<const MmWaveEvent> event, const MmWaveNiTimeline &ni, double powerW) const
     {
-        NS_LOG_FUNCTION (this << band.first << band.second);
+        NS_LOG_FUNCTION (this << ni.bandIndex);
         const MmWaveTxVector txVector = event->GetTxVector ();
         uint16_t channelWidth = txVector.GetChannelWidth ();
         double psr = 1.0; /* Packet Success Rate */
-        auto ni_it = nis->find (band)->second;
-        auto j = ni_it.begin ();
-        Time previous = j->first;
         MmWaveMode mcsHeaderMode = MmWavePhy::GetPhyHeaderMcsMode ();
         MmWaveMode headerMode = MmWavePhy::GetPhyHeaderMode ();
-        Time phyHeaderStart = j->first + MmWavePhy::GetPhyPreambleDuration (txVector); //PPDU start time + short training field (STF) + channel estimation field (CEF)
+        Time phyHeaderStart = event->GetStartTime () + MmWavePhy::GetPhyPreambleDuration (txVector); //PPDU start time + short training field (STF) + channel estimation field (CEF)
         Time phyPayloadStart = phyHeaderStart + MmWavePhy::GetPhyHeaderDuration (txVector); //PPDU start time + short training field (STF) + channel estimation field (CEF) + Header (64bits)
 
-        double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
-        double powerW = event->GetRxPowerW (band);
-        while (++j != ni_it.end ())
+        for (auto segment = ni.segments.begin (); segment != ni.segments.end (); ++segment)
         {
-            Time current = j->first;
+            Time previous = segment->start;
+            Time current = segment->end;
             NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
-            NS_ASSERT (current >= previous);
-            double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, 1);
             if (previous >= phyPayloadStart)
             {
-                psr *= 1;
-                NS_LOG_DEBUG ("Case 1 - previous and current after payload start: nothing to do");
+                NS_LOG_DEBUG ("Case 1 - previous and current after payload start: nothing left to do");
+                break;
             }
-            else if (previous >= phyHeaderStart)
+            double snr = CalculateSnr (powerW, segment->niW, channelWidth, 1);
+            if (previous >= phyHeaderStart)
             {
                 if (current >= phyPayloadStart)
                 {
@@ -397,7 +722,6 @@ namespace ns3 {
                 }
                 else
                 {
-                    psr *= 1;
                     NS_LOG_DEBUG ("Case 2b - current with previous in preamble: nothing to do");
                 }
             }
@@ -416,13 +740,9 @@ namespace ns3 {
                 }
                 else
                 {
-                    psr *= 1;
                     NS_LOG_DEBUG ("Case 3c - current with previous in preamble: nothing to do");
                 }
             }
-
-            noiseInterferenceW = j->second.GetPower () - powerW;
-            previous = j->first;
         }
 
         double per = 1 - psr;
@@ -433,10 +753,11 @@ namespace ns3 {
     MmWaveInterferenceHelper::CalculatePayloadSnrPer (Ptr<MmWaveEvent> event, uint16_t channelWidth, MmWaveSpectrumBand band, std::pair<Time, Time> relativeMpduStartStop) const
     {
         NS_LOG_FUNCTION (this << channelWidth << band.first << band.second << relativeMpduStartStop.first << relativeMpduStartStop.second);
-        NiChangesPerBand ni;
-        double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni, band);
-        double snr = CalculateSnr (event->GetRxPowerW (band), noiseInterferenceW, channelWidth, event->GetTxVector ().GetNss ());
-        double per = CalculatePayloadPer (event, channelWidth, &ni, band, relativeMpduStartStop);
+        const MmWaveNiTimeline &ni = GetNiTimeline (event, band);
+        double powerW = event->GetRxPowerW (band);
+        double noiseInterferenceW = CalculateNoiseInterferenceW (event, ni);
+        double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, event->GetTxVector ().GetNss ());
+        double per = CalculatePayloadPer (event, channelWidth, ni, powerW, relativeMpduStartStop);
 
         struct SnrPer snrPer;
         snrPer.snr = snr;
@@ -447,8 +768,8 @@ namespace ns3 {
     double
     MmWaveInterferenceHelper::CalculateSnr (Ptr<MmWaveEvent> event, uint16_t channelWidth, uint8_t nss, MmWaveSpectrumBand band) const
     {
-        NiChangesPerBand ni;
-        double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni, band);
+        const MmWaveNiTimeline &ni = GetNiTimeline (event, band);
+        double noiseInterferenceW = CalculateNoiseInterferenceW (event, ni);
         double snr = CalculateSnr (event->GetRxPowerW (band), noiseInterferenceW, channelWidth, nss);
         return snr;
     }
@@ -457,11 +778,12 @@ namespace ns3 {
     MmWaveInterferenceHelper::CalculatePhyHeaderSnrPer (Ptr<MmWaveEvent> event, MmWaveSpectrumBand band) const
     {
         NS_LOG_FUNCTION (this << band.first << band.second);
-        NiChangesPerBand ni;
         uint16_t channelWidth = event->GetTxVector ().GetChannelWidth ();
-        double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni, band);
-        double snr = CalculateSnr (event->GetRxPowerW (band), noiseInterferenceW, channelWidth, 1);
-        double per = CalculatePhyHeaderPer (event, &ni, band);
+        const MmWaveNiTimeline &ni = GetNiTimeline (event, band);
+        double powerW = event->GetRxPowerW (band);
+        double noiseInterferenceW = CalculateNoiseInterferenceW (event, ni);
+        double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, 1);
+        double per = CalculatePhyHeaderPer (event, ni, powerW);
 
         struct SnrPer snrPer;
         snrPer.snr = snr;
@@ -472,15 +794,21 @@ namespace ns3 {
     void
     MmWaveInterferenceHelper::EraseEvents ()
     {
-        for (auto it : m_niChangesPerBand)
+        for (auto &niChanges : m_niChangesPerBand)
         {
-            it.second.clear ();
-            AddNiChangeEvent (Time (0), NiChange (0.0, 0), it.first);
-            m_firstPowerPerBand.at (it.first) = 0.0;
+            niChanges.Clear ();
         }
+        NotifyNiChangesModified ();
         m_rxing = false;
     }
 
+    void
+    MmWaveInterferenceHelper::NotifyNiChangesModified ()
+    {
+        // the NI timelines cached on the events are recomputed on their next use
+        m_niVersion = ++g_mmWaveNiVersion;
+    }
+
     double
     MmWaveInterferenceHelper::DbToRatio (double dB)
     {
@@ -505,32 +833,6 @@ namespace ns3 {
         return 10.0 * std::log10 (ratio);
     }
 
-    MmWaveInterferenceHelper::NiChanges::const_iterator
-    MmWaveInterferenceHelper::GetNextPosition (Time moment, MmWaveSpectrumBand band) const
-    {
-        auto it = m_niChangesPerBand.find (band);
-        NS_ASSERT (it != m_niChangesPerBand.end ());
-        return it->second.upper_bound (moment);
-    }
-
-    MmWaveInterferenceHelper::NiChanges::const_iterator
-    MmWaveInterferenceHelper::GetPreviousPosition (Time moment, MmWaveSpectrumBand band) const
-    {
-        auto it = GetNextPosition (moment, band);
-        // This is safe since there is always an NiChange at time 0,
-        // before moment.
-        --it;
-        return it;
-    }
-
-    MmWaveInterferenceHelper::NiChanges::iterator
-    MmWaveInterferenceHelper::AddNiChangeEvent (Time moment, NiChange change, MmWaveSpectrumBand band)
-    {
-        auto it = m_niChangesPerBand.find (band);
-        NS_ASSERT (it != m_niChangesPerBand.end ());
-        return it->second.insert (GetNextPosition (moment, band), std::make_pair (moment, change));
-    }
-
     void
     MmWaveInterferenceHelper::NotifyRxStart ()
     {
@@ -543,14 +845,19 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this);
         m_rxing = false;
-        //Update m_firstPower for frame capture
-        for (auto ni : m_niChangesPerBand)
+        NotifyNiChangesModified ();
+        //Update the first power for frame capture, then drop the changes nobody can look back at anymore
+        for (auto &niChanges : m_niChangesPerBand)
         {
-            if (ni.second.size () > 1)
+            if (niChanges.End () - niChanges.Begin () > 1)
             {
-                auto it = GetPreviousPosition (Simulator::Now (), ni.first);
-                it--;
-                m_firstPowerPerBand.find (ni.first)->second = it->second.GetPower ();
+                std::size_t it = niChanges.UpperBound (Simulator::Now ()) - 1;
+                if (it > niChanges.Begin ())
+                {
+                    it--;
+                    niChanges.SetFirstPower (niChanges.At (it).GetPower ());
+                    niChanges.PruneBefore (it);
+                }
             }
         }
     }
@@ -2,6 +2,7 @@
 #ifndef MMWAVE_INTERFERENCE_HELPER_H
 #define MMWAVE_INTERFERENCE_HELPER_H
 #include <map>
+#include <vector>
 #include "ns3/nstime.h"
 #include "mmwave-spectrum-value-helper.h"
 #include "mmwave-tx-vector.h"
@@ -12,30 +13,113 @@ namespace ns3 {
     class MmWavePsdu;
     class MmWaveErrorRateModel;
 
-    typedef std::map <MmWaveSpectrumBand, double> RxPowerWattPerChannelBand;
+    /// number of 1280/640/.../20 MHz bands of the widest (1280 MHz) channel
+    const uint8_t MMWAVE_MAX_NUM_BANDS = 127;
 
+    /**
+     * Dense index of the bands a PHY measures the received power of. The index of a
+     * band is its position in the RF filter bank of the PHY. A new layout is created
+     * whenever the PHY changes its channel, the layout of a received signal stays valid.
+     */
+    class MmWaveBandLayout : public SimpleRefCount<MmWaveBandLayout>
+    {
+    public:
+        void AddBand (MmWaveSpectrumBand band);
+        std::size_t GetNBands () const;
+        MmWaveSpectrumBand GetBand (std::size_t index) const;
+        std::size_t GetIndex (MmWaveSpectrumBand band) const;
+
+    private:
+        std::vector<MmWaveSpectrumBand> m_bands;              //!< band of each index
+        std::map <MmWaveSpectrumBand, std::size_t> m_index;   //!< index of each band
+    };
+
+    /**
+     * Received power in watts of each band of a MmWaveBandLayout, stored inline so
+     * that receptions and events do not allocate.
+     */
+    class MmWaveRxPowers
+    {
+    public:
+        MmWaveRxPowers (Ptr<const MmWaveBandLayout> layout);
+        MmWaveRxPowers (const MmWaveRxPowers &o);
+        MmWaveRxPowers & operator= (const MmWaveRxPowers &o);
+
+        Ptr<const MmWaveBandLayout> GetLayout () const;
+        std::size_t GetNBands () const;
+        double Get (std::size_t index) const;
+        double Get (MmWaveSpectrumBand band) const;
+        void Set (std::size_t index, double powerW);
+        /// \return the GetNBands () powers, to be filled in place
+        double * GetData ();
+        /// \return the highest power of all bands
+        double GetMax () const;
+
+    private:
+        Ptr<const MmWaveBandLayout> m_layout;    //!< the bands
+        uint8_t m_nBands;                        //!< number of bands in use
+        double m_powerW[MMWAVE_MAX_NUM_BANDS];   //!< received power in watts of each band
+    };
+
+    /**
+     * Noise plus interference seen by an event on one band, as the constant-power
+     * segments between the start and the end of the event. It is computed by the
+     * interference helper and cached on the event until a signal is added to or
+     * removed from the NI changes of the helper.
+     */
+    struct MmWaveNiTimeline
+    {
+        /// noise plus interference over [start, end)
+        struct Segment
+        {
+            Time start;  ///< segment start time
+            Time end;    ///< segment end time
+            double niW;  ///< noise plus interference power in watts
+        };
+
+        uint64_t version;              ///< version of the NI changes the timeline was computed from
+        std::size_t bandIndex;         ///< dense index of the band
+        double startNiW;               ///< power of the event start change in watts, minus the event power
+        std::vector<Segment> segments; ///< time-sorted segments covering the event
+    };
+
+    /**
+     * A signal received by a PHY. The memory of released events is kept in a free
+     * list and reused by the next events, which saves a heap allocation per reception.
+     */
     class MmWaveEvent : public SimpleRefCount<MmWaveEvent>
     {
     public:
 
-        MmWaveEvent (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPower);
+        MmWaveEvent (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, const MmWaveRxPowers &rxPower);
         ~MmWaveEvent ();
 
+        static void * operator new (std::size_t size);
+        static void operator delete (void *block);
+        /// \return a UID that no event uses, for signals recorded without an event
+        static uint64_t AllocateUid ();
+
         Ptr<const MmWavePpdu> GetPpdu () const;
         Time GetStartTime () const;
         Time GetEndTime () const;
         Time GetDuration () const;
         double GetRxPowerW () const;
         double GetRxPowerW (MmWaveSpectrumBand band) const;
-        RxPowerWattPerChannelBand GetRxPowerWPerBand () const;
+        const MmWaveRxPowers & GetRxPowerWPerBand () const;
         MmWaveTxVector GetTxVector () const;
+        uint64_t GetUid () const;
+        /// \return the NI timelines of the bands this event was evaluated on
+        std::vector<MmWaveNiTimeline> & GetNiTimelines () const;
 
     private:
+        static uint64_t m_uidCounter;         //!< last assigned event UID
+        uint64_t m_uid;                       //!< UID identifying the event in the NI change timelines
         Ptr<const MmWavePpdu> m_ppdu;           //!< PPDU
         MmWaveTxVector m_txVector;              //!< TXVECTOR
         Time m_startTime;                     //!< start time
         Time m_endTime;                       //!< end time
-        RxPowerWattPerChannelBand m_rxPowerW; //!< received power in watts per band
+        MmWaveRxPowers m_rxPowerW;            //!< received power in watts per band
+        mutable std::vector<MmWaveNiTimeline> m_niTimelines; //!< cached NI timelines
     };
 
     std::ostream& operator<< (std::ostream& os, const MmWaveEvent &event);
@@ -55,13 +139,14 @@ namespace ns3 {
 
         void AddBand (MmWaveSpectrumBand band);
         void RemoveBands ();
+        Ptr<const MmWaveBandLayout> GetBandLayout () const;
         void SetNoiseFigure (double value);
         void SetErrorRateModel (const Ptr<MmWaveErrorRateModel> rate);
         Ptr<MmWaveErrorRateModel> GetErrorRateModel () const;
         void SetNumberOfReceiveAntennas (uint8_t rx);
         Time GetEnergyDuration (double energyW, MmWaveSpectrumBand band) const;
-        Ptr<MmWaveEvent> Add (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPower);
-        void AddForeignSignal (Time duration, RxPowerWattPerChannelBand rxPower);
+        Ptr<MmWaveEvent> Add (Ptr<const MmWavePpdu> ppdu, MmWaveTxVector txVector, Time duration, const MmWaveRxPowers &rxPower);
+        void AddForeignSignal (Time duration, const MmWaveRxPowers &rxPower);
         struct MmWaveInterferenceHelper::SnrPer CalculatePayloadSnrPer (Ptr<MmWaveEvent> event, uint16_t channelWidth, MmWaveSpectrumBand band, std::pair<Time, Time> relativeMpduStartStop) const;
         double CalculateSnr (Ptr<MmWaveEvent> event, uint16_t channelWidth, uint8_t nss, MmWaveSpectrumBand band) const;
         struct MmWaveInterferenceHelper::SnrPer CalculatePhyHeaderSnrPer (Ptr<MmWaveEvent> event, MmWaveSpectrumBand band) const;
@@ -83,34 +168,68 @@ namespace ns3 {
         class NiChange
         {
         public:
-            NiChange (double power, Ptr<MmWaveEvent> event);
+            NiChange (Time moment, double power, uint64_t eventUid);
+            Time GetTime () const;
             double GetPower () const;
             void AddPower (double power);
-            Ptr<MmWaveEvent> GetEvent () const;
+            uint64_t GetEventUid () const;
 
         private:
-            double m_power; ///< power in watts
-            Ptr<MmWaveEvent> m_event; ///< event
+            Time m_time;        ///< time of the change
+            double m_power;     ///< cumulative power in watts from this change on
+            uint64_t m_eventUid; ///< UID of the event that caused the change (0 for none)
         };
 
-        typedef std::multimap<Time, NiChange> NiChanges;
-        typedef std::map <MmWaveSpectrumBand, NiChanges> NiChangesPerBand;
-        void AppendEvent (Ptr<MmWaveEvent> event);
-        double CalculateNoiseInterferenceW (Ptr<MmWaveEvent> event, NiChangesPerBand *nis, MmWaveSpectrumBand band) const;
-        double CalculatePayloadChunkSuccessRate (double snir, Time duration, MmWaveTxVector txVector) const;
-        double CalculatePayloadPer (Ptr<const MmWaveEvent> event, uint16_t channelWidth, NiChangesPerBand *nis, MmWaveSpectrumBand band, std::pair<Time, Time> window) const;
-        double CalculatePhyHeaderPer (Ptr<const MmWaveEvent> event, NiChangesPerBand *nis, MmWaveSpectrumBand band) const;
+        /**
+         * Time-sorted NI change timeline of a single band, stored contiguously.
+         * Live changes are [m_head, m_changes.size ()); m_changes[m_head] is the
+         * zero-power sentinel. Old changes are dropped by moving the sentinel up to a
+         * watermark, and the dead prefix is compacted away once it dominates the buffer.
+         */
+        class NiChanges
+        {
+        public:
+            NiChanges ();
+            void Clear ();
+            std::size_t Begin () const;
+            std::size_t End () const;
+            const NiChange & At (std::size_t index) const;
+            std::size_t LowerBound (Time moment) const;
+            std::size_t UpperBound (Time moment) const;
+            std::size_t Insert (NiChange change);
+            void AddPower (std::size_t first, std::size_t last, double power);
+            void PruneBefore (std::size_t index);
+            /// \return the power in watts received before the first live change, for frame capture
+            double GetFirstPower () const;
+            void SetFirstPower (double power);
+
+        private:
+            double m_firstPower;             ///< first power in watts
+            std::vector<NiChange> m_changes; ///< time-sorted changes
+            std::size_t m_head;              ///< index of the sentinel (first live change)
+        };
+
+        void AppendSignal (Time start, Time end, uint64_t uid, const MmWaveRxPowers &rxPowerW);
+        /**
+         * \return the NI timeline of the event on the band, computed from the NI changes
+         * only when the cached one is outdated
+         */
+        const MmWaveNiTimeline & GetNiTimeline (Ptr<const MmWaveEvent> event, MmWaveSpectrumBand band) const;
+        double CalculateNoiseInterferenceW (Ptr<const MmWaveEvent> event, const MmWaveNiTimeline &ni) const;
+        double CalculatePayloadPer (Ptr<const MmWaveEvent> event, uint16_t channelWidth, const MmWaveNiTimeline &ni, double powerW, std::pair<Time, Time> window) const;
+        double CalculatePhyHeaderPer (Ptr<const MmWaveEvent> event, const MmWaveNiTimeline &ni, double powerW) const;
+        void NotifyNiChangesModified ();
 
         double m_noiseFigure;                                    //!< noise figure (linear)
         Ptr<MmWaveErrorRateModel> m_errorRateModel;                    //!< error rate model
         uint8_t m_numRxAntennas;                                 //!< the number of RX antennas in the corresponding receiver
-        NiChangesPerBand m_niChangesPerBand;                     //!< NI Changes for each band
-        std::map <MmWaveSpectrumBand, double> m_firstPowerPerBand; //!< first power of each band in watts
+        std::vector<NiChanges> m_niChangesPerBand;               //!< NI Changes for each band, indexed by band index
+        Ptr<MmWaveBandLayout> m_bandLayout;                      //!< dense index of each band
         bool m_rxing;                                            //!< flag whether it is in receiving state
-
-        NiChanges::const_iterator GetNextPosition (Time moment, MmWaveSpectrumBand band) const;
-        NiChanges::const_iterator GetPreviousPosition (Time moment, MmWaveSpectrumBand band) const;
-        NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change, MmWaveSpectrumBand band);
+        uint64_t m_niVersion;                                    //!< version of the NI changes, unique across helpers
+        mutable std::vector<double> m_chunkSnrs;                 //!< SNR of each payload chunk (scratch)
+        mutable std::vector<uint64_t> m_chunkBits;               //!< number of bits of each payload chunk (scratch)
+        mutable std::vector<double> m_chunkSuccessRates;         //!< success rate of each payload chunk (scratch)
     };
 
 } //namespace ns3
@@ -1,7 +1,9 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <algorithm>
+#include <limits>
 #include "ns3/simulator.h"
 #include "ns3/enum.h"
+#include "ns3/boolean.h"
 #include "ns3/queue-size.h"
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
@@ -30,6 +32,13 @@ namespace ns3 {
                                                    TimeValue (MilliSeconds (500)),
                                                    MakeTimeAccessor (&MmWaveMacQueue::SetMaxDelay),
                                                    MakeTimeChecker ())
+                                    .AddAttribute ("Indexed",
+                                                   "If true, keep per-destination and per-channel indexes and a timestamp-ordered "
+                                                   "expiry index so that lookups do not scan the whole queue. Must be set while the queue is empty.",
+                                                   BooleanValue (false),
+                                                   MakeBooleanAccessor (&MmWaveMacQueue::SetIndexed,
+                                                                        &MmWaveMacQueue::IsIndexed),
+                                                   MakeBooleanChecker ())
                                     .AddAttribute ("DropPolicy", "Upon enqueue with full queue, drop oldest (DropOldest) or newest (DropNewest) packet",
                                                    EnumValue (DROP_NEWEST),
                                                    MakeEnumAccessor (&MmWaveMacQueue::m_dropPolicy),
@@ -43,7 +52,8 @@ namespace ns3 {
     }
 
     MmWaveMacQueue::MmWaveMacQueue ()
-            : m_expiredPacketsPresent (false),
+            : m_indexed (false),
+              m_expiredPacketsPresent (false),
               NS_LOG_TEMPLATE_DEFINE ("MmWaveMacQueue")
     {
     }
@@ -71,6 +81,217 @@ namespace ns3 {
         return m_maxDelay;
     }
 
+    void
+    MmWaveMacQueue::SetIndexed (bool indexed)
+    {
+        NS_LOG_FUNCTION (this << indexed);
+        NS_ABORT_MSG_IF (!QueueBase::IsEmpty (), "Cannot change the indexing mode of a non-empty queue");
+        m_indexed = indexed;
+    }
+
+    bool
+    MmWaveMacQueue::IsIndexed () const
+    {
+        return m_indexed;
+    }
+
+    bool
+    MmWaveMacQueue::IsExpired (ConstIterator it) const
+    {
+        return Simulator::Now () > (*it)->GetTimeStamp () + m_maxDelay;
+    }
+
+    int64_t
+    MmWaveMacQueue::GetKey (ConstIterator it) const
+    {
+        NS_ASSERT (m_indexed);
+        if (it == end ())
+        {
+            return std::numeric_limits<int64_t>::max ();
+        }
+        return m_entries.at (PeekPointer (*it)).key;
+    }
+
+    MmWaveMacQueue::ConstIterator
+    MmWaveMacQueue::GetFirstLive (IndexedItems::const_iterator first, IndexedItems::const_iterator last) const
+    {
+        for (auto item = first; item != last; item++)
+        {
+            if (!IsExpired (item->second))
+            {
+                return item->second;
+            }
+        }
+        return end ();
+    }
+
+    bool
+    MmWaveMacQueue::HasExpiredBefore (ConstIterator pos) const
+    {
+        // items expire in timestamp order, so only the head of the deadline index needs to be checked
+        int64_t stop = GetKey (pos);
+        for (auto dit = m_deadlines.begin (); dit != m_deadlines.end () && Simulator::Now () > dit->first + m_maxDelay; dit++)
+        {
+            if (dit->second < stop)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void
+    MmWaveMacQueue::RemoveExpiredBefore (ConstIterator pos)
+    {
+        NS_LOG_FUNCTION (this);
+        int64_t stop = GetKey (pos);
+        std::vector<int64_t> keys;
+        for (auto dit = m_deadlines.begin (); dit != m_deadlines.end () && Simulator::Now () > dit->first + m_maxDelay; dit++)
+        {
+            if (dit->second < stop)
+            {
+                keys.push_back (dit->second);
+            }
+        }
+        // drop the items in queue order, as a scan from the head of the queue does
+        std::sort (keys.begin (), keys.end ());
+        for (int64_t key : keys)
+        {
+            ConstIterator it = m_order.at (key);
+            NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" << Simulator::Now () - (*it)->GetTimeStamp () << ")");
+            m_traceExpired (*it);
+            DoRemove (it);
+        }
+    }
+
+    bool
+    MmWaveMacQueue::DoEnqueue (ConstIterator pos, Ptr<MmWaveMacQueueItem> item)
+    {
+        if (!Queue<MmWaveMacQueueItem>::DoEnqueue (pos, item))
+        {
+            return false;
+        }
+        if (m_indexed)
+        {
+            // space position keys out so that pushing at either end never needs renumbering
+            static const int64_t step = 1 << 20;
+            ConstIterator it = std::prev (pos);
+            bool hasPrev = (it != begin ());
+            bool hasNext = (pos != end ());
+            if (!hasPrev && !hasNext)
+            {
+                AddToIndex (it, 0);
+            }
+            else if (!hasNext)
+            {
+                AddToIndex (it, m_entries.at (PeekPointer (*std::prev (it))).key + step);
+            }
+            else if (!hasPrev)
+            {
+                AddToIndex (it, m_entries.at (PeekPointer (*pos)).key - step);
+            }
+            else
+            {
+                int64_t prevKey = m_entries.at (PeekPointer (*std::prev (it))).key;
+                int64_t nextKey = m_entries.at (PeekPointer (*pos)).key;
+                if (nextKey - prevKey > 1)
+                {
+                    AddToIndex (it, prevKey + (nextKey - prevKey) / 2);
+                }
+                else
+                {
+                    RebuildIndex ();
+                }
+            }
+        }
+        return true;
+    }
+
+    Ptr<MmWaveMacQueueItem>
+    MmWaveMacQueue::DoDequeue (ConstIterator pos)
+    {
+        if (m_indexed)
+        {
+            RemoveFromIndex (pos);
+        }
+        return Queue<MmWaveMacQueueItem>::DoDequeue (pos);
+    }
+
+    Ptr<MmWaveMacQueueItem>
+    MmWaveMacQueue::DoRemove (ConstIterator pos)
+    {
+        if (m_indexed)
+        {
+            RemoveFromIndex (pos);
+        }
+        return Queue<MmWaveMacQueueItem>::DoRemove (pos);
+    }
+
+    void
+    MmWaveMacQueue::AddToIndex (ConstIterator it, int64_t key)
+    {
+        const Ptr<MmWaveMacQueueItem> &item = *it;
+        IndexEntry entry;
+        entry.key = key;
+        entry.address = item->GetDestinationAddress ();
+        entry.channel = item->GetChannel ();
+        entry.timeStamp = item->GetTimeStamp ();
+        entry.isData = item->GetHeader ().IsData ();
+        NS_ASSERT (m_entries.find (PeekPointer (item)) == m_entries.end ());
+        m_entries.insert ({PeekPointer (item), entry});
+        m_order.insert ({key, it});
+        m_deadlines.insert ({entry.timeStamp, key});
+        SubQueue &byAddress = m_byAddress[entry.address];
+        byAddress.items.insert ({key, it});
+        byAddress.nDataPackets += entry.isData ? 1 : 0;
+        SubQueue &byChannel = m_byChannel[entry.channel];
+        byChannel.items.insert ({key, it});
+        byChannel.nDataPackets += entry.isData ? 1 : 0;
+    }
+
+    void
+    MmWaveMacQueue::RemoveFromIndex (ConstIterator it)
+    {
+        const Ptr<MmWaveMacQueueItem> &item = *it;
+        auto eit = m_entries.find (PeekPointer (item));
+        NS_ASSERT (eit != m_entries.end ());
+        const IndexEntry &entry = eit->second;
+        m_order.erase (entry.key);
+        m_deadlines.erase ({entry.timeStamp, entry.key});
+        auto ait = m_byAddress.find (entry.address);
+        ait->second.items.erase (entry.key);
+        ait->second.nDataPackets -= entry.isData ? 1 : 0;
+        if (ait->second.items.empty ())
+        {
+            m_byAddress.erase (ait);
+        }
+        auto cit = m_byChannel.find (entry.channel);
+        cit->second.items.erase (entry.key);
+        cit->second.nDataPackets -= entry.isData ? 1 : 0;
+        if (cit->second.items.empty ())
+        {
+            m_byChannel.erase (cit);
+        }
+        m_entries.erase (eit);
+    }
+
+    void
+    MmWaveMacQueue::RebuildIndex ()
+    {
+        NS_LOG_FUNCTION (this);
+        m_order.clear ();
+        m_entries.clear ();
+        m_byAddress.clear ();
+        m_byChannel.clear ();
+        m_deadlines.clear ();
+        int64_t key = 0;
+        for (ConstIterator it = begin (); it != end (); it++)
+        {
+            AddToIndex (it, key);
+            key += 1 << 20;
+        }
+    }
+
     bool
     MmWaveMacQueue::TtlExceeded (ConstIterator &it)
     {
@@ -116,19 +337,37 @@ namespace ns3 {
             return DoEnqueue (pos, item);
         }
 
-        // the queue is full; scan the list in the attempt to remove stale packets
-        ConstIterator it = begin ();
-        while (it != end ())
+        // the queue is full; remove the first stale packet, if any
+        if (m_indexed)
         {
-            if (it == pos && TtlExceeded (it))
+            int64_t first = std::numeric_limits<int64_t>::max ();
+            for (auto dit = m_deadlines.begin (); dit != m_deadlines.end () && Simulator::Now () > dit->first + m_maxDelay; dit++)
             {
-                return DoEnqueue (it, item);
+                first = std::min (first, dit->second);
             }
-            if (TtlExceeded (it))
+            if (first != std::numeric_limits<int64_t>::max ())
             {
-                return DoEnqueue (pos, item);
+                ConstIterator it = m_order.at (first);
+                bool atPos = (it == pos);
+                TtlExceeded (it);
+                return DoEnqueue (atPos ? it : pos, item);
+            }
+        }
+        else
+        {
+            ConstIterator it = begin ();
+            while (it != end ())
+            {
+                if (it == pos && TtlExceeded (it))
+                {
+                    return DoEnqueue (it, item);
+                }
+                if (TtlExceeded (it))
+                {
+                    return DoEnqueue (pos, item);
+                }
+                it++;
             }
-            it++;
         }
 
         // the queue is still full, remove the oldest item if the policy is drop oldest
@@ -236,6 +475,18 @@ namespace ns3 {
             return DoDequeue (pos);
         }
 
+        if (m_indexed)
+        {
+            RemoveExpiredBefore (pos);
+            m_expiredPacketsPresent = false;
+            if (TtlExceeded (pos))
+            {
+                NS_LOG_DEBUG ("Packet lifetime expired");
+                return 0;
+            }
+            return DoDequeue (pos);
+        }
+
         // remove stale items queued before the given position
         ConstIterator it = begin ();
         while (it != end ())
@@ -283,6 +534,25 @@ namespace ns3 {
     MmWaveMacQueue::PeekByAddress (Mac48Address dest) const
     {
         NS_LOG_FUNCTION (this << dest);
+        if (m_indexed)
+        {
+            ConstIterator found = end ();
+            auto ait = m_byAddress.find (dest);
+            if (ait != m_byAddress.end () && ait->second.nDataPackets > 0)
+            {
+                for (const auto &item : ait->second.items)
+                {
+                    if (!IsExpired (item.second) && (*item.second)->GetHeader ().IsData ())
+                    {
+                        found = item.second;
+                        break;
+                    }
+                }
+            }
+            // signal the presence of expired packets ahead of the item found
+            m_expiredPacketsPresent |= HasExpiredBefore (found);
+            return found;
+        }
         ConstIterator it = begin ();
         while (it != end ())
         {
@@ -310,6 +580,25 @@ namespace ns3 {
     MmWaveMacQueue::PeekByChannel (MmWaveChannelNumberStandardPair channel) const
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            ConstIterator found = end ();
+            auto cit = m_byChannel.find (channel);
+            if (cit != m_byChannel.end () && cit->second.nDataPackets > 0)
+            {
+                for (const auto &item : cit->second.items)
+                {
+                    if (!IsExpired (item.second) && (*item.second)->GetHeader ().IsData ())
+                    {
+                        found = item.second;
+                        break;
+                    }
+                }
+            }
+            // signal the presence of expired packets ahead of the item found
+            m_expiredPacketsPresent |= HasExpiredBefore (found);
+            return found;
+        }
         ConstIterator it = begin ();
         while (it != end ())
         {
@@ -337,6 +626,31 @@ namespace ns3 {
     MmWaveMacQueue::PeekByAddressAndChannel (Mac48Address dest, MmWaveChannelNumberStandardPair channel) const
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            // walk the smaller of the two sub-queues
+            ConstIterator found = end ();
+            auto ait = m_byAddress.find (dest);
+            auto cit = m_byChannel.find (channel);
+            if (ait != m_byAddress.end () && cit != m_byChannel.end ())
+            {
+                const IndexedItems &items = (ait->second.items.size () <= cit->second.items.size ()) ? ait->second.items : cit->second.items;
+                for (const auto &item : items)
+                {
+                    if (!IsExpired (item.second)
+                        && (*item.second)->GetHeader ().IsData ()
+                        && ((*item.second)->GetChannel () == channel)
+                        && ((*item.second)->GetDestinationAddress () == dest))
+                    {
+                        found = item.second;
+                        break;
+                    }
+                }
+            }
+            // signal the presence of expired packets ahead of the item found
+            m_expiredPacketsPresent |= HasExpiredBefore (found);
+            return found;
+        }
         ConstIterator it = begin ();
         while (it != end ())
         {
@@ -460,6 +774,15 @@ namespace ns3 {
             return pos;
         }
 
+        if (m_indexed)
+        {
+            RemoveExpiredBefore (pos);
+            m_expiredPacketsPresent = false;
+            ConstIterator curr = pos++;
+            DoRemove (curr);
+            return pos;
+        }
+
         // remove stale items queued before the given position
         ConstIterator it = begin ();
         while (it != end ())
@@ -487,6 +810,13 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this << dest);
 
+        if (m_indexed)
+        {
+            RemoveExpiredBefore (end ());
+            auto ait = m_byAddress.find (dest);
+            return (ait == m_byAddress.end ()) ? 0 : ait->second.nDataPackets;
+        }
+
         uint32_t nPackets = 0;
 
         for (ConstIterator it = begin (); it != end (); )
@@ -525,6 +855,11 @@ namespace ns3 {
     MmWaveMacQueue::GetNPackets ()
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            RemoveExpiredBefore (end ());
+            return QueueBase::GetNPackets ();
+        }
         // remove packets that stayed in the queue for too long
         for (ConstIterator it = begin (); it != end (); )
         {
@@ -540,6 +875,11 @@ namespace ns3 {
     MmWaveMacQueue::GetNBytes ()
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            RemoveExpiredBefore (end ());
+            return QueueBase::GetNBytes ();
+        }
         // remove packets that stayed in the queue for too long
         for (ConstIterator it = begin (); it != end (); )
         {
@@ -555,6 +895,13 @@ namespace ns3 {
     MmWaveMacQueue::FindByAddress (Mac48Address to)
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            auto ait = m_byAddress.find (to);
+            ConstIterator found = (ait == m_byAddress.end ()) ? end () : GetFirstLive (ait->second.items.begin (), ait->second.items.end ());
+            RemoveExpiredBefore (found);
+            return found != end ();
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -575,6 +922,13 @@ namespace ns3 {
     MmWaveMacQueue::FindByChannel (MmWaveChannelNumberStandardPair channel)
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            auto cit = m_byChannel.find (channel);
+            ConstIterator found = (cit == m_byChannel.end ()) ? end () : GetFirstLive (cit->second.items.begin (), cit->second.items.end ());
+            RemoveExpiredBefore (found);
+            return found != end ();
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -595,6 +949,29 @@ namespace ns3 {
     MmWaveMacQueue::FindByAddressAndChannel (Mac48Address to, MmWaveChannelNumberStandardPair channel)
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            // walk the smaller of the two sub-queues
+            ConstIterator found = end ();
+            auto ait = m_byAddress.find (to);
+            auto cit = m_byChannel.find (channel);
+            if (ait != m_byAddress.end () && cit != m_byChannel.end ())
+            {
+                const IndexedItems &items = (ait->second.items.size () <= cit->second.items.size ()) ? ait->second.items : cit->second.items;
+                for (const auto &item : items)
+                {
+                    if (!IsExpired (item.second)
+                        && (*item.second)->GetChannel () == channel
+                        && (*item.second)->GetHeader ().GetAddr1 () == to)
+                    {
+                        found = item.second;
+                        break;
+                    }
+                }
+            }
+            RemoveExpiredBefore (found);
+            return found != end ();
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -616,6 +993,40 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this);
         std::vector<Mac48Address> list;
+        if (m_indexed)
+        {
+            // destinations ordered by the position of their first live item
+            std::map<int64_t, Mac48Address> firsts;
+            for (const auto &sub : m_byAddress)
+            {
+                ConstIterator first = GetFirstLive (sub.second.items.begin (), sub.second.items.end ());
+                if (first != end ())
+                {
+                    firsts.insert ({GetKey (first), sub.first});
+                }
+            }
+            // the scan of the queue stops at the first live item it does not need
+            ConstIterator stop = (num <= 0) ? GetFirstLive (m_order.begin (), m_order.end ()) : end ();
+            for (auto first = firsts.begin (); first != firsts.end () && list.size () < static_cast<uint32_t>(num); first++)
+            {
+                if (first->second == Mac48Address::GetBroadcast ())
+                {
+                    if (list.size () == 0)
+                    {
+                        list.push_back (first->second);
+                    }
+                    stop = m_order.at (first->first);
+                    break;
+                }
+                list.push_back (first->second);
+                if (list.size () >= static_cast<uint32_t>(num))
+                {
+                    stop = GetFirstLive (m_order.upper_bound (first->first), m_order.end ());
+                }
+            }
+            RemoveExpiredBefore (stop);
+            return list;
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -656,6 +1067,13 @@ namespace ns3 {
     MmWaveMacQueue::PeekItemByAddress (Mac48Address addr)
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            auto ait = m_byAddress.find (addr);
+            ConstIterator found = (ait == m_byAddress.end ()) ? end () : GetFirstLive (ait->second.items.begin (), ait->second.items.end ());
+            RemoveExpiredBefore (found);
+            return (found == end ()) ? 0 : DoPeek (found);
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -676,6 +1094,13 @@ namespace ns3 {
     MmWaveMacQueue::PeekItemByChannel (MmWaveChannelNumberStandardPair channel)
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            auto cit = m_byChannel.find (channel);
+            ConstIterator found = (cit == m_byChannel.end ()) ? end () : GetFirstLive (cit->second.items.begin (), cit->second.items.end ());
+            RemoveExpiredBefore (found);
+            return (found == end ()) ? 0 : DoPeek (found);
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -698,6 +1123,26 @@ namespace ns3 {
         NS_LOG_FUNCTION (this);
         uint32_t count = 0;
         std::vector<Ptr<const MmWaveMacQueueItem>> list;
+        if (m_indexed)
+        {
+            // the scan of the queue stops right after the last item returned
+            ConstIterator stop = (max == 0) ? begin () : end ();
+            auto cit = m_byChannel.find (channel);
+            if (cit != m_byChannel.end ())
+            {
+                for (auto it = cit->second.items.begin (); it != cit->second.items.end () && count < max; it++)
+                {
+                    if (!IsExpired (it->second))
+                    {
+                        list.push_back (DoPeek (it->second));
+                        count++;
+                        stop = (count < max) ? end () : it->second;
+                    }
+                }
+            }
+            RemoveExpiredBefore (stop);
+            return list;
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (count >= max)
@@ -722,6 +1167,24 @@ namespace ns3 {
     MmWaveMacQueue::GetNeedToAccessExcludedChannel (MmWaveChannelNumberStandardPair c)
     {
         NS_LOG_FUNCTION (this);
+        if (m_indexed)
+        {
+            // the other channel whose first live item is the closest to the head of the queue
+            ConstIterator found = end ();
+            for (const auto &sub : m_byChannel)
+            {
+                if (sub.first != c)
+                {
+                    ConstIterator first = GetFirstLive (sub.second.items.begin (), sub.second.items.end ());
+                    if (GetKey (first) < GetKey (found))
+                    {
+                        found = first;
+                    }
+                }
+            }
+            RemoveExpiredBefore (found);
+            return (found == end ()) ? c : (*found)->GetChannel ();
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             if (!TtlExceeded (it))
@@ -743,6 +1206,27 @@ namespace ns3 {
         std::map<Mac48Address, std::vector<std::pair<MmWaveMacHeader, uint32_t>>> items;
         Mac48Address to;
         uint32_t index = 0;
+        if (m_indexed)
+        {
+            // the scan of the queue stops at the last item returned
+            ConstIterator stop = end ();
+            auto cit = m_byChannel.find (channel);
+            if (cit != m_byChannel.end ())
+            {
+                for (auto it = cit->second.items.begin (); it != cit->second.items.end () && index < num; it++)
+                {
+                    if (!IsExpired (it->second))
+                    {
+                        const Ptr<MmWaveMacQueueItem> &item = *it->second;
+                        items[item->GetHeader ().GetAddr1 ()].push_back (std::make_pair (item->GetHeader (), item->GetPacket ()->GetSize ()));
+                        index++;
+                        stop = (index < num) ? end () : it->second;
+                    }
+                }
+            }
+            RemoveExpiredBefore (stop);
+            return items;
+        }
         for (ConstIterator it = begin (); it != end (); )
         {
             NS_ASSERT (index < num);
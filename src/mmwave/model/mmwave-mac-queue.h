@@ -3,6 +3,9 @@
 #define MMWAVE_MAC_QUEUUE_H
 #include <vector>
 #include <utility>
+#include <map>
+#include <set>
+#include <unordered_map>
 #include "ns3/queue.h"
 #include "mmwave.h"
 #include "mmwave-mac-queue-item.h"
@@ -28,6 +31,8 @@ namespace ns3 {
         
         void SetMaxDelay (Time delay);
         Time GetMaxDelay () const;
+        void SetIndexed (bool indexed);
+        bool IsIndexed () const;
         bool PushFront (Ptr<MmWaveMacQueueItem> item);
         bool IsEmpty ();
         bool Insert (ConstIterator pos, Ptr<MmWaveMacQueueItem> item);
@@ -63,7 +68,45 @@ namespace ns3 {
         static const ConstIterator EMPTY;         //!< Invalid iterator to signal an empty queue
 
     private:
+        /// Items of a sub-queue in queue order, keyed by their position key
+        typedef std::map<int64_t, ConstIterator> IndexedItems;
+
+        /// Per-destination or per-channel view of the queue
+        struct SubQueue
+        {
+            IndexedItems items;    //!< items of the sub-queue in queue order
+            uint32_t nDataPackets; //!< data frames queued in the sub-queue
+        };
+
+        /// Where an item has been recorded in the indexes
+        struct IndexEntry
+        {
+            int64_t key;                             //!< position key (increasing from head to tail)
+            Mac48Address address;                    //!< destination address the item is indexed under
+            MmWaveChannelNumberStandardPair channel; //!< channel the item is indexed under
+            Time timeStamp;                          //!< enqueue time the deadline is indexed under
+            bool isData;                             //!< whether the item is accounted as a data packet
+        };
+
         bool TtlExceeded (ConstIterator &it);
+        bool IsExpired (ConstIterator it) const;
+        int64_t GetKey (ConstIterator it) const;
+        ConstIterator GetFirstLive (IndexedItems::const_iterator first, IndexedItems::const_iterator last) const;
+        bool HasExpiredBefore (ConstIterator pos) const;
+        void RemoveExpiredBefore (ConstIterator pos);
+        bool DoEnqueue (ConstIterator pos, Ptr<MmWaveMacQueueItem> item);
+        Ptr<MmWaveMacQueueItem> DoDequeue (ConstIterator pos);
+        Ptr<MmWaveMacQueueItem> DoRemove (ConstIterator pos);
+        void AddToIndex (ConstIterator it, int64_t key);
+        void RemoveFromIndex (ConstIterator it);
+        void RebuildIndex ();
+
+        bool m_indexed;                           //!< True if lookups use the per-destination/per-channel indexes
+        IndexedItems m_order;                     //!< all items in queue order
+        std::unordered_map<const MmWaveMacQueueItem *, IndexEntry> m_entries; //!< index entry of each queued item
+        std::map<Mac48Address, SubQueue> m_byAddress;                        //!< per-destination sub-queues
+        std::map<MmWaveChannelNumberStandardPair, SubQueue> m_byChannel;     //!< per-channel sub-queues
+        std::set<std::pair<Time, int64_t> > m_deadlines;                     //!< (timestamp, key) of the queued items, oldest first
         Time m_maxDelay;                          //!< Time to live for packets in the queue
         DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
         mutable bool m_expiredPacketsPresent;     //!< True if expired packets are in the queue
@@ -1,8 +1,10 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <cmath>
 #include <bitset>
+#include <map>
 #include "ns3/log.h"
 #include "ns3/object.h"
+#include "ns3/boolean.h"
 #include "mmwave-nist-error-rate-model.h"
 #include "mmwave-tx-vector.h"
 
@@ -11,6 +13,12 @@ namespace ns3 {
     NS_LOG_COMPONENT_DEFINE ("MmWaveNistErrorRateModel");
     NS_OBJECT_ENSURE_REGISTERED (MmWaveNistErrorRateModel);
 
+    static const double g_mmWaveNistTableMinSnrDb = -10.0; ///< SNR (dB) of the first table entry
+    static const double g_mmWaveNistTableMaxSnrDb = 60.0;  ///< SNR (dB) of the last table entry
+    static const double g_mmWaveNistTableStepDb = 0.01;    ///< SNR (dB) between two table entries
+    /// log of the bit success rate on the SNR grid, per (constellation size, b value), shared by all models
+    static std::map<std::pair<uint16_t, uint8_t>, std::vector<double> > g_mmWaveNistLogBitSuccessRateTables;
+
     TypeId
     MmWaveNistErrorRateModel::GetTypeId (void)
     {
@@ -18,12 +26,32 @@ namespace ns3 {
                 .SetParent<MmWaveErrorRateModel> ()
                 .SetGroupName ("MmWave")
                 .AddConstructor<MmWaveNistErrorRateModel> ()
+                .AddAttribute ("UseTable",
+                               "If true, interpolate the chunk success rate from precomputed SNR tables "
+                               "instead of evaluating the analytic model for every chunk.",
+                               BooleanValue (false),
+                               MakeBooleanAccessor (&MmWaveNistErrorRateModel::SetUseTable,
+                                                    &MmWaveNistErrorRateModel::GetUseTable),
+                               MakeBooleanChecker ())
         ;
         return tid;
     }
 
     MmWaveNistErrorRateModel::MmWaveNistErrorRateModel ()
+            : m_useTable (false)
+    {
+    }
+
+    void
+    MmWaveNistErrorRateModel::SetUseTable (bool useTable)
+    {
+        m_useTable = useTable;
+    }
+
+    bool
+    MmWaveNistErrorRateModel::GetUseTable () const
     {
+        return m_useTable;
     }
 
     double
@@ -192,24 +220,104 @@ namespace ns3 {
     }
 
     double
-    MmWaveNistErrorRateModel::DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const
+    MmWaveNistErrorRateModel::GetLogBitSuccessRate (uint16_t constellationSize, double snr, uint8_t bValue) const
     {
-        NS_LOG_FUNCTION (this << mode << snr << nbits);
-        if (mode.GetModulationClass () == MMWAVE_MOD_CLASS_OFDM)
+        double ber;
+        if (constellationSize == 2)
         {
-            if (mode.GetConstellationSize () == 2)
+            ber = GetBpskBer (snr);
+        }
+        else if (constellationSize == 4)
+        {
+            ber = GetQpskBer (snr);
+        }
+        else
+        {
+            ber = GetQamBer (constellationSize, snr);
+        }
+        if (ber == 0.0)
+        {
+            return 0.0;
+        }
+        double pe = CalculatePe (ber, bValue);
+        pe = std::min (pe, 1.0);
+        return std::log1p (-pe); // -inf if every bit is lost
+    }
+
+    const std::vector<double> &
+    MmWaveNistErrorRateModel::GetLogBitSuccessRateTable (uint16_t constellationSize, uint8_t bValue) const
+    {
+        std::pair<uint16_t, uint8_t> key = std::make_pair (constellationSize, bValue);
+        auto it = g_mmWaveNistLogBitSuccessRateTables.find (key);
+        if (it == g_mmWaveNistLogBitSuccessRateTables.end ())
+        {
+            std::size_t size = static_cast<std::size_t> (std::lrint ((g_mmWaveNistTableMaxSnrDb - g_mmWaveNistTableMinSnrDb) / g_mmWaveNistTableStepDb)) + 1;
+            std::vector<double> table (size);
+            for (std::size_t i = 0; i < size; i++)
             {
-                return GetFecBpskBer (snr, nbits, GetBValue (mode.GetCodeRate ()));
+                double snrDb = g_mmWaveNistTableMinSnrDb + i * g_mmWaveNistTableStepDb;
+                table[i] = GetLogBitSuccessRate (constellationSize, std::pow (10.0, snrDb / 10.0), bValue);
             }
-            else if (mode.GetConstellationSize () == 4)
+            NS_LOG_DEBUG ("Built success rate table for constellation size " << constellationSize << " and b value " << +bValue);
+            it = g_mmWaveNistLogBitSuccessRateTables.insert (std::make_pair (key, table)).first;
+        }
+        return it->second;
+    }
+
+    double
+    MmWaveNistErrorRateModel::GetAnalyticChunkSuccessRate (MmWaveMode mode, double snr, uint64_t nbits) const
+    {
+        if (mode.GetConstellationSize () == 2)
+        {
+            return GetFecBpskBer (snr, nbits, GetBValue (mode.GetCodeRate ()));
+        }
+        else if (mode.GetConstellationSize () == 4)
+        {
+            return GetFecQpskBer (snr, nbits, GetBValue (mode.GetCodeRate ()));
+        }
+        else
+        {
+            return GetFecQamBer (mode.GetConstellationSize (), snr, nbits, GetBValue (mode.GetCodeRate ()));
+        }
+    }
+
+    double
+    MmWaveNistErrorRateModel::GetTableChunkSuccessRate (MmWaveMode mode, double snr, uint64_t nbits) const
+    {
+        uint8_t bValue = GetBValue (mode.GetCodeRate ());
+        const std::vector<double> &table = GetLogBitSuccessRateTable (mode.GetConstellationSize (), bValue);
+        double x = snr > 0 ? (10.0 * std::log10 (snr) - g_mmWaveNistTableMinSnrDb) / g_mmWaveNistTableStepDb : -1;
+        if (x >= 0 && x < table.size () - 1)
+        {
+            std::size_t i = static_cast<std::size_t> (x);
+            double low = table[i];
+            double high = table[i + 1];
+            if (!std::isinf (low) && !std::isinf (high))
             {
-                return GetFecQpskBer (snr, nbits, GetBValue (mode.GetCodeRate ()));
+                // the log of the bit success rate is interpolated linearly in dB
+                return std::exp (nbits * (low + (x - i) * (high - low)));
             }
-            else
+            if (std::isinf (low) && std::isinf (high))
             {
-                return GetFecQamBer (mode.GetConstellationSize (), snr, nbits, GetBValue (mode.GetCodeRate ()));
+                return (nbits == 0) ? 1.0 : 0.0;
             }
         }
+        // outside of the table, or across the edge of the region where every bit is lost
+        return GetAnalyticChunkSuccessRate (mode, snr, nbits);
+    }
+
+    double
+    MmWaveNistErrorRateModel::DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const
+    {
+        NS_LOG_FUNCTION (this << mode << snr << nbits);
+        if (m_useTable && mode.GetModulationClass () == MMWAVE_MOD_CLASS_OFDM)
+        {
+            return GetTableChunkSuccessRate (mode, snr, nbits);
+        }
+        if (mode.GetModulationClass () == MMWAVE_MOD_CLASS_OFDM)
+        {
+            return GetAnalyticChunkSuccessRate (mode, snr, nbits);
+        }
         return 0;
     }
 
@@ -1,6 +1,7 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #ifndef MMWAVE_NIST_ERROR_RATE_MODEL_H
 #define MMWAVE_NIST_ERROR_RATE_MODEL_H
+#include <vector>
 #include "mmwave-error-rate-model.h"
 #include "mmwave-mode.h"
 
@@ -12,6 +13,9 @@ namespace ns3 {
         static TypeId GetTypeId ();
         MmWaveNistErrorRateModel ();
 
+        void SetUseTable (bool useTable);
+        bool GetUseTable () const;
+
     private:
         double DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const;
         uint8_t GetBValue (MmWaveCodeRate codeRate) const;
@@ -22,6 +26,12 @@ namespace ns3 {
         double GetFecBpskBer (double snr, uint64_t nbits, uint8_t bValue) const;
         double GetFecQpskBer (double snr, uint64_t nbits, uint8_t bValue) const;
         double GetFecQamBer (uint16_t constellationSize, double snr, uint64_t nbits, uint8_t bValue) const;
+        double GetLogBitSuccessRate (uint16_t constellationSize, double snr, uint8_t bValue) const;
+        const std::vector<double> & GetLogBitSuccessRateTable (uint16_t constellationSize, uint8_t bValue) const;
+        double GetAnalyticChunkSuccessRate (MmWaveMode mode, double snr, uint64_t nbits) const;
+        double GetTableChunkSuccessRate (MmWaveMode mode, double snr, uint64_t nbits) const;
+
+        bool m_useTable; //!< whether chunk success rates are interpolated from precomputed tables
     };
 
 } //namespace ns3
@@ -1,6 +1,8 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <algorithm>
+#include <unordered_map>
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
 #include "ns3/pointer.h"
@@ -22,6 +24,25 @@ namespace ns3 {
     NS_LOG_COMPONENT_DEFINE ("MmWavePhy");
     NS_OBJECT_ENSURE_REGISTERED (MmWavePhy);
 
+    /**
+     * Payload duration parameters of a (MCS, channel width, guard interval, NSS, band, MPDU type) tuple,
+     * and the number of OFDM symbols of each bucket of payload sizes.
+     */
+    struct MmWavePayloadDurationEntry
+    {
+        double numDataBitsPerSymbol;             //!< number of data bits carried by an OFDM symbol
+        Time symbolDuration;                     //!< OFDM symbol duration, including the guard interval
+        std::vector<int64_t> symbolsPerBucket;   //!< symbols shared by every size of a bucket, 0 if unknown, -1 if not shared
+    };
+
+    static const uint32_t g_mmWavePayloadSizeBucket = 64;        ///< payload sizes (bytes) per cache bucket
+    static const uint32_t g_mmWavePayloadMaxBuckets = 16384;     ///< larger payloads always use the exact computation
+    // the cache is shared by all the PHYs: its entries depend on nothing but their key
+    static std::unordered_map<uint64_t, MmWavePayloadDurationEntry> g_mmWavePayloadDurationCache; ///< payload duration cache
+    static bool g_mmWaveTxDurationCacheEnabled = true;           ///< whether GetPayloadDuration uses the cache
+    static uint64_t g_mmWaveTxDurationCacheHits = 0;             ///< number of payload durations served from the cache
+    static uint64_t g_mmWaveTxDurationCacheMisses = 0;           ///< number of payload durations computed
+
     TypeId
     MmWavePhy::GetTypeId ()
     {
@@ -461,20 +482,108 @@ namespace ns3 {
     {
         NS_ASSERT (mpdutype == MMWAVE_NORMAL_MPDU);
         MmWaveMode payloadMode = txVector.GetMode ();
-        double stbc = 1;
-        double Nes = 1;
-        Time symbolDuration = NanoSeconds (12800 + txVector.GetGuardInterval ());
-        double numDataBitsPerSymbol = payloadMode.GetDataRate (txVector) * symbolDuration.GetNanoSeconds () / 1e9;
-        double numSymbols = lrint (stbc * ceil ((16 + size * 8.0 + 6.0 * Nes) / (stbc * numDataBitsPerSymbol)));
+        if (payloadMode.GetModulationClass () != MMWAVE_MOD_CLASS_OFDM)
+        {
+            NS_FATAL_ERROR ("unsupported modulation class");
+            return MicroSeconds (0);
+        }
+        if (!g_mmWaveTxDurationCacheEnabled)
+        {
+            g_mmWaveTxDurationCacheMisses++;
+            Time symbolDuration = NanoSeconds (12800 + txVector.GetGuardInterval ());
+            double numDataBitsPerSymbol = payloadMode.GetDataRate (txVector) * symbolDuration.GetNanoSeconds () / 1e9;
+            int64_t numSymbols = GetNumberOfPayloadSymbols (size, numDataBitsPerSymbol);
+            return FemtoSeconds (static_cast<uint64_t> (static_cast<double> (numSymbols) * symbolDuration.GetFemtoSeconds ()));
+        }
 
-        switch (payloadMode.GetModulationClass ())
+        uint64_t key = (static_cast<uint64_t> (payloadMode.GetUid ()) << 44)
+                       | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 28)
+                       | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 12)
+                       | (static_cast<uint64_t> (txVector.GetNss ()) << 8)
+                       | (static_cast<uint64_t> (band) << 4)
+                       | static_cast<uint64_t> (mpdutype);
+        auto it = g_mmWavePayloadDurationCache.find (key);
+        if (it == g_mmWavePayloadDurationCache.end ())
         {
-            case MMWAVE_MOD_CLASS_OFDM:
-                return FemtoSeconds (static_cast<uint64_t> (numSymbols * symbolDuration.GetFemtoSeconds ()));
-            default:
-                NS_FATAL_ERROR ("unsupported modulation class");
-                return MicroSeconds (0);
+            MmWavePayloadDurationEntry entry;
+            entry.symbolDuration = NanoSeconds (12800 + txVector.GetGuardInterval ());
+            entry.numDataBitsPerSymbol = payloadMode.GetDataRate (txVector) * entry.symbolDuration.GetNanoSeconds () / 1e9;
+            it = g_mmWavePayloadDurationCache.insert ({key, entry}).first;
+        }
+        MmWavePayloadDurationEntry &entry = it->second;
+
+        // the number of symbols is non-decreasing with the size, hence it is shared by every
+        // size of a bucket whenever the first and the last size of the bucket agree on it
+        uint32_t bucket = size / g_mmWavePayloadSizeBucket;
+        int64_t numSymbols = 0;
+        bool hit = false;
+        if (bucket < g_mmWavePayloadMaxBuckets)
+        {
+            if (bucket >= entry.symbolsPerBucket.size ())
+            {
+                entry.symbolsPerBucket.resize (bucket + 1, 0);
+            }
+            hit = (entry.symbolsPerBucket[bucket] > 0);
+            if (entry.symbolsPerBucket[bucket] == 0)
+            {
+                int64_t first = GetNumberOfPayloadSymbols (bucket * g_mmWavePayloadSizeBucket, entry.numDataBitsPerSymbol);
+                int64_t last = GetNumberOfPayloadSymbols ((bucket + 1) * g_mmWavePayloadSizeBucket - 1, entry.numDataBitsPerSymbol);
+                entry.symbolsPerBucket[bucket] = (first == last) ? first : -1;
+            }
+            numSymbols = entry.symbolsPerBucket[bucket];
+        }
+        if (numSymbols <= 0)
+        {
+            numSymbols = GetNumberOfPayloadSymbols (size, entry.numDataBitsPerSymbol);
+        }
+        if (hit)
+        {
+            g_mmWaveTxDurationCacheHits++;
+        }
+        else
+        {
+            g_mmWaveTxDurationCacheMisses++;
         }
+        return FemtoSeconds (static_cast<uint64_t> (static_cast<double> (numSymbols) * entry.symbolDuration.GetFemtoSeconds ()));
+    }
+
+    int64_t
+    MmWavePhy::GetNumberOfPayloadSymbols (uint32_t size, double numDataBitsPerSymbol)
+    {
+        double stbc = 1;
+        double Nes = 1;
+        return lrint (stbc * ceil ((16 + size * 8.0 + 6.0 * Nes) / (stbc * numDataBitsPerSymbol)));
+    }
+
+    void
+    MmWavePhy::ResetTxDurationCache ()
+    {
+        g_mmWavePayloadDurationCache.clear ();
+    }
+
+    void
+    MmWavePhy::SetTxDurationCacheEnabled (bool enabled)
+    {
+        g_mmWaveTxDurationCacheEnabled = enabled;
+        g_mmWavePayloadDurationCache.clear ();
+    }
+
+    bool
+    MmWavePhy::IsTxDurationCacheEnabled ()
+    {
+        return g_mmWaveTxDurationCacheEnabled;
+    }
+
+    uint64_t
+    MmWavePhy::GetTxDurationCacheHits ()
+    {
+        return g_mmWaveTxDurationCacheHits;
+    }
+
+    uint64_t
+    MmWavePhy::GetTxDurationCacheMisses ()
+    {
+        return g_mmWaveTxDurationCacheMisses;
     }
 
     Ptr<const MmWavePsdu>
@@ -609,6 +718,7 @@ namespace ns3 {
         NS_LOG_FUNCTION (this << standard << band);
         m_standard = standard;
         m_band = band;
+        ResetTxDurationCache ();
         NS_ASSERT (m_standard != MMWAVE_PHY_STANDARD_UNSPECIFIED);
         NS_ASSERT (m_band != MMWAVE_PHY_BAND_UNSPECIFIED);
         m_isConstructed = true;
@@ -891,7 +1001,7 @@ namespace ns3 {
         m_txPowerMaxSiso = txPowerMaxSiso;
         m_txPowerMaxMimo = txPowerMaxMimo;
         NS_ASSERT ((m_currentEvent->GetEndTime () - Simulator::Now ()).IsPositive ());
-        Simulator::Schedule (m_currentEvent->GetEndTime () - Simulator::Now (), &MmWavePhy::EndReceiveInterBss, this);
+        NS_PROFILE_SCHEDULE (m_currentEvent->GetEndTime () - Simulator::Now (), &MmWavePhy::EndReceiveInterBss, this);
         AbortCurrentReception (MMWAVE_OBSS_PD_CCA_RESET);
     }
 
@@ -934,15 +1044,15 @@ namespace ns3 {
         {
             case MmWavePhyState::MMWAVE_TX:
                 NS_LOG_DEBUG ("setting sleep mode postponed until end of current transmission");
-                Simulator::Schedule (GetDelayUntilIdle (), &MmWavePhy::SetSleepMode, this);
+                NS_PROFILE_SCHEDULE (GetDelayUntilIdle (), &MmWavePhy::SetSleepMode, this);
                 break;
             case MmWavePhyState::MMWAVE_RX:
                 NS_LOG_DEBUG ("setting sleep mode postponed until end of current reception");
-                Simulator::Schedule (GetDelayUntilIdle (), &MmWavePhy::SetSleepMode, this);
+                NS_PROFILE_SCHEDULE (GetDelayUntilIdle (), &MmWavePhy::SetSleepMode, this);
                 break;
             case MmWavePhyState::MMWAVE_SWITCHING:
                 NS_LOG_DEBUG ("setting sleep mode postponed until end of channel switching");
-                Simulator::Schedule (GetDelayUntilIdle (), &MmWavePhy::SetSleepMode, this);
+                NS_PROFILE_SCHEDULE (GetDelayUntilIdle (), &MmWavePhy::SetSleepMode, this);
                 break;
             case MmWavePhyState::MMWAVE_CCA_BUSY:
             case MmWavePhyState::MMWAVE_IDLE:
@@ -1158,7 +1268,7 @@ namespace ns3 {
                 break;
             case MmWavePhyState::MMWAVE_TX:
                 NS_LOG_DEBUG ("channel switching postponed until end of current transmission");
-                Simulator::Schedule (GetDelayUntilIdle (), &MmWavePhy::SetChannelNumber, this, nch);
+                NS_PROFILE_SCHEDULE (GetDelayUntilIdle (), &MmWavePhy::SetChannelNumber, this, nch);
                 break;
             case MmWavePhyState::MMWAVE_CCA_BUSY:
             case MmWavePhyState::MMWAVE_IDLE:
@@ -1213,7 +1323,7 @@ namespace ns3 {
                 break;
             case MmWavePhyState::MMWAVE_TX:
                 NS_LOG_DEBUG ("channel/frequency switching postponed until end of current transmission");
-                Simulator::Schedule (GetDelayUntilIdle (), &MmWavePhy::SetFrequency, this, frequency);
+                NS_PROFILE_SCHEDULE (GetDelayUntilIdle (), &MmWavePhy::SetFrequency, this, frequency);
                 break;
             case MmWavePhyState::MMWAVE_CCA_BUSY:
             case MmWavePhyState::MMWAVE_IDLE:
@@ -1544,7 +1654,7 @@ namespace ns3 {
     }
 
     void
-    MmWavePhy::NotifyRxBegin (Ptr<const MmWavePsdu> psdu, RxPowerWattPerChannelBand rxPowersW)
+    MmWavePhy::NotifyRxBegin (Ptr<const MmWavePsdu> psdu, const MmWaveRxPowers &rxPowersW)
     {
         if (psdu)
         {
@@ -1700,20 +1810,16 @@ namespace ns3 {
         }
         m_state->SwitchToTx (txDuration, psdus, GetPowerDbm (txVector.GetTxPowerLevel ()), txVector, GetChannelNumber(), GetFrequency(), GetChannelWidth());
         Ptr<MmWavePpdu> ppdu = Create<MmWavePpdu> (psdus, txVector, txDuration, GetPhyBand ());
-        m_endTxEvent = Simulator::Schedule (txDuration, &MmWavePhy::NotifyTxEnd, this, psdus);
+        m_endTxEvent = NS_PROFILE_SCHEDULE (txDuration, &MmWavePhy::NotifyTxEnd, this, psdus);
         StartTx (ppdu);
         m_channelAccessRequested = false;
         m_powerRestricted = false;
     }
 
     void
-    MmWavePhy::StartReceivePreamble (Ptr<MmWavePpdu> ppdu, RxPowerWattPerChannelBand rxPowersW)
+    MmWavePhy::StartReceivePreamble (Ptr<MmWavePpdu> ppdu, const MmWaveRxPowers &rxPowersW)
     {
-        NS_LOG_FUNCTION (this);
-        auto it = std::max_element (rxPowersW.begin (), rxPowersW.end (),
-                                    [] (const std::pair<MmWaveSpectrumBand, double>& p1, const std::pair<MmWaveSpectrumBand, double>& p2)
-                                    {return p1.second < p2.second;});
-        NS_LOG_FUNCTION (this << *ppdu << it->second);
+        NS_LOG_FUNCTION (this << *ppdu << rxPowersW.GetMax ());
         MmWaveTxVector txVector = ppdu->GetTxVector ();
         Time rxDuration = ppdu->GetTxDuration ();
         Ptr<MmWaveEvent> event = m_interference.Add (ppdu, txVector, rxDuration, rxPowersW);
@@ -1868,7 +1974,7 @@ namespace ns3 {
         {
             Time startOfPreambleDuration = GetPreambleDetectionDuration ();
             Time remainingRxDuration = event->GetDuration () - startOfPreambleDuration;
-            m_endPreambleDetectionEvent = Simulator::Schedule (startOfPreambleDuration, &MmWavePhy::StartReceiveHeader, this, event);
+            m_endPreambleDetectionEvent = NS_PROFILE_SCHEDULE (startOfPreambleDuration, &MmWavePhy::StartReceiveHeader, this, event);
         }
         else if ((m_frameCaptureModel != 0) && (rxPowerW > m_currentEvent->GetRxPowerW (primaryBand)))
         {
@@ -1879,7 +1985,7 @@ namespace ns3 {
             m_interference.NotifyRxStart ();
             Time startOfPreambleDuration = GetPreambleDetectionDuration ();
             Time remainingRxDuration = event->GetDuration () - startOfPreambleDuration;
-            m_endPreambleDetectionEvent = Simulator::Schedule (startOfPreambleDuration, &MmWavePhy::StartReceiveHeader, this, event);
+            m_endPreambleDetectionEvent = NS_PROFILE_SCHEDULE (startOfPreambleDuration, &MmWavePhy::StartReceiveHeader, this, event);
         }
         else
         {
@@ -1914,7 +2020,7 @@ namespace ns3 {
             MmWaveTxVector txVector = event->GetTxVector ();
             Time remainingPreambleAndHeaderDuration = GetPhyPreambleDuration (txVector) - GetPreambleDetectionDuration ();
             m_state->SwitchMaybeToCcaBusy (remainingPreambleAndHeaderDuration);
-            m_endPhyRxEvent = Simulator::Schedule (remainingPreambleAndHeaderDuration, &MmWavePhy::ContinueReceiveHeader, this, event);
+            m_endPhyRxEvent = NS_PROFILE_SCHEDULE (remainingPreambleAndHeaderDuration, &MmWavePhy::ContinueReceiveHeader, this, event);
 
         }
         else
@@ -1947,7 +2053,7 @@ namespace ns3 {
             Time remainingRxDuration = event->GetEndTime () - Simulator::Now ();
             m_state->SwitchMaybeToCcaBusy (remainingRxDuration);
             Time remainingPreambleHeaderDuration = CalculatePhyPreambleAndHeaderDuration (txVector) - GetPhyPreambleDuration (txVector);
-            m_endPhyRxEvent = Simulator::Schedule (remainingPreambleHeaderDuration, &MmWavePhy::StartReceivePayload, this, event);
+            m_endPhyRxEvent = NS_PROFILE_SCHEDULE (remainingPreambleHeaderDuration, &MmWavePhy::StartReceivePayload, this, event);
         }
         else
         {
@@ -2007,7 +2113,7 @@ namespace ns3 {
                     m_statusPerMpdu.clear ();
                     m_state->SwitchToRx (payloadDuration);
                     m_phyRxPayloadBeginTrace (txVector, payloadDuration); //this callback (equivalent to PHY-RXSTART primitive) is triggered only if headers have been correctly decoded and that the mode within is supported
-                    m_endRxEvent = Simulator::Schedule (payloadDuration, &MmWavePhy::EndReceive, this, event);
+                    m_endRxEvent = NS_PROFILE_SCHEDULE (payloadDuration, &MmWavePhy::EndReceive, this, event);
                     success = true;
                     NS_LOG_DEBUG ("Receiving PSDU");
                 }
@@ -2042,7 +2148,7 @@ namespace ns3 {
         {
             if (payloadDuration.IsStrictlyPositive ())
             {
-                m_endRxEvent = Simulator::Schedule (payloadDuration, &MmWavePhy::ResetReceive, this, event);
+                m_endRxEvent = NS_PROFILE_SCHEDULE (payloadDuration, &MmWavePhy::ResetReceive, this, event);
             }
             else
             {
@@ -2101,6 +2207,7 @@ namespace ns3 {
         NS_ASSERT (GetLastRxEndTime () == Simulator::Now ());
         NS_ASSERT (event->GetEndTime () == Simulator::Now ());
 
+        // the PSDU is not copied: a copy would share the MPDU with the other receivers anyway
         Ptr<const MmWavePsdu> psdu = GetAddressedPsduInPpdu (event->GetPpdu ());
         std::pair<bool, MmWaveSignalNoiseDbm> rxInfo = GetReceptionStatus (psdu, event, NanoSeconds (0), psduDuration);
         m_signalNoise = rxInfo.second;
@@ -2116,11 +2223,11 @@ namespace ns3 {
             //At least one MPDU has been successfully received
             MmWaveTxVector txVector = event->GetTxVector ();
             NotifyMonitorSniffRx (psdu, GetFrequency (), txVector, m_signalNoise, m_statusPerMpdu);
-            m_state->SwitchFromRxEndOk (Copy (psdu), snr, event->GetStartTime (), psduDuration, txVector, GetChannelNumber(), GetFrequency(), GetChannelWidth());
+            m_state->SwitchFromRxEndOk (ConstCast<MmWavePsdu> (psdu), snr, event->GetStartTime (), psduDuration, txVector, GetChannelNumber(), GetFrequency(), GetChannelWidth());
         }
         else
         {
-            m_state->SwitchFromRxEndError (Copy (psdu), snr, event->GetStartTime (), psduDuration, txVector);
+            m_state->SwitchFromRxEndError (ConstCast<MmWavePsdu> (psdu), snr, event->GetStartTime (), psduDuration, txVector);
         }
 
         m_interference.NotifyRxEnd ();
@@ -2159,6 +2266,7 @@ namespace ns3 {
 
         m_mcsIndexMap[modulation][mode.GetMcsValue ()] = m_deviceMcsSet.size ();
         m_deviceMcsSet.push_back (mode);
+        ResetTxDurationCache ();
     }
 
     void
@@ -2166,6 +2274,7 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this);
         m_mcsIndexMap.clear ();
+        ResetTxDurationCache ();
         uint8_t index = 0;
         for (auto& mode : m_deviceMcsSet)
         {
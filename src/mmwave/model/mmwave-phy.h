@@ -66,6 +66,12 @@ namespace ns3 {
         static Time GetPhyPreambleDuration (MmWaveTxVector txVector);
         static Time GetPayloadDuration (uint32_t size, MmWaveTxVector txVector, MmWavePhyBand band, MmWaveMpduType mpdutype = MMWAVE_NORMAL_MPDU);
         static Time GetPayloadDuration (uint32_t size, MmWaveTxVector txVector, MmWavePhyBand band, MmWaveMpduType mpdutype, bool incFlag, uint32_t &totalAmpduSize, double &totalAmpduNumSymbols);
+        // the payload duration cache and its counters are shared by all the PHYs of the simulation
+        static void ResetTxDurationCache ();
+        static void SetTxDurationCacheEnabled (bool enabled);
+        static bool IsTxDurationCacheEnabled ();
+        static uint64_t GetTxDurationCacheHits ();
+        static uint64_t GetTxDurationCacheMisses ();
 
         int64_t AssignStreams (int64_t stream);
         void SetSifs (Time sifs);
@@ -82,7 +88,7 @@ namespace ns3 {
         void UnregisterListener (MmWavePhyListener *listener);
         void SetCapabilitiesChangedCallback (Callback<void> callback);
         void StartRx (Ptr<MmWaveEvent> event);
-        void StartReceivePreamble (Ptr<MmWavePpdu> ppdu, RxPowerWattPerChannelBand rxPowersW);
+        void StartReceivePreamble (Ptr<MmWavePpdu> ppdu, const MmWaveRxPowers &rxPowersW);
         void StartReceiveHeader (Ptr<MmWaveEvent> event);
         void ContinueReceiveHeader (Ptr<MmWaveEvent> event);
         void StartReceivePayload (Ptr<MmWaveEvent> event);
@@ -94,7 +100,7 @@ namespace ns3 {
         void NotifyTxBegin (MmWaveConstPsduMap psdus, double txPowerW);
         void NotifyTxEnd (MmWaveConstPsduMap psdus);
         void NotifyTxDrop (Ptr<const MmWavePsdu> psdu);
-        void NotifyRxBegin (Ptr<const MmWavePsdu> psdu, RxPowerWattPerChannelBand rxPowersW);
+        void NotifyRxBegin (Ptr<const MmWavePsdu> psdu, const MmWaveRxPowers &rxPowersW);
         void NotifyRxEnd (Ptr<const MmWavePsdu> psdu);
         void NotifyRxDrop (Ptr<const MmWavePsdu> psdu, MmWavePhyRxfailureReason reason);
         void NotifyMonitorSniffRx (Ptr<const MmWavePsdu> psdu, uint16_t channelFreqMhz, MmWaveTxVector txVector, MmWaveSignalNoiseDbm signalNoise, std::vector<bool> statusPerMpdu);
@@ -126,6 +132,7 @@ namespace ns3 {
         void InitializeFrequencyChannelNumber ();
         void ConfigureDefaultsForStandard ();
         void ConfigureChannelForStandard ();
+        static int64_t GetNumberOfPayloadSymbols (uint32_t size, double numDataBitsPerSymbol);
         void PushMcs (MmWaveMode mode);
         void RebuildMcsMap ();
         void AbortCurrentReception (MmWavePhyRxfailureReason reason);
@@ -204,7 +211,7 @@ namespace ns3 {
         TracedCallback<MmWaveConstPsduMap, MmWaveTxVector, double /* TX power (W) */> m_phyTxPsduBeginTrace;
         TracedCallback<Ptr<const Packet>> m_phyTxEndTrace;
         TracedCallback<Ptr<const Packet>> m_phyTxDropTrace;
-        TracedCallback<Ptr<const Packet>, RxPowerWattPerChannelBand> m_phyRxBeginTrace;
+        TracedCallback<Ptr<const Packet>, const MmWaveRxPowers &> m_phyRxBeginTrace;
         TracedCallback<MmWaveTxVector, Time> m_phyRxPayloadBeginTrace;
         TracedCallback<Ptr<const Packet>> m_phyRxEndTrace;
         TracedCallback<Ptr<const Packet>, MmWavePhyRxfailureReason> m_phyRxDropTrace;
@@ -0,0 +1,345 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+// the AVX kernels are compiled for AVX whatever the flags of the module, and only
+// called when the CPU supports it
+#define MMWAVE_PSD_KERNELS_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "mmwave-psd-kernels.h"
+
+#ifdef MMWAVE_PSD_KERNELS_AVX
+#define MMWAVE_TARGET_AVX __attribute__ ((target ("avx")))
+#endif
+
+namespace ns3 {
+
+    MmWavePsdKernels::Isa MmWavePsdKernels::m_isa = MmWavePsdKernels::GetBestIsa ();
+
+    namespace {
+
+#ifdef MMWAVE_PSD_KERNELS_AVX
+        /// \return the number of values filled, a multiple of 4
+        MMWAVE_TARGET_AVX std::size_t
+        FillAvx (double *out, double value, std::size_t n)
+        {
+            std::size_t i = 0;
+            __m256d v = _mm256_set1_pd (value);
+            for (; i + 4 <= n; i += 4)
+            {
+                _mm256_storeu_pd (out + i, v);
+            }
+            return i;
+        }
+
+        /// \return the number of values multiplied, a multiple of 4
+        MMWAVE_TARGET_AVX std::size_t
+        MultiplyAvx (const double *a, const double *b, double *out, std::size_t n)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                _mm256_storeu_pd (out + i, _mm256_mul_pd (_mm256_loadu_pd (a + i), _mm256_loadu_pd (b + i)));
+            }
+            return i;
+        }
+
+        /// \return the number of values divided, a multiple of 4
+        MMWAVE_TARGET_AVX std::size_t
+        DivideAvx (const double *num, const double *den, double *out, std::size_t n)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                _mm256_storeu_pd (out + i, _mm256_div_pd (_mm256_loadu_pd (num + i), _mm256_loadu_pd (den + i)));
+            }
+            return i;
+        }
+
+        /// \return the number of values divided, a multiple of 4
+        MMWAVE_TARGET_AVX std::size_t
+        DivideByScalarAvx (double *inOut, double den, std::size_t n)
+        {
+            std::size_t i = 0;
+            __m256d d = _mm256_set1_pd (den);
+            for (; i + 4 <= n; i += 4)
+            {
+                _mm256_storeu_pd (inOut + i, _mm256_div_pd (_mm256_loadu_pd (inOut + i), d));
+            }
+            return i;
+        }
+
+        /// \return the number of products summed in sum, a multiple of 8
+        MMWAVE_TARGET_AVX std::size_t
+        DotAvx (const double *a, const double *b, std::size_t n, double &sum)
+        {
+            std::size_t i = 0;
+            // two independent accumulators hide the latency of the additions
+            __m256d acc0 = _mm256_setzero_pd ();
+            __m256d acc1 = _mm256_setzero_pd ();
+            for (; i + 8 <= n; i += 8)
+            {
+                acc0 = _mm256_add_pd (acc0, _mm256_mul_pd (_mm256_loadu_pd (a + i), _mm256_loadu_pd (b + i)));
+                acc1 = _mm256_add_pd (acc1, _mm256_mul_pd (_mm256_loadu_pd (a + i + 4), _mm256_loadu_pd (b + i + 4)));
+            }
+            double lanes[4];
+            _mm256_storeu_pd (lanes, _mm256_add_pd (acc0, acc1));
+            sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            return i;
+        }
+#endif
+
+#if defined(__SSE2__)
+        /// \return the number of values filled, a multiple of 2
+        std::size_t
+        FillSse2 (double *out, double value, std::size_t n)
+        {
+            std::size_t i = 0;
+            __m128d v = _mm_set1_pd (value);
+            for (; i + 2 <= n; i += 2)
+            {
+                _mm_storeu_pd (out + i, v);
+            }
+            return i;
+        }
+
+        /// \return the number of values multiplied, a multiple of 2
+        std::size_t
+        MultiplySse2 (const double *a, const double *b, double *out, std::size_t n)
+        {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                _mm_storeu_pd (out + i, _mm_mul_pd (_mm_loadu_pd (a + i), _mm_loadu_pd (b + i)));
+            }
+            return i;
+        }
+
+        /// \return the number of values divided, a multiple of 2
+        std::size_t
+        DivideSse2 (const double *num, const double *den, double *out, std::size_t n)
+        {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                _mm_storeu_pd (out + i, _mm_div_pd (_mm_loadu_pd (num + i), _mm_loadu_pd (den + i)));
+            }
+            return i;
+        }
+
+        /// \return the number of values divided, a multiple of 2
+        std::size_t
+        DivideByScalarSse2 (double *inOut, double den, std::size_t n)
+        {
+            std::size_t i = 0;
+            __m128d d = _mm_set1_pd (den);
+            for (; i + 2 <= n; i += 2)
+            {
+                _mm_storeu_pd (inOut + i, _mm_div_pd (_mm_loadu_pd (inOut + i), d));
+            }
+            return i;
+        }
+
+        /// \return the number of products summed in sum, a multiple of 4
+        std::size_t
+        DotSse2 (const double *a, const double *b, std::size_t n, double &sum)
+        {
+            std::size_t i = 0;
+            __m128d acc0 = _mm_setzero_pd ();
+            __m128d acc1 = _mm_setzero_pd ();
+            for (; i + 4 <= n; i += 4)
+            {
+                acc0 = _mm_add_pd (acc0, _mm_mul_pd (_mm_loadu_pd (a + i), _mm_loadu_pd (b + i)));
+                acc1 = _mm_add_pd (acc1, _mm_mul_pd (_mm_loadu_pd (a + i + 2), _mm_loadu_pd (b + i + 2)));
+            }
+            double lanes[2];
+            _mm_storeu_pd (lanes, _mm_add_pd (acc0, acc1));
+            sum = lanes[0] + lanes[1];
+            return i;
+        }
+#endif
+
+    } // unnamed namespace
+
+    MmWavePsdKernels::Isa
+    MmWavePsdKernels::GetBestIsa ()
+    {
+#ifdef MMWAVE_PSD_KERNELS_AVX
+        // may run before the constructor of libgcc that initializes the CPU model
+        __builtin_cpu_init ();
+        if (__builtin_cpu_supports ("avx"))
+        {
+            return AVX;
+        }
+#endif
+#if defined(__SSE2__)
+        return SSE2;
+#else
+        return SCALAR;
+#endif
+    }
+
+    MmWavePsdKernels::Isa
+    MmWavePsdKernels::GetIsa ()
+    {
+        return m_isa;
+    }
+
+    bool
+    MmWavePsdKernels::SetIsa (Isa isa)
+    {
+        if (isa > GetBestIsa ())
+        {
+            return false;
+        }
+#if !defined(__SSE2__)
+        if (isa == SSE2)
+        {
+            return false;
+        }
+#endif
+        m_isa = isa;
+        return true;
+    }
+
+    void
+    MmWavePsdKernels::SetVectorized (bool vectorized)
+    {
+        m_isa = vectorized ? GetBestIsa () : SCALAR;
+    }
+
+    bool
+    MmWavePsdKernels::IsVectorized ()
+    {
+        return m_isa != SCALAR;
+    }
+
+    void
+    MmWavePsdKernels::Fill (double *out, double value, std::size_t n)
+    {
+        std::size_t i = 0;
+        switch (m_isa)
+        {
+#ifdef MMWAVE_PSD_KERNELS_AVX
+            case AVX:
+                i = FillAvx (out, value, n);
+                break;
+#endif
+#if defined(__SSE2__)
+            case SSE2:
+                i = FillSse2 (out, value, n);
+                break;
+#endif
+            default:
+                break;
+        }
+        for (; i < n; i++)
+        {
+            out[i] = value;
+        }
+    }
+
+    void
+    MmWavePsdKernels::Multiply (const double *a, const double *b, double *out, std::size_t n)
+    {
+        std::size_t i = 0;
+        switch (m_isa)
+        {
+#ifdef MMWAVE_PSD_KERNELS_AVX
+            case AVX:
+                i = MultiplyAvx (a, b, out, n);
+                break;
+#endif
+#if defined(__SSE2__)
+            case SSE2:
+                i = MultiplySse2 (a, b, out, n);
+                break;
+#endif
+            default:
+                break;
+        }
+        for (; i < n; i++)
+        {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    void
+    MmWavePsdKernels::Divide (const double *num, const double *den, double *out, std::size_t n)
+    {
+        std::size_t i = 0;
+        switch (m_isa)
+        {
+#ifdef MMWAVE_PSD_KERNELS_AVX
+            case AVX:
+                i = DivideAvx (num, den, out, n);
+                break;
+#endif
+#if defined(__SSE2__)
+            case SSE2:
+                i = DivideSse2 (num, den, out, n);
+                break;
+#endif
+            default:
+                break;
+        }
+        for (; i < n; i++)
+        {
+            out[i] = num[i] / den[i];
+        }
+    }
+
+    void
+    MmWavePsdKernels::DivideByScalar (double *inOut, double den, std::size_t n)
+    {
+        std::size_t i = 0;
+        switch (m_isa)
+        {
+#ifdef MMWAVE_PSD_KERNELS_AVX
+            case AVX:
+                i = DivideByScalarAvx (inOut, den, n);
+                break;
+#endif
+#if defined(__SSE2__)
+            case SSE2:
+                i = DivideByScalarSse2 (inOut, den, n);
+                break;
+#endif
+            default:
+                break;
+        }
+        for (; i < n; i++)
+        {
+            inOut[i] = inOut[i] / den;
+        }
+    }
+
+    double
+    MmWavePsdKernels::Dot (const double *a, const double *b, std::size_t n)
+    {
+        std::size_t i = 0;
+        double sum = 0.0;
+        switch (m_isa)
+        {
+#ifdef MMWAVE_PSD_KERNELS_AVX
+            case AVX:
+                i = DotAvx (a, b, n, sum);
+                break;
+#endif
+#if defined(__SSE2__)
+            case SSE2:
+                i = DotSse2 (a, b, n, sum);
+                break;
+#endif
+            default:
+                break;
+        }
+        for (; i < n; i++)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+} // namespace ns3
@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MMWAVE_PSD_KERNELS_H
+#define MMWAVE_PSD_KERNELS_H
+#include <cstddef>
+
+namespace ns3 {
+
+    /**
+     * Element-wise kernels over the value arrays of power spectral densities.
+     *
+     * The instruction set is chosen when the program starts: the kernels use AVX
+     * when the CPU supports it, SSE2 on the other x86 CPUs and plain loops
+     * otherwise. The AVX kernels are always built on x86 with GCC or Clang, so
+     * the module needs no -mavx. Fill, Multiply and the divisions give the same
+     * results on every path; Dot sums in a different order when vectorized and is
+     * only equal within rounding to the scalar sum.
+     */
+    class MmWavePsdKernels
+    {
+    public:
+        enum Isa
+        {
+            SCALAR,
+            SSE2,
+            AVX
+        };
+
+        /**
+         * \return the best instruction set of the kernels supported by this CPU
+         */
+        static Isa GetBestIsa ();
+        /**
+         * \return the instruction set the kernels use
+         */
+        static Isa GetIsa ();
+        /**
+         * Force the kernels to use an instruction set (used for validation)
+         * \param isa the instruction set
+         * \return false, without any change, if the CPU or the build does not support it
+         */
+        static bool SetIsa (Isa isa);
+        /**
+         * \param vectorized false to force the scalar kernels, true to use the best
+         *        instruction set
+         */
+        static void SetVectorized (bool vectorized);
+        static bool IsVectorized ();
+
+        /// out[i] = value
+        static void Fill (double *out, double value, std::size_t n);
+        /// out[i] = a[i] * b[i]; out may alias a or b
+        static void Multiply (const double *a, const double *b, double *out, std::size_t n);
+        /// out[i] = num[i] / den[i]; out may alias num or den
+        static void Divide (const double *num, const double *den, double *out, std::size_t n);
+        /// inOut[i] = inOut[i] / den
+        static void DivideByScalar (double *inOut, double den, std::size_t n);
+        /// \return the sum of a[i] * b[i]
+        static double Dot (const double *a, const double *b, std::size_t n);
+
+    private:
+        static Isa m_isa; //!< the instruction set the kernels use
+    };
+
+} // namespace ns3
+
+#endif //MMWAVE_PSD_KERNELS_H
@@ -22,6 +22,10 @@ namespace ns3 {
     Ptr<const Packet>
     MmWavePsdu::GetPacket () const
     {
+        if (m_packet != 0)
+        {
+            return m_packet;
+        }
         Ptr<Packet> packet = Create<Packet> ();
         if (m_mpdu != 0)
         {
@@ -33,7 +37,8 @@ namespace ns3 {
         {
             NS_ABORT_MSG ("MPDUs size should be 1.");
         }
-        return packet;
+        m_packet = packet;
+        return m_packet;
     }
 
     Mac48Address
@@ -62,6 +67,7 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this << duration);
         m_mpdu->GetHeader ().SetDuration (duration);
+        m_packet = 0;
     }
 
     uint32_t
@@ -79,6 +85,7 @@ namespace ns3 {
     MmWaveMacHeader &
     MmWavePsdu::GetHeader ()
     {
+        m_packet = 0; // the caller may modify the header
         return m_mpdu->GetHeader ();
     }
 
@@ -10,6 +10,11 @@
 #include "mmwave-mac-queue-item.h"
 namespace ns3 {
 
+    /**
+     * The PSDU is shared by the transmitter and all the receivers of a PPDU, so it
+     * must not be modified once it has been handed to the PHY. The serialized MPDU
+     * returned by GetPacket is built on first use and then shared as well.
+     */
     class MmWavePsdu : public SimpleRefCount<MmWavePsdu> {
     public:
 
@@ -32,6 +37,7 @@ namespace ns3 {
     private:
         Ptr<MmWaveMacQueueItem> m_mpdu;
         uint32_t m_size;
+        mutable Ptr<const Packet> m_packet; //!< MPDU with header and trailer, built by GetPacket
     };
 
     std::ostream &operator<<(std::ostream &os, const MmWavePsdu &psdu);
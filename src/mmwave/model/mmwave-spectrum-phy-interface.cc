@@ -40,6 +40,12 @@ namespace ns3 {
         m_phy = phy;
     }
 
+    Ptr<MmWaveSpectrumPhy>
+    MmWaveSpectrumPhyInterface::GetPhy () const
+    {
+        return m_phy;
+    }
+
     Ptr<NetDevice>
     MmWaveSpectrumPhyInterface::GetDevice () const
     {
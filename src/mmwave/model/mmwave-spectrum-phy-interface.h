@@ -13,6 +13,7 @@ namespace ns3 {
         MmWaveSpectrumPhyInterface ();
 
         void SetPhy (const Ptr<MmWaveSpectrumPhy> phy);
+        Ptr<MmWaveSpectrumPhy> GetPhy () const;
 
         Ptr<NetDevice> GetDevice () const;
         void SetDevice (const Ptr<NetDevice> d);
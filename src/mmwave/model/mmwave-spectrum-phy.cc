@@ -1,8 +1,13 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include <list>
+#include <map>
+#include <tuple>
 #include "ns3/log.h"
 #include "ns3/object.h"
 #include "ns3/double.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/global-value.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/spectrum-value.h"
@@ -17,6 +22,41 @@ namespace ns3 {
     NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumPhy");
     NS_OBJECT_ENSURE_REGISTERED (MmWaveSpectrumPhy);
 
+    /**
+     * Parameters a transmit PSD is built from.
+     */
+    struct MmWaveTxPsdKey
+    {
+        uint16_t centerFrequency;
+        uint16_t channelWidth;
+        double txPowerW;
+        uint16_t guardBandwidth;
+        double innerBandMinimumRejection;
+        double outerBandMinimumRejection;
+        double outerBandMaximumRejection;
+        MmWaveModulationClass modulationClass;
+
+        bool operator < (const MmWaveTxPsdKey &o) const
+        {
+            return std::tie (centerFrequency, channelWidth, txPowerW, guardBandwidth, innerBandMinimumRejection,
+                             outerBandMinimumRejection, outerBandMaximumRejection, modulationClass)
+                   < std::tie (o.centerFrequency, o.channelWidth, o.txPowerW, o.guardBandwidth, o.innerBandMinimumRejection,
+                               o.outerBandMinimumRejection, o.outerBandMaximumRejection, o.modulationClass);
+        }
+    };
+
+    typedef std::list<std::pair<MmWaveTxPsdKey, Ptr<const SpectrumValue> > > MmWaveTxPsdList;
+    static MmWaveTxPsdList g_mmWaveTxPsdList;                                       ///< transmit PSDs shared by all PHYs, most recently used first
+    static std::map<MmWaveTxPsdKey, MmWaveTxPsdList::iterator> g_mmWaveTxPsdIndex; ///< position of each transmit PSD in the list
+    static uint64_t g_mmWaveTxPsdCacheHits = 0;                                      ///< number of transmit PSDs found in the cache
+    static uint64_t g_mmWaveTxPsdCacheMisses = 0;                                    ///< number of transmit PSDs built
+
+    /// maximum number of cached transmit PSDs, shared by all the PHYs
+    static GlobalValue g_mmWaveTxPsdCacheSize = GlobalValue ("MmWaveTxPsdCacheSize",
+                                                             "The maximum number of transmit PSDs cached and shared by all the mmWave PHYs, 0 to disable the cache",
+                                                             UintegerValue (64),
+                                                             MakeUintegerChecker<uint32_t> ());
+
     TypeId
     MmWaveSpectrumPhy::GetTypeId ()
     {
@@ -44,6 +84,18 @@ namespace ns3 {
                                DoubleValue (-40.0),
                                MakeDoubleAccessor (&MmWaveSpectrumPhy::m_txMaskOuterBandMaximumRejection),
                                MakeDoubleChecker<double> ())
+                .AddAttribute ("TxPsdCacheHits",
+                               "The number of transmit PSDs found in the cache shared by all the PHYs, see the MmWaveTxPsdCacheSize global value",
+                               TypeId::ATTR_GET,
+                               UintegerValue (0),
+                               MakeUintegerAccessor (&MmWaveSpectrumPhy::DoGetTxPsdCacheHits),
+                               MakeUintegerChecker<uint64_t> ())
+                .AddAttribute ("TxPsdCacheMisses",
+                               "The number of transmit PSDs built because they were not in the cache shared by all the PHYs",
+                               TypeId::ATTR_GET,
+                               UintegerValue (0),
+                               MakeUintegerAccessor (&MmWaveSpectrumPhy::DoGetTxPsdCacheMisses),
+                               MakeUintegerChecker<uint64_t> ())
                 .AddTraceSource ("SignalArrival",
                                  "Signal arrival",
                                  MakeTraceSourceAccessor (&MmWaveSpectrumPhy::m_signalCb),
@@ -68,6 +120,7 @@ namespace ns3 {
         NS_LOG_FUNCTION (this);
         m_channel = 0;
         m_mmWaveSpectrumPhyInterface = 0;
+        m_rfFilterBank = 0;
         MmWavePhy::DoDispose ();
     }
 
@@ -117,21 +170,14 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (this);
         uint16_t channelWidth = GetChannelWidth ();
+        m_rfFilterBank = MmWaveSpectrumValueHelper::GetRfFilterBank (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth));
+        NS_ASSERT_MSG (channelWidth >= 20, "the RF filters cover bands of 20 MHz or more");
+        // the index of each band is the index of its filter, so that the filter bank
+        // output is the per-band RX power of an event
         m_interference.RemoveBands ();
-        if (channelWidth < 20)
+        for (std::size_t k = 0; k < m_rfFilterBank->GetNFilters (); k++)
         {
-            MmWaveSpectrumBand band = GetBand (channelWidth);
-            m_interference.AddBand (band);
-        }
-        else
-        {
-            for (uint16_t bw = 1280; bw >= 20; bw = bw / 2)
-            {
-                for (uint8_t i = 0; i < (channelWidth / bw); ++i)
-                {
-                    m_interference.AddBand (GetBand (bw, i));
-                }
-            }
+            m_interference.AddBand (m_rfFilterBank->GetFilterBand (k));
         }
     }
 
@@ -232,36 +278,22 @@ namespace ns3 {
         {
             senderNodeId = rxParams->txPhy->GetDevice ()->GetNode ()->GetId ();
         }
-        uint16_t channelWidth = GetChannelWidth ();
         double totalRxPowerW = 0;
-        RxPowerWattPerChannelBand rxPowerW;
+        MmWaveRxPowers rxPowerW (m_interference.GetBandLayout ());
 
-        for (uint16_t bw = 1280; bw > 20; bw = bw / 2)
+        NS_ASSERT (m_rfFilterBank);
+        NS_ASSERT (rxPowerW.GetNBands () == m_rfFilterBank->GetNFilters ());
+        double rxGain = DbToRatio (GetRxGain ());
+        double *rxPowerPerBandW = rxPowerW.GetData ();
+        m_rfFilterBank->Integrate (*receivedSignalPsd, rxPowerPerBandW);
+        for (std::size_t k = 0; k < m_rfFilterBank->GetNFilters (); k++)
         {
-            for (uint8_t i = 0; i < (channelWidth / bw); i++)
+            rxPowerPerBandW[k] *= rxGain;
+            if (m_rfFilterBank->GetFilterWidth (k) == 20)
             {
-                NS_ASSERT (channelWidth >= bw);
-                MmWaveSpectrumBand filteredBand = GetBand (bw, i);
-                Ptr<SpectrumValue> filter = MmWaveSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth), filteredBand);
-                SpectrumValue filteredSignal = (*filter) * (*receivedSignalPsd);
-//                NS_LOG_DEBUG ("Signal power received (watts) before antenna gain for" << bw << " MHz channel band " << +i << ": " << Integral (filteredSignal));
-                double rxPowerPerBandW = Integral (filteredSignal) * DbToRatio (GetRxGain ());
-                rxPowerW.insert ({filteredBand, rxPowerPerBandW});
-//                NS_LOG_DEBUG ("Signal power received after antenna gain for" << bw << " MHz channel band " << +i << ": " << rxPowerPerBandW << " W (" << WToDbm (rxPowerPerBandW) << " dBm)");
+                totalRxPowerW += rxPowerPerBandW[k];
             }
         }
-        
-        for (uint8_t i = 0; i < (channelWidth / 20); i++)
-        {
-            MmWaveSpectrumBand filteredBand = GetBand (20, i);
-            Ptr<SpectrumValue> filter = MmWaveSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth), filteredBand);
-            SpectrumValue filteredSignal = (*filter) * (*receivedSignalPsd);
-//            NS_LOG_DEBUG ("Signal power received (watts) before antenna gain for 20 MHz channel band " << +i << ": " << Integral (filteredSignal));
-            double rxPowerPerBandW = Integral (filteredSignal) * DbToRatio (GetRxGain ());
-            totalRxPowerW += rxPowerPerBandW;
-            rxPowerW.insert ({filteredBand, rxPowerPerBandW});
-//            NS_LOG_DEBUG ("Signal power received after antenna gain for 20 MHz channel band " << +i << ": " << rxPowerPerBandW << " W (" << WToDbm (rxPowerPerBandW) << " dBm)");
-        }
 
 //        NS_LOG_DEBUG ("Total signal power received after antenna gain: " << totalRxPowerW << " W (" << WToDbm (totalRxPowerW) << " dBm)");
 //        Ptr<MmWaveSpectrumSignalParameters> mmWaveRxParams = DynamicCast<MmWaveSpectrumSignalParameters> (rxParams);
@@ -290,8 +322,9 @@ namespace ns3 {
         }
 
         NS_LOG_INFO ("Received signal");
-        Ptr<MmWavePpdu> ppdu = Copy (mmWaveRxParams->ppdu);
-        StartReceivePreamble (ppdu, rxPowerW);
+        // the PPDU is shared with the transmitter and the other receivers, only the
+        // per-receiver state (RX powers, SNR) is kept in the reception event
+        StartReceivePreamble (mmWaveRxParams->ppdu, rxPowerW);
     }
 
     void
@@ -303,10 +336,22 @@ namespace ns3 {
         m_mmWaveSpectrumPhyInterface->SetDevice (device);
     }
 
-    Ptr<SpectrumValue>
+    Ptr<const SpectrumValue>
     MmWaveSpectrumPhy::GetTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, MmWaveModulationClass modulationClass) const
     {
         NS_LOG_FUNCTION (this);
+        MmWaveTxPsdKey key = {centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth),
+                              m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection,
+                              m_txMaskOuterBandMaximumRejection, modulationClass};
+        auto it = g_mmWaveTxPsdIndex.find (key);
+        if (it != g_mmWaveTxPsdIndex.end ())
+        {
+            g_mmWaveTxPsdCacheHits++;
+            g_mmWaveTxPsdList.splice (g_mmWaveTxPsdList.begin (), g_mmWaveTxPsdList, it->second);
+            return it->second->second;
+        }
+        g_mmWaveTxPsdCacheMisses++;
+
         Ptr<SpectrumValue> v;
         switch (modulationClass)
         {
@@ -319,9 +364,65 @@ namespace ns3 {
                 NS_FATAL_ERROR ("modulation class unknown: " << modulationClass);
                 break;
         }
+        uint32_t cacheSize = GetTxPsdCacheSize ();
+        if (cacheSize > 0)
+        {
+            g_mmWaveTxPsdList.push_front (std::make_pair (key, v));
+            g_mmWaveTxPsdIndex[key] = g_mmWaveTxPsdList.begin ();
+        }
+        // the size may have been changed through the global value since the last miss
+        while (g_mmWaveTxPsdList.size () > cacheSize)
+        {
+            g_mmWaveTxPsdIndex.erase (g_mmWaveTxPsdList.back ().first);
+            g_mmWaveTxPsdList.pop_back ();
+        }
         return v;
     }
 
+    void
+    MmWaveSpectrumPhy::SetTxPsdCacheSize (uint32_t size)
+    {
+        NS_LOG_FUNCTION (size);
+        g_mmWaveTxPsdCacheSize.SetValue (UintegerValue (size));
+        while (g_mmWaveTxPsdList.size () > size)
+        {
+            g_mmWaveTxPsdIndex.erase (g_mmWaveTxPsdList.back ().first);
+            g_mmWaveTxPsdList.pop_back ();
+        }
+    }
+
+    uint32_t
+    MmWaveSpectrumPhy::GetTxPsdCacheSize ()
+    {
+        UintegerValue size;
+        g_mmWaveTxPsdCacheSize.GetValue (size);
+        return size.Get ();
+    }
+
+    uint64_t
+    MmWaveSpectrumPhy::GetTxPsdCacheHits ()
+    {
+        return g_mmWaveTxPsdCacheHits;
+    }
+
+    uint64_t
+    MmWaveSpectrumPhy::GetTxPsdCacheMisses ()
+    {
+        return g_mmWaveTxPsdCacheMisses;
+    }
+
+    uint64_t
+    MmWaveSpectrumPhy::DoGetTxPsdCacheHits () const
+    {
+        return g_mmWaveTxPsdCacheHits;
+    }
+
+    uint64_t
+    MmWaveSpectrumPhy::DoGetTxPsdCacheMisses () const
+    {
+        return g_mmWaveTxPsdCacheMisses;
+    }
+
     uint16_t
     MmWaveSpectrumPhy::GetCenterFrequencyForChannelWidth (MmWaveTxVector txVector) const
     {
@@ -345,10 +446,12 @@ namespace ns3 {
         double txPowerDbm = GetTxPowerForTransmission (txVector) + GetTxGain ();
 //        NS_LOG_DEBUG ("Start transmission: signal power before antenna gain=" << txPowerDbm << "dBm");
         double txPowerWatts = DbmToW (txPowerDbm);
-        Ptr<SpectrumValue> txPowerSpectrum = GetTxPowerSpectralDensity (GetCenterFrequencyForChannelWidth (txVector), txVector.GetChannelWidth (), txPowerWatts, ppdu->GetModulation ());
+        Ptr<const SpectrumValue> txPowerSpectrum = GetTxPowerSpectralDensity (GetCenterFrequencyForChannelWidth (txVector), txVector.GetChannelWidth (), txPowerWatts, ppdu->GetModulation ());
         Ptr<MmWaveSpectrumSignalParameters> txParams = Create<MmWaveSpectrumSignalParameters> ();
         txParams->duration = ppdu->GetTxDuration ();
-        txParams->psd = txPowerSpectrum;
+        // the cached PSD is shared with the other transmissions: the channel copies it
+        // for each receiver (SpectrumSignalParameters::Copy) before it applies the loss
+        txParams->psd = ConstCast<SpectrumValue> (txPowerSpectrum);
         NS_ASSERT_MSG (m_mmWaveSpectrumPhyInterface, "SpectrumPhy() is not set; maybe forgot to call CreateMmWaveSpectrumPhyInterface?");
         txParams->txPhy = m_mmWaveSpectrumPhyInterface->GetObject<SpectrumPhy> ();
         txParams->txAntenna = m_antenna;
@@ -391,26 +494,7 @@ namespace ns3 {
     MmWaveSpectrumPhy::GetBand (uint16_t bandWidth, uint8_t bandIndex)
     {
         NS_LOG_FUNCTION (this);
-        uint16_t channelWidth = GetChannelWidth ();
-        uint32_t bandBandwidth = GetBandBandwidth ();
-        size_t numBandsInChannel = static_cast<size_t> (channelWidth * 1e6 / bandBandwidth);
-        size_t numBandsInBand = static_cast<size_t> (bandWidth * 1e6 / bandBandwidth);
-        if (numBandsInBand % 2 == 0)
-        {
-            numBandsInChannel += 1; // symmetry around center frequency
-        }
-        size_t totalNumBands = GetRxSpectrumModel ()->GetNumBands ();
-        NS_ASSERT_MSG ((numBandsInChannel % 2 == 1) && (totalNumBands % 2 == 1), "Should have odd number of bands");
-        NS_ASSERT_MSG ((bandIndex * bandWidth) < channelWidth, "Band index is out of bound");
-        MmWaveSpectrumBand band;
-        band.first = ((totalNumBands - numBandsInChannel) / 2) + (bandIndex * numBandsInBand);
-        if (band.first >= totalNumBands / 2)
-        {
-            //step past DC
-            band.first += 1;
-        }
-        band.second = band.first + numBandsInBand - 1;
-        return band;
+        return MmWaveSpectrumValueHelper::GetBand (GetRxSpectrumModel ()->GetNumBands (), GetChannelWidth (), GetBandBandwidth (), bandWidth, bandIndex);
     }
 
 } //namespace ns3
\ No newline at end of file
@@ -41,18 +41,36 @@ namespace ns3 {
         virtual void SetChannelWidth (uint16_t channelwidth);
         virtual void ConfigureStandardAndBand (MmWavePhyStandard standard, MmWavePhyBand band);
 
+        // the transmit PSD cache and its counters are shared by all the PHYs of the simulation;
+        // the size is the MmWaveTxPsdCacheSize global value and the counters are also the
+        // read-only TxPsdCacheHits and TxPsdCacheMisses attributes
+        /// \param size the maximum number of cached transmit PSDs, 0 to disable the cache
+        static void SetTxPsdCacheSize (uint32_t size);
+        static uint32_t GetTxPsdCacheSize ();
+        static uint64_t GetTxPsdCacheHits ();
+        static uint64_t GetTxPsdCacheMisses ();
+
     protected:
         void DoDispose ();
         void DoInitialize ();
         MmWaveSpectrumBand GetBand (uint16_t bandWidth, uint8_t bandIndex = 0);
-        Ptr<SpectrumValue> GetTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, MmWaveModulationClass modulationClass) const;
+        /**
+         * The returned PSD may be shared with other transmissions and must not be modified;
+         * the channel copies it for each receiver before it applies the loss.
+         */
+        Ptr<const SpectrumValue> GetTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, MmWaveModulationClass modulationClass) const;
         void ResetSpectrumModel ();
         void UpdateInterferenceHelperBands ();
+        /// \return the number of transmit PSDs found in the shared cache, for the TxPsdCacheHits attribute
+        uint64_t DoGetTxPsdCacheHits () const;
+        /// \return the number of transmit PSDs built, for the TxPsdCacheMisses attribute
+        uint64_t DoGetTxPsdCacheMisses () const;
 
         Ptr<MmWaveSpectrumPhyInterface> m_mmWaveSpectrumPhyInterface;
         Ptr<AntennaModel> m_antenna;
         Ptr<SpectrumChannel> m_channel;
         mutable Ptr<const SpectrumModel> m_rxSpectrumModel;
+        Ptr<const MmWaveRfFilterBank> m_rfFilterBank; //!< Per-band RF filters of the current spectrum model, in band layout order
         bool m_disableReception;
         TracedCallback<bool, uint32_t, double, Time> m_signalCb;
         double m_txMaskInnerBandMinimumRejection; //!< The minimum rejection (in dBr) for the inner band of the transmit spectrum mask
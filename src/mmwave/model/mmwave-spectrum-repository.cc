@@ -1,4 +1,5 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include <algorithm>
 #include <cmath>
 #include "ns3/log.h"
 #include "ns3/type-id.h"
@@ -240,8 +241,25 @@ namespace ns3 {
         return m_vacancyRate;
     }
 
+    MmWaveSpectrumRepository::ChannelRecords::ChannelRecords ()
+            : firstId (0),
+              nRecords (0),
+              timeOrdered (true),
+              lastUpdateTime (Seconds (0.0)),
+              nPUs (0),
+              nSUs (0),
+              durationForPUs (0),
+              durationForSUs (0),
+              totalDuration (0),
+              powerDuration (0)
+    {
+    }
+
     MmWaveSpectrumRepository::MmWaveSpectrumRepository ()
-            : m_deltaNum (2),
+            : m_nRecords (0),
+              m_nGridRefs (0),
+              m_gridCellSize (50),
+              m_deltaNum (2),
               m_configure (false),
               m_channelToFrequencyWidthMapInitialized (false),
               m_isEachChannelDetected (false)
@@ -276,6 +294,11 @@ namespace ns3 {
                                MakeTimeAccessor (&MmWaveSpectrumRepository::SetMaxDelay,
                                                  &MmWaveSpectrumRepository::GetMaxDelay),
                                MakeTimeChecker ())
+                .AddAttribute ("GridCellSize", "The edge of the cells of the grid indexing the records by position (m)",
+                               DoubleValue (50),
+                               MakeDoubleAccessor (&MmWaveSpectrumRepository::SetGridCellSize,
+                                                   &MmWaveSpectrumRepository::GetGridCellSize),
+                               MakeDoubleChecker<double> (0.001))
                 .AddAttribute ("ThresholdForPUsActivity",
                                "If the occupancy rate of the unrecognized signal larger than this value, PU is considered to be active.",
                                DoubleValue (0.1),
@@ -293,7 +316,10 @@ namespace ns3 {
     MmWaveSpectrumRepository::DoDispose ()
     {
         NS_LOG_FUNCTION (this);
-        m_spectrumDataInfo.clear ();
+        m_records.clear ();
+        m_grid.clear ();
+        m_nRecords = 0;
+        m_nGridRefs = 0;
         m_statisticalInfo.clear ();
     }
 
@@ -339,6 +365,19 @@ namespace ns3 {
         return m_maxSize;
     }
 
+    void
+    MmWaveSpectrumRepository::SetGridCellSize (double size)
+    {
+        m_gridCellSize = size;
+        RebuildGrid ();
+    }
+
+    double
+    MmWaveSpectrumRepository::GetGridCellSize () const
+    {
+        return m_gridCellSize;
+    }
+
     void MmWaveSpectrumRepository::SetNetDevice (Ptr<NetDevice> device)
     {
         m_device = device;
@@ -371,20 +410,162 @@ namespace ns3 {
     void
     MmWaveSpectrumRepository::AddActivityInfoToRepository (MmWaveChannelNumberStandardPair channel, Ptr<MmWaveSpectrumData> data)
     {
-        m_spectrumDataInfo[channel].push_back (data);
+        ChannelRecords &records = m_records[channel];
+        if (records.nRecords != 0 && data->GetUpdateTime () < records.lastUpdateTime)
+        {
+            records.timeOrdered = false;
+        }
+        records.lastUpdateTime = data->GetUpdateTime ();
+        uint64_t id = records.firstId + records.ring.size ();
+        records.ring.push_back (data);
+        UpdateTotals (records, data, 1);
+        m_grid[GetGridCell (data->GetPosition ())].push_back ({channel, id});
+        m_nGridRefs++;
         CheckSizeExceeded ();
+        if (m_nGridRefs > 2 * m_nRecords + 64)
+        {
+            RebuildGrid ();
+        }
+    }
+
+    MmWaveSpectrumRepository::GridCell
+    MmWaveSpectrumRepository::GetGridCell (const Vector &position) const
+    {
+        return std::make_tuple (static_cast<int64_t> (std::floor (position.x / m_gridCellSize)),
+                                static_cast<int64_t> (std::floor (position.y / m_gridCellSize)),
+                                static_cast<int64_t> (std::floor (position.z / m_gridCellSize)));
+    }
+
+    Ptr<MmWaveSpectrumData>
+    MmWaveSpectrumRepository::GetRecord (const RecordRef &ref) const
+    {
+        auto records = m_records.find (ref.channel);
+        if (records == m_records.end ()
+            || ref.id < records->second.firstId
+            || ref.id >= records->second.firstId + records->second.ring.size ())
+        {
+            return 0;
+        }
+        return records->second.ring[ref.id - records->second.firstId];
+    }
+
+    void
+    MmWaveSpectrumRepository::UpdateTotals (ChannelRecords &records, Ptr<const MmWaveSpectrumData> data, int sign)
+    {
+        std::pair<Time, Time> window = std::make_pair (data->GetDetectionStart (), data->GetDetectionEnd ());
+        int64_t windowDuration = data->GetDetectionEnd ().GetMicroSeconds () - data->GetDetectionStart ().GetMicroSeconds ();
+        if (sign > 0)
+        {
+            if (records.windows[window]++ == 0)
+            {
+                records.totalDuration += windowDuration;
+            }
+        }
+        else
+        {
+            auto w = records.windows.find (window);
+            NS_ASSERT (w != records.windows.end ());
+            if (--w->second == 0)
+            {
+                records.totalDuration -= windowDuration;
+                records.windows.erase (w);
+            }
+        }
+
+        int64_t occupied = data->GetOccupiedDuration ().GetMicroSeconds ();
+        switch (data->GetChannelState ())
+        {
+            case UTILIZED_BY_PUs:
+                records.nPUs += sign;
+                records.durationForPUs += sign * occupied;
+                break;
+            case UTILIZED_BY_SUs:
+                records.nSUs += sign;
+                records.durationForSUs += sign * occupied;
+                break;
+            case UNUTILIZED:
+            default:
+                break;
+        }
+        records.nRecords += sign;
+        m_nRecords += sign;
+        // restart from an exact zero so that rounding errors do not accumulate
+        records.powerDuration = (records.nRecords == 0) ? 0 : records.powerDuration + sign * data->GetPower () * occupied;
+    }
+
+    void
+    MmWaveSpectrumRepository::RemoveRecord (ChannelRecords &records, uint64_t id)
+    {
+        Ptr<MmWaveSpectrumData> &slot = records.ring[id - records.firstId];
+        NS_ASSERT (slot != 0);
+        UpdateTotals (records, slot, -1);
+        slot = 0;
+        while (!records.ring.empty () && records.ring.front () == 0)
+        {
+            records.ring.pop_front ();
+            records.firstId++;
+        }
+        if (records.nRecords == 0)
+        {
+            records.timeOrdered = true;
+        }
+    }
+
+    void
+    MmWaveSpectrumRepository::CompactRecords ()
+    {
+        bool rebuild = false;
+        for (auto & i : m_records)
+        {
+            ChannelRecords &records = i.second;
+            if (records.ring.size () > 2 * records.nRecords + 64)
+            {
+                // renumber past the current ids so that stale references never match
+                std::deque<Ptr<MmWaveSpectrumData>> ring;
+                for (auto & j : records.ring)
+                {
+                    if (j != 0)
+                    {
+                        ring.push_back (j);
+                    }
+                }
+                records.firstId += records.ring.size ();
+                records.ring.swap (ring);
+                rebuild = true;
+            }
+        }
+        if (rebuild || m_nGridRefs > 2 * m_nRecords + 64)
+        {
+            RebuildGrid ();
+        }
+    }
+
+    void
+    MmWaveSpectrumRepository::RebuildGrid ()
+    {
+        m_grid.clear ();
+        m_nGridRefs = 0;
+        for (auto & i : m_records)
+        {
+            for (uint64_t j = 0; j < i.second.ring.size (); j++)
+            {
+                if (i.second.ring[j] != 0)
+                {
+                    m_grid[GetGridCell (i.second.ring[j]->GetPosition ())].push_back ({i.first, i.second.firstId + j});
+                    m_nGridRefs++;
+                }
+            }
+        }
     }
 
     void
     MmWaveSpectrumRepository::CheckSizeExceeded ()
     {
-        std::vector<Ptr<MmWaveSpectrumData>>::iterator j;
-        for (auto & i : m_spectrumDataInfo)
+        for (auto & i : m_records)
         {
-            j = i.second.begin ();
-            while (static_cast<int> (i.second.size ()) > GetMaxSize ())
+            while (static_cast<int> (i.second.nRecords) > GetMaxSize ())
             {
-                i.second.erase (j++);
+                RemoveRecord (i.second, i.second.firstId);
             }
         }
     }
@@ -392,51 +573,92 @@ namespace ns3 {
     void
     MmWaveSpectrumRepository::CheckTtlExceeded ()
     {
-        std::vector<Ptr<MmWaveSpectrumData>>::iterator j;
-        for (auto & i : m_spectrumDataInfo)
+        Time now = Simulator::Now ();
+        for (auto & i : m_records)
         {
-            j = i.second.begin ();
-            while (j != i.second.end ())
+            ChannelRecords &records = i.second;
+            if (records.timeOrdered)
             {
-                if (Simulator::Now () > (*j)->GetUpdateTime () + GetMaxDelay ())
+                // the oldest records are at the head of the ring
+                while (!records.ring.empty () && now > records.ring.front ()->GetUpdateTime () + GetMaxDelay ())
                 {
-                    i.second.erase (j++);
+                    RemoveRecord (records, records.firstId);
                 }
-                else
+                continue;
+            }
+            uint64_t id = records.firstId;
+            while (id < records.firstId + records.ring.size ())
+            {
+                Ptr<MmWaveSpectrumData> data = records.ring[id - records.firstId];
+                if (data != 0 && now > data->GetUpdateTime () + GetMaxDelay ())
                 {
-                    j++;
+                    RemoveRecord (records, id);
                 }
+                id = std::max (id + 1, records.firstId);
             }
         }
+        CompactRecords ();
     }
 
     void
     MmWaveSpectrumRepository::CheckRadiusExceeded (Vector aPos)
     {
-        std::vector<Ptr<MmWaveSpectrumData>>::iterator j;
-        Vector bPos;
-        double MaxRadius = std::pow (GetMaxRadius (), 2);
-        double d;
-        for (auto & i : m_spectrumDataInfo)
+        double maxRadius = GetMaxRadius () * GetMaxRadius ();
+        const double a[3] = {aPos.x, aPos.y, aPos.z};
+        auto cell = m_grid.begin ();
+        while (cell != m_grid.end ())
         {
-            j = i.second.begin ();
-            while (j != i.second.end ())
+            // bound the distance of every record of the cell before testing them one by one
+            const int64_t index[3] = {std::get<0> (cell->first), std::get<1> (cell->first), std::get<2> (cell->first)};
+            double minDistance = 0;
+            double maxDistance = 0;
+            for (int k = 0; k < 3; k++)
             {
-                bPos = (*j)->GetPosition ();
-                d = std::pow (aPos.x - bPos.x, 2)
-                    + std::pow (aPos.y - bPos.y, 2)
-                    + std::pow (aPos.z - bPos.z, 2);
+                double low = index[k] * m_gridCellSize;
+                double high = low + m_gridCellSize;
+                double nearest = std::min (std::max (a[k], low), high) - a[k];
+                double farthest = std::max (std::abs (a[k] - low), std::abs (a[k] - high));
+                minDistance += nearest * nearest;
+                maxDistance += farthest * farthest;
+            }
+            bool keepAll = (maxDistance <= maxRadius);
+            bool dropAll = (minDistance > maxRadius);
 
-                if (d > MaxRadius)
+            std::vector<RecordRef> &refs = cell->second;
+            size_t kept = 0;
+            for (auto & ref : refs)
+            {
+                Ptr<MmWaveSpectrumData> data = GetRecord (ref);
+                if (data == 0)
                 {
-                    i.second.erase (j++);
+                    continue;
                 }
-                else
+                if (!keepAll)
                 {
-                    j++;
+                    Vector bPos = data->GetPosition ();
+                    double d = (aPos.x - bPos.x) * (aPos.x - bPos.x)
+                               + (aPos.y - bPos.y) * (aPos.y - bPos.y)
+                               + (aPos.z - bPos.z) * (aPos.z - bPos.z);
+                    if (dropAll || d > maxRadius)
+                    {
+                        RemoveRecord (m_records[ref.channel], ref.id);
+                        continue;
+                    }
                 }
+                refs[kept++] = ref;
+            }
+            m_nGridRefs -= refs.size () - kept;
+            refs.resize (kept);
+            if (refs.empty ())
+            {
+                cell = m_grid.erase (cell);
+            }
+            else
+            {
+                cell++;
             }
         }
+        CompactRecords ();
     }
 
     void
@@ -505,94 +727,44 @@ namespace ns3 {
         {
             NS_FATAL_ERROR ("channel to frequency has not been initialized");
         }
-        std::map<std::pair<Time, Time>, ActivityDuration> recordList;
-        std::pair<Time, Time> startAndEnd;
-        bool valid;
-        bool isAnyPUs;
-        bool isAnySUs;
-        double avgPower;
-        double durationForPUs;
-        double durationForSUs;
-        double totalDuration;
-        ResetStatisticalInfo ();
+        // the totals are kept up to date as records are added and removed
+        m_statisticalInfo.clear ();
         for (auto & i : m_channelToFrequency)
         {
-            valid = false;
-            isAnyPUs = false;
-            isAnySUs = false;
-            avgPower = 0;
-            durationForPUs = 0;
-            durationForSUs = 0;
-            totalDuration = 0;
-            recordList.clear ();
-            for (auto & k : m_spectrumDataInfo[i.first])
-            {
-                valid = true;
-                startAndEnd = std::make_pair (k->GetDetectionStart (), k->GetDetectionEnd ());
-                auto g = recordList.find (startAndEnd);
-                if (g == recordList.end ())
-                {
-                    ActivityDuration info{};
-                    info.isAnyPUs = false;
-                    info.isAnySUs = false;
-                    info.durationForPUs = 0;
-                    info.durationForSUs = 0;
-                    info.totalDuration = k->GetDetectionEnd ().GetMicroSeconds () - k->GetDetectionStart ().GetMicroSeconds ();
-                    recordList[startAndEnd]= info;
-                }
-
-                switch (k->GetChannelState ())
-                {
-                    case UTILIZED_BY_PUs:
-                        recordList[startAndEnd].isAnyPUs = true;
-                        recordList[startAndEnd].durationForPUs += k->GetOccupiedDuration ().GetMicroSeconds ();
-                        break;
-                    case UTILIZED_BY_SUs:
-                        recordList[startAndEnd].isAnySUs = true;
-                        recordList[startAndEnd].durationForSUs += k->GetOccupiedDuration ().GetMicroSeconds ();
-                        break;
-                    case UNUTILIZED:
-                    default:
-                        break;
-                }
-            }
-
-            for (auto & j : recordList)
-            {
-                if (j.second.isAnyPUs)
-                {
-                    isAnyPUs = true;
-                }
-                if (j.second.isAnySUs)
-                {
-                    isAnySUs = true;
-                }
-                durationForPUs += j.second.durationForPUs;
-                durationForSUs += j.second.durationForSUs;
-                totalDuration += j.second.totalDuration;
-            }
-
-            for (auto & u : m_spectrumDataInfo[i.first])
-            {
-                avgPower += (u->GetPower() * u->GetOccupiedDuration ().GetMicroSeconds () / (durationForPUs + durationForSUs));
-            }
-
             Ptr<MmWaveSpectrumStatistical> statistic = Create<MmWaveSpectrumStatistical> ();
-            statistic->SetValid (valid);
-            statistic->SetAvgPower (avgPower);
-            statistic->SetPUs (isAnyPUs);
-            statistic->SetSUs (isAnySUs);
-            if (totalDuration == 0)
+            auto r = m_records.find (i.first);
+            if (r == m_records.end () || r->second.nRecords == 0)
             {
+                statistic->SetValid (false);
+                statistic->SetAvgPower (0);
+                statistic->SetPUs (false);
+                statistic->SetSUs (false);
                 statistic->SetUtilizationForPUs (0);
                 statistic->SetUtilizationForSUs (0);
                 statistic->SetVacancyRate (1);
             }
             else
             {
-                statistic->SetUtilizationForPUs (durationForPUs / totalDuration);
-                statistic->SetUtilizationForSUs (durationForSUs / totalDuration);
-                statistic->SetVacancyRate ((totalDuration - durationForPUs - durationForSUs) / totalDuration);
+                const ChannelRecords &records = r->second;
+                double durationForPUs = records.durationForPUs;
+                double durationForSUs = records.durationForSUs;
+                double totalDuration = records.totalDuration;
+                statistic->SetValid (true);
+                statistic->SetAvgPower (records.powerDuration / (durationForPUs + durationForSUs));
+                statistic->SetPUs (records.nPUs != 0);
+                statistic->SetSUs (records.nSUs != 0);
+                if (totalDuration == 0)
+                {
+                    statistic->SetUtilizationForPUs (0);
+                    statistic->SetUtilizationForSUs (0);
+                    statistic->SetVacancyRate (1);
+                }
+                else
+                {
+                    statistic->SetUtilizationForPUs (durationForPUs / totalDuration);
+                    statistic->SetUtilizationForSUs (durationForSUs / totalDuration);
+                    statistic->SetVacancyRate ((totalDuration - durationForPUs - durationForSUs) / totalDuration);
+                }
             }
 
             m_statisticalInfo[i.first] = statistic;
@@ -627,7 +799,7 @@ namespace ns3 {
         int minNum;
         if (m_statisticalInfo[c]->IsValid ())
         {
-            for (auto i : m_statisticalInfo)
+            for (const auto & i : m_statisticalInfo)
             {
                 if (i.second->IsValid ())
                 {
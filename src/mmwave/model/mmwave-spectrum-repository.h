@@ -1,7 +1,9 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #ifndef CR_REPOSITORY_H
 #define CR_REPOSITORY_H
+#include <deque>
 #include <map>
+#include <tuple>
 #include <vector>
 #include "ns3/vector.h"
 #include "ns3/nstime.h"
@@ -105,7 +107,6 @@ namespace ns3 {
         };
 
         typedef std::map<MmWaveChannelNumberStandardPair, Ptr <MmWaveSpectrumStatistical>> StatisticalInfo;
-        typedef std::map<MmWaveChannelNumberStandardPair, std::vector<Ptr<MmWaveSpectrumData>>> SpectrumDataInfo;
 
         void CheckTtlExceeded ();
         void CheckSizeExceeded ();
@@ -113,6 +114,7 @@ namespace ns3 {
         void SetMaxDelay (Time delay);
         void SetMaxRadius (double radius);
         void SetMaxSize (int size);
+        void SetGridCellSize (double size);
         void SetNetDevice (Ptr<NetDevice> device);
         void SetChannelToFrequencyWidth (MmWavePhyStandard standard, MmWavePhyBand band);
         void AddActivityInfoToRepository (MmWaveChannelNumberStandardPair channel, Ptr<MmWaveSpectrumData> data);
@@ -122,15 +124,56 @@ namespace ns3 {
         bool IsEachChannelDetected (Vector position);
         double GetMaxRadius () const;
         int GetMaxSize () const;
+        double GetGridCellSize () const;
         Time GetMaxDelay () const;
         Ptr<NetDevice> GetNetDevice () const;
         Ptr<MmWaveSpectrumStatistical> GetStatisticalInfo (Vector position, MmWaveChannelNumberStandardPair channel);
         StatisticalInfo GetAllStatisticalInfo (Vector position);
         MmWaveChannelNumberStandardPair GetRecommendedChannel (MmWaveChannelNumberStandardPair c, Vector position, MmWaveNeighborDevices neighbors);
     protected:
+        /**
+         * The records of one channel, in a time-ordered ring buffer, along with the
+         * running totals its statistical information is derived from. Records are
+         * identified by a sequence number; removed records leave a null slot until
+         * they reach the head of the ring or the ring is compacted.
+         */
+        struct ChannelRecords
+        {
+            ChannelRecords ();
+            std::deque<Ptr<MmWaveSpectrumData>> ring;           //!< records, oldest first
+            uint64_t firstId;                                   //!< sequence number of the record at the head of the ring
+            uint32_t nRecords;                                  //!< number of records in the ring
+            bool timeOrdered;                                   //!< whether update times never decrease along the ring
+            Time lastUpdateTime;                                //!< update time of the last record added
+            std::map<std::pair<Time, Time>, uint32_t> windows;  //!< number of records per detection window
+            uint32_t nPUs;                                      //!< number of records utilized by PUs
+            uint32_t nSUs;                                      //!< number of records utilized by SUs
+            int64_t durationForPUs;                             //!< occupied duration by PUs, in microseconds
+            int64_t durationForSUs;                             //!< occupied duration by SUs, in microseconds
+            int64_t totalDuration;                              //!< duration of the distinct detection windows, in microseconds
+            double powerDuration;                               //!< sum of power times occupied duration (microseconds)
+        };
+        struct RecordRef
+        {
+            MmWaveChannelNumberStandardPair channel;
+            uint64_t id;
+        };
+        typedef std::tuple<int64_t, int64_t, int64_t> GridCell;
+
+        GridCell GetGridCell (const Vector &position) const;
+        Ptr<MmWaveSpectrumData> GetRecord (const RecordRef &ref) const;
+        void UpdateTotals (ChannelRecords &records, Ptr<const MmWaveSpectrumData> data, int sign);
+        void RemoveRecord (ChannelRecords &records, uint64_t id);
+        void CompactRecords ();
+        void RebuildGrid ();
+
         MmWavePhyStandard m_standard;
         MmWavePhyBand m_band;
-        SpectrumDataInfo m_spectrumDataInfo;
+        std::map<MmWaveChannelNumberStandardPair, ChannelRecords> m_records; //!< per-channel records
+        std::map<GridCell, std::vector<RecordRef>> m_grid;                   //!< records by position (may hold removed ones)
+        uint32_t m_nRecords;                      //!< number of records in all channels
+        uint32_t m_nGridRefs;                     //!< number of references held by the grid
+        double m_gridCellSize;                    //!< edge of a grid cell, in meters
         StatisticalInfo m_statisticalInfo;
         MmWaveChannelToFrequencyWidthMap m_channelToFrequency;
         Ptr<NetDevice> m_device;
@@ -0,0 +1,52 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/log.h"
+#include "mmwave-spectrum-transmit-filter.h"
+#include "mmwave-spectrum-signal-parameters.h"
+#include "mmwave-spectrum-phy-interface.h"
+#include "mmwave-spectrum-phy.h"
+
+namespace ns3 {
+
+    NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumTransmitFilter");
+    NS_OBJECT_ENSURE_REGISTERED (MmWaveSpectrumTransmitFilter);
+
+    TypeId
+    MmWaveSpectrumTransmitFilter::GetTypeId ()
+    {
+        static TypeId tid = TypeId ("ns3::MmWaveSpectrumTransmitFilter")
+                .SetParent<SpectrumTransmitFilter> ()
+                .SetGroupName ("MmWave")
+                .AddConstructor<MmWaveSpectrumTransmitFilter> ()
+        ;
+        return tid;
+    }
+
+    MmWaveSpectrumTransmitFilter::MmWaveSpectrumTransmitFilter ()
+    {
+        NS_LOG_FUNCTION (this);
+    }
+
+    bool
+    MmWaveSpectrumTransmitFilter::DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiverPhy)
+    {
+        NS_LOG_FUNCTION (this << params << receiverPhy);
+        Ptr<const MmWaveSpectrumSignalParameters> mmWaveParams = DynamicCast<const MmWaveSpectrumSignalParameters> (params);
+        if (mmWaveParams == 0 || mmWaveParams->channel == 0)
+        {
+            return false;
+        }
+        Ptr<const MmWaveSpectrumPhyInterface> interface = DynamicCast<const MmWaveSpectrumPhyInterface> (receiverPhy);
+        if (interface == 0)
+        {
+            return false;
+        }
+        Ptr<MmWaveSpectrumPhy> phy = interface->GetPhy ();
+        if (phy == 0)
+        {
+            return false;
+        }
+        // same test as MmWaveSpectrumPhy::StartRx
+        return !mmWaveParams->channel->IsMatch (phy->GetPhyStandard (), phy->GetPhyBand (), phy->GetChannelNumber (), phy->GetFrequency (), phy->GetChannelWidth ());
+    }
+
+} // namespace ns3
@@ -0,0 +1,28 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MMWAVE_SPECTRUM_TRANSMIT_FILTER_H
+#define MMWAVE_SPECTRUM_TRANSMIT_FILTER_H
+#include "ns3/spectrum-transmit-filter.h"
+
+namespace ns3 {
+
+    /**
+     * Skip the mmWave receivers that are not tuned to the channel of a mmWave signal.
+     *
+     * The channel already groups its receivers by spectrum model, i.e. by center
+     * frequency and width; this filter checks the remaining fields of the channel
+     * (standard, band and channel number) so that the propagation loss and the
+     * received PSD are only computed for the receivers that MmWaveSpectrumPhy::StartRx
+     * would not drop. Signals and receivers of other technologies are never filtered.
+     */
+    class MmWaveSpectrumTransmitFilter : public SpectrumTransmitFilter
+    {
+    public:
+        static TypeId GetTypeId ();
+        MmWaveSpectrumTransmitFilter ();
+
+    private:
+        bool DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiverPhy);
+    };
+
+} // namespace ns3
+#endif //MMWAVE_SPECTRUM_TRANSMIT_FILTER_H
@@ -1,10 +1,12 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <map>
 #include <cmath>
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/fatal-error.h"
 #include "ns3/assert.h"
 #include "mmwave-spectrum-value-helper.h"
+#include "mmwave-psd-kernels.h"
 namespace ns3 {
 
     NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumValueHelper");
@@ -47,6 +49,90 @@ namespace ns3 {
     }
 
     static std::map<MmWaveSpectrumModelId, Ptr<SpectrumModel> > g_mmWaveSpectrumModelMap; ///< static initializer for the class
+    static std::map<MmWaveSpectrumModelId, Ptr<const MmWaveRfFilterBank> > g_mmWaveRfFilterBankMap; ///< filter banks shared by all PHYs
+    static std::map<SpectrumModelUid_t, std::vector<double> > g_mmWaveBandWidthsMap; ///< band widths (Hz) of each spectrum model
+
+    MmWaveRfFilterBank::MmWaveRfFilterBank (Ptr<const SpectrumModel> model, uint16_t channelWidth, uint32_t bandBandwidth)
+            : m_spectrumModel (model),
+              m_firstIndex (0)
+    {
+        NS_LOG_FUNCTION (this << model << channelWidth << bandBandwidth);
+        // same band ordering as the reception loop: widest bands first, 20 MHz bands last
+        for (uint16_t bw = 1280; bw >= 20; bw = bw / 2)
+        {
+            for (uint8_t i = 0; i < (channelWidth / bw); i++)
+            {
+                m_bands.push_back (MmWaveSpectrumValueHelper::GetBand (model->GetNumBands (), channelWidth, bandBandwidth, bw, i));
+                m_widths.push_back (bw);
+            }
+        }
+        if (m_bands.empty ())
+        {
+            return;
+        }
+        uint32_t lastIndex = 0;
+        m_firstIndex = m_bands.front ().first;
+        for (const auto & band : m_bands)
+        {
+            m_firstIndex = std::min (m_firstIndex, band.first);
+            lastIndex = std::max (lastIndex, band.second);
+        }
+        NS_ASSERT (lastIndex < model->GetNumBands ());
+        Bands::const_iterator bit = model->Begin () + m_firstIndex;
+        for (uint32_t i = m_firstIndex; i <= lastIndex; i++, bit++)
+        {
+            m_bandWidthsHz.push_back (bit->fh - bit->fl);
+        }
+    }
+
+    std::size_t
+    MmWaveRfFilterBank::GetNFilters () const
+    {
+        return m_bands.size ();
+    }
+
+    MmWaveSpectrumBand
+    MmWaveRfFilterBank::GetFilterBand (std::size_t index) const
+    {
+        NS_ASSERT (index < m_bands.size ());
+        return m_bands[index];
+    }
+
+    uint16_t
+    MmWaveRfFilterBank::GetFilterWidth (std::size_t index) const
+    {
+        NS_ASSERT (index < m_widths.size ());
+        return m_widths[index];
+    }
+
+    Ptr<const SpectrumModel>
+    MmWaveRfFilterBank::GetSpectrumModel () const
+    {
+        return m_spectrumModel;
+    }
+
+    void
+    MmWaveRfFilterBank::Integrate (const SpectrumValue &psd, double *powerW) const
+    {
+        NS_ASSERT_MSG (psd.GetSpectrumModelUid () == m_spectrumModel->GetUid (), "PSD does not match the filter bank spectrum model");
+        if (m_bands.empty ())
+        {
+            return;
+        }
+        // the filter banks are shared by all the PHYs: the prefix sums live in a per-thread buffer
+        static thread_local std::vector<double> prefix;
+        prefix.resize (m_bandWidthsHz.size () + 1);
+        prefix[0] = 0.0;
+        MmWavePsdKernels::Multiply (&psd.ValuesAt (m_firstIndex), m_bandWidthsHz.data (), prefix.data () + 1, m_bandWidthsHz.size ());
+        for (std::size_t i = 1; i < prefix.size (); i++)
+        {
+            prefix[i] += prefix[i - 1];
+        }
+        for (std::size_t k = 0; k < m_bands.size (); k++)
+        {
+            powerW[k] = prefix[m_bands[k].second + 1 - m_firstIndex] - prefix[m_bands[k].first - m_firstIndex];
+        }
+    }
 
     Ptr<SpectrumModel>
     MmWaveSpectrumValueHelper::GetSpectrumModel (uint32_t centerFrequency, uint16_t channelWidth, uint32_t bandBandwidth, uint16_t guardBandwidth)
@@ -437,7 +523,7 @@ namespace ns3 {
         double noisePowerSpectralDensity =  kT_W_Hz * noiseFigureLinear;
 
         Ptr<SpectrumValue> noisePsd = Create <SpectrumValue> (spectrumModel);
-        (*noisePsd) = noisePowerSpectralDensity;
+        MmWavePsdKernels::Fill (&(*noisePsd)[0], noisePowerSpectralDensity, noisePsd->GetValuesN ());
         NS_LOG_INFO ("NoisePowerSpectralDensity has integrated power of " << Integral (*noisePsd));
         return noisePsd;
     }
@@ -461,6 +547,60 @@ namespace ns3 {
         return c;
     }
 
+    Ptr<const MmWaveRfFilterBank>
+    MmWaveSpectrumValueHelper::GetRfFilterBank (uint32_t centerFrequency, uint16_t channelWidth, uint32_t bandBandwidth, uint16_t guardBandwidth)
+    {
+        NS_LOG_FUNCTION (centerFrequency << channelWidth << bandBandwidth << guardBandwidth);
+        MmWaveSpectrumModelId key (centerFrequency, channelWidth, bandBandwidth, guardBandwidth);
+        std::map<MmWaveSpectrumModelId, Ptr<const MmWaveRfFilterBank> >::iterator it = g_mmWaveRfFilterBankMap.find (key);
+        if (it != g_mmWaveRfFilterBankMap.end ())
+        {
+            return it->second;
+        }
+        Ptr<const MmWaveRfFilterBank> filterBank = Create<MmWaveRfFilterBank> (GetSpectrumModel (centerFrequency, channelWidth, bandBandwidth, guardBandwidth), channelWidth, bandBandwidth);
+        g_mmWaveRfFilterBankMap.insert (std::make_pair (key, filterBank));
+        return filterBank;
+    }
+
+    const std::vector<double> &
+    MmWaveSpectrumValueHelper::GetBandWidths (Ptr<const SpectrumModel> model)
+    {
+        auto it = g_mmWaveBandWidthsMap.find (model->GetUid ());
+        if (it == g_mmWaveBandWidthsMap.end ())
+        {
+            std::vector<double> widths;
+            widths.reserve (model->GetNumBands ());
+            for (Bands::const_iterator bit = model->Begin (); bit != model->End (); bit++)
+            {
+                widths.push_back (bit->fh - bit->fl);
+            }
+            it = g_mmWaveBandWidthsMap.insert (std::make_pair (model->GetUid (), widths)).first;
+        }
+        return it->second;
+    }
+
+    MmWaveSpectrumBand
+    MmWaveSpectrumValueHelper::GetBand (std::size_t totalNumBands, uint16_t channelWidth, uint32_t bandBandwidth, uint16_t bandWidth, uint8_t bandIndex)
+    {
+        size_t numBandsInChannel = static_cast<size_t> (channelWidth * 1e6 / bandBandwidth);
+        size_t numBandsInBand = static_cast<size_t> (bandWidth * 1e6 / bandBandwidth);
+        if (numBandsInBand % 2 == 0)
+        {
+            numBandsInChannel += 1; // symmetry around center frequency
+        }
+        NS_ASSERT_MSG ((numBandsInChannel % 2 == 1) && (totalNumBands % 2 == 1), "Should have odd number of bands");
+        NS_ASSERT_MSG ((bandIndex * bandWidth) < channelWidth, "Band index is out of bound");
+        MmWaveSpectrumBand band;
+        band.first = ((totalNumBands - numBandsInChannel) / 2) + (bandIndex * numBandsInBand);
+        if (band.first >= totalNumBands / 2)
+        {
+            //step past DC
+            band.first += 1;
+        }
+        band.second = band.first + numBandsInBand - 1;
+        return band;
+    }
+
     void
     MmWaveSpectrumValueHelper::CreateSpectrumMaskForOfdm (Ptr<SpectrumValue> c, std::vector <MmWaveSpectrumBand> allocatedSubBands, MmWaveSpectrumBand maskBand,
                                                         double txPowerPerBandW, uint32_t nGuardBands, uint32_t innerSlopeWidth,
@@ -509,72 +649,91 @@ namespace ns3 {
         double middleSlope = (-1 * (minOuterBandDbr - minInnerBandDbr)) / middleSlopeWidth;
         double outerSlope = (txPowerMiddleBandMinDbm - txPowerOuterBandMinDbm) / outerSlopeWidth;
 
-        //Build spectrum mask
-        Values::iterator vit = c->ValuesBegin ();
-        Bands::const_iterator bit = c->ConstBandsBegin ();
-        double txPowerW = 0.0;
-        for (size_t i = 0; i < numBands; i++, vit++, bit++)
+        //Build spectrum mask: the power (W) of each band is written segment by segment, from the
+        //lowest to the highest priority segment so that overlapping segments resolve as before, and
+        //only the slopes need a dBm conversion per band
+        double *powerW = &(*c)[0];
+        auto paint = [numBands] (MmWaveSpectrumBand segment, uint32_t &first, uint32_t &last)
         {
-            if (i < maskBand.first || i > maskBand.second) //outside the spectrum mask
-            {
-                txPowerW = 0.0;
-            }
-            else if (i <= outerBandLeft.second && i >= outerBandLeft.first) //better to put greater first (less computation)
-            {
-                txPowerW = DbmToW (txPowerOuterBandMinDbm + ((i - outerBandLeft.first) * outerSlope));
-            }
-            else if (i <= middleBandLeft.second && i >= middleBandLeft.first)
+            first = segment.first;
+            last = std::min<uint32_t> (segment.second, numBands - 1);
+            return first <= last;
+        };
+        uint32_t first;
+        uint32_t last;
+        if (paint (outerBandRight, first, last))
+        {
+            for (size_t i = first; i <= last; i++)
             {
-                txPowerW = DbmToW (txPowerMiddleBandMinDbm + ((i - middleBandLeft.first) * middleSlope));
+                powerW[i] = DbmToW (txPowerMiddleBandMinDbm - ((i - outerBandRight.first + 1) * outerSlope)); // +1 so as to be symmetric with left slope
             }
-            else if (i <= flatJunctionLeft.second && i >= flatJunctionLeft.first)
+        }
+        if (paint (middleBandRight, first, last))
+        {
+            for (size_t i = first; i <= last; i++)
             {
-                txPowerW = DbmToW (txPowerInnerBandMinDbm);
+                powerW[i] = DbmToW (txPowerInnerBandMinDbm - ((i - middleBandRight.first + 1) * middleSlope)); // +1 so as to be symmetric with left slope
             }
-            else if (i <= innerBandLeft.second && i >= innerBandLeft.first)
+        }
+        double txPowerInnerBandMinW = DbmToW (txPowerInnerBandMinDbm);
+        if (paint (flatJunctionRight, first, last))
+        {
+            MmWavePsdKernels::Fill (powerW + first, txPowerInnerBandMinW, last - first + 1);
+        }
+        if (paint (innerBandRight, first, last))
+        {
+            for (size_t i = first; i <= last; i++)
             {
-                txPowerW = DbmToW (txPowerInnerBandMinDbm + ((i - innerBandLeft.first) * innerSlope));
+                powerW[i] = DbmToW (txPowerRefDbm - ((i - innerBandRight.first + 1) * innerSlope)); // +1 so as to be symmetric with left slope
             }
-            else if (i <= allocatedSubBands.back ().second && i >= allocatedSubBands.front ().first) //roughly in allocated band
+        }
+        if (paint (MmWaveSpectrumBand (allocatedSubBands.front ().first, allocatedSubBands.back ().second), first, last)) //roughly in allocated band
+        {
+            MmWavePsdKernels::Fill (powerW + first, txPowerInnerBandMinW, last - first + 1);
+            for (const auto & subBand : allocatedSubBands)
             {
-                bool insideSubBand = false;
-                for (uint32_t j = 0; !insideSubBand && j < numSubBands; j++) //continue until inside a sub-band
+                uint32_t subFirst = std::max (subBand.first, first);
+                uint32_t subLast = std::min (subBand.second, last);
+                if (subFirst <= subLast)
                 {
-                    insideSubBand = (i <= allocatedSubBands[j].second) && (i >= allocatedSubBands[j].first);
+                    MmWavePsdKernels::Fill (powerW + subFirst, txPowerPerBandW, subLast - subFirst + 1);
                 }
-                if (insideSubBand)
-                {
-                    txPowerW = txPowerPerBandW;
-                }
-                else
-                {
-                    txPowerW = DbmToW (txPowerInnerBandMinDbm);
-                }
-            }
-            else if (i <= innerBandRight.second && i >= innerBandRight.first)
-            {
-                txPowerW = DbmToW (txPowerRefDbm - ((i - innerBandRight.first + 1) * innerSlope)); // +1 so as to be symmetric with left slope
             }
-            else if (i <= flatJunctionRight.second && i >= flatJunctionRight.first)
-            {
-                txPowerW = DbmToW (txPowerInnerBandMinDbm);
-            }
-            else if (i <= middleBandRight.second && i >= middleBandRight.first)
+        }
+        if (paint (innerBandLeft, first, last))
+        {
+            for (size_t i = first; i <= last; i++)
             {
-                txPowerW = DbmToW (txPowerInnerBandMinDbm - ((i - middleBandRight.first + 1) * middleSlope)); // +1 so as to be symmetric with left slope
+                powerW[i] = DbmToW (txPowerInnerBandMinDbm + ((i - innerBandLeft.first) * innerSlope));
             }
-            else if (i <= outerBandRight.second && i >= outerBandRight.first)
+        }
+        if (paint (flatJunctionLeft, first, last))
+        {
+            MmWavePsdKernels::Fill (powerW + first, txPowerInnerBandMinW, last - first + 1);
+        }
+        if (paint (middleBandLeft, first, last))
+        {
+            for (size_t i = first; i <= last; i++)
             {
-                txPowerW = DbmToW (txPowerMiddleBandMinDbm - ((i - outerBandRight.first + 1) * outerSlope)); // +1 so as to be symmetric with left slope
+                powerW[i] = DbmToW (txPowerMiddleBandMinDbm + ((i - middleBandLeft.first) * middleSlope));
             }
-            else
+        }
+        if (paint (outerBandLeft, first, last)) //better to put greater first (less computation)
+        {
+            for (size_t i = first; i <= last; i++)
             {
-                NS_FATAL_ERROR ("Should have handled all cases");
+                powerW[i] = DbmToW (txPowerOuterBandMinDbm + ((i - outerBandLeft.first) * outerSlope));
             }
-            double txPowerDbr = 10 * std::log10 (txPowerW / txPowerPerBandW);
-            NS_LOG_LOGIC (uint32_t (i) << " -> " << txPowerDbr);
-            *vit = txPowerW / (bit->fh - bit->fl);
         }
+        //outside the spectrum mask
+        MmWavePsdKernels::Fill (powerW, 0.0, std::min (maskBand.first, numBands));
+        if (maskBand.second + 1 < numBands)
+        {
+            MmWavePsdKernels::Fill (powerW + maskBand.second + 1, 0.0, numBands - maskBand.second - 1);
+        }
+
+        //convert to power spectral density
+        MmWavePsdKernels::Divide (powerW, GetBandWidths (c->GetSpectrumModel ()).data (), powerW, numBands);
         NS_LOG_INFO ("Added signal power to subbands " << allocatedSubBands.front ().first << "-" << allocatedSubBands.back ().second);
     }
 
@@ -583,14 +742,11 @@ namespace ns3 {
     {
         NS_LOG_FUNCTION (c << txPowerW);
         //Normalize power so that total signal power equals transmit power
-        double currentTxPowerW = Integral (*c);
+        uint32_t numBands = c->GetSpectrumModel ()->GetNumBands ();
+        double currentTxPowerW = MmWavePsdKernels::Dot (&(*c)[0], GetBandWidths (c->GetSpectrumModel ()).data (), numBands);
         double normalizationRatio = currentTxPowerW / txPowerW;
         NS_LOG_LOGIC ("Current power: " << currentTxPowerW << "W vs expected power: " << txPowerW << "W" << " -> ratio (C/E) = " << normalizationRatio);
-        Values::iterator vit = c->ValuesBegin ();
-        for (size_t i = 0; i < c->GetSpectrumModel ()->GetNumBands (); i++, vit++)
-        {
-            *vit = (*vit) / normalizationRatio;
-        }
+        MmWavePsdKernels::DivideByScalar (&(*c)[0], normalizationRatio, numBands);
     }
 
     double
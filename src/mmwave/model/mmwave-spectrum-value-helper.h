@@ -1,7 +1,9 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #ifndef MMWAVE_SPECTRUM_VALUE_HELPER_H
 #define MMWAVE_SPECTRUM_VALUE_HELPER_H
+#include <vector>
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/spectrum-value.h"
 #include "ns3/spectrum-model.h"
 
@@ -9,6 +11,35 @@ namespace ns3 {
 
     typedef std::pair<uint32_t, uint32_t> MmWaveSpectrumBand;
 
+    /**
+     * Set of rectangular RF filters covering every 1280/640/.../20 MHz band of a
+     * channel. Each filter is stored as a [start, stop] subcarrier index range, so
+     * the power of all bands can be obtained from a single prefix-sum pass over a
+     * received PSD instead of building and multiplying one filter SpectrumValue per band.
+     */
+    class MmWaveRfFilterBank : public SimpleRefCount<MmWaveRfFilterBank>
+    {
+    public:
+        MmWaveRfFilterBank (Ptr<const SpectrumModel> model, uint16_t channelWidth, uint32_t bandBandwidth);
+
+        std::size_t GetNFilters () const;
+        MmWaveSpectrumBand GetFilterBand (std::size_t index) const;
+        uint16_t GetFilterWidth (std::size_t index) const;
+        Ptr<const SpectrumModel> GetSpectrumModel () const;
+        /**
+         * \param psd the received power spectral density (must use this filter bank's spectrum model)
+         * \param powerW array of GetNFilters () elements receiving the integrated power (W) of each filter
+         */
+        void Integrate (const SpectrumValue &psd, double *powerW) const;
+
+    private:
+        Ptr<const SpectrumModel> m_spectrumModel;
+        std::vector<MmWaveSpectrumBand> m_bands;  //!< subcarrier index range of each filter
+        std::vector<uint16_t> m_widths;           //!< width (MHz) of each filter
+        std::vector<double> m_bandWidthsHz;       //!< width (Hz) of each subcarrier covered by the filters
+        uint32_t m_firstIndex;                    //!< first subcarrier covered by any filter
+    };
+
     class MmWaveSpectrumValueHelper
     {
     public:
@@ -19,6 +50,9 @@ namespace ns3 {
         static Ptr<SpectrumValue> CreateNoisePowerSpectralDensity (uint32_t centerFrequency, uint16_t channelWidth, uint32_t bandBandwidth, double noiseFigure, uint16_t guardBandwidth);
         static Ptr<SpectrumValue> CreateNoisePowerSpectralDensity (double noiseFigure, Ptr<SpectrumModel> spectrumModel);
         static Ptr<SpectrumValue> CreateRfFilter (uint32_t centerFrequency, uint16_t totalChannelWidth, uint32_t bandBandwidth, uint16_t guardBandwidth, MmWaveSpectrumBand band);
+        static Ptr<const MmWaveRfFilterBank> GetRfFilterBank (uint32_t centerFrequency, uint16_t channelWidth, uint32_t bandBandwidth, uint16_t guardBandwidth);
+        static const std::vector<double> & GetBandWidths (Ptr<const SpectrumModel> model);
+        static MmWaveSpectrumBand GetBand (std::size_t totalNumBands, uint16_t channelWidth, uint32_t bandBandwidth, uint16_t bandWidth, uint8_t bandIndex);
         static void CreateSpectrumMaskForOfdm (Ptr<SpectrumValue> c, std::vector <MmWaveSpectrumBand> allocatedSubBands, MmWaveSpectrumBand maskBand, double txPowerPerBandW, uint32_t nGuardBands, uint32_t innerSlopeWidth, double minInnerBandDbr, double minOuterbandDbr, double lowestPointDbr);
         static void NormalizeSpectrumMask (Ptr<SpectrumValue> c, double txPowerW);
         static double DbmToW (double dbm);
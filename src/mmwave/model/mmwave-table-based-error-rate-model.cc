@@ -65,67 +65,59 @@ namespace ns3 {
         return mcs;
     }
 
+    /**
+     * Interpolate the PER of one MCS at the given SNR.
+     *
+     * \param table the flattened table
+     * \param index the location of the MCS in the table
+     * \param step the SNR (dB) between two entries of the table
+     * \param snr the SNR (dB), already rounded
+     * \return the PER
+     */
+    static double
+    InterpolatePer (const double *table, const MmWaveAwgnErrorTableIndex &index, double step, double snr)
+    {
+        double x = (snr - index.minSnr) / step;
+        if (x < 0)
+        {
+            return 1.0;
+        }
+        // the tolerance absorbs the rounding of SNRs that fall on a grid point
+        std::size_t i = static_cast<std::size_t> (x + 1e-9);
+        if (i >= index.size - 1u)
+        {
+            return (x > index.size - 1 + 1e-9) ? 0.0 : table[index.offset + index.size - 1];
+        }
+        double a = table[index.offset + i];
+        double b = table[index.offset + i + 1];
+        return a + std::max (x - i, 0.0) * (b - a);
+    }
+
     double
-    MmWaveTableBasedErrorRateModel::DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const
+    MmWaveTableBasedErrorRateModel::GetTableChunkSuccessRate (uint8_t mcs, bool ldpc, double snr, uint64_t nbits) const
     {
-        NS_LOG_FUNCTION (this << mode << txVector << snr << nbits);
         uint64_t size = std::max<uint64_t> (1, (nbits / 8));
         double roundedSnr = RoundSnr (RatioToDb (snr), SNR_PRECISION);
-        uint8_t mcs = GetMcsForMode (mode);
-        bool ldpc = txVector.IsLdpc ();
         NS_LOG_FUNCTION (this << +mcs << roundedSnr << size << ldpc);
-        
-        if (mcs > (ldpc ? MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS : MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS))
-        {
-            NS_LOG_WARN ("Table missing for MCS: " << +mcs << " in MmWaveTableBasedErrorRateModel: use fallback error rate model");
-            return m_fallbackErrorModel->GetChunkSuccessRate (mode, txVector, snr, nbits);
-        }
 
-        auto errorTable = (ldpc ? MmWaveAwgnErrorTableLdpc1458 : (size < m_threshold ? MmWaveAwgnErrorTableBcc32 : MmWaveAwgnErrorTableBcc1458));
-        auto itVector = errorTable[mcs];
-        auto itTable = std::find_if (itVector.begin(), itVector.end(),
-                                     [&roundedSnr](const std::pair<double, double>& element) {
-                                         return element.first == roundedSnr;
-                                     });
-        double minSnr = itVector.begin ()->first;
-        double maxSnr = (--itVector.end ())->first;
         double per;
-        if (itTable == itVector.end ())
+        uint16_t tableSize;
+        if (ldpc)
         {
-            if (roundedSnr < minSnr)
-            {
-                per = 1.0;
-            }
-            else if (roundedSnr > maxSnr)
-            {
-                per = 0.0;
-            }
-            else
-            {
-                double a = 0.0, b = 0.0, previousSnr = 0.0, nextSnr = 0.0;
-                for (auto i = itVector.begin (); i != itVector.end (); ++i)
-                {
-                    if (i->first < roundedSnr)
-                    {
-                        previousSnr = i->first;
-                        a = i->second;
-                    }
-                    else
-                    {
-                        nextSnr = i->first;
-                        b = i->second;
-                        break;
-                    }
-                }
-                per = a + (roundedSnr - previousSnr) * (b - a) / (nextSnr - previousSnr);
-            }
+            per = InterpolatePer (MmWaveAwgnErrorTableLdpc1458, MmWaveAwgnErrorTableLdpc1458Index[mcs], MMWAVE_ERROR_TABLE_LDPC_SNR_STEP, roundedSnr);
+            tableSize = MMWAVE_ERROR_TABLE_LDPC_FRAME_SIZE;
+        }
+        else if (size < m_threshold)
+        {
+            per = InterpolatePer (MmWaveAwgnErrorTableBcc32, MmWaveAwgnErrorTableBcc32Index[mcs], MMWAVE_ERROR_TABLE_BCC_SNR_STEP, roundedSnr);
+            tableSize = MMWAVE_ERROR_TABLE_BCC_SMALL_FRAME_SIZE;
         }
         else
         {
-            per = itTable->second;
+            per = InterpolatePer (MmWaveAwgnErrorTableBcc1458, MmWaveAwgnErrorTableBcc1458Index[mcs], MMWAVE_ERROR_TABLE_BCC_SNR_STEP, roundedSnr);
+            tableSize = MMWAVE_ERROR_TABLE_BCC_LARGE_FRAME_SIZE;
         }
 
-        uint16_t tableSize = (ldpc ? MMWAVE_ERROR_TABLE_LDPC_FRAME_SIZE : (size < m_threshold ? MMWAVE_ERROR_TABLE_BCC_SMALL_FRAME_SIZE : MMWAVE_ERROR_TABLE_BCC_LARGE_FRAME_SIZE));
         if (size != tableSize)
         {
             per = (1.0 - std::pow ((1 - per), (static_cast<double> (size) / tableSize)));
@@ -134,6 +126,40 @@ namespace ns3 {
         return 1.0 - per;
     }
 
+    double
+    MmWaveTableBasedErrorRateModel::DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const
+    {
+        NS_LOG_FUNCTION (this << mode << txVector << snr << nbits);
+        uint8_t mcs = GetMcsForMode (mode);
+        bool ldpc = txVector.IsLdpc ();
+
+        if (mcs > (ldpc ? MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS : MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS))
+        {
+            NS_LOG_WARN ("Table missing for MCS: " << +mcs << " in MmWaveTableBasedErrorRateModel: use fallback error rate model");
+            return m_fallbackErrorModel->GetChunkSuccessRate (mode, txVector, snr, nbits);
+        }
+        return GetTableChunkSuccessRate (mcs, ldpc, snr, nbits);
+    }
+
+    void
+    MmWaveTableBasedErrorRateModel::DoGetChunkSuccessRates (MmWaveMode mode, MmWaveTxVector txVector, const double *snrs, const uint64_t *nbits, double *csrs, std::size_t n) const
+    {
+        NS_LOG_FUNCTION (this << mode << txVector << n);
+        uint8_t mcs = GetMcsForMode (mode);
+        bool ldpc = txVector.IsLdpc ();
+
+        if (mcs > (ldpc ? MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS : MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS))
+        {
+            NS_LOG_WARN ("Table missing for MCS: " << +mcs << " in MmWaveTableBasedErrorRateModel: use fallback error rate model");
+            m_fallbackErrorModel->GetChunkSuccessRates (mode, txVector, snrs, nbits, csrs, n);
+            return;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            csrs[i] = GetTableChunkSuccessRate (mcs, ldpc, snrs[i], nbits[i]);
+        }
+    }
+
     double
     MmWaveTableBasedErrorRateModel::RatioToDb (double ratio) const
     {
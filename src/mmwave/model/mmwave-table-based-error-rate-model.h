@@ -13,267 +13,182 @@ namespace ns3 {
     const uint8_t MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS = 9;
     const uint8_t MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS = 11;
 
-    static const std::vector<std::pair<double /* SNR (dB) */, double /* PER */> > MmWaveAwgnErrorTableBcc32 [MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS + 1] = {
+    const double MMWAVE_ERROR_TABLE_BCC_SNR_STEP = 0.2;   ///< SNR (dB) between two entries of the BCC tables
+    const double MMWAVE_ERROR_TABLE_LDPC_SNR_STEP = 0.25; ///< SNR (dB) between two entries of the LDPC tables
+
+    /// Location of the PER values of one MCS in a flattened AWGN error table
+    struct MmWaveAwgnErrorTableIndex
+    {
+        double minSnr;   //!< SNR (dB) of the first PER value, the following ones are evenly spaced
+        uint16_t offset; //!< position of the first PER value in the flattened table
+        uint16_t size;   //!< number of PER values
+    };
+
+    /// PER on a uniform SNR grid, for every MCS one after the other (see MmWaveAwgnErrorTableBcc32Index)
+    static constexpr double MmWaveAwgnErrorTableBcc32 [] = {
             // MCS-0
-            {
-                    {-3.20000, 1.00000}, {-3.00000, 0.99751}, {-2.80000, 0.98526}, {-2.60000, 0.97805}, {-2.40000, 0.95933},
-                    {-2.20000, 0.90724}, {-2.00000, 0.87939}, {-1.80000, 0.73985}, {-1.60000, 0.63150}, {-1.40000, 0.57615},
-                    {-1.20000, 0.42980}, {-1.00000, 0.34749}, {-0.80000, 0.22253}, {-0.60000, 0.14667}, {-0.40000, 0.10149},
-                    {-0.20000, 0.06517}, {0.00000, 0.03774}, {0.20000, 0.02305}, {0.40000, 0.01258}, {0.60000, 0.00725},
-                    {0.80000, 0.00388}, {1.00000, 0.00220}, {1.20000, 0.00120}, {1.40000, 0.00042}, {1.60000, 0.00030},
-                    {1.80000, 0.00020}, {2.00000, 0.00007}, {2.20000, 0.00003}, {2.40000, 0.00000},
-            },
+            1.00000, 0.99751, 0.98526, 0.97805, 0.95933, 0.90724, 0.87939, 0.73985, 0.63150, 0.57615,
+            0.42980, 0.34749, 0.22253, 0.14667, 0.10149, 0.06517, 0.03774, 0.02305, 0.01258, 0.00725,
+            0.00388, 0.00220, 0.00120, 0.00042, 0.00030, 0.00020, 0.00007, 0.00003, 0.00000,
             // MCS-1
-            {
-                    {-0.20000, 1.00000}, {0.00000, 0.99504}, {0.20000, 0.99504}, {0.40000, 0.98044}, {0.60000, 0.94799},
-                    {0.80000, 0.90519}, {1.00000, 0.84958}, {1.20000, 0.75518}, {1.40000, 0.66281}, {1.60000, 0.53113},
-                    {1.80000, 0.41128}, {2.00000, 0.29792}, {2.20000, 0.21889}, {2.40000, 0.15850}, {2.60000, 0.08589},
-                    {2.80000, 0.05338}, {3.00000, 0.03401}, {3.20000, 0.02251}, {3.40000, 0.01171}, {3.60000, 0.00653},
-                    {3.80000, 0.00340}, {4.00000, 0.00185}, {4.20000, 0.00080}, {4.40000, 0.00042}, {4.60000, 0.00015},
-                    {4.80000, 0.00005}, {5.00000, 0.00005}, {5.20000, 0.00000},
-            },
+            1.00000, 0.99504, 0.99504, 0.98044, 0.94799, 0.90519, 0.84958, 0.75518, 0.66281, 0.53113,
+            0.41128, 0.29792, 0.21889, 0.15850, 0.08589, 0.05338, 0.03401, 0.02251, 0.01171, 0.00653,
+            0.00340, 0.00185, 0.00080, 0.00042, 0.00015, 0.00005, 0.00005, 0.00000,
             // MCS-2
-            {
-                    {2.80000, 1.00000}, {3.00000, 0.96394}, {3.20000, 0.94353}, {3.40000, 0.91553}, {3.60000, 0.81837},
-                    {3.80000, 0.71993}, {4.00000, 0.56879}, {4.20000, 0.50695}, {4.40000, 0.35644}, {4.60000, 0.28440},
-                    {4.80000, 0.18496}, {5.00000, 0.11938}, {5.20000, 0.08119}, {5.40000, 0.04399}, {5.60000, 0.02675},
-                    {5.80000, 0.01540}, {6.00000, 0.00822}, {6.20000, 0.00470}, {6.40000, 0.00205}, {6.60000, 0.00140},
-                    {6.80000, 0.00060}, {7.00000, 0.00038}, {7.20000, 0.00015}, {7.40000, 0.00011}, {7.60000, 0.00007},
-                    {7.80000, 0.00000},
-            },
+            1.00000, 0.96394, 0.94353, 0.91553, 0.81837, 0.71993, 0.56879, 0.50695, 0.35644, 0.28440,
+            0.18496, 0.11938, 0.08119, 0.04399, 0.02675, 0.01540, 0.00822, 0.00470, 0.00205, 0.00140,
+            0.00060, 0.00038, 0.00015, 0.00011, 0.00007, 0.00000,
             // MCS-3
-            {
-                    {5.60000, 1.00000}, {5.80000, 0.99257}, {6.00000, 0.96860}, {6.20000, 0.95094}, {6.40000, 0.94353},
-                    {6.60000, 0.85138}, {6.80000, 0.78474}, {7.00000, 0.69019}, {7.20000, 0.56006}, {7.40000, 0.48547},
-                    {7.60000, 0.36257}, {7.80000, 0.25722}, {8.00000, 0.18471}, {8.20000, 0.12046}, {8.40000, 0.08022},
-                    {8.60000, 0.05137}, {8.80000, 0.03217}, {9.00000, 0.01752}, {9.20000, 0.01129}, {9.40000, 0.00613},
-                    {9.60000, 0.00350}, {9.80000, 0.00200}, {10.00000, 0.00083}, {10.20000, 0.00055}, {10.40000, 0.00028},
-                    {10.60000, 0.00005}, {10.80000, 0.00001}, {11.00000, 0.00000},
-            },
+            1.00000, 0.99257, 0.96860, 0.95094, 0.94353, 0.85138, 0.78474, 0.69019, 0.56006, 0.48547,
+            0.36257, 0.25722, 0.18471, 0.12046, 0.08022, 0.05137, 0.03217, 0.01752, 0.01129, 0.00613,
+            0.00350, 0.00200, 0.00083, 0.00055, 0.00028, 0.00005, 0.00001, 0.00000,
             // MCS-4
-            {
-                    {8.40000, 1.00000}, {8.60000, 0.99930}, {8.80000, 0.98937}, {9.00000, 0.97814}, {9.20000, 0.96570},
-                    {9.40000, 0.91493}, {9.60000, 0.86559}, {9.80000, 0.83368}, {10.00000, 0.74157}, {10.20000, 0.64457},
-                    {10.40000, 0.56077}, {10.60000, 0.42837}, {10.80000, 0.31723}, {11.00000, 0.21704}, {11.20000, 0.15537},
-                    {11.40000, 0.10741}, {11.60000, 0.06370}, {11.80000, 0.04047}, {12.00000, 0.02421}, {12.20000, 0.01397},
-                    {12.40000, 0.00803}, {12.60000, 0.00444}, {12.80000, 0.00257}, {13.00000, 0.00139}, {13.20000, 0.00082},
-                    {13.40000, 0.00063}, {13.60000, 0.00034}, {13.80000, 0.00011}, {14.00000, 0.00005}, {14.20000, 0.00000},
-            },
+            1.00000, 0.99930, 0.98937, 0.97814, 0.96570, 0.91493, 0.86559, 0.83368, 0.74157, 0.64457,
+            0.56077, 0.42837, 0.31723, 0.21704, 0.15537, 0.10741, 0.06370, 0.04047, 0.02421, 0.01397,
+            0.00803, 0.00444, 0.00257, 0.00139, 0.00082, 0.00063, 0.00034, 0.00011, 0.00005, 0.00000,
             // MCS-5
-            {
-                    {12.00000, 1.00000}, {12.20000, 0.99257}, {12.40000, 0.99012}, {12.60000, 0.95933}, {12.80000, 0.95933},
-                    {13.00000, 0.92396}, {13.20000, 0.86237}, {13.40000, 0.78937}, {13.60000, 0.72383}, {13.80000, 0.68547},
-                    {14.00000, 0.59673}, {14.20000, 0.46901}, {14.40000, 0.37095}, {14.60000, 0.29616}, {14.80000, 0.21594},
-                    {15.00000, 0.16150}, {15.20000, 0.12067}, {15.40000, 0.08217}, {15.60000, 0.05459}, {15.80000, 0.03878},
-                    {16.00000, 0.02268}, {16.20000, 0.01605}, {16.40000, 0.00933}, {16.60000, 0.00590}, {16.80000, 0.00355},
-                    {17.00000, 0.00248}, {17.20000, 0.00143}, {17.40000, 0.00077}, {17.60000, 0.00065}, {17.80000, 0.00035},
-                    {18.00000, 0.00025}, {18.20000, 0.00013}, {18.40000, 0.00009}, {18.60000, 0.00003}, {18.80000, 0.00000},
-            },
+            1.00000, 0.99257, 0.99012, 0.95933, 0.95933, 0.92396, 0.86237, 0.78937, 0.72383, 0.68547,
+            0.59673, 0.46901, 0.37095, 0.29616, 0.21594, 0.16150, 0.12067, 0.08217, 0.05459, 0.03878,
+            0.02268, 0.01605, 0.00933, 0.00590, 0.00355, 0.00248, 0.00143, 0.00077, 0.00065, 0.00035,
+            0.00025, 0.00013, 0.00009, 0.00003, 0.00000,
             // MCS-6
-            {
-                    {13.40000, 1.00000}, {13.60000, 0.99257}, {13.80000, 0.99012}, {14.00000, 0.95704}, {14.20000, 0.94163},
-                    {14.40000, 0.93473}, {14.60000, 0.87174}, {14.80000, 0.80847}, {15.00000, 0.72777}, {15.20000, 0.62461},
-                    {15.40000, 0.57948}, {15.60000, 0.47232}, {15.80000, 0.34659}, {16.00000, 0.30402}, {16.20000, 0.20864},
-                    {16.40000, 0.16778}, {16.60000, 0.10941}, {16.80000, 0.07152}, {17.00000, 0.04993}, {17.20000, 0.03387},
-                    {17.40000, 0.02261}, {17.60000, 0.01324}, {17.80000, 0.00912}, {18.00000, 0.00515}, {18.20000, 0.00382},
-                    {18.40000, 0.00190}, {18.60000, 0.00088}, {18.80000, 0.00072}, {19.00000, 0.00045}, {19.20000, 0.00022},
-                    {19.40000, 0.00015}, {19.60000, 0.00007}, {19.80000, 0.00003}, {20.00000, 0.00000},
-            },
+            1.00000, 0.99257, 0.99012, 0.95704, 0.94163, 0.93473, 0.87174, 0.80847, 0.72777, 0.62461,
+            0.57948, 0.47232, 0.34659, 0.30402, 0.20864, 0.16778, 0.10941, 0.07152, 0.04993, 0.03387,
+            0.02261, 0.01324, 0.00912, 0.00515, 0.00382, 0.00190, 0.00088, 0.00072, 0.00045, 0.00022,
+            0.00015, 0.00007, 0.00003, 0.00000,
             // MCS-7
-            {
-                    {14.80000, 1.00000}, {15.00000, 0.98768}, {15.20000, 0.97504}, {15.40000, 0.95476}, {15.60000, 0.94353},
-                    {15.80000, 0.91553}, {16.00000, 0.84067}, {16.20000, 0.76820}, {16.40000, 0.67282}, {16.60000, 0.57781},
-                    {16.80000, 0.52214}, {17.00000, 0.43921}, {17.20000, 0.32788}, {17.40000, 0.24347}, {17.60000, 0.19123},
-                    {17.80000, 0.12722}, {18.00000, 0.08600}, {18.20000, 0.05338}, {18.40000, 0.03655}, {18.60000, 0.02303},
-                    {18.80000, 0.01483}, {19.00000, 0.00890}, {19.20000, 0.00543}, {19.40000, 0.00335}, {19.60000, 0.00165},
-                    {19.80000, 0.00110}, {20.00000, 0.00065}, {20.20000, 0.00040}, {20.40000, 0.00032}, {20.60000, 0.00028},
-                    {20.80000, 0.00010}, {21.00000, 0.00007}, {21.20000, 0.00003}, {21.40000, 0.00000},
-            },
+            1.00000, 0.98768, 0.97504, 0.95476, 0.94353, 0.91553, 0.84067, 0.76820, 0.67282, 0.57781,
+            0.52214, 0.43921, 0.32788, 0.24347, 0.19123, 0.12722, 0.08600, 0.05338, 0.03655, 0.02303,
+            0.01483, 0.00890, 0.00543, 0.00335, 0.00165, 0.00110, 0.00065, 0.00040, 0.00032, 0.00028,
+            0.00010, 0.00007, 0.00003, 0.00000,
             // MCS-8
-            {
-                    {19.80000, 1.00000}, {20.00000, 0.99012}, {20.20000, 0.96163}, {20.40000, 0.89709}, {20.60000, 0.85501},
-                    {20.80000, 0.78782}, {21.00000, 0.70475}, {21.20000, 0.59320}, {21.40000, 0.50062}, {21.60000, 0.37582},
-                    {21.80000, 0.29792}, {22.00000, 0.22707}, {22.20000, 0.17262}, {22.40000, 0.14036}, {22.60000, 0.09376},
-                    {22.80000, 0.06519}, {23.00000, 0.05036}, {23.20000, 0.03603}, {23.40000, 0.02608}, {23.60000, 0.02247},
-                    {23.80000, 0.01413}, {24.00000, 0.01113}, {24.20000, 0.00775}, {24.40000, 0.00580}, {24.60000, 0.00428},
-                    {24.80000, 0.00305}, {25.00000, 0.00290}, {25.20000, 0.00180}, {25.40000, 0.00097}, {25.60000, 0.00090},
-                    {25.80000, 0.00065}, {26.00000, 0.00032}, {26.20000, 0.00028}, {26.40000, 0.00020}, {26.60000, 0.00018},
-                    {26.80000, 0.00015}, {27.00000, 0.00000},
-            },
+            1.00000, 0.99012, 0.96163, 0.89709, 0.85501, 0.78782, 0.70475, 0.59320, 0.50062, 0.37582,
+            0.29792, 0.22707, 0.17262, 0.14036, 0.09376, 0.06519, 0.05036, 0.03603, 0.02608, 0.02247,
+            0.01413, 0.01113, 0.00775, 0.00580, 0.00428, 0.00305, 0.00290, 0.00180, 0.00097, 0.00090,
+            0.00065, 0.00032, 0.00028, 0.00020, 0.00018, 0.00015, 0.00000,
             // MCS-9
-            {
-                    {21.60000, 1.00000}, {21.80000, 0.99751}, {22.00000, 0.98768}, {22.20000, 0.96163}, {22.40000, 0.93911},
-                    {22.60000, 0.86609}, {22.80000, 0.80040}, {23.00000, 0.66172}, {23.20000, 0.57368}, {23.40000, 0.47625},
-                    {23.60000, 0.34629}, {23.80000, 0.25428}, {24.00000, 0.18871}, {24.20000, 0.13644}, {24.40000, 0.10722},
-                    {24.60000, 0.08231}, {24.80000, 0.05274}, {25.00000, 0.03870}, {25.20000, 0.02931}, {25.40000, 0.02209},
-                    {25.60000, 0.01624}, {25.80000, 0.01290}, {26.00000, 0.00932}, {26.20000, 0.00653}, {26.40000, 0.00532},
-                    {26.60000, 0.00380}, {26.80000, 0.00313}, {27.00000, 0.00225}, {27.20000, 0.00153}, {27.40000, 0.00097},
-                    {27.60000, 0.00075}, {27.80000, 0.00057}, {28.00000, 0.00047}, {28.20000, 0.00032}, {28.40000, 0.00022},
-                    {28.60000, 0.00013}, {28.80000, 0.00007}, {29.00000, 0.00005}, {29.20000, 0.00000},
-            },
+            1.00000, 0.99751, 0.98768, 0.96163, 0.93911, 0.86609, 0.80040, 0.66172, 0.57368, 0.47625,
+            0.34629, 0.25428, 0.18871, 0.13644, 0.10722, 0.08231, 0.05274, 0.03870, 0.02931, 0.02209,
+            0.01624, 0.01290, 0.00932, 0.00653, 0.00532, 0.00380, 0.00313, 0.00225, 0.00153, 0.00097,
+            0.00075, 0.00057, 0.00047, 0.00032, 0.00022, 0.00013, 0.00007, 0.00005, 0.00000,
+    };
+    static constexpr MmWaveAwgnErrorTableIndex MmWaveAwgnErrorTableBcc32Index [MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS + 1] = {
+            {-3.20000, 0, 29}, // MCS-0
+            {-0.20000, 29, 28}, // MCS-1
+            {2.80000, 57, 26}, // MCS-2
+            {5.60000, 83, 28}, // MCS-3
+            {8.40000, 111, 30}, // MCS-4
+            {12.00000, 141, 35}, // MCS-5
+            {13.40000, 176, 34}, // MCS-6
+            {14.80000, 210, 34}, // MCS-7
+            {19.80000, 244, 37}, // MCS-8
+            {21.60000, 281, 39}, // MCS-9
     };
 
-    static const std::vector<std::pair<double /* SNR (dB) */, double /* PER */> > MmWaveAwgnErrorTableBcc1458 [MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS + 1] = {
+    /// PER on a uniform SNR grid, for every MCS one after the other (see MmWaveAwgnErrorTableBcc1458Index)
+    static constexpr double MmWaveAwgnErrorTableBcc1458 [] = {
             // MCS-0
-            {
-                    {-0.80000, 1.00000}, {-0.60000, 0.99751}, {-0.40000, 0.98284}, {-0.20000, 0.93473}, {0.00000, 0.77713},
-                    {0.20000, 0.61598}, {0.40000, 0.39391}, {0.60000, 0.23602}, {0.80000, 0.12170}, {1.00000, 0.06643},
-                    {1.20000, 0.03463}, {1.40000, 0.01655}, {1.60000, 0.00670}, {1.80000, 0.00343}, {2.00000, 0.00155},
-                    {2.20000, 0.00063}, {2.40000, 0.00032}, {2.60000, 0.00018}, {2.80000, 0.00005}, {3.00000, 0.00000},
-            },
+            1.00000, 0.99751, 0.98284, 0.93473, 0.77713, 0.61598, 0.39391, 0.23602, 0.12170, 0.06643,
+            0.03463, 0.01655, 0.00670, 0.00343, 0.00155, 0.00063, 0.00032, 0.00018, 0.00005, 0.00000,
             // MCS-1
-            {
-                    {2.40000, 1.00000}, {2.60000, 0.99504}, {2.80000, 0.93911}, {3.00000, 0.80847}, {3.20000, 0.60850},
-                    {3.40000, 0.41255}, {3.60000, 0.23700}, {3.80000, 0.12812}, {4.00000, 0.07167}, {4.20000, 0.03566},
-                    {4.40000, 0.01664}, {4.60000, 0.00777}, {4.80000, 0.00443}, {5.00000, 0.00160}, {5.20000, 0.00083},
-                    {5.40000, 0.00050}, {5.60000, 0.00022}, {5.80000, 0.00010}, {6.00000, 0.00000},
-            },
+            1.00000, 0.99504, 0.93911, 0.80847, 0.60850, 0.41255, 0.23700, 0.12812, 0.07167, 0.03566,
+            0.01664, 0.00777, 0.00443, 0.00160, 0.00083, 0.00050, 0.00022, 0.00010, 0.00000,
             // MCS-2
-            {
-                    {4.80000, 1.00000}, {5.00000, 0.99751}, {5.20000, 0.94575}, {5.40000, 0.86985}, {5.60000, 0.67282},
-                    {5.80000, 0.48313}, {6.00000, 0.27809}, {6.20000, 0.19251}, {6.40000, 0.09300}, {6.60000, 0.05184},
-                    {6.80000, 0.02559}, {7.00000, 0.01407}, {7.20000, 0.00670}, {7.40000, 0.00360}, {7.60000, 0.00175},
-                    {7.80000, 0.00088}, {8.00000, 0.00055}, {8.20000, 0.00025}, {8.40000, 0.00007}, {8.60000, 0.00005},
-                    {8.80000, 0.00000},
-            },
+            1.00000, 0.99751, 0.94575, 0.86985, 0.67282, 0.48313, 0.27809, 0.19251, 0.09300, 0.05184,
+            0.02559, 0.01407, 0.00670, 0.00360, 0.00175, 0.00088, 0.00055, 0.00025, 0.00007, 0.00005,
+            0.00000,
             // MCS-3
-            {
-                    {8.00000, 1.00000}, {8.20000, 0.99751}, {8.40000, 0.97567}, {8.60000, 0.89709}, {8.80000, 0.76820},
-                    {9.00000, 0.60392}, {9.20000, 0.38857}, {9.40000, 0.26841}, {9.60000, 0.15543}, {9.80000, 0.08695},
-                    {10.00000, 0.04018}, {10.20000, 0.02370}, {10.40000, 0.01189}, {10.60000, 0.00643}, {10.80000, 0.00313},
-                    {11.00000, 0.00173}, {11.20000, 0.00090}, {11.40000, 0.00032}, {11.60000, 0.00018}, {11.80000, 0.00005},
-                    {12.00000, 0.00003}, {12.20000, 0.00000},
-            },
+            1.00000, 0.99751, 0.97567, 0.89709, 0.76820, 0.60392, 0.38857, 0.26841, 0.15543, 0.08695,
+            0.04018, 0.02370, 0.01189, 0.00643, 0.00313, 0.00173, 0.00090, 0.00032, 0.00018, 0.00005,
+            0.00003, 0.00000,
             // MCS-4
-            {
-                    {11.20000, 1.00000}, {11.40000, 0.99012}, {11.60000, 0.94131}, {11.80000, 0.80200}, {12.00000, 0.66391},
-                    {12.20000, 0.43730}, {12.40000, 0.28911}, {12.60000, 0.17115}, {12.80000, 0.10219}, {13.00000, 0.05927},
-                    {13.20000, 0.03395}, {13.40000, 0.01924}, {13.60000, 0.01083}, {13.80000, 0.00588}, {14.00000, 0.00265},
-                    {14.20000, 0.00145}, {14.40000, 0.00068}, {14.60000, 0.00035}, {14.80000, 0.00018}, {15.00000, 0.00005},
-                    {15.20000, 0.00000},
-            },
+            1.00000, 0.99012, 0.94131, 0.80200, 0.66391, 0.43730, 0.28911, 0.17115, 0.10219, 0.05927,
+            0.03395, 0.01924, 0.01083, 0.00588, 0.00265, 0.00145, 0.00068, 0.00035, 0.00018, 0.00005,
+            0.00000,
             // MCS-5
-            {
-                    {15.00000, 1.00000}, {15.20000, 0.99257}, {15.40000, 0.96394}, {15.60000, 0.92184}, {15.80000, 0.81010},
-                    {16.00000, 0.65846}, {16.20000, 0.50631}, {16.40000, 0.37938}, {16.60000, 0.23672}, {16.80000, 0.15382},
-                    {17.00000, 0.10256}, {17.20000, 0.06430}, {17.40000, 0.03643}, {17.60000, 0.02224}, {17.80000, 0.01320},
-                    {18.00000, 0.00790}, {18.20000, 0.00453}, {18.40000, 0.00273}, {18.60000, 0.00115}, {18.80000, 0.00070},
-                    {19.00000, 0.00052}, {19.20000, 0.00025}, {19.40000, 0.00015}, {19.60000, 0.00010}, {19.80000, 0.00003},
-                    {20.00000, 0.00000},
-            },
+            1.00000, 0.99257, 0.96394, 0.92184, 0.81010, 0.65846, 0.50631, 0.37938, 0.23672, 0.15382,
+            0.10256, 0.06430, 0.03643, 0.02224, 0.01320, 0.00790, 0.00453, 0.00273, 0.00115, 0.00070,
+            0.00052, 0.00025, 0.00015, 0.00010, 0.00003, 0.00000,
             // MCS-6
-            {
-                    {16.00000, 1.00000}, {16.20000, 0.99751}, {16.40000, 0.99751}, {16.60000, 0.99012}, {16.80000, 0.93911},
-                    {17.00000, 0.89509}, {17.20000, 0.76967}, {17.40000, 0.60483}, {17.60000, 0.45881}, {17.80000, 0.31109},
-                    {18.00000, 0.20470}, {18.20000, 0.12686}, {18.40000, 0.08283}, {18.60000, 0.05102}, {18.80000, 0.03264},
-                    {19.00000, 0.01910}, {19.20000, 0.01107}, {19.40000, 0.00677}, {19.60000, 0.00445}, {19.80000, 0.00228},
-                    {20.00000, 0.00110}, {20.20000, 0.00050}, {20.40000, 0.00038}, {20.60000, 0.00015}, {20.80000, 0.00010},
-                    {21.00000, 0.00007}, {21.20000, 0.00003}, {21.40000, 0.00000},
-            },
+            1.00000, 0.99751, 0.99751, 0.99012, 0.93911, 0.89509, 0.76967, 0.60483, 0.45881, 0.31109,
+            0.20470, 0.12686, 0.08283, 0.05102, 0.03264, 0.01910, 0.01107, 0.00677, 0.00445, 0.00228,
+            0.00110, 0.00050, 0.00038, 0.00015, 0.00010, 0.00007, 0.00003, 0.00000,
             // MCS-7
-            {
-                    {17.80000, 1.00000}, {18.00000, 0.98284}, {18.20000, 0.91972}, {18.40000, 0.78937}, {18.60000, 0.65203},
-                    {18.80000, 0.48902}, {19.00000, 0.32869}, {19.20000, 0.21817}, {19.40000, 0.14835}, {19.60000, 0.08870},
-                    {19.80000, 0.05506}, {20.00000, 0.03440}, {20.20000, 0.02175}, {20.40000, 0.01328}, {20.60000, 0.00673},
-                    {20.80000, 0.00415}, {21.00000, 0.00285}, {21.20000, 0.00150}, {21.40000, 0.00090}, {21.60000, 0.00040},
-                    {21.80000, 0.00032}, {22.00000, 0.00010}, {22.20000, 0.00007}, {22.40000, 0.00005}, {22.60000, 0.00000},
-            },
+            1.00000, 0.98284, 0.91972, 0.78937, 0.65203, 0.48902, 0.32869, 0.21817, 0.14835, 0.08870,
+            0.05506, 0.03440, 0.02175, 0.01328, 0.00673, 0.00415, 0.00285, 0.00150, 0.00090, 0.00040,
+            0.00032, 0.00010, 0.00007, 0.00005, 0.00000,
             // MCS-8
-            {
-                    {20.80000, 1.00000}, {21.00000, 0.99257}, {21.20000, 0.98768}, {21.40000, 0.96394}, {21.60000, 0.90930},
-                    {21.80000, 0.80522}, {22.00000, 0.67966}, {22.20000, 0.59584}, {22.40000, 0.44605}, {22.60000, 0.35330},
-                    {22.80000, 0.25955}, {23.00000, 0.19391}, {23.20000, 0.15323}, {23.40000, 0.09721}, {23.60000, 0.07040},
-                    {23.80000, 0.04871}, {24.00000, 0.03459}, {24.20000, 0.02438}, {24.40000, 0.01740}, {24.60000, 0.01167},
-                    {24.80000, 0.00822}, {25.00000, 0.00570}, {25.20000, 0.00420}, {25.40000, 0.00293}, {25.60000, 0.00185},
-                    {25.80000, 0.00143}, {26.00000, 0.00100}, {26.20000, 0.00085}, {26.40000, 0.00068}, {26.60000, 0.00047},
-                    {26.80000, 0.00040}, {27.00000, 0.00020}, {27.20000, 0.00000},
-            },
+            1.00000, 0.99257, 0.98768, 0.96394, 0.90930, 0.80522, 0.67966, 0.59584, 0.44605, 0.35330,
+            0.25955, 0.19391, 0.15323, 0.09721, 0.07040, 0.04871, 0.03459, 0.02438, 0.01740, 0.01167,
+            0.00822, 0.00570, 0.00420, 0.00293, 0.00185, 0.00143, 0.00100, 0.00085, 0.00068, 0.00047,
+            0.00040, 0.00020, 0.00000,
             // MCS-9
-            {
-                    {22.80000, 1.00000}, {23.00000, 0.99751}, {23.20000, 0.98526}, {23.40000, 0.93473}, {23.60000, 0.83195},
-                    {23.80000, 0.71352}, {24.00000, 0.58200}, {24.20000, 0.43682}, {24.40000, 0.30356}, {24.60000, 0.21375},
-                    {24.80000, 0.15621}, {25.00000, 0.10932}, {25.20000, 0.06856}, {25.40000, 0.04815}, {25.60000, 0.03408},
-                    {25.80000, 0.02385}, {26.00000, 0.01641}, {26.20000, 0.01043}, {26.40000, 0.00685}, {26.60000, 0.00480},
-                    {26.80000, 0.00360}, {27.00000, 0.00240}, {27.20000, 0.00168}, {27.40000, 0.00108}, {27.60000, 0.00072},
-                    {27.80000, 0.00055}, {28.00000, 0.00035}, {28.20000, 0.00020}, {28.40000, 0.00015}, {28.60000, 0.00008},
-                    {28.80000, 0.00000},
-            },
+            1.00000, 0.99751, 0.98526, 0.93473, 0.83195, 0.71352, 0.58200, 0.43682, 0.30356, 0.21375,
+            0.15621, 0.10932, 0.06856, 0.04815, 0.03408, 0.02385, 0.01641, 0.01043, 0.00685, 0.00480,
+            0.00360, 0.00240, 0.00168, 0.00108, 0.00072, 0.00055, 0.00035, 0.00020, 0.00015, 0.00008,
+            0.00000,
+    };
+    static constexpr MmWaveAwgnErrorTableIndex MmWaveAwgnErrorTableBcc1458Index [MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS + 1] = {
+            {-0.80000, 0, 20}, // MCS-0
+            {2.40000, 20, 19}, // MCS-1
+            {4.80000, 39, 21}, // MCS-2
+            {8.00000, 60, 22}, // MCS-3
+            {11.20000, 82, 21}, // MCS-4
+            {15.00000, 103, 26}, // MCS-5
+            {16.00000, 129, 28}, // MCS-6
+            {17.80000, 157, 25}, // MCS-7
+            {20.80000, 182, 33}, // MCS-8
+            {22.80000, 215, 31}, // MCS-9
     };
 
-    static const std::vector<std::pair<double /* SNR (dB) */, double /* PER */> > MmWaveAwgnErrorTableLdpc1458 [MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS + 1] = {
+    /// PER on a uniform SNR grid, for every MCS one after the other (see MmWaveAwgnErrorTableLdpc1458Index)
+    static constexpr double MmWaveAwgnErrorTableLdpc1458 [] = {
             // MCS-0
-            {
-                    {-1.50000, 1.00000}, {-1.25000, 0.97950}, {-1.00000, 0.60480}, {-0.75000, 0.17050},
-                    {-0.50000, 0.03320}, {-0.25000, 0.00530}, {0.00000, 0.00085}, {0.25000, 0.00022},
-                    {0.50000, 0.00004}, {0.75000, 0.00000},
-            },
+            1.00000, 0.97950, 0.60480, 0.17050, 0.03320, 0.00530, 0.00085, 0.00022, 0.00004, 0.00000,
             // MCS-1
-            {
-                    {1.50000, 1.00000}, {1.75000, 0.97470}, {2.00000, 0.62330}, {2.25000, 0.18590},
-                    {2.50000, 0.03400}, {2.75000, 0.00550}, {3.00000, 0.00083}, {3.25000, 0.00015},
-                    {3.50000, 0.00003}, {3.75000, 0.00000},
-            },
+            1.00000, 0.97470, 0.62330, 0.18590, 0.03400, 0.00550, 0.00083, 0.00015, 0.00003, 0.00000,
             // MCS-2
-            {
-                    {4.00000, 1.00000}, {4.25000, 0.98720}, {4.50000, 0.62560}, {4.75000, 0.15800},
-                    {5.00000, 0.02090}, {5.25000, 0.00250}, {5.50000, 0.00034}, {5.75000, 0.00003},
-                    {6.00000, 0.00000},
-            },
+            1.00000, 0.98720, 0.62560, 0.15800, 0.02090, 0.00250, 0.00034, 0.00003, 0.00000,
             // MCS-3
-            {
-                    {6.75000, 1.00000}, {7.00000, 0.99800}, {7.25000, 0.94340}, {7.50000, 0.57890},
-                    {7.75000, 0.20640}, {8.00000, 0.04840}, {8.25000, 0.00930}, {8.50000, 0.00180},
-                    {8.75000, 0.00040}, {9.00000, 0.00011}, {9.25000, 0.00002}, {9.50000, 0.00000},
-            },
+            1.00000, 0.99800, 0.94340, 0.57890, 0.20640, 0.04840, 0.00930, 0.00180, 0.00040, 0.00011,
+            0.00002, 0.00000,
             // MCS-4
-            {
-                    {10.00000, 1.00000}, {10.25000, 0.99310}, {10.50000, 0.70890}, {10.75000, 0.24720},
-                    {11.00000, 0.04700}, {11.25000, 0.00590}, {11.50000, 0.00091}, {11.75000, 0.00016},
-                    {12.00000, 0.00003}, {12.25000, 0.00000}
-            },
+            1.00000, 0.99310, 0.70890, 0.24720, 0.04700, 0.00590, 0.00091, 0.00016, 0.00003, 0.00000,
             // MCS-5
-            {
-                    {14.00000, 1.00000}, {14.25000, 0.99700}, {14.50000, 0.91830}, {14.75000, 0.53790},
-                    {15.00000, 0.16610}, {15.25000, 0.03690}, {15.50000, 0.00650}, {15.75000, 0.00100},
-                    {16.00000, 0.00031}, {16.25000, 0.00005}, {16.50000, 0.00000},
-            },
+            1.00000, 0.99700, 0.91830, 0.53790, 0.16610, 0.03690, 0.00650, 0.00100, 0.00031, 0.00005,
+            0.00000,
             // MCS-6
-            {
-                    {15.50000, 1.00000}, {15.75000, 0.98140}, {16.00000, 0.73930}, {16.25000, 0.33110},
-                    {16.50000, 0.08150}, {16.75000, 0.01620}, {17.00000, 0.00270}, {17.25000, 0.00052},
-                    {17.50000, 0.00005}, {17.75000, 0.00003}, {18.00000, 0.00000},
-            },
+            1.00000, 0.98140, 0.73930, 0.33110, 0.08150, 0.01620, 0.00270, 0.00052, 0.00005, 0.00003,
+            0.00000,
             // MCS-7
-            {
-                    {17.00000, 1.00000}, {17.25000, 0.97750}, {17.50000, 0.73980}, {17.75000, 0.33190},
-                    {18.00000, 0.09640}, {18.25000, 0.02180}, {18.50000, 0.00470}, {18.75000, 0.00087},
-                    {19.00000, 0.00018}, {19.25000, 0.00003}, {19.50000, 0.00000},
-            },
+            1.00000, 0.97750, 0.73980, 0.33190, 0.09640, 0.02180, 0.00470, 0.00087, 0.00018, 0.00003,
+            0.00000,
             // MCS-8
-            {
-                    {20.50000, 1.00000}, {20.75000, 0.99500}, {21.00000, 0.89700}, {21.25000, 0.56270},
-                    {21.50000, 0.20920}, {21.75000, 0.05600}, {22.00000, 0.01170}, {22.25000, 0.00250},
-                    {22.50000, 0.00038}, {22.75000, 0.00013}, {23.00000, 0.00004}, {23.25000, 0.00001},
-                    {23.50000, 0.00000},
-            },
+            1.00000, 0.99500, 0.89700, 0.56270, 0.20920, 0.05600, 0.01170, 0.00250, 0.00038, 0.00013,
+            0.00004, 0.00001, 0.00000,
             // MCS-9
-            {
-                    {22.25000, 1.00000}, {22.50000, 0.99900}, {22.75000, 0.94080}, {23.00000, 0.63600},
-                    {23.25000, 0.27190}, {23.50000, 0.08700}, {23.75000, 0.02210}, {24.00000, 0.00500},
-                    {24.25000, 0.00110}, {24.50000, 0.00032}, {24.75000, 0.00004}, {25.00000, 0.00000},
-            },
+            1.00000, 0.99900, 0.94080, 0.63600, 0.27190, 0.08700, 0.02210, 0.00500, 0.00110, 0.00032,
+            0.00004, 0.00000,
             // MCS-10
-            {
-                    {25.75000, 1.00000}, {26.00000, 0.94970}, {26.25000, 0.68660}, {26.50000, 0.32940},
-                    {26.75000, 0.11620}, {27.00000, 0.03440}, {27.25000, 0.00880}, {27.50000, 0.00210},
-                    {27.75000, 0.00054}, {28.00000, 0.00009}, {28.25000, 0.00002}, {28.50000, 0.00000},
-            },
+            1.00000, 0.94970, 0.68660, 0.32940, 0.11620, 0.03440, 0.00880, 0.00210, 0.00054, 0.00009,
+            0.00002, 0.00000,
             // MCS-11
-            {
-                    {27.75000, 1.00000}, {28.00000, 0.94880}, {28.25000, 0.75260}, {28.50000, 0.40230},
-                    {28.75000, 0.16210}, {29.00000, 0.05150}, {29.25000, 0.01310}, {29.50000, 0.00360},
-                    {29.75000, 0.00100}, {30.00000, 0.00022}, {30.25000, 0.00006}, {30.50000, 0.00000},
-            },
+            1.00000, 0.94880, 0.75260, 0.40230, 0.16210, 0.05150, 0.01310, 0.00360, 0.00100, 0.00022,
+            0.00006, 0.00000,
+    };
+    static constexpr MmWaveAwgnErrorTableIndex MmWaveAwgnErrorTableLdpc1458Index [MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS + 1] = {
+            {-1.50000, 0, 10}, // MCS-0
+            {1.50000, 10, 10}, // MCS-1
+            {4.00000, 20, 9}, // MCS-2
+            {6.75000, 29, 12}, // MCS-3
+            {10.00000, 41, 10}, // MCS-4
+            {14.00000, 51, 11}, // MCS-5
+            {15.50000, 62, 11}, // MCS-6
+            {17.00000, 73, 11}, // MCS-7
+            {20.50000, 84, 13}, // MCS-8
+            {22.25000, 97, 12}, // MCS-9
+            {25.75000, 109, 12}, // MCS-10
+            {27.75000, 121, 12}, // MCS-11
     };
 
     class MmWaveTableBasedErrorRateModel : public MmWaveErrorRateModel
@@ -285,11 +200,13 @@ namespace ns3 {
         ~MmWaveTableBasedErrorRateModel ();
         
         double DoGetChunkSuccessRate (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const;
+        void DoGetChunkSuccessRates (MmWaveMode mode, MmWaveTxVector txVector, const double *snrs, const uint64_t *nbits, double *csrs, std::size_t n) const;
         static uint8_t GetMcsForMode (MmWaveMode mode);
         double RatioToDb (double ratio) const;
     private:
         double RoundSnr (double snr, double precision) const;
         double FetchFsr (MmWaveMode mode, MmWaveTxVector txVector, double snr, uint64_t nbits) const;
+        double GetTableChunkSuccessRate (uint8_t mcs, bool ldpc, double snr, uint64_t nbits) const;
         Ptr<MmWaveErrorRateModel> m_fallbackErrorModel; //!< Error rate model to fallback to if no value is found in the table
         uint64_t m_threshold; //!< Threshold in bytes over which the table for large size frames is used
         double SNR_PRECISION = 2;
@@ -1,6 +1,7 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include <algorithm>
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
 #include "ns3/socket.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/llc-snap-header.h"
@@ -215,7 +216,7 @@ namespace ns3 {
         m_dataStationManager->Initialize ();
 
         Time start = m_rng->GetInteger (0, 20) * m_ctrlPhyEntities[0]->GetSifs ();
-        m_beaconEvent = Simulator::Schedule (start, &V2xMmWaveNetDevice::SendOneBeacon, this);
+        m_beaconEvent = NS_PROFILE_SCHEDULE (start, &V2xMmWaveNetDevice::SendOneBeacon, this);
 
         NetDevice::DoInitialize ();
     }
@@ -826,7 +827,7 @@ namespace ns3 {
         Ptr<V2xCtrlMac> mac = GetCtrlMac (CCH);
         Mac48Address to = Mac48Address::GetBroadcast ();
         mac->SendBeacon (packet, to);
-        m_beaconEvent = Simulator::Schedule (m_beaconInterval, &V2xMmWaveNetDevice::SendOneBeacon, this);
+        m_beaconEvent = NS_PROFILE_SCHEDULE (m_beaconInterval, &V2xMmWaveNetDevice::SendOneBeacon, this);
     }
 
     bool
@@ -1145,7 +1146,7 @@ namespace ns3 {
         {
             return;
         }
-        m_waitContentionFreeDuration = Simulator::Schedule (delay, &V2xMmWaveNetDevice::StartContentionFreeDuration, this, duration, to);
+        m_waitContentionFreeDuration = NS_PROFILE_SCHEDULE (delay, &V2xMmWaveNetDevice::StartContentionFreeDuration, this, duration, to);
         m_contentionFreeRx = to;
     }
 
@@ -1163,7 +1164,7 @@ namespace ns3 {
             return;
         }
         
-        m_startContentionFreeDuration = Simulator::Schedule (duration, &V2xMmWaveNetDevice::StopContentionFreeDuration, this);
+        m_startContentionFreeDuration = NS_PROFILE_SCHEDULE (duration, &V2xMmWaveNetDevice::StopContentionFreeDuration, this);
         m_contentionFreeRx = to;
         ReadyToTransmitFrame ();
     }
@@ -1258,7 +1259,7 @@ namespace ns3 {
         {
             if (!m_tryAgain.IsRunning ())
             {
-                m_tryAgain = Simulator::Schedule (m_dataPhy->GetDelayUntilIdle (), &V2xMmWaveNetDevice::TryToStartContentionFreeDuration, this);
+                m_tryAgain = NS_PROFILE_SCHEDULE (m_dataPhy->GetDelayUntilIdle (), &V2xMmWaveNetDevice::TryToStartContentionFreeDuration, this);
             }
         }
     }
@@ -1,7 +1,35 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 // Include a header file from your module to test.
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
 #include "ns3/mmwave.h"
+#include "ns3/mmwave-binary-trace.h"
+#include "ns3/mmwave-interference-helper.h"
+#include "ns3/mmwave-stats-collector.h"
+#include "ns3/mmwave-mac-queue-item.h"
+#include "ns3/mmwave-mac-queue.h"
+#include "ns3/mmwave-nist-error-rate-model.h"
+#include "ns3/mmwave-phy.h"
+#include "ns3/mmwave-psd-kernels.h"
+#include "ns3/mmwave-spectrum-phy.h"
+#include "ns3/mmwave-spectrum-repository.h"
+#include "ns3/mmwave-spectrum-value-helper.h"
+#include "ns3/mmwave-table-based-error-rate-model.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/global-value.h"
+#include "ns3/node.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/multi-model-spectrum-channel.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/queue-size.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +74,1279 @@ MmwaveTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * Check the vectorized PSD kernels against their scalar versions.
+ */
+class MmWavePsdKernelsTestCase : public TestCase
+{
+public:
+  MmWavePsdKernelsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWavePsdKernelsTestCase::MmWavePsdKernelsTestCase ()
+  : TestCase ("Check the vectorized PSD kernels against the scalar ones")
+{
+}
+
+void
+MmWavePsdKernelsTestCase::DoRun (void)
+{
+  // odd sizes exercise the scalar remainder of the vector loops
+  for (std::size_t n : {1, 3, 7, 16, 1001, 16641})
+    {
+      std::vector<double> a (n);
+      std::vector<double> b (n);
+      for (std::size_t i = 0; i < n; i++)
+        {
+          a[i] = std::pow (10.0, -0.1 * (i % 400)) * (1.0 + 1e-3 * i);
+          b[i] = 78125.0 + (i % 7);
+        }
+
+      // every instruction set the CPU supports against the scalar kernels
+      std::vector<std::vector<double> > results[MmWavePsdKernels::AVX + 1];
+      double dot[MmWavePsdKernels::AVX + 1];
+      for (int isa = MmWavePsdKernels::SCALAR; isa <= MmWavePsdKernels::AVX; isa++)
+        {
+          if (!MmWavePsdKernels::SetIsa (MmWavePsdKernels::Isa (isa)))
+            {
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_EQ (MmWavePsdKernels::GetIsa (), isa, "The instruction set is not forced");
+          std::vector<double> filled (n);
+          std::vector<double> product (n);
+          std::vector<double> quotient (n);
+          std::vector<double> scaled (a);
+          MmWavePsdKernels::Fill (filled.data (), 0.5, n);
+          MmWavePsdKernels::Multiply (a.data (), b.data (), product.data (), n);
+          MmWavePsdKernels::Divide (a.data (), b.data (), quotient.data (), n);
+          MmWavePsdKernels::DivideByScalar (scaled.data (), 3.0, n);
+          results[isa] = {filled, product, quotient, scaled};
+          dot[isa] = MmWavePsdKernels::Dot (a.data (), b.data (), n);
+        }
+      MmWavePsdKernels::SetVectorized (true);
+
+      for (int isa = MmWavePsdKernels::SSE2; isa <= MmWavePsdKernels::AVX; isa++)
+        {
+          if (results[isa].empty ())
+            {
+              continue;
+            }
+          for (std::size_t k = 0; k < results[0].size (); k++)
+            {
+              for (std::size_t i = 0; i < n; i++)
+                {
+                  NS_TEST_ASSERT_MSG_EQ (results[isa][k][i], results[0][k][i], "Kernel " << k << " differs at index " << i << " for size " << n << ", ISA " << isa);
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ_TOL (dot[isa], dot[0], 1e-12 * std::abs (dot[0]), "Dot product differs for size " << n << ", ISA " << isa);
+        }
+    }
+}
+
+/**
+ * Check that the transmit PSDs built with the vectorized kernels match the scalar ones.
+ */
+class MmWaveTxPsdTestCase : public TestCase
+{
+public:
+  MmWaveTxPsdTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveTxPsdTestCase::MmWaveTxPsdTestCase ()
+  : TestCase ("Check the mmWave transmit and noise PSDs built with the vectorized kernels")
+{
+}
+
+void
+MmWaveTxPsdTestCase::DoRun (void)
+{
+  double txPowerW = 0.1;
+  // values of the PSDs built band by band before the kernels were vectorized
+  struct PsdSamples
+  {
+    uint16_t channelWidth;
+    uint32_t nBands;
+    std::vector<std::pair<uint32_t, double> > values; //!< band index and PSD
+  };
+  const double expectedNoise = 1.9952623149688692e-20;
+  // the outer slopes, the edges of the subcarrier groups and the center band
+  const std::vector<PsdSamples> expected = {
+    { 320, 12289, {
+        { 0, 3.1916661065791662e-14 },
+        { 1024, 1.2706251630417277e-13 },
+        { 2048, 5.0584498849261799e-13 },
+        { 4090, 3.1916661065791596e-12 },
+        { 4095, 3.1916661065791596e-12 },
+        { 4101, 2.673587332045191e-11 },
+        { 4108, 3.1916661065791686e-10 },
+        { 4605, 3.1916661065791686e-10 },
+        { 4606, 3.1916661065791596e-12 },
+        { 4610, 3.1916661065791596e-12 },
+        { 4611, 3.1916661065791686e-10 },
+        { 6144, 3.1916661065791596e-12 },
+        { 8180, 3.1916661065791686e-10 },
+        { 8198, 3.1916661065791596e-12 },
+        { 11264, 1.2706251630417277e-13 },
+        { 12288, 3.1916661065791662e-14 } } },
+    { 640, 24577, {
+        { 0, 1.5967214893077077e-14 },
+        { 2048, 6.3566627427025739e-14 },
+        { 4096, 2.5306330186601523e-13 },
+        { 8186, 1.5967214893077044e-12 },
+        { 8191, 1.5967214893077044e-12 },
+        { 8197, 1.33753788900961e-11 },
+        { 8204, 1.596721489307709e-10 },
+        { 8701, 1.596721489307709e-10 },
+        { 8702, 1.5967214893077044e-12 },
+        { 8706, 1.5967214893077044e-12 },
+        { 8707, 1.596721489307709e-10 },
+        { 12288, 1.5967214893077044e-12 },
+        { 16372, 1.596721489307709e-10 },
+        { 16390, 1.5967214893077044e-12 },
+        { 22528, 6.3566627427025739e-14 },
+        { 24576, 1.5967214893077077e-14 } } },
+    { 1280, 49153, {
+        { 0, 7.9858303912982621e-15 },
+        { 4096, 3.1792163415998766e-14 },
+        { 8192, 1.2656688223317663e-13 },
+        { 16378, 7.9858303912982455e-13 },
+        { 16383, 7.9858303912982455e-13 },
+        { 16389, 6.6895515561683759e-12 },
+        { 16396, 7.9858303912982693e-11 },
+        { 16893, 7.9858303912982693e-11 },
+        { 16894, 7.9858303912982455e-13 },
+        { 16898, 7.9858303912982455e-13 },
+        { 16899, 7.9858303912982693e-11 },
+        { 24576, 7.9858303912982455e-13 },
+        { 32756, 7.9858303912982693e-11 },
+        { 32774, 7.9858303912982455e-13 },
+        { 45056, 3.1792163415998766e-14 },
+        { 49152, 7.9858303912982621e-15 } } }
+  };
+  for (const auto &samples : expected)
+    {
+      // the pinned values hold for every instruction set the CPU supports
+      for (int isa = MmWavePsdKernels::SCALAR; isa <= MmWavePsdKernels::AVX; isa++)
+        {
+          if (!MmWavePsdKernels::SetIsa (MmWavePsdKernels::Isa (isa)))
+            {
+              continue;
+            }
+          Ptr<SpectrumValue> tx = MmWaveSpectrumValueHelper::CreateMmWaveOfdmTxPowerSpectralDensity (60480, samples.channelWidth, txPowerW, samples.channelWidth);
+          Ptr<SpectrumValue> noise = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (60480, samples.channelWidth, 78125, 7, samples.channelWidth);
+          NS_TEST_ASSERT_MSG_EQ (tx->GetValuesN (), samples.nBands, "Unexpected number of bands for " << samples.channelWidth << " MHz");
+          for (const auto &value : samples.values)
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL ((*tx)[value.first], value.second, 1e-12 * value.second,
+                                         "TX PSD changed at band " << value.first << " for " << samples.channelWidth << " MHz, ISA " << isa);
+              NS_TEST_ASSERT_MSG_EQ_TOL ((*noise)[value.first], expectedNoise, 1e-12 * expectedNoise,
+                                         "Noise PSD changed at band " << value.first << " for " << samples.channelWidth << " MHz, ISA " << isa);
+            }
+        }
+    }
+
+  for (uint16_t channelWidth : {320, 640, 1280})
+    {
+      MmWavePsdKernels::SetVectorized (false);
+      Ptr<SpectrumValue> scalarTx = MmWaveSpectrumValueHelper::CreateMmWaveOfdmTxPowerSpectralDensity (60480, channelWidth, txPowerW, channelWidth);
+      Ptr<SpectrumValue> scalarNoise = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (60480, channelWidth, 78125, 7, channelWidth);
+      for (int isa = MmWavePsdKernels::SSE2; isa <= MmWavePsdKernels::AVX; isa++)
+        {
+          if (!MmWavePsdKernels::SetIsa (MmWavePsdKernels::Isa (isa)))
+            {
+              continue;
+            }
+          Ptr<SpectrumValue> tx = MmWaveSpectrumValueHelper::CreateMmWaveOfdmTxPowerSpectralDensity (60480, channelWidth, txPowerW, channelWidth);
+          Ptr<SpectrumValue> noise = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (60480, channelWidth, 78125, 7, channelWidth);
+
+          NS_TEST_ASSERT_MSG_EQ (tx->GetValuesN (), scalarTx->GetValuesN (), "Unexpected number of bands");
+          for (uint32_t i = 0; i < tx->GetValuesN (); i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL ((*tx)[i], (*scalarTx)[i], 1e-12 * (*scalarTx)[i], "TX PSD differs at band " << i << " for " << channelWidth << " MHz, ISA " << isa);
+              NS_TEST_ASSERT_MSG_EQ ((*noise)[i], (*scalarNoise)[i], "Noise PSD differs at band " << i << " for " << channelWidth << " MHz, ISA " << isa);
+            }
+          NS_TEST_ASSERT_MSG_EQ_TOL (Integral (*tx), txPowerW, 1e-9, "Unexpected transmit power for " << channelWidth << " MHz, ISA " << isa);
+        }
+    }
+  MmWavePsdKernels::SetVectorized (true);
+}
+
+/**
+ * Check that the table-driven NIST error model stays close to the analytic one.
+ */
+class MmWaveNistErrorRateTableTestCase : public TestCase
+{
+public:
+  MmWaveNistErrorRateTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveNistErrorRateTableTestCase::MmWaveNistErrorRateTableTestCase ()
+  : TestCase ("Check the accuracy of the table-driven mmWave NIST error rate model")
+{
+}
+
+void
+MmWaveNistErrorRateTableTestCase::DoRun (void)
+{
+  Ptr<MmWaveNistErrorRateModel> analytic = CreateObject<MmWaveNistErrorRateModel> ();
+  Ptr<MmWaveNistErrorRateModel> table = CreateObject<MmWaveNistErrorRateModel> ();
+  table->SetUseTable (true);
+  MmWaveTxVector txVector;
+  for (uint8_t mcs = 0; mcs < 4; mcs++)
+    {
+      MmWaveMode mode = MmWavePhy::GetMmWaveMcs (mcs);
+      for (uint64_t nbits : {8, 12000, 524280})
+        {
+          // covers both edges of the table and the snr values in between the grid points
+          for (double snrDb = -12.0; snrDb <= 62.0; snrDb += 0.137)
+            {
+              double snr = std::pow (10.0, snrDb / 10.0);
+              double expected = analytic->GetChunkSuccessRate (mode, txVector, snr, nbits);
+              double actual = table->GetChunkSuccessRate (mode, txVector, snr, nbits);
+              NS_TEST_ASSERT_MSG_EQ_TOL (actual, expected, 1e-4, "MCS " << +mcs << ", " << nbits << " bits, SNR " << snrDb << " dB");
+            }
+        }
+    }
+}
+
+/**
+ * Check the table-based error rate model against the values of the tables searched
+ * SNR by SNR, and the batch lookups against the chunk by chunk ones.
+ */
+class MmWaveTableErrorRateTestCase : public TestCase
+{
+public:
+  MmWaveTableErrorRateTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param mcs an MCS value
+   * \return a mode with the MCS value
+   */
+  static MmWaveMode GetMode (uint8_t mcs);
+};
+
+MmWaveTableErrorRateTestCase::MmWaveTableErrorRateTestCase ()
+  : TestCase ("Check the lookups of the mmWave table-based error rate model")
+{
+}
+
+MmWaveMode
+MmWaveTableErrorRateTestCase::GetMode (uint8_t mcs)
+{
+  std::ostringstream name;
+  name << "MmWaveTableTestMcs" << +mcs;
+  return MmWaveModeFactory::CreateMmWaveMcs (name.str (), mcs, MMWAVE_MOD_CLASS_OFDM);
+}
+
+void
+MmWaveTableErrorRateTestCase::DoRun (void)
+{
+  Ptr<MmWaveTableBasedErrorRateModel> model = CreateObject<MmWaveTableBasedErrorRateModel> ();
+
+  // success rates given by the tables of (SNR, PER) pairs before they were flattened:
+  // below and above the tables, on their grid points and in between, and for sizes
+  // other than the size of the table (256 bits for the small BCC frames, 11664 bits otherwise)
+  struct Sample
+  {
+    bool ldpc;
+    uint8_t mcs;
+    uint64_t nbits;
+    double snrDb;
+    double csr;
+  };
+  const std::vector<Sample> samples = {
+    { false, 0, 256, -4, 0 },
+    { false, 0, 256, -3.2, 0 },
+    { false, 0, 256, -2.1, 0.10668499999999992 },
+    { false, 0, 256, -1, 0.65250999999999992 },
+    { false, 0, 256, -0.93, 0.69624599999999992 },
+    { false, 0, 256, 2.4, 1 },
+    { false, 0, 256, 2.5, 1 },
+    { false, 0, 800, -0.93, 0.32257705935175385 },
+    { false, 0, 8, -0.93, 0.98874963181394016 },
+    { false, 9, 256, 23, 0.33828000000000003 },
+    { false, 9, 256, 23.07, 0.36909400000000026 },
+    { false, 3, 11664, 7.9, 0 },
+    { false, 3, 11664, 8, 0 },
+    { false, 3, 11664, 8.1, 0.0012449999999999406 },
+    { false, 3, 11664, 9, 0.39607999999999999 },
+    { false, 3, 11664, 9.13, 0.5360575000000013 },
+    { false, 3, 11664, 12.2, 1 },
+    { false, 3, 24000, 9.13, 0.2772182148767095 },
+    { true, 2, 11664, 3.9, 0 },
+    { true, 2, 11664, 4, 0 },
+    { true, 2, 11664, 4.1, 0.0051200000000000134 },
+    { true, 2, 11664, 4.25, 0.012800000000000034 },
+    { true, 2, 11664, 4.37, 0.18636800000000009 },
+    { true, 2, 11664, 4.5, 0.37439999999999996 },
+    { true, 2, 11664, 6, 1 },
+    { true, 2, 11664, 6.1, 1 },
+    { true, 2, 800, 4.37, 0.89116245729328125 },
+    { true, 2, 24000, 4.37, 0.031528729493017216 },
+    { true, 11, 11664, 27.75, 0 },
+    { true, 11, 11664, 28, 0.051200000000000023 },
+    { true, 11, 11664, 28.63, 0.72260399999999902 },
+    { true, 11, 11664, 30.5, 1 },
+    { true, 11, 11664, 31, 1 }
+  };
+  for (const auto &sample : samples)
+    {
+      MmWaveTxVector txVector;
+      txVector.SetMode (GetMode (sample.mcs));
+      txVector.SetLdpc (sample.ldpc);
+      double snr = std::pow (10.0, sample.snrDb / 10.0);
+      double csr = model->GetChunkSuccessRate (txVector.GetMode (), txVector, snr, sample.nbits);
+      NS_TEST_ASSERT_MSG_EQ_TOL (csr, sample.csr, 1e-12, (sample.ldpc ? "LDPC" : "BCC") << " MCS " << +sample.mcs << ", "
+                                 << sample.nbits << " bits, SNR " << sample.snrDb << " dB");
+      double batchCsr;
+      model->GetChunkSuccessRates (txVector.GetMode (), txVector, &snr, &sample.nbits, &batchCsr, 1);
+      NS_TEST_ASSERT_MSG_EQ (batchCsr, csr, "Batch lookup differs for " << (sample.ldpc ? "LDPC" : "BCC") << " MCS " << +sample.mcs);
+    }
+
+  // every 0.01 dB (the precision of the lookups) from below to above each table, with chunks of every table size
+  const uint64_t nbits[] = {8, 256, 3200, 11664, 24000};
+  for (bool ldpc : {false, true})
+    {
+      uint8_t maxMcs = ldpc ? MMWAVE_ERROR_TABLE_LDPC_MAX_NUM_MCS : MMWAVE_ERROR_TABLE_BCC_MAX_NUM_MCS;
+      for (uint8_t mcs = 0; mcs <= maxMcs; mcs++)
+        {
+          double minSnr = ldpc ? MmWaveAwgnErrorTableLdpc1458Index[mcs].minSnr : std::min (MmWaveAwgnErrorTableBcc32Index[mcs].minSnr, MmWaveAwgnErrorTableBcc1458Index[mcs].minSnr);
+          std::vector<double> snrs;
+          std::vector<uint64_t> chunkBits;
+          for (int step = -100; step < 1000; step++)
+            {
+              snrs.push_back (std::pow (10.0, (minSnr + step * 0.01) / 10.0));
+              chunkBits.push_back (nbits[(step + 100) % 5]);
+            }
+          MmWaveTxVector txVector;
+          txVector.SetMode (GetMode (mcs));
+          txVector.SetLdpc (ldpc);
+          std::vector<double> csrs (snrs.size ());
+          model->GetChunkSuccessRates (txVector.GetMode (), txVector, snrs.data (), chunkBits.data (), csrs.data (), snrs.size ());
+          for (std::size_t i = 0; i < snrs.size (); i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (csrs[i], model->GetChunkSuccessRate (txVector.GetMode (), txVector, snrs[i], chunkBits[i]),
+                                     "Batch lookup differs for " << (ldpc ? "LDPC" : "BCC") << " MCS " << +mcs << ", " << chunkBits[i] << " bits, chunk " << i);
+            }
+        }
+    }
+}
+
+/**
+ * Check the SNR and PER computed by the interference helper against the values of
+ * the map-based NI changes it replaced, with interferers overlapping each other and
+ * arriving in the preamble, the header and the payload of the received frames.
+ */
+class MmWaveInterferenceHelperTestCase : public TestCase
+{
+public:
+  MmWaveInterferenceHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a frame to the interference helper.
+   * \param powerDbm the received power on each of the two bands
+   * \param powerOffsetDb the power on the second band relative to the first one
+   * \param duration the duration of the frame
+   * \param mcs the MCS of the frame
+   */
+  void AddFrame (double powerDbm, double powerOffsetDb, Time duration, uint8_t mcs);
+  /**
+   * Add a signal that is not a frame to the interference helper.
+   * \param powerDbm the received power on the first band
+   * \param powerOffsetDb the power on the second band relative to the first one
+   * \param duration the duration of the signal
+   */
+  void AddForeignSignal (double powerDbm, double powerOffsetDb, Time duration);
+  /**
+   * Store the SNR and PER of the header and of payload windows of a frame, on each band.
+   * \param frame the index of the frame
+   */
+  void Evaluate (std::size_t frame);
+
+  MmWaveInterferenceHelper m_interference; //!< the helper under test
+  std::vector<Ptr<MmWaveEvent> > m_frames; //!< the frames added
+  std::vector<double> m_results;           //!< the SNR and PER computed, in order
+};
+
+MmWaveInterferenceHelperTestCase::MmWaveInterferenceHelperTestCase ()
+  : TestCase ("Check the SNR and PER of the mmWave interference helper")
+{
+}
+
+void
+MmWaveInterferenceHelperTestCase::AddFrame (double powerDbm, double powerOffsetDb, Time duration, uint8_t mcs)
+{
+  MmWaveTxVector txVector;
+  txVector.SetMode (MmWavePhy::GetMmWaveMcs (mcs));
+  MmWaveRxPowers rxPowers (m_interference.GetBandLayout ());
+  rxPowers.Set (0, m_interference.DbmToW (powerDbm));
+  rxPowers.Set (1, m_interference.DbmToW (powerDbm + powerOffsetDb));
+  m_frames.push_back (m_interference.Add (0, txVector, duration, rxPowers));
+}
+
+void
+MmWaveInterferenceHelperTestCase::AddForeignSignal (double powerDbm, double powerOffsetDb, Time duration)
+{
+  MmWaveRxPowers rxPowers (m_interference.GetBandLayout ());
+  rxPowers.Set (0, m_interference.DbmToW (powerDbm));
+  rxPowers.Set (1, m_interference.DbmToW (powerDbm + powerOffsetDb));
+  m_interference.AddForeignSignal (duration, rxPowers);
+}
+
+void
+MmWaveInterferenceHelperTestCase::Evaluate (std::size_t frame)
+{
+  Ptr<MmWaveEvent> event = m_frames[frame];
+  // the payload starts after the preamble and the header, 4575 ns after the frame
+  int64_t payloadNs = event->GetDuration ().GetNanoSeconds () - 4575;
+  std::pair<Time, Time> windows[] = {
+    std::make_pair (NanoSeconds (0), NanoSeconds (payloadNs)),
+    std::make_pair (NanoSeconds (0), NanoSeconds (payloadNs / 2)),
+    std::make_pair (NanoSeconds (payloadNs / 4), NanoSeconds (payloadNs * 3 / 4))
+  };
+  for (std::size_t band = 0; band < 2; band++)
+    {
+      MmWaveSpectrumBand spectrumBand = m_interference.GetBandLayout ()->GetBand (band);
+      MmWaveInterferenceHelper::SnrPer header = m_interference.CalculatePhyHeaderSnrPer (event, spectrumBand);
+      m_results.push_back (header.snr);
+      m_results.push_back (header.per);
+      for (const auto &window : windows)
+        {
+          MmWaveInterferenceHelper::SnrPer payload = m_interference.CalculatePayloadSnrPer (event, 1280, spectrumBand, window);
+          m_results.push_back (payload.snr);
+          m_results.push_back (payload.per);
+        }
+      m_results.push_back (m_interference.CalculateSnr (event, 1280, 1, spectrumBand));
+    }
+}
+
+void
+MmWaveInterferenceHelperTestCase::DoRun (void)
+{
+  Ptr<MmWaveTableBasedErrorRateModel> errorRateModel = CreateObject<MmWaveTableBasedErrorRateModel> ();
+  m_interference.SetNoiseFigure (m_interference.DbToRatio (7));
+  m_interference.SetErrorRateModel (errorRateModel);
+  m_interference.AddBand (std::make_pair (1, 100));
+  m_interference.AddBand (std::make_pair (101, 200));
+
+  // frame 0 is received from 10 to 70 us; it starts during a foreign signal and is
+  // overlapped by frame 1 from its preamble, by a foreign signal from its header, and
+  // by frame 2 and another foreign signal from its payload. Frame 1 is evaluated while
+  // frame 0 is received. Frame 3 is received from 95 to 125 us, after the end of the
+  // reception of frame 0 and while frame 2 is still on the air; it is evaluated at the
+  // end of its header too, like the PHY does, and again at its end.
+  Simulator::Schedule (MicroSeconds (0), &MmWaveInterferenceHelperTestCase::AddForeignSignal, this, -84.0, 2.0, MicroSeconds (30));
+  Simulator::Schedule (MicroSeconds (10), &MmWaveInterferenceHelper::NotifyRxStart, &m_interference);
+  Simulator::Schedule (MicroSeconds (10), &MmWaveInterferenceHelperTestCase::AddFrame, this, -62.0, -12.0, MicroSeconds (60), 2);
+  Simulator::Schedule (MicroSeconds (12), &MmWaveInterferenceHelperTestCase::AddFrame, this, -70.0, 10.0, MicroSeconds (20), 3);
+  Simulator::Schedule (MicroSeconds (14), &MmWaveInterferenceHelperTestCase::AddForeignSignal, this, -80.0, -4.0, MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (32), &MmWaveInterferenceHelperTestCase::Evaluate, this, 1);
+  Simulator::Schedule (MicroSeconds (40), &MmWaveInterferenceHelperTestCase::AddFrame, this, -79.0, 12.0, MicroSeconds (60), 1);
+  Simulator::Schedule (MicroSeconds (55), &MmWaveInterferenceHelperTestCase::AddForeignSignal, this, -82.0, 5.0, MicroSeconds (5));
+  Simulator::Schedule (MicroSeconds (70), &MmWaveInterferenceHelperTestCase::Evaluate, this, 0);
+  Simulator::Schedule (MicroSeconds (70), &MmWaveInterferenceHelper::NotifyRxEnd, &m_interference);
+  Simulator::Schedule (MicroSeconds (95), &MmWaveInterferenceHelper::NotifyRxStart, &m_interference);
+  Simulator::Schedule (MicroSeconds (95), &MmWaveInterferenceHelperTestCase::AddFrame, this, -64.0, -2.0, MicroSeconds (30), 2);
+  Simulator::Schedule (NanoSeconds (99575), &MmWaveInterferenceHelperTestCase::Evaluate, this, 3);
+  Simulator::Schedule (MicroSeconds (105), &MmWaveInterferenceHelperTestCase::AddForeignSignal, this, -83.0, 0.0, MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (125), &MmWaveInterferenceHelperTestCase::Evaluate, this, 3);
+  Simulator::Schedule (MicroSeconds (125), &MmWaveInterferenceHelper::NotifyRxEnd, &m_interference);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // values computed with the map-based NI changes, for each evaluation and band: the SNR and
+  // PER of the header, the SNR and PER of the three payload windows and the SNR
+  const double expected[] = {
+    // frame 1, band 0
+    0.15229125023403972, 1, 0.15229125023403972, 1, 0.15229125023403972, 1, 0.15229125023403972, 1, 0.15229125023403972,
+    // frame 1, band 1
+    15.269526606079122, 0, 15.269526606079122, 0.0046338748205380087, 15.269526606079122, 0.0036339086865505577, 15.269526606079122, 0.0024054536188294895, 15.269526606079122,
+    // frame 0, band 0
+    16.487663073814755, 0, 16.487663073814755, 0.31192773700375775, 16.487663073814755, 0.31192773700375775, 16.487663073814755, 0.029824416159762501, 16.487663073814755,
+    // frame 0, band 1
+    0.17677512104633661, 1, 0.17677512104633661, 1, 0.17677512104633661, 1, 0.17677512104633661, 1, 0.17677512104633661,
+    // frame 3 at the end of its header, band 0
+    10.403012109738317, 1, 10.403012109738317, 1, 10.403012109738317, 1, 10.403012109738317, 0, 10.403012109738317,
+    // frame 3 at the end of its header, band 1
+    1.11537560945561, 0.97821259322691556, 1.11537560945561, 1, 1.11537560945561, 1, 1.11537560945561, 0, 1.11537560945561,
+    // frame 3, band 0
+    15.503099860308835, 1, 15.503099860308835, 1, 15.503099860308835, 1, 15.503099860308835, 0, 15.503099860308835,
+    // frame 3, band 1
+    9.7817947190716925, 0.97821259322691556, 9.7817947190716925, 1, 9.7817947190716925, 1, 9.7817947190716925, 0, 9.7817947190716925
+  };
+  NS_TEST_ASSERT_MSG_EQ (m_results.size (), sizeof (expected) / sizeof (expected[0]), "Unexpected number of results");
+  for (std::size_t i = 0; i < m_results.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (m_results[i], expected[i], 1e-9 * std::max (1.0, expected[i]), "Unexpected value " << i);
+    }
+}
+
+/**
+ * Check that the binary PHY trace stores the events it is given and reads them back as CSV.
+ */
+class MmWaveBinaryTraceTestCase : public TestCase
+{
+public:
+  MmWaveBinaryTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveBinaryTraceTestCase::MmWaveBinaryTraceTestCase ()
+  : TestCase ("Check the binary mmWave PHY trace")
+{
+}
+
+void
+MmWaveBinaryTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("mmwave-trace.bin");
+  // a small chunk makes the file grow several times
+  Ptr<MmWaveBinaryTraceFile> file = Create<MmWaveBinaryTraceFile> (filename, 4);
+  uint32_t source = file->AddSource (3, 1, MmWaveBinaryTraceFile::CR_INTER_GROUP);
+  Ptr<Packet> packet = Create<Packet> (1000);
+  MmWaveMode mode = MmWavePhy::GetMmWaveMcs (2);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      MmWaveBinaryTraceFile::MmWaveTxSink (file, source, packet, mode, MMWAVE_PREAMBLE_DEFAULT, 1, 2, 60480, 2160);
+      MmWaveBinaryTraceFile::MmWaveRxOkSink (file, source, packet, 12.5, mode, MMWAVE_PREAMBLE_DEFAULT, 2, 60480, 2160);
+    }
+  NS_TEST_ASSERT_MSG_EQ (file->GetNRecords (), 20, "Unexpected number of records");
+  file->Close ();
+
+  std::ostringstream csv;
+  NS_TEST_ASSERT_MSG_EQ (MmWaveBinaryTraceFile::ReadCsv (filename, csv), true, "Cannot read the binary trace");
+  std::istringstream lines (csv.str ());
+  std::string line;
+  std::getline (lines, line);
+  std::getline (lines, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "0,t,3,1,inter,2,60480,2160,2,1,1000,0", "Unexpected TX record");
+  std::getline (lines, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "0,r,3,1,inter,2,60480,2160,2,0,1000,12.5", "Unexpected RX record");
+  uint32_t nLines = 3;
+  while (std::getline (lines, line))
+    {
+      nLines++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (nLines, 21, "Unexpected number of CSV lines");
+
+  // a file that is not closed is completed when the simulator is destroyed
+  std::string openFilename = CreateTempDirFilename ("mmwave-trace-open.bin");
+  Ptr<MmWaveBinaryTraceFile> openFile = Create<MmWaveBinaryTraceFile> (openFilename, 4);
+  source = openFile->AddSource (3, 1, MmWaveBinaryTraceFile::CR_INTER_GROUP);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      MmWaveBinaryTraceFile::MmWaveTxSink (openFile, source, packet, mode, MMWAVE_PREAMBLE_DEFAULT, 1, 2, 60480, 2160);
+    }
+  Simulator::Destroy ();
+  std::ifstream in (openFilename.c_str (), std::ios::binary | std::ios::ate);
+  NS_TEST_ASSERT_MSG_EQ (in.tellg (), std::streampos (16 + 3 * sizeof (MmWaveBinaryTraceRecord)), "Binary trace not truncated when the simulator is destroyed");
+  std::ostringstream openCsv;
+  NS_TEST_ASSERT_MSG_EQ (MmWaveBinaryTraceFile::ReadCsv (openFilename, openCsv), true, "Cannot read the binary trace");
+  std::istringstream openLines (openCsv.str ());
+  nLines = 0;
+  while (std::getline (openLines, line))
+    {
+      nLines++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (nLines, 4, "Unexpected number of CSV lines");
+}
+
+/**
+ * Check that the statistics collector counts the events it is given, writes
+ * periodic snapshots and reads them back as CSV.
+ */
+class MmWaveStatsCollectorTestCase : public TestCase
+{
+public:
+  MmWaveStatsCollectorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveStatsCollectorTestCase::MmWaveStatsCollectorTestCase ()
+  : TestCase ("Check the mmWave statistics collector")
+{
+}
+
+void
+MmWaveStatsCollectorTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("mmwave-stats.bin");
+  Ptr<MmWaveStatsCollector> stats = Create<MmWaveStatsCollector> (filename, MilliSeconds (10));
+  stats->AddNode (2);
+  MmWaveStatsCollector::BulkAckSink (stats, 2, 5, 1, 5000);
+  MmWaveStatsCollector::MissedBulkAckSink (stats, 2, 4);
+  MmWaveStatsCollector::AccessGrantedSink (stats, 2, MicroSeconds (3));
+  MmWaveStatsCollector::AccessGrantedSink (stats, 2, Seconds (0));
+  Ptr<MmWaveMacQueueItem> item = Create<MmWaveMacQueueItem> (Create<Packet> (1000), MmWaveMacHeader ());
+  Simulator::Schedule (MilliSeconds (15), &MmWaveStatsCollector::QueueDequeueSink, stats, 2, item);
+  Simulator::Schedule (MilliSeconds (15), &MmWaveStatsCollector::BulkAckSink, stats, 0, 2, 0, 2000);
+  Simulator::Stop (MilliSeconds (25));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (stats->GetCounter (2, MmWaveStatsCollector::TX_MPDU_OK), 5, "Unexpected acknowledged MPDUs");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetCounter (2, MmWaveStatsCollector::TX_MPDU_FAILED), 5, "Unexpected failed MPDUs");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetCounter (2, MmWaveStatsCollector::ACCESS_DELAY_NS), 3000, "Unexpected access delay");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetCounter (0, MmWaveStatsCollector::TX_BYTES_OK), 2000, "Unexpected acknowledged bytes");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetHistogramCount (2, MmWaveStatsCollector::ACCESS_DELAY, 0), 1, "Unexpected access delay bin");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetHistogramCount (2, MmWaveStatsCollector::ACCESS_DELAY, 11), 1, "Unexpected access delay bin");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetHistogramCount (2, MmWaveStatsCollector::QUEUE_SOJOURN, 23), 1, "Unexpected queue sojourn bin");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetNSnapshots (), 2, "Unexpected number of periodic snapshots");
+  // the last snapshot is written when the simulator is destroyed
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (stats->GetNSnapshots (), 3, "Unexpected number of snapshots");
+
+  std::ostringstream csv;
+  NS_TEST_ASSERT_MSG_EQ (MmWaveStatsCollector::ReadCsv (filename, csv), true, "Cannot read the statistics");
+  std::istringstream lines (csv.str ());
+  std::vector<std::string> rows;
+  std::string line;
+  while (std::getline (lines, line))
+    {
+      rows.push_back (line);
+    }
+  // a header, then the three nodes of the three snapshots
+  NS_TEST_ASSERT_MSG_EQ (rows.size (), 10, "Unexpected number of CSV lines");
+  std::string header = "time_ns,node,tx_mpdu_ok,tx_mpdu_failed,tx_bytes_ok,bulk_ack_ok,bulk_ack_missed,";
+  NS_TEST_ASSERT_MSG_EQ (rows[0].compare (0, header.size (), header), 0, "Unexpected CSV header " << rows[0]);
+  std::string first = "10000000,2,5,5,5000,1,1,0,0,0,0,0,0,2,3000,0,0,";
+  NS_TEST_ASSERT_MSG_EQ (rows[3].compare (0, first.size (), first), 0, "Unexpected first snapshot " << rows[3]);
+  std::string second = "20000000,2,5,5,5000,1,1,0,0,0,1,0,15000000,2,3000,0,0,";
+  NS_TEST_ASSERT_MSG_EQ (rows[6].compare (0, second.size (), second), 0, "Unexpected second snapshot " << rows[6]);
+  std::string last = "25000000,0,2,0,2000,1,0,";
+  NS_TEST_ASSERT_MSG_EQ (rows[7].compare (0, last.size (), last), 0, "Unexpected last snapshot " << rows[7]);
+}
+
+/**
+ * Check that the indexed MAC queue returns the same items and fires the same
+ * traces as the scans of the queue, with expired items at the head, in the
+ * middle and at the tail of the queue.
+ */
+class MmWaveMacQueueIndexTestCase : public TestCase
+{
+public:
+  MmWaveMacQueueIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the sequence of operations on a new queue.
+   * \param indexed whether the queue is indexed
+   * \return the results of the operations and the traces, in order
+   */
+  std::vector<std::string> RunSequence (bool indexed);
+  /**
+   * Run the operations of a step of the sequence.
+   * \param queue the queue
+   * \param step the step
+   */
+  void DoStep (Ptr<MmWaveMacQueue> queue, uint32_t step);
+  /**
+   * Create a queue item, identified by its size.
+   * \param size the size of the packet
+   * \param address the last byte of the destination address
+   * \param channel the channel number
+   * \param data whether the item is a data frame or a beacon
+   * \param tstamp the timestamp of the item
+   * \return the item
+   */
+  static Ptr<MmWaveMacQueueItem> CreateItem (uint32_t size, uint8_t address, uint8_t channel, bool data, Time tstamp);
+  /**
+   * \param address the last byte of the address
+   * \return the address
+   */
+  static Mac48Address GetAddress (uint8_t address);
+  /**
+   * \param channel the channel number
+   * \return the channel
+   */
+  static MmWaveChannelNumberStandardPair GetChannel (uint8_t channel);
+  /**
+   * \param item an item, or 0
+   * \return the size of the item, or "none"
+   */
+  static std::string Describe (Ptr<const MmWaveMacQueueItem> item);
+  /**
+   * Sink of the queue traces.
+   * \param log the log
+   * \param event the trace
+   * \param item the item
+   */
+  static void Trace (std::vector<std::string> *log, std::string event, Ptr<const MmWaveMacQueueItem> item);
+
+  std::vector<std::string> m_log; //!< results and traces of the current run
+};
+
+MmWaveMacQueueIndexTestCase::MmWaveMacQueueIndexTestCase ()
+  : TestCase ("Check the indexed mmWave MAC queue against the queue scans")
+{
+}
+
+Mac48Address
+MmWaveMacQueueIndexTestCase::GetAddress (uint8_t address)
+{
+  uint8_t buffer[6] = {0, 0, 0, 0, 0, address};
+  Mac48Address mac;
+  mac.CopyFrom (buffer);
+  return mac;
+}
+
+MmWaveChannelNumberStandardPair
+MmWaveMacQueueIndexTestCase::GetChannel (uint8_t channel)
+{
+  return MmWaveChannelNumberStandardPair (MmWaveChannelNumberBandPair (channel, MMWAVE_PHY_BAND_60GHZ), MMWAVE_PHY_STANDARD_320MHz);
+}
+
+Ptr<MmWaveMacQueueItem>
+MmWaveMacQueueIndexTestCase::CreateItem (uint32_t size, uint8_t address, uint8_t channel, bool data, Time tstamp)
+{
+  MmWaveMacHeader header;
+  header.SetType (data ? MMWAVE_MAC_DATA : MMWAVE_MAC_MGT_BEACON);
+  header.SetAddr1 (GetAddress (address));
+  return Create<MmWaveMacQueueItem> (Create<Packet> (size), header, GetChannel (channel), tstamp);
+}
+
+std::string
+MmWaveMacQueueIndexTestCase::Describe (Ptr<const MmWaveMacQueueItem> item)
+{
+  std::ostringstream os;
+  if (item == 0)
+    {
+      os << "none";
+    }
+  else
+    {
+      os << item->GetPacket ()->GetSize ();
+    }
+  return os.str ();
+}
+
+void
+MmWaveMacQueueIndexTestCase::Trace (std::vector<std::string> *log, std::string event, Ptr<const MmWaveMacQueueItem> item)
+{
+  log->push_back (event + " " + Describe (item));
+}
+
+void
+MmWaveMacQueueIndexTestCase::DoStep (Ptr<MmWaveMacQueue> queue, uint32_t step)
+{
+  Time now = Simulator::Now ();
+  std::ostringstream os;
+  MmWaveMacQueue::ConstIterator it;
+  switch (step)
+    {
+    case 0:
+      os << "Enqueue " << queue->Enqueue (CreateItem (101, 1, 1, true, now));
+      os << " " << queue->Enqueue (CreateItem (102, 2, 1, true, now));
+      os << " " << queue->Enqueue (CreateItem (103, 1, 2, false, now));
+      os << " " << queue->Enqueue (CreateItem (104, 3, 2, true, now));
+      break;
+    case 1:
+      os << "Enqueue " << queue->Enqueue (CreateItem (105, 2, 2, true, now));
+      // the queue is full and no item is expired
+      os << " " << queue->Enqueue (CreateItem (106, 1, 1, true, now));
+      break;
+    case 2:
+      os << "Dequeue " << Describe (queue->Dequeue ());
+      // a retransmission younger than the items behind it
+      os << " PushFront " << queue->PushFront (CreateItem (107, 3, 1, true, now));
+      it = queue->PeekByAddress (GetAddress (1));
+      os << " PeekByAddress " << (it == queue->end () ? "end" : Describe (*it));
+      os << " GetNPacketsByAddress " << queue->GetNPacketsByAddress (GetAddress (2));
+      break;
+    case 3:
+      os << "Enqueue " << queue->Enqueue (CreateItem (108, 2, 1, true, now));
+      os << " FindByChannel " << queue->FindByChannel (GetChannel (2));
+      os << " PeekItemByAddress " << Describe (queue->PeekItemByAddress (GetAddress (3)));
+      break;
+    case 4:
+      // the items behind the live head are expired
+      os << "Dequeue " << Describe (queue->Dequeue ());
+      it = queue->PeekByChannel (GetChannel (2));
+      os << " PeekByChannel " << (it == queue->end () ? "end" : Describe (*it));
+      os << " Enqueue " << queue->Enqueue (CreateItem (109, 1, 2, true, now));
+      // the queue is full: the first expired item makes room
+      os << " " << queue->Enqueue (CreateItem (110, 3, 1, true, now));
+      os << " PushFront " << queue->PushFront (CreateItem (111, 2, 1, true, now));
+      os << " FindByAddress " << queue->FindByAddress (GetAddress (3));
+      os << " DequeueByChannel " << Describe (queue->DequeueByChannel (GetChannel (2)));
+      break;
+    case 5:
+      os << "Enqueue " << queue->Enqueue (CreateItem (112, 1, 2, false, now));
+      os << " PushFront " << queue->PushFront (CreateItem (113, 2, 2, true, MilliSeconds (1)));
+      os << " PeekFrontNAddresses";
+      for (const auto &address : queue->PeekFrontNAddresses (2))
+        {
+          os << " " << address;
+        }
+      os << " PushFront " << queue->PushFront (CreateItem (114, 3, 1, true, MilliSeconds (2)));
+      os << " Enqueue " << queue->Enqueue (CreateItem (115, 2, 1, true, MilliSeconds (3)));
+      os << " GetBulkAccessRequestsInQueue";
+      for (const auto &requests : queue->GetBulkAccessRequestsInQueue (2, GetChannel (1)))
+        {
+          os << " " << requests.first << " " << requests.second.size ();
+        }
+      os << " PeekFrontNItemByChannel";
+      for (const auto &item : queue->PeekFrontNItemByChannel (5, GetChannel (1)))
+        {
+          os << " " << Describe (item);
+        }
+      break;
+    case 6:
+      os << "PushFront " << queue->PushFront (CreateItem (116, 1, 1, true, Seconds (0)));
+      os << " IsEmpty " << queue->IsEmpty ();
+      os << " PushFront " << queue->PushFront (CreateItem (118, 3, 2, true, Seconds (0)));
+      it = queue->PeekByAddressAndChannel (GetAddress (1), GetChannel (2));
+      os << " PeekByAddressAndChannel " << (it == queue->end () ? "end" : Describe (*it));
+      os << " DequeueByAddressAndChannel " << Describe (queue->DequeueByAddressAndChannel (GetAddress (1), GetChannel (2)));
+      os << " GetNeedToAccessExcludedChannel " << static_cast<uint32_t> (queue->GetNeedToAccessExcludedChannel (GetChannel (1)).first.first);
+      os << " Remove " << queue->Remove (queue->PeekItemByAddress (GetAddress (3))->GetPacket ());
+      break;
+    case 7:
+      os << "DequeueFirstAvailable " << Describe (queue->DequeueFirstAvailable ());
+      os << " Enqueue " << queue->Enqueue (CreateItem (119, 1, 1, true, now));
+      os << " " << queue->Enqueue (CreateItem (120, 2, 2, false, now));
+      os << " " << queue->Enqueue (CreateItem (121, 1, 2, true, now));
+      break;
+    case 8:
+      os << "PushFront " << queue->PushFront (CreateItem (122, 2, 1, true, MilliSeconds (5)));
+      it = queue->Remove (queue->PeekFirstAvailable (), true);
+      os << " Remove " << (it == queue->end () ? "end" : Describe (*it));
+      os << " FindByAddressAndChannel " << queue->FindByAddressAndChannel (GetAddress (1), GetChannel (2));
+      os << " Remove " << Describe (queue->Remove ());
+      os << " GetNPackets " << queue->GetNPackets () << " GetNBytes " << queue->GetNBytes ();
+      break;
+    case 9:
+      os << "Peek " << Describe (queue->Peek ());
+      os << " GetNPackets " << queue->GetNPackets ();
+      os << " Dequeue " << Describe (queue->Dequeue ());
+      break;
+    }
+  m_log.push_back (os.str ());
+}
+
+std::vector<std::string>
+MmWaveMacQueueIndexTestCase::RunSequence (bool indexed)
+{
+  m_log.clear ();
+  Ptr<MmWaveMacQueue> queue = CreateObject<MmWaveMacQueue> ();
+  queue->SetAttribute ("MaxSize", QueueSizeValue (QueueSize ("5p")));
+  queue->SetAttribute ("MaxDelay", TimeValue (MilliSeconds (10)));
+  queue->SetAttribute ("Indexed", BooleanValue (indexed));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeBoundCallback (&MmWaveMacQueueIndexTestCase::Trace, &m_log, std::string ("enqueue")));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&MmWaveMacQueueIndexTestCase::Trace, &m_log, std::string ("dequeue")));
+  queue->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&MmWaveMacQueueIndexTestCase::Trace, &m_log, std::string ("drop")));
+  queue->TraceConnectWithoutContext ("Expired", MakeBoundCallback (&MmWaveMacQueueIndexTestCase::Trace, &m_log, std::string ("expired")));
+  uint32_t times[] = {0, 2, 6, 8, 11, 13, 15, 22, 25, 40};
+  for (uint32_t step = 0; step < sizeof (times) / sizeof (times[0]); step++)
+    {
+      Simulator::Schedule (MilliSeconds (times[step]), &MmWaveMacQueueIndexTestCase::DoStep, this, queue, step);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_log;
+}
+
+void
+MmWaveMacQueueIndexTestCase::DoRun (void)
+{
+  std::vector<std::string> scanned = RunSequence (false);
+  std::vector<std::string> indexed = RunSequence (true);
+  NS_TEST_ASSERT_MSG_EQ (indexed.size (), scanned.size (), "Different number of results and traces");
+  for (std::size_t i = 0; i < std::min (indexed.size (), scanned.size ()); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (indexed[i], scanned[i], "Different result or trace " << i);
+    }
+  // expired items behind a live head stay queued until a scan reaches them
+  uint32_t nExpired = 0;
+  for (const auto &line : scanned)
+    {
+      nExpired += (line.compare (0, 8, "expired ") == 0) ? 1 : 0;
+    }
+  NS_TEST_ASSERT_MSG_EQ (nExpired, 11u, "Unexpected number of expired items");
+}
+
+/**
+ * Check the pruning and the statistics of the spectrum repository, with records
+ * spread over several cells of its grid.
+ */
+class MmWaveSpectrumRepositoryTestCase : public TestCase
+{
+public:
+  MmWaveSpectrumRepositoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a record.
+   * \param position the position of the detection
+   * \param state the state of the channel
+   * \param power the power detected
+   * \param occupiedUs the occupied duration, in microseconds
+   * \param startUs the start of the detection window, in microseconds
+   * \param endUs the end of the detection window, in microseconds
+   * \param update the update time
+   * \return the record
+   */
+  static Ptr<MmWaveSpectrumData> CreateRecord (Vector position, MmWaveChannelState state, double power,
+                                               int64_t occupiedUs, int64_t startUs, int64_t endUs, Time update);
+  /**
+   * Check the statistics of a channel.
+   * \param repository the repository
+   * \param channel the channel number
+   * \param avgPower the expected average power
+   * \param durationForPUs the expected duration occupied by PUs, in microseconds
+   * \param durationForSUs the expected duration occupied by SUs, in microseconds
+   * \param totalDuration the expected duration of the detection windows, in microseconds
+   * \param stage the stage of the test
+   */
+  void CheckStatistics (Ptr<MmWaveSpectrumRepository> repository, uint8_t channel, double avgPower,
+                        double durationForPUs, double durationForSUs, double totalDuration, std::string stage);
+};
+
+MmWaveSpectrumRepositoryTestCase::MmWaveSpectrumRepositoryTestCase ()
+  : TestCase ("Check the pruning and the statistics of the mmWave spectrum repository")
+{
+}
+
+Ptr<MmWaveSpectrumData>
+MmWaveSpectrumRepositoryTestCase::CreateRecord (Vector position, MmWaveChannelState state, double power,
+                                                int64_t occupiedUs, int64_t startUs, int64_t endUs, Time update)
+{
+  Ptr<MmWaveSpectrumData> data = Create<MmWaveSpectrumData> ();
+  data->SetPosition (position);
+  data->SetChannelState (state);
+  data->SetPower (power);
+  data->SetOccupiedDuration (MicroSeconds (occupiedUs));
+  data->SetDetectionStart (MicroSeconds (startUs));
+  data->SetDetectionEnd (MicroSeconds (endUs));
+  data->SetUpdateTime (update);
+  return data;
+}
+
+void
+MmWaveSpectrumRepositoryTestCase::CheckStatistics (Ptr<MmWaveSpectrumRepository> repository, uint8_t channel, double avgPower,
+                                                   double durationForPUs, double durationForSUs, double totalDuration, std::string stage)
+{
+  MmWaveChannelNumberStandardPair c (MmWaveChannelNumberBandPair (channel, MMWAVE_PHY_BAND_60GHZ), MMWAVE_PHY_STANDARD_640MHz);
+  Ptr<MmWaveSpectrumStatistical> statistic = repository->GetStatisticalInfo (Vector (0, 0, 0), c);
+  NS_TEST_ASSERT_MSG_EQ (statistic->IsValid (), true, "Channel " << +channel << " has no records " << stage);
+  NS_TEST_ASSERT_MSG_EQ (statistic->IsAnyPUs (), (durationForPUs > 0), "Unexpected PUs on channel " << +channel << " " << stage);
+  NS_TEST_ASSERT_MSG_EQ (statistic->IsAnySUs (), (durationForSUs > 0), "Unexpected SUs on channel " << +channel << " " << stage);
+  NS_TEST_ASSERT_MSG_EQ_TOL (statistic->GetAvgPower (), avgPower, 1e-12, "Unexpected average power on channel " << +channel << " " << stage);
+  NS_TEST_ASSERT_MSG_EQ_TOL (statistic->GetUtilizationForPUs (), durationForPUs / totalDuration, 1e-12,
+                             "Unexpected PU utilization on channel " << +channel << " " << stage);
+  NS_TEST_ASSERT_MSG_EQ_TOL (statistic->GetUtilizationForSUs (), durationForSUs / totalDuration, 1e-12,
+                             "Unexpected SU utilization on channel " << +channel << " " << stage);
+  NS_TEST_ASSERT_MSG_EQ_TOL (statistic->GetVacancyRate (), (totalDuration - durationForPUs - durationForSUs) / totalDuration, 1e-12,
+                             "Unexpected vacancy rate on channel " << +channel << " " << stage);
+}
+
+void
+MmWaveSpectrumRepositoryTestCase::DoRun (void)
+{
+  Ptr<MmWaveSpectrumRepository> repository = CreateObject<MmWaveSpectrumRepository> ();
+  // cells of 7 m: the records below fall in cells on both sides of the origin
+  repository->SetAttribute ("GridCellSize", DoubleValue (7));
+  repository->SetAttribute ("MaxRadius", DoubleValue (20));
+  repository->SetAttribute ("MaxDelay", TimeValue (Seconds (1)));
+  repository->SetChannelToFrequencyWidth (MMWAVE_PHY_STANDARD_640MHz, MMWAVE_PHY_BAND_60GHZ);
+  MmWaveChannelNumberStandardPair channel3 (MmWaveChannelNumberBandPair (3, MMWAVE_PHY_BAND_60GHZ), MMWAVE_PHY_STANDARD_640MHz);
+  MmWaveChannelNumberStandardPair channel4 (MmWaveChannelNumberBandPair (4, MMWAVE_PHY_BAND_60GHZ), MMWAVE_PHY_STANDARD_640MHz);
+
+  // channel 3: the update times are not in insertion order
+  repository->AddActivityInfoToRepository (channel3, CreateRecord (Vector (1, 1, 0), UTILIZED_BY_PUs, 2, 100, 0, 1000, Seconds (0.5)));
+  repository->AddActivityInfoToRepository (channel3, CreateRecord (Vector (15, 0, 0), UTILIZED_BY_SUs, 4, 300, 0, 1000, Seconds (2)));
+  repository->AddActivityInfoToRepository (channel3, CreateRecord (Vector (-13, 6, 0), UTILIZED_BY_PUs, 1, 200, 1000, 1500, Seconds (1.5)));
+  repository->AddActivityInfoToRepository (channel3, CreateRecord (Vector (30, 0, 0), UTILIZED_BY_SUs, 3, 50, 2000, 2400, Seconds (1)));
+  repository->AddActivityInfoToRepository (channel3, CreateRecord (Vector (-30, 2, 0), UTILIZED_BY_PUs, 6, 100, 1000, 1500, Seconds (2)));
+  // channel 4: (12, 16, 0) is exactly at the maximum radius of the origin
+  repository->AddActivityInfoToRepository (channel4, CreateRecord (Vector (6.9, 7.1, 0), UTILIZED_BY_SUs, 5, 400, 0, 800, Seconds (2)));
+  repository->AddActivityInfoToRepository (channel4, CreateRecord (Vector (0, -21, 0), UTILIZED_BY_PUs, 1, 100, 0, 800, Seconds (2)));
+  repository->AddActivityInfoToRepository (channel4, CreateRecord (Vector (12, 16, 0), UTILIZED_BY_PUs, 3, 200, 800, 1200, Seconds (2)));
+  repository->AddActivityInfoToRepository (channel4, CreateRecord (Vector (3, 2, 0), UTILIZED_BY_SUs, 2, 100, 0, 800, Seconds (2)));
+
+  // the windows sharing a start and an end count once in the total duration
+  CheckStatistics (repository, 3, 2350.0 / 750, 400, 350, 1900, "before pruning");
+  CheckStatistics (repository, 4, 2900.0 / 800, 300, 500, 1200, "before pruning");
+
+  // the records updated before 1.2 s expire, one of them behind a younger record
+  Simulator::Schedule (Seconds (2.2), &MmWaveSpectrumRepository::CheckTtlExceeded, repository);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  CheckStatistics (repository, 3, 2000.0 / 600, 300, 300, 1500, "after the TTL pruning");
+  CheckStatistics (repository, 4, 2900.0 / 800, 300, 500, 1200, "after the TTL pruning");
+
+  // regrouping the records in smaller cells keeps them all
+  repository->SetGridCellSize (5);
+  CheckStatistics (repository, 3, 2000.0 / 600, 300, 300, 1500, "after a change of the cell size");
+
+  repository->CheckRadiusExceeded (Vector (0, 0, 0));
+  CheckStatistics (repository, 3, 1400.0 / 500, 200, 300, 1500, "after the radius pruning");
+  CheckStatistics (repository, 4, 2800.0 / 700, 200, 500, 1200, "after the radius pruning");
+
+  repository->CheckRadiusExceeded (Vector (1000, 0, 0));
+  MmWaveSpectrumRepository::StatisticalInfo all = repository->GetAllStatisticalInfo (Vector (1000, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ (all.size (), 2u, "Unexpected number of channels");
+  for (const auto &statistic : all)
+    {
+      NS_TEST_ASSERT_MSG_EQ (statistic.second->IsValid (), false, "Records left on channel " << statistic.first);
+      NS_TEST_ASSERT_MSG_EQ (statistic.second->GetVacancyRate (), 1, "Unexpected vacancy rate on channel " << statistic.first);
+    }
+  repository->Dispose ();
+}
+
+/**
+ * Check that the payload duration cache returns the durations computed without
+ * it, and that changing the MCS set of a PHY empties it.
+ */
+class MmWaveTxDurationCacheTestCase : public TestCase
+{
+public:
+  MmWaveTxDurationCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MmWaveTxDurationCacheTestCase::MmWaveTxDurationCacheTestCase ()
+  : TestCase ("Check the mmWave payload duration cache against the uncached durations")
+{
+}
+
+void
+MmWaveTxDurationCacheTestCase::DoRun (void)
+{
+  // every size of the first buckets, the edges of the larger buckets and sizes past the last bucket
+  std::vector<uint32_t> sizes;
+  for (uint32_t size = 0; size < 2048; size++)
+    {
+      sizes.push_back (size);
+    }
+  for (uint32_t size : {65535, 65536, 1048575, 1048576, 1048577, 4000000})
+    {
+      sizes.push_back (size);
+    }
+  for (uint8_t mcs = 0; mcs < 4; mcs++)
+    {
+      for (uint16_t channelWidth : {320, 640, 1280})
+        {
+          for (uint16_t guardInterval : {800, 1600, 3200})
+            {
+              MmWaveTxVector txVector;
+              txVector.SetMode (MmWavePhy::GetMmWaveMcs (mcs));
+              txVector.SetChannelWidth (channelWidth);
+              txVector.SetGuardInterval (guardInterval);
+              MmWavePhy::SetTxDurationCacheEnabled (false);
+              std::vector<Time> expected;
+              for (uint32_t size : sizes)
+                {
+                  expected.push_back (MmWavePhy::CalculateTxDuration (size, txVector, MMWAVE_PHY_BAND_60GHZ));
+                }
+              MmWavePhy::SetTxDurationCacheEnabled (true);
+              // the first pass fills the cache, the second one reads it
+              for (int pass = 0; pass < 2; pass++)
+                {
+                  for (std::size_t i = 0; i < sizes.size (); i++)
+                    {
+                      NS_TEST_ASSERT_MSG_EQ (MmWavePhy::CalculateTxDuration (sizes[i], txVector, MMWAVE_PHY_BAND_60GHZ), expected[i],
+                                             "MCS " << +mcs << ", " << channelWidth << " MHz, GI " << guardInterval
+                                                    << " ns, " << sizes[i] << " bytes, pass " << pass);
+                    }
+                }
+            }
+        }
+    }
+
+  MmWaveTxVector txVector;
+  txVector.SetMode (MmWavePhy::GetMmWaveMcs (3));
+  Ptr<MmWaveSpectrumPhy> phy = CreateObject<MmWaveSpectrumPhy> ();
+  MmWavePhy::ResetTxDurationCache ();
+  uint64_t hits = MmWavePhy::GetTxDurationCacheHits ();
+  uint64_t misses = MmWavePhy::GetTxDurationCacheMisses ();
+  Time duration = MmWavePhy::CalculateTxDuration (1000, txVector, MMWAVE_PHY_BAND_60GHZ);
+  MmWavePhy::CalculateTxDuration (1000, txVector, MMWAVE_PHY_BAND_60GHZ);
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::GetTxDurationCacheMisses (), misses + 1, "The first duration is not computed");
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::GetTxDurationCacheHits (), hits + 1, "The second duration is not cached");
+  phy->PushMcs (MmWavePhy::GetMmWaveMcs (3));
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::CalculateTxDuration (1000, txVector, MMWAVE_PHY_BAND_60GHZ), duration, "Unexpected duration after PushMcs");
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::GetTxDurationCacheMisses (), misses + 2, "PushMcs does not empty the cache");
+  phy->RebuildMcsMap ();
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::CalculateTxDuration (1000, txVector, MMWAVE_PHY_BAND_60GHZ), duration, "Unexpected duration after RebuildMcsMap");
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::GetTxDurationCacheMisses (), misses + 3, "RebuildMcsMap does not empty the cache");
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhy::GetTxDurationCacheHits (), hits + 1, "Unexpected cache hits");
+  phy->Dispose ();
+}
+
+/**
+ * mmWave spectrum PHY giving access to the cached transmit PSDs
+ */
+class MmWaveTxPsdCacheTestPhy : public MmWaveSpectrumPhy
+{
+public:
+  using MmWaveSpectrumPhy::GetTxPowerSpectralDensity;
+};
+
+/**
+ * Spectrum PHY keeping the PSD of the last signal it received
+ */
+class MmWaveTxPsdCacheTestRxPhy : public SpectrumPhy
+{
+public:
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return 0;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+    m_mobility = m;
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return m_mobility;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return m_model;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    m_rxPsd = params->psd;
+  }
+
+  Ptr<const SpectrumModel> m_model; //!< the rx spectrum model
+  Ptr<MobilityModel> m_mobility; //!< the mobility model
+  Ptr<SpectrumValue> m_rxPsd; //!< the PSD of the last signal received
+};
+
+/**
+ * Check that the transmit PSD cache returns the PSDs built without it, evicts
+ * the least recently used PSD at its size cap, counts its hits and misses, and
+ * that the shared PSD is left unchanged when a channel applies the loss.
+ */
+class MmWaveTxPsdCacheTestCase : public TestCase
+{
+public:
+  MmWaveTxPsdCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check a cached PSD against a PSD built without the cache
+   * \param psd the cached PSD
+   * \param channelWidth the channel width (MHz)
+   * \param txPowerW the transmit power (W)
+   */
+  void CheckPsd (Ptr<const SpectrumValue> psd, uint16_t channelWidth, double txPowerW);
+};
+
+MmWaveTxPsdCacheTestCase::MmWaveTxPsdCacheTestCase ()
+  : TestCase ("Check the mmWave transmit PSD cache")
+{
+}
+
+void
+MmWaveTxPsdCacheTestCase::CheckPsd (Ptr<const SpectrumValue> psd, uint16_t channelWidth, double txPowerW)
+{
+  Ptr<SpectrumValue> expected = MmWaveSpectrumValueHelper::CreateMmWaveOfdmTxPowerSpectralDensity (60480, channelWidth, txPowerW, channelWidth);
+  NS_TEST_ASSERT_MSG_EQ ((psd->GetSpectrumModel () == expected->GetSpectrumModel ()), true, "Unexpected spectrum model");
+  for (std::size_t i = 0; i < expected->GetValuesN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((*psd)[i], (*expected)[i], channelWidth << " MHz, " << txPowerW << " W, band " << i);
+    }
+}
+
+void
+MmWaveTxPsdCacheTestCase::DoRun (void)
+{
+  Ptr<MmWaveTxPsdCacheTestPhy> phy = CreateObject<MmWaveTxPsdCacheTestPhy> ();
+  GlobalValue::Bind ("MmWaveTxPsdCacheSize", UintegerValue (2));
+  NS_TEST_ASSERT_MSG_EQ (MmWaveSpectrumPhy::GetTxPsdCacheSize (), 2, "The global value does not set the cache size");
+  uint64_t hits = MmWaveSpectrumPhy::GetTxPsdCacheHits ();
+  uint64_t misses = MmWaveSpectrumPhy::GetTxPsdCacheMisses ();
+
+  Ptr<const SpectrumValue> a = phy->GetTxPowerSpectralDensity (60480, 640, 0.01, MMWAVE_MOD_CLASS_OFDM);
+  CheckPsd (a, 640, 0.01);
+  Ptr<const SpectrumValue> b = phy->GetTxPowerSpectralDensity (60480, 640, 0.1, MMWAVE_MOD_CLASS_OFDM);
+  CheckPsd (b, 640, 0.1);
+  NS_TEST_ASSERT_MSG_EQ (MmWaveSpectrumPhy::GetTxPsdCacheMisses (), misses + 2, "The first PSDs are not built");
+  Ptr<const SpectrumValue> hit = phy->GetTxPowerSpectralDensity (60480, 640, 0.01, MMWAVE_MOD_CLASS_OFDM);
+  NS_TEST_ASSERT_MSG_EQ ((hit == a), true, "The PSD is not shared from the cache");
+  CheckPsd (hit, 640, 0.01);
+  NS_TEST_ASSERT_MSG_EQ (MmWaveSpectrumPhy::GetTxPsdCacheHits (), hits + 1, "The PSD is not found in the cache");
+
+  // a third PSD evicts b, the least recently used one
+  Ptr<const SpectrumValue> c = phy->GetTxPowerSpectralDensity (60480, 1280, 0.01, MMWAVE_MOD_CLASS_OFDM);
+  CheckPsd (c, 1280, 0.01);
+  NS_TEST_ASSERT_MSG_EQ ((phy->GetTxPowerSpectralDensity (60480, 640, 0.01, MMWAVE_MOD_CLASS_OFDM) == a), true, "The most recently used PSD is evicted");
+  NS_TEST_ASSERT_MSG_EQ (MmWaveSpectrumPhy::GetTxPsdCacheHits (), hits + 2, "The most recently used PSD is not found");
+  NS_TEST_ASSERT_MSG_EQ ((phy->GetTxPowerSpectralDensity (60480, 640, 0.1, MMWAVE_MOD_CLASS_OFDM) == b), false, "The least recently used PSD is not evicted");
+  NS_TEST_ASSERT_MSG_EQ (MmWaveSpectrumPhy::GetTxPsdCacheMisses (), misses + 4, "The evicted PSD is not built again");
+
+  UintegerValue counter;
+  phy->GetAttribute ("TxPsdCacheHits", counter);
+  NS_TEST_ASSERT_MSG_EQ (counter.Get (), hits + 2, "Unexpected TxPsdCacheHits attribute");
+  phy->GetAttribute ("TxPsdCacheMisses", counter);
+  NS_TEST_ASSERT_MSG_EQ (counter.Get (), misses + 4, "Unexpected TxPsdCacheMisses attribute");
+
+  // the channel applies the loss to its copy of the shared PSD
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->AddPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+  Ptr<MmWaveTxPsdCacheTestRxPhy> txPhy = Create<MmWaveTxPsdCacheTestRxPhy> ();
+  txPhy->m_model = a->GetSpectrumModel ();
+  Ptr<MobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  CreateObject<Node> ()->AggregateObject (txMobility);
+  txPhy->SetMobility (txMobility);
+  Ptr<MmWaveTxPsdCacheTestRxPhy> rxPhy = Create<MmWaveTxPsdCacheTestRxPhy> ();
+  rxPhy->m_model = a->GetSpectrumModel ();
+  Ptr<MobilityModel> rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+  rxMobility->SetPosition (Vector (10, 0, 0));
+  CreateObject<Node> ()->AggregateObject (rxMobility);
+  rxPhy->SetMobility (rxMobility);
+  channel->AddRx (rxPhy);
+  Ptr<SpectrumSignalParameters> txParams = Create<SpectrumSignalParameters> ();
+  txParams->duration = MicroSeconds (10);
+  txParams->psd = ConstCast<SpectrumValue> (a);
+  txParams->txPhy = txPhy;
+  channel->StartTx (txParams);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ ((rxPhy->m_rxPsd != 0), true, "The signal is not received");
+  NS_TEST_ASSERT_MSG_EQ ((rxPhy->m_rxPsd == a), false, "The receiver gets the shared PSD");
+  NS_TEST_ASSERT_MSG_LT (Integral (*rxPhy->m_rxPsd), Integral (*a), "The loss is not applied");
+  CheckPsd (a, 640, 0.01);
+  Simulator::Destroy ();
+
+  channel->Dispose ();
+  phy->Dispose ();
+  MmWaveSpectrumPhy::SetTxPsdCacheSize (64);
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +1362,17 @@ MmwaveTestSuite::MmwaveTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new MmwaveTestCase1, TestCase::QUICK);
+  AddTestCase (new MmWavePsdKernelsTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveTxPsdTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveNistErrorRateTableTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveTableErrorRateTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveInterferenceHelperTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveBinaryTraceTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveStatsCollectorTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveMacQueueIndexTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveSpectrumRepositoryTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveTxDurationCacheTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveTxPsdCacheTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -303,6 +303,8 @@ DistributedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
           Scheduler::Event next = m_events->RemoveNext ();
           scheduler->Insert (next);
         }
+      // the events released by the old scheduler will not be run
+      m_unscheduledEvents -= m_events->GetDroppedCount ();
     }
   m_events = scheduler;
 }
@@ -442,7 +444,7 @@ DistributedSimulatorImpl::Run (void)
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == (int) m_events->GetDroppedCount ());
 }
 
 uint32_t DistributedSimulatorImpl::GetSystemId () const
@@ -19,16 +19,19 @@
  */
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <utility>
 #include <ns3/object.h>
 #include <ns3/simulator.h>
+#include <ns3/event-profiler.h>
 #include <ns3/log.h>
 #include <ns3/packet.h>
 #include <ns3/packet-burst.h>
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -79,7 +82,9 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 }
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
-  : m_numDevices {0}
+  : m_numDevices {0},
+    m_cullingGridDirty (true),
+    m_cullingMaxSpeed (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -90,6 +95,14 @@ MultiModelSpectrumChannel::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  for (std::set<Ptr<MobilityModel> >::iterator it = m_cullingMobilities.begin ();
+       it != m_cullingMobilities.end ();
+       ++it)
+    {
+      (*it)->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+    }
+  m_cullingMobilities.clear ();
+  m_cullingGrids.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -100,7 +113,51 @@ MultiModelSpectrumChannel::GetTypeId (void)
     .SetParent<SpectrumChannel> ()
     .SetGroupName ("Spectrum")
     .AddConstructor<MultiModelSpectrumChannel> ()
-
+    .AddAttribute ("SpatialCulling",
+                   "If true, the receivers are kept in a spatial index and "
+                   "a signal is only delivered to the receivers within the "
+                   "range allowed by the Culling* attributes. The index is "
+                   "refreshed when a receiver changes course, so mobility "
+                   "models must notify every change of velocity.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_spatialCulling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CullingGridCellSize",
+                   "Side in m of the cells of the spatial index",
+                   DoubleValue (100.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cullingCellSize),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("CullingReferenceLoss",
+                   "Lower bound in dB of the propagation loss at 1 m. "
+                   "The default is the free space loss at 950 MHz.",
+                   DoubleValue (32.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cullingReferenceLoss),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("CullingPathLossExponent",
+                   "Exponent of the lower bound of the propagation loss "
+                   "beyond 1 m",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cullingPathLossExponent),
+                   MakeDoubleChecker<double> (0.1))
+    .AddAttribute ("CullingMaxAntennaGain",
+                   "Upper bound in dB of the sum of the TX and RX antenna "
+                   "gains, including any beamforming gain",
+                   DoubleValue (40.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cullingMaxAntennaGain),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("CullingRxSensitivity",
+                   "Received power in dBm below which a signal is of no "
+                   "interest to any receiver, not even as interference",
+                   DoubleValue (-200.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cullingRxSensitivity),
+                   MakeDoubleChecker<double> ())
+    .AddTraceSource ("CulledLinks",
+                     "Fired once for each transmission for which the "
+                     "spatial index left out some receivers. The parameters "
+                     "are the TX SpectrumPhy and the total number of "
+                     "receivers left out.",
+                     MakeTraceSourceAccessor (&MultiModelSpectrumChannel::m_culledLinksTrace),
+                     "ns3::MultiModelSpectrumChannel::CulledLinksTracedCallback")
   ;
   return tid;
 }
@@ -115,6 +172,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   NS_ASSERT_MSG ((0 != rxSpectrumModel), "phy->GetRxSpectrumModel () returned 0. Please check that the RxSpectrumModel is already set for the phy before calling MultiModelSpectrumChannel::AddRx (phy)");
 
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
+  m_cullingGridDirty = true;
 
   // remove a previous entry of this phy if it exists
   // we need to scan for all rxSpectrumModel values since we don't
@@ -237,6 +295,14 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  double cullingRange = 0;
+  if (m_spatialCulling && txMobility)
+    {
+      cullingRange = GetCullingRange (txParams);
+      NS_LOG_LOGIC ("culling range " << cullingRange << " m");
+    }
+  uint32_t nCulled = 0; // receivers left out by the spatial index, over all the RX SpectrumModels
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -255,8 +321,17 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           continue;
         }
 
-      for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhys.end ();
+      const std::vector<Ptr<SpectrumPhy> > *rxPhys = &rxInfoIterator->second.m_rxPhys;
+      std::vector<Ptr<SpectrumPhy> > rxPhysInRange;
+      if (m_spatialCulling && txMobility)
+        {
+          rxPhysInRange = GetRxPhysInRange (rxSpectrumModelUid, *rxPhys, txMobility->GetPosition (), cullingRange);
+          nCulled += rxPhys->size () - rxPhysInRange.size ();
+          rxPhys = &rxPhysInRange;
+        }
+
+      for (auto rxPhyIterator = rxPhys->begin ();
+           rxPhyIterator != rxPhys->end ();
            ++rxPhyIterator)
         {
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
@@ -266,6 +341,11 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           uint32_t bId = txParams->txPhy->GetMobility ()->GetObject<Node> ()->GetId ();
           if (((*rxPhyIterator) != txParams->txPhy) && (aId != bId))
             {
+              if (m_filter && m_filter->Filter (txParams, *rxPhyIterator))
+                {
+                  NS_LOG_LOGIC ("signal filtered out for receiver " << *rxPhyIterator);
+                  continue;
+                }
               NS_LOG_LOGIC ("copying signal parameters " << txParams);
               Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
               rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
@@ -328,13 +408,13 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 {
                   // the receiver has a NetDevice, so we expect that it is attached to a Node
                   uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
+                  NS_PROFILE_SCHEDULE_WITH_CONTEXT (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                                    rxParams, *rxPhyIterator);
                 }
               else
                 {
                   // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                  NS_PROFILE_SCHEDULE (delay, &MultiModelSpectrumChannel::StartRx, this,
                                        rxParams, *rxPhyIterator);
                 }
             }
@@ -342,6 +422,10 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
     }
 
+  if (nCulled > 0)
+    {
+      m_culledLinksTrace (txParams->txPhy, nCulled);
+    }
 }
 
 void
@@ -351,6 +435,129 @@ MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<Sp
   receiver->StartRx (params);
 }
 
+double
+MultiModelSpectrumChannel::GetCullingRange (Ptr<const SpectrumSignalParameters> params) const
+{
+  NS_LOG_FUNCTION (this << params);
+  double txPowerW = Integral (*params->psd);
+  if (txPowerW <= 0)
+    {
+      return 0;
+    }
+  double budgetDb = std::min (m_maxLossDb, 10 * std::log10 (txPowerW) + 30 - m_cullingRxSensitivity);
+  budgetDb += m_cullingMaxAntennaGain;
+  // the bound of the propagation loss does not hold within 1 m
+  if (budgetDb <= m_cullingReferenceLoss)
+    {
+      return 1.0;
+    }
+  return std::pow (10.0, (budgetDb - m_cullingReferenceLoss) / (10 * m_cullingPathLossExponent));
+}
+
+std::vector<Ptr<SpectrumPhy> >
+MultiModelSpectrumChannel::GetRxPhysInRange (SpectrumModelUid_t rxSpectrumModelUid,
+                                             const std::vector<Ptr<SpectrumPhy> > &rxPhys,
+                                             const Vector &position, double range)
+{
+  NS_LOG_FUNCTION (this << rxSpectrumModelUid << position << range);
+
+  // the receivers move by at most this distance from the cell they were placed in
+  double slack = m_cullingMaxSpeed * (Simulator::Now () - m_cullingGridTime).GetSeconds ();
+  if (m_cullingGridDirty || slack > m_cullingCellSize)
+    {
+      BuildCullingGrid ();
+      slack = 0;
+    }
+
+  const CullingGrid &grid = m_cullingGrids[rxSpectrumModelUid];
+  std::vector<std::size_t> candidates (grid.m_unplaced);
+  double reach = range + slack;
+  double cellsPerSide = 2 * std::ceil (reach / m_cullingCellSize) + 1;
+  if (cellsPerSide * cellsPerSide >= grid.m_cells.size ())
+    {
+      // there are fewer occupied cells than cells within reach
+      for (auto it = grid.m_cells.begin (); it != grid.m_cells.end (); ++it)
+        {
+          candidates.insert (candidates.end (), it->second.begin (), it->second.end ());
+        }
+    }
+  else
+    {
+      int64_t minX = static_cast<int64_t> (std::floor ((position.x - reach) / m_cullingCellSize));
+      int64_t maxX = static_cast<int64_t> (std::floor ((position.x + reach) / m_cullingCellSize));
+      int64_t minY = static_cast<int64_t> (std::floor ((position.y - reach) / m_cullingCellSize));
+      int64_t maxY = static_cast<int64_t> (std::floor ((position.y + reach) / m_cullingCellSize));
+      for (int64_t x = minX; x <= maxX; ++x)
+        {
+          for (int64_t y = minY; y <= maxY; ++y)
+            {
+              auto it = grid.m_cells.find (std::make_pair (x, y));
+              if (it != grid.m_cells.end ())
+                {
+                  candidates.insert (candidates.end (), it->second.begin (), it->second.end ());
+                }
+            }
+        }
+    }
+  // keep the order in which the receivers were added
+  std::sort (candidates.begin (), candidates.end ());
+
+  std::vector<Ptr<SpectrumPhy> > rxPhysInRange;
+  rxPhysInRange.reserve (candidates.size ());
+  for (std::vector<std::size_t>::const_iterator it = candidates.begin (); it != candidates.end (); ++it)
+    {
+      Ptr<MobilityModel> mobility = rxPhys[*it]->GetMobility ();
+      if (!mobility || CalculateDistance (mobility->GetPosition (), position) <= range)
+        {
+          rxPhysInRange.push_back (rxPhys[*it]);
+        }
+    }
+  NS_LOG_LOGIC (rxPhysInRange.size () << " of " << rxPhys.size () << " receivers in range");
+  return rxPhysInRange;
+}
+
+void
+MultiModelSpectrumChannel::BuildCullingGrid (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cullingGrids.clear ();
+  m_cullingMaxSpeed = 0;
+  for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+       rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+       ++rxInfoIterator)
+    {
+      CullingGrid &grid = m_cullingGrids[rxInfoIterator->first];
+      const std::vector<Ptr<SpectrumPhy> > &rxPhys = rxInfoIterator->second.m_rxPhys;
+      for (std::size_t i = 0; i < rxPhys.size (); ++i)
+        {
+          Ptr<MobilityModel> mobility = rxPhys[i]->GetMobility ();
+          if (!mobility)
+            {
+              grid.m_unplaced.push_back (i);
+              continue;
+            }
+          if (m_cullingMobilities.insert (mobility).second)
+            {
+              mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+            }
+          Vector position = mobility->GetPosition ();
+          std::pair<int64_t, int64_t> cell (static_cast<int64_t> (std::floor (position.x / m_cullingCellSize)),
+                                            static_cast<int64_t> (std::floor (position.y / m_cullingCellSize)));
+          grid.m_cells[cell].push_back (i);
+          m_cullingMaxSpeed = std::max (m_cullingMaxSpeed, mobility->GetVelocity ().GetLength ());
+        }
+    }
+  m_cullingGridTime = Simulator::Now ();
+  m_cullingGridDirty = false;
+}
+
+void
+MultiModelSpectrumChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  m_cullingGridDirty = true;
+}
+
 std::size_t
 MultiModelSpectrumChannel::GetNDevices (void) const
 {
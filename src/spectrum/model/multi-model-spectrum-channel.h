@@ -27,11 +27,14 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/nstime.h>
+#include <ns3/vector.h>
 #include <map>
 #include <set>
 
 namespace ns3 {
 
+class MobilityModel;
 
 /**
  * \ingroup spectrum
@@ -102,6 +105,16 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * If SpatialCulling is enabled, the receivers are kept in a uniform grid
+ * by position, and a transmission is only delivered to the receivers
+ * within a maximum range. The range is the distance at which a lower bound
+ * of the propagation loss (CullingReferenceLoss at 1 m, growing with
+ * CullingPathLossExponent) exceeds the link budget, that is the smallest of
+ * MaxLossDb and the difference between the transmitted power and
+ * CullingRxSensitivity, plus CullingMaxAntennaGain. The culled links are
+ * neither evaluated nor reported by the Gain and PathLoss traces; they are
+ * counted by the CulledLinks trace instead.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -124,6 +137,15 @@ public:
   virtual std::size_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
+  /**
+   * TracedCallback signature for the links culled by the spatial index.
+   *
+   * \param [in] txPhy The TX SpectrumPhy instance.
+   * \param [in] nCulled The number of receivers that were out of range.
+   */
+  typedef void (* CulledLinksTracedCallback)
+    (Ptr<const SpectrumPhy> txPhy, uint32_t nCulled);
+
 
 protected:
   void DoDispose ();
@@ -149,6 +171,50 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Computes the distance beyond which the signal cannot be received
+   * according to the culling attributes.
+   *
+   * \param params The signal parameters.
+   * \return the maximum range in m
+   */
+  double GetCullingRange (Ptr<const SpectrumSignalParameters> params) const;
+
+  /**
+   * Looks up in the spatial index the receivers that are within a given
+   * range, rebuilding the index first if it is outdated.
+   *
+   * \param rxSpectrumModelUid The spectrum model of the receivers.
+   * \param rxPhys All the receivers with that spectrum model.
+   * \param position The position of the transmitter.
+   * \param range The maximum range in m.
+   * \return the receivers within range, in the same order as in rxPhys
+   */
+  std::vector<Ptr<SpectrumPhy> > GetRxPhysInRange (SpectrumModelUid_t rxSpectrumModelUid,
+                                                   const std::vector<Ptr<SpectrumPhy> > &rxPhys,
+                                                   const Vector &position, double range);
+
+  /**
+   * Places all the receivers in the cells of the spatial index.
+   */
+  void BuildCullingGrid (void);
+
+  /**
+   * Invalidates the spatial index when a receiver changes course.
+   *
+   * \param mobility The mobility model of the receiver.
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
+
+  /**
+   * Receivers with the same spectrum model, placed in the cells of a grid.
+   */
+  struct CullingGrid
+  {
+    std::map<std::pair<int64_t, int64_t>, std::vector<std::size_t> > m_cells; //!< indices in m_rxPhys of the receivers in each cell
+    std::vector<std::size_t> m_unplaced; //!< indices in m_rxPhys of the receivers without a mobility model
+  };
+
   /**
    * Data structure holding, for each TX SpectrumModel,  all the
    * converters to any RX SpectrumModel, and all the corresponding
@@ -169,6 +235,24 @@ private:
    */
   std::size_t m_numDevices;
 
+  bool m_spatialCulling; //!< whether transmissions are delivered only to the receivers in range
+  double m_cullingCellSize; //!< side of the grid cells in m
+  double m_cullingReferenceLoss; //!< lower bound of the propagation loss at 1 m, in dB
+  double m_cullingPathLossExponent; //!< exponent of the lower bound of the propagation loss
+  double m_cullingMaxAntennaGain; //!< upper bound of the sum of the TX and RX antenna gains, in dB
+  double m_cullingRxSensitivity; //!< power below which a signal is of no interest to a receiver, in dBm
+  std::map<SpectrumModelUid_t, CullingGrid> m_cullingGrids; //!< spatial index of the receivers of each spectrum model
+  std::set<Ptr<MobilityModel> > m_cullingMobilities; //!< mobility models whose course changes are tracked
+  bool m_cullingGridDirty; //!< whether the spatial index must be rebuilt
+  Time m_cullingGridTime; //!< time at which the spatial index was built
+  double m_cullingMaxSpeed; //!< highest receiver speed when the spatial index was built, in m/s
+
+  /**
+   * The `CulledLinks` trace source. Fired once for each transmission for
+   * which some receivers were out of range, with the total number of them.
+   */
+  TracedCallback<Ptr<const SpectrumPhy>, uint32_t> m_culledLinksTrace;
+
 };
 
 
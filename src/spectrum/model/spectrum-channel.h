@@ -30,6 +30,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/propagation-loss-model.h>
 #include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-transmit-filter.h>
 #include <ns3/traced-callback.h>
 #include <ns3/mobility-model.h>
 
@@ -101,6 +102,21 @@ public:
    */
   Ptr<PropagationLossModel> GetPropagationLossModel (void);
 
+  /**
+   * Add a filter that skips receivers before the propagation loss and
+   * the received PSD are computed for them. The filters added before
+   * are consulted after this one.
+   *
+   * \param filter the filter to add
+   */
+  void AddSpectrumTransmitFilter (Ptr<SpectrumTransmitFilter> filter);
+
+  /**
+   * Get the first filter of the chain.
+   * \returns a pointer to the filter, or 0 if there is none.
+   */
+  Ptr<SpectrumTransmitFilter> GetSpectrumTransmitFilter (void) const;
+
   /**
    * Used by attached PHY instances to transmit signals on the channel
    *
@@ -198,6 +214,11 @@ protected:
    */
   Ptr<SpectrumPropagationLossModel> m_spectrumPropagationLoss;
 
+  /**
+   * Filters consulted for each receiver before the signal is propagated to it.
+   */
+  Ptr<SpectrumTransmitFilter> m_filter;
+
 
 };
 
@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPECTRUM_TRANSMIT_FILTER_H
+#define SPECTRUM_TRANSMIT_FILTER_H
+
+#include <ns3/object.h>
+
+namespace ns3 {
+
+struct SpectrumSignalParameters;
+class SpectrumPhy;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief spectrum-aware receiver filter for SpectrumChannel
+ *
+ * A SpectrumChannel asks its filters, before computing the propagation
+ * loss and the received PSD, whether a transmitted signal can be of any
+ * interest to a given receiver. Receivers for which a filter returns true
+ * are skipped. Filters can be chained, the signal is filtered out as soon
+ * as one of them returns true.
+ */
+class SpectrumTransmitFilter : public Object
+{
+public:
+  SpectrumTransmitFilter ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * Add the filter to be consulted after this one.
+   *
+   * \param next the next filter in the chain
+   */
+  void SetNext (Ptr<SpectrumTransmitFilter> next);
+
+  /**
+   * \param params the parameters of the transmitted signal
+   * \param receiverPhy the receiver
+   * \return true if the signal does not need to be delivered to the receiver
+   */
+  bool Filter (Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiverPhy);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \param params the parameters of the transmitted signal
+   * \param receiverPhy the receiver
+   * \return true if this filter rejects the signal for the receiver
+   */
+  virtual bool DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiverPhy) = 0;
+
+  Ptr<SpectrumTransmitFilter> m_next; //!< next filter in the chain
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_TRANSMIT_FILTER_H */
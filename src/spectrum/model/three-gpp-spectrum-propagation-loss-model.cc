@@ -27,6 +27,8 @@
 #include "ns3/node.h"
 #include "ns3/channel-condition-model.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/simulator.h"
 #include "ns3/pointer.h"
@@ -38,7 +40,14 @@ NS_LOG_COMPONENT_DEFINE ("ThreeGppSpectrumPropagationLossModel");
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeGppSpectrumPropagationLossModel);
 
+/// Number of sub-bands after which the delay phasors are recomputed exactly
+static const std::size_t PHASOR_RESEED_PERIOD = 32;
+
 ThreeGppSpectrumPropagationLossModel::ThreeGppSpectrumPropagationLossModel ()
+  : m_phasorRecurrence (true),
+    m_gainCacheBytes (0),
+    m_gainCacheHits (0),
+    m_gainCacheMisses (0)
 {
   NS_LOG_FUNCTION (this);
   m_uniformRv = CreateObject<UniformRandomVariable> ();
@@ -54,6 +63,9 @@ ThreeGppSpectrumPropagationLossModel::DoDispose ()
 {
   m_deviceAntennaMap.clear ();
   m_longTermMap.clear ();
+  m_gainCacheIndex.clear ();
+  m_gainCacheList.clear ();
+  m_gainCacheBytes = 0;
   m_channelModel->Dispose ();
   m_channelModel = nullptr;
 }
@@ -78,6 +90,42 @@ ThreeGppSpectrumPropagationLossModel::GetTypeId (void)
                    DoubleValue (0.0),
                    MakeDoubleAccessor (&ThreeGppSpectrumPropagationLossModel::m_vScatt),
                    MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PhasorRecurrence",
+                   "If true, on spectrum models with evenly spaced sub-bands the delay "
+                   "phase of each cluster is advanced by a constant rotation from one "
+                   "sub-band to the next, instead of computing a complex exponential "
+                   "per sub-band and cluster. The phasors are recomputed exactly every "
+                   "few sub-bands to bound the rounding error.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ThreeGppSpectrumPropagationLossModel::m_phasorRecurrence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GainCacheCoherenceTime",
+                   "How long the gain of each sub-band computed for a link is reused. "
+                   "Zero disables the cache. Within this time the Doppler term is not "
+                   "updated, so it should be well below the channel coherence time.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&ThreeGppSpectrumPropagationLossModel::m_gainCacheCoherenceTime),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("GainCacheMaxDisplacement",
+                   "Distance (m) either node of a link can move before the cached gain "
+                   "of the link is recomputed",
+                   DoubleValue (0.001),
+                   MakeDoubleAccessor (&ThreeGppSpectrumPropagationLossModel::m_gainCacheMaxDisplacement),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("GainCacheMaxBytes",
+                   "Memory allowed for the cached gains; the least recently used "
+                   "gains are evicted beyond it",
+                   UintegerValue (64 << 20),
+                   MakeUintegerAccessor (&ThreeGppSpectrumPropagationLossModel::m_gainCacheMaxBytes),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddTraceSource ("GainCacheHits",
+                     "Number of sub-band gains taken from the gain cache",
+                     MakeTraceSourceAccessor (&ThreeGppSpectrumPropagationLossModel::m_gainCacheHits),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("GainCacheMisses",
+                     "Number of sub-band gains computed while the gain cache is enabled",
+                     MakeTraceSourceAccessor (&ThreeGppSpectrumPropagationLossModel::m_gainCacheMisses),
+                     "ns3::TracedValueCallback::Uint64")
     ;
   return tid;
 }
@@ -156,7 +204,7 @@ ThreeGppSpectrumPropagationLossModel::CalcLongTerm (Ptr<const MatrixBasedChannel
 
 Ptr<SpectrumValue>
 ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain (Ptr<SpectrumValue> txPsd,
-                                                           ThreeGppAntennaArrayModel::ComplexVector longTerm,
+                                                           const ThreeGppAntennaArrayModel::ComplexVector &longTerm,
                                                            Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
                                                            const ns3::Vector &sSpeed, const ns3::Vector &uSpeed) const
 {
@@ -205,6 +253,58 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain (Ptr<SpectrumValue> tx
 
   // apply the doppler term and the propagation delay to the long term component
   // to obtain the beamforming gain
+  double bandSpacing = m_phasorRecurrence ? GetUniformBandSpacing (tempPsd->GetSpectrumModel ()) : 0;
+  if (bandSpacing > 0)
+    {
+      // structure of arrays over the clusters: the long term component times the
+      // doppler term, the delay phasor of the current sub-band and the rotation
+      // from one sub-band to the next
+      std::vector<double> wRe (numCluster), wIm (numCluster);
+      std::vector<double> pRe (numCluster), pIm (numCluster);
+      std::vector<double> rRe (numCluster), rIm (numCluster);
+      for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+        {
+          std::complex<double> w = longTerm[cIndex] * doppler[cIndex];
+          std::complex<double> r = exp (std::complex<double> (0, -2 * M_PI * bandSpacing * (params->m_delay[cIndex])));
+          wRe[cIndex] = w.real ();
+          wIm[cIndex] = w.imag ();
+          rRe[cIndex] = r.real ();
+          rIm[cIndex] = r.imag ();
+        }
+      auto sbit = tempPsd->ConstBandsBegin ();
+      std::size_t numBands = tempPsd->GetValuesN ();
+      for (std::size_t k = 0; k < numBands; k++, sbit++)
+        {
+          if (k % PHASOR_RESEED_PERIOD == 0)
+            {
+              for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+                {
+                  std::complex<double> p = exp (std::complex<double> (0, -2 * M_PI * (*sbit).fc * (params->m_delay[cIndex])));
+                  pRe[cIndex] = p.real ();
+                  pIm[cIndex] = p.imag ();
+                }
+            }
+          if ((*tempPsd)[k] != 0.00)
+            {
+              double gRe = 0.0;
+              double gIm = 0.0;
+              for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+                {
+                  gRe += wRe[cIndex] * pRe[cIndex] - wIm[cIndex] * pIm[cIndex];
+                  gIm += wRe[cIndex] * pIm[cIndex] + wIm[cIndex] * pRe[cIndex];
+                }
+              (*tempPsd)[k] *= gRe * gRe + gIm * gIm;
+            }
+          for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+            {
+              double re = pRe[cIndex] * rRe[cIndex] - pIm[cIndex] * rIm[cIndex];
+              pIm[cIndex] = pRe[cIndex] * rIm[cIndex] + pIm[cIndex] * rRe[cIndex];
+              pRe[cIndex] = re;
+            }
+        }
+      return tempPsd;
+    }
+
   auto vit = tempPsd->ValuesBegin (); // psd iterator
   auto sbit = tempPsd->ConstBandsBegin(); // band iterator
   while (vit != tempPsd->ValuesEnd ())
@@ -226,6 +326,34 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain (Ptr<SpectrumValue> tx
   return tempPsd;
 }
 
+double
+ThreeGppSpectrumPropagationLossModel::GetUniformBandSpacing (Ptr<const SpectrumModel> model) const
+{
+  auto it = m_bandSpacingMap.find (model->GetUid ());
+  if (it != m_bandSpacingMap.end ())
+    {
+      return it->second;
+    }
+  double spacing = 0;
+  if (model->GetNumBands () > 1)
+    {
+      Bands::const_iterator first = model->Begin ();
+      spacing = (first + 1)->fc - first->fc;
+      for (Bands::const_iterator bit = first + 1; bit != model->End (); ++bit)
+        {
+          // allow for the rounding of the center frequencies
+          if (std::abs ((bit->fc - (bit - 1)->fc) - spacing) > 1e-6 * std::abs (spacing))
+            {
+              spacing = 0;
+              break;
+            }
+        }
+    }
+  NS_LOG_DEBUG ("Sub-band spacing of spectrum model " << model->GetUid () << ": " << spacing << " Hz");
+  m_bandSpacingMap[model->GetUid ()] = spacing;
+  return spacing;
+}
+
 ThreeGppAntennaArrayModel::ComplexVector
 ThreeGppSpectrumPropagationLossModel::GetLongTerm (uint32_t aId, uint32_t bId,
                                                    Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
@@ -335,10 +463,85 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Sp
   ThreeGppAntennaArrayModel::ComplexVector longTerm = GetLongTerm (aId, bId, channelMatrix, aW, bW);
 
   // apply the beamforming gain
+  if (!m_gainCacheCoherenceTime.IsZero ())
+    {
+      *rxPsd *= *GetGain (aId, bId, txPsd, a, b, longTerm, channelMatrix);
+      return rxPsd;
+    }
   rxPsd = CalcBeamformingGain (rxPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
 
   return rxPsd;
 }
 
+Ptr<const SpectrumValue>
+ThreeGppSpectrumPropagationLossModel::GetGain (uint32_t aId, uint32_t bId, Ptr<const SpectrumValue> txPsd,
+                                               Ptr<const MobilityModel> a, Ptr<const MobilityModel> b,
+                                               const ThreeGppAntennaArrayModel::ComplexVector &longTerm,
+                                               Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix) const
+{
+  NS_LOG_FUNCTION (this << aId << bId);
+  // the Doppler term depends on the direction of the link and on the velocities, so the key does too
+  GainCacheKey key = std::make_tuple (aId, bId, txPsd->GetSpectrumModelUid (), a->GetVelocity (), b->GetVelocity ());
+  Vector aPosition = a->GetPosition ();
+  Vector bPosition = b->GetPosition ();
+  auto it = m_gainCacheIndex.find (key);
+  if (it != m_gainCacheIndex.end ())
+    {
+      const GainCacheEntry &entry = it->second->second;
+      if (Simulator::Now () - entry.m_creationTime < m_gainCacheCoherenceTime
+          && CalculateDistance (aPosition, entry.m_aPosition) <= m_gainCacheMaxDisplacement
+          && CalculateDistance (bPosition, entry.m_bPosition) <= m_gainCacheMaxDisplacement
+          && entry.m_channel == channelMatrix
+          && entry.m_longTerm == longTerm)
+        {
+          m_gainCacheHits++;
+          m_gainCacheList.splice (m_gainCacheList.begin (), m_gainCacheList, it->second);
+          // draw what CalcBeamformingGain draws, the next gains computed then do not
+          // depend on whether this one was cached
+          for (std::size_t cIndex = 1; cIndex < channelMatrix->m_channel[0][0].size (); cIndex++)
+            {
+              m_uniformRv->GetValue (-1, 1);
+              m_uniformRv->GetValue (-m_vScatt, m_vScatt);
+            }
+          return entry.m_gain;
+        }
+      NS_LOG_DEBUG ("Cached gain of link " << aId << "-" << bId << " is outdated");
+      m_gainCacheBytes -= entry.m_gain->GetValuesN () * sizeof (double);
+      m_gainCacheList.erase (it->second);
+      m_gainCacheIndex.erase (it);
+    }
+  m_gainCacheMisses++;
+
+  // the gain is computed for all the sub-bands, so that it can be reused for
+  // PSDs that are empty in different sub-bands
+  Ptr<SpectrumValue> unitPsd = Create<SpectrumValue> (txPsd->GetSpectrumModel ());
+  (*unitPsd) = 1.0;
+  GainCacheEntry entry;
+  entry.m_gain = CalcBeamformingGain (unitPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
+  entry.m_channel = channelMatrix;
+  entry.m_longTerm = longTerm;
+  entry.m_aPosition = aPosition;
+  entry.m_bPosition = bPosition;
+  entry.m_creationTime = Simulator::Now ();
+  m_gainCacheList.push_front (std::make_pair (key, entry));
+  m_gainCacheIndex[key] = m_gainCacheList.begin ();
+  m_gainCacheBytes += entry.m_gain->GetValuesN () * sizeof (double);
+  TrimGainCache ();
+  return entry.m_gain;
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::TrimGainCache () const
+{
+  // the entry just added is kept even if it is larger than the cap
+  while (m_gainCacheBytes > m_gainCacheMaxBytes && m_gainCacheList.size () > 1)
+    {
+      const GainCacheList::value_type &lru = m_gainCacheList.back ();
+      m_gainCacheBytes -= lru.second.m_gain->GetValuesN () * sizeof (double);
+      m_gainCacheIndex.erase (lru.first);
+      m_gainCacheList.pop_back ();
+    }
+}
+
 
 }  // namespace ns3
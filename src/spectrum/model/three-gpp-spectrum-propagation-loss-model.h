@@ -24,10 +24,15 @@
 
 #include "ns3/spectrum-propagation-loss-model.h"
 #include <complex.h>
+#include <list>
 #include <map>
+#include <tuple>
 #include <unordered_map>
 #include "ns3/matrix-based-channel-model.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-value.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
@@ -119,6 +124,12 @@ public:
    * To reduce the computational load, the long term component associated with
    * a certain channel is cached and recomputed only when the channel realization
    * is updated, or when the beamforming vectors change.
+   * If GainCacheCoherenceTime is not zero, the gain of each sub-band is cached
+   * as well, for each link and spectrum model, and reused until the coherence
+   * time expires, either node moves by more than GainCacheMaxDisplacement or
+   * changes its velocity, the channel realization is updated or the long term
+   * component changes. The random variables of the Doppler term are drawn for
+   * the cached gains too, so that enabling the cache does not shift the stream.
    *
    * \param txPsd tx PSD
    * \param a first node mobility model
@@ -142,12 +153,52 @@ private:
     ThreeGppAntennaArrayModel::ComplexVector m_uW; //!< the beamforming vector for the node u used to compute the long term
   };
 
+  /**
+   * Sub-band gains of a link, cached for the coherence time
+   */
+  struct GainCacheEntry
+  {
+    Ptr<SpectrumValue> m_gain; //!< the gain of each sub-band
+    Ptr<const MatrixBasedChannelModel::ChannelMatrix> m_channel; //!< the channel matrix used to compute the gain
+    ThreeGppAntennaArrayModel::ComplexVector m_longTerm; //!< the long term component used to compute the gain
+    Vector m_aPosition; //!< position of the first node when the gain was computed
+    Vector m_bPosition; //!< position of the second node when the gain was computed
+    Time m_creationTime; //!< time at which the gain was computed
+  };
+
+  /// (first node id, second node id, spectrum model uid, first node velocity, second node velocity)
+  typedef std::tuple<uint32_t, uint32_t, SpectrumModelUid_t, Vector, Vector> GainCacheKey;
+  /// cached gains, the most recently used first
+  typedef std::list<std::pair<GainCacheKey, GainCacheEntry> > GainCacheList;
+
   /**
    * Get the operating frequency
    * \return the operating frequency in Hz
   */
   double GetFrequency () const;
 
+  /**
+   * Looks for the sub-band gains of the link in the gain cache and checks
+   * that they are still valid. If not, computes them and caches them.
+   * \param aId id of the first node
+   * \param bId id of the second node
+   * \param txPsd the tx PSD, only its spectrum model is used
+   * \param a first node mobility model
+   * \param b second node mobility model
+   * \param longTerm the long term component
+   * \param channelMatrix the channel matrix
+   * \return the gain of each sub-band
+   */
+  Ptr<const SpectrumValue> GetGain (uint32_t aId, uint32_t bId, Ptr<const SpectrumValue> txPsd,
+                                    Ptr<const MobilityModel> a, Ptr<const MobilityModel> b,
+                                    const ThreeGppAntennaArrayModel::ComplexVector &longTerm,
+                                    Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix) const;
+
+  /**
+   * Evicts the least recently used gains until the cache fits in m_gainCacheMaxBytes
+   */
+  void TrimGainCache () const;
+
   /**
    * Looks for the long term component in m_longTermMap. If found, checks
    * whether it has to be updated. If not found or if it has to be updated,
@@ -184,10 +235,18 @@ private:
    * \return the rx PSD
    */
   Ptr<SpectrumValue> CalcBeamformingGain (Ptr<SpectrumValue> txPsd,
-                                          ThreeGppAntennaArrayModel::ComplexVector longTerm,
+                                          const ThreeGppAntennaArrayModel::ComplexVector &longTerm,
                                           Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
                                           const Vector &sSpeed, const Vector &uSpeed) const;
 
+  /**
+   * Get the spacing of the sub-bands of a spectrum model, if it is uniform
+   * \param model the spectrum model
+   * \return the distance between the center frequencies of two consecutive
+   *         sub-bands in Hz, or 0 if the sub-bands are not evenly spaced
+   */
+  double GetUniformBandSpacing (Ptr<const SpectrumModel> model) const;
+
   std::unordered_map <uint32_t, Ptr<const ThreeGppAntennaArrayModel> > m_deviceAntennaMap; //!< map containig the <node, antenna> associations
   mutable std::unordered_map < uint32_t, Ptr<const LongTerm> > m_longTermMap; //!< map containing the long term components
   Ptr<MatrixBasedChannelModel> m_channelModel; //!< the model to generate the channel matrix
@@ -196,6 +255,18 @@ private:
   // (reflected) paths, as described in 3GPP TR 37.885 v15.3.0, Sec. 6.2.3.
   double m_vScatt; //!< value used to compute the additional Doppler contribution for the delayed paths 
   Ptr<UniformRandomVariable> m_uniformRv; //!< uniform random variable, used to compute the additional Doppler contribution
+
+  bool m_phasorRecurrence; //!< whether the delay phasors are advanced by a constant rotation on evenly spaced sub-bands
+  mutable std::unordered_map <SpectrumModelUid_t, double> m_bandSpacingMap; //!< sub-band spacing of each spectrum model, 0 if not uniform
+
+  Time m_gainCacheCoherenceTime; //!< how long the gain of a link is reused, 0 disables the gain cache
+  double m_gainCacheMaxDisplacement; //!< movement of either node (m) after which the gain of a link is recomputed
+  uint64_t m_gainCacheMaxBytes; //!< memory allowed for the cached gains
+  mutable GainCacheList m_gainCacheList; //!< the cached gains, the most recently used first
+  mutable std::map<GainCacheKey, GainCacheList::iterator> m_gainCacheIndex; //!< position of each cached gain in m_gainCacheList
+  mutable uint64_t m_gainCacheBytes; //!< memory used by the cached gains
+  mutable TracedValue<uint64_t> m_gainCacheHits; //!< number of gains taken from the cache
+  mutable TracedValue<uint64_t> m_gainCacheMisses; //!< number of gains computed while the cache is enabled
 };
 } // namespace ns3
 
@@ -0,0 +1,273 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/log.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/node.h>
+#include <ns3/mobility-model.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/multi-model-spectrum-channel.h>
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumCullingTest");
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum
+ *
+ * SpectrumPhy that counts the signals it receives
+ */
+class CountingSpectrumPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   * \param model the rx spectrum model
+   */
+  CountingSpectrumPhy (Ptr<const SpectrumModel> model);
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+  uint32_t m_rxCount; //!< number of signals received
+
+private:
+  Ptr<const SpectrumModel> m_model; //!< the rx spectrum model
+  Ptr<MobilityModel> m_mobility; //!< the mobility model
+};
+
+CountingSpectrumPhy::CountingSpectrumPhy (Ptr<const SpectrumModel> model)
+  : m_rxCount (0),
+    m_model (model)
+{
+}
+
+void
+CountingSpectrumPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+CountingSpectrumPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+CountingSpectrumPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+CountingSpectrumPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+CountingSpectrumPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+CountingSpectrumPhy::GetRxSpectrumModel () const
+{
+  return m_model;
+}
+
+Ptr<AntennaModel>
+CountingSpectrumPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+CountingSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  m_rxCount++;
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Checks that the spatial culling of MultiModelSpectrumChannel delivers a
+ * signal to the same receivers as the MaxLossDb check alone, and that the
+ * spatial index follows the receivers that move.
+ */
+class SpectrumCullingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param culling whether the spatial culling is enabled
+   */
+  SpectrumCullingTestCase (bool culling);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Transmits a signal and checks the number of receivers it reached
+   * \param txPhy the transmitter
+   * \param received the expected number of receivers that got the signal
+   * \param culled the expected number of receivers left out by the spatial index
+   */
+  void CheckTx (Ptr<CountingSpectrumPhy> txPhy, uint32_t received, uint32_t culled);
+
+  /**
+   * Records the receivers left out by the spatial index
+   * \param txPhy the transmitter
+   * \param nCulled the number of receivers left out
+   */
+  void CulledLinks (Ptr<const SpectrumPhy> txPhy, uint32_t nCulled);
+
+  bool m_culling; //!< whether the spatial culling is enabled
+  Ptr<MultiModelSpectrumChannel> m_channel; //!< the channel
+  std::vector<Ptr<CountingSpectrumPhy> > m_rxPhys; //!< the receivers
+  uint32_t m_culled; //!< receivers left out by the last transmission
+  uint32_t m_culledEvents; //!< times the CulledLinks trace fired for the last transmission
+};
+
+SpectrumCullingTestCase::SpectrumCullingTestCase (bool culling)
+  : TestCase (culling ? "Check the spatial culling of MultiModelSpectrumChannel" : "Check MultiModelSpectrumChannel without spatial culling"),
+    m_culling (culling),
+    m_culled (0),
+    m_culledEvents (0)
+{
+}
+
+void
+SpectrumCullingTestCase::CulledLinks (Ptr<const SpectrumPhy> txPhy, uint32_t nCulled)
+{
+  m_culled += nCulled;
+  ++m_culledEvents;
+}
+
+void
+SpectrumCullingTestCase::CheckTx (Ptr<CountingSpectrumPhy> txPhy, uint32_t received, uint32_t culled)
+{
+  for (std::size_t i = 0; i < m_rxPhys.size (); ++i)
+    {
+      m_rxPhys[i]->m_rxCount = 0;
+    }
+  m_culled = 0;
+  m_culledEvents = 0;
+
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->txPhy = txPhy;
+  params->psd = Create<SpectrumValue> (txPhy->GetRxSpectrumModel ());
+  (*params->psd) = 1e-9;
+  params->duration = MicroSeconds (10);
+  m_channel->StartTx (params);
+  Simulator::Run ();
+
+  uint32_t count = 0;
+  for (std::size_t i = 0; i < m_rxPhys.size (); ++i)
+    {
+      count += m_rxPhys[i]->m_rxCount;
+    }
+  NS_TEST_ASSERT_MSG_EQ (count, received, "Unexpected number of receivers reached");
+  NS_TEST_ASSERT_MSG_EQ (m_culled, (m_culling ? culled : 0), "Unexpected number of culled links");
+  NS_TEST_ASSERT_MSG_EQ (m_culledEvents, (m_culling ? 1 : 0), "CulledLinks not fired once per transmission");
+}
+
+void
+SpectrumCullingTestCase::DoRun ()
+{
+  std::vector<double> frequencies;
+  frequencies.push_back (2.4e9);
+  frequencies.push_back (2.401e9);
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (frequencies);
+
+  // signals are received up to 99.4 m with a maximum loss of 80 dB, the
+  // bound of the propagation loss gives a range of 100 m
+  Ptr<FriisPropagationLossModel> loss = CreateObject<FriisPropagationLossModel> ();
+  loss->SetAttribute ("Frequency", DoubleValue (2.4e9));
+  m_channel = CreateObject<MultiModelSpectrumChannel> ();
+  m_channel->AddPropagationLossModel (loss);
+  m_channel->SetAttribute ("MaxLossDb", DoubleValue (80.0));
+  m_channel->SetAttribute ("SpatialCulling", BooleanValue (m_culling));
+  m_channel->SetAttribute ("CullingGridCellSize", DoubleValue (50.0));
+  m_channel->SetAttribute ("CullingReferenceLoss", DoubleValue (40.0));
+  m_channel->SetAttribute ("CullingMaxAntennaGain", DoubleValue (0.0));
+  m_channel->TraceConnectWithoutContext ("CulledLinks", MakeCallback (&SpectrumCullingTestCase::CulledLinks, this));
+
+  Ptr<Node> txNode = CreateObject<Node> ();
+  Ptr<MobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  txNode->AggregateObject (txMobility);
+  Ptr<CountingSpectrumPhy> txPhy = CreateObject<CountingSpectrumPhy> (model);
+  txPhy->SetMobility (txMobility);
+
+  // 200 receivers every 25 m along the x axis
+  for (uint32_t i = 1; i <= 200; ++i)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (25.0 * i, 0.0, 0.0));
+      node->AggregateObject (mobility);
+      Ptr<CountingSpectrumPhy> phy = CreateObject<CountingSpectrumPhy> (model);
+      phy->SetMobility (mobility);
+      m_channel->AddRx (phy);
+      m_rxPhys.push_back (phy);
+    }
+
+  // the receivers at 25, 50 and 75 m get the signal, the one at 100 m is in
+  // range but beyond MaxLossDb
+  CheckTx (txPhy, 3, 196);
+
+  // the index is refreshed when a receiver moves
+  m_rxPhys.back ()->GetMobility ()->SetPosition (Vector (60.0, 10.0, 0.0));
+  CheckTx (txPhy, 4, 195);
+
+  m_channel->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Test suite for the spatial culling of MultiModelSpectrumChannel
+ */
+class SpectrumCullingTestSuite : public TestSuite
+{
+public:
+  SpectrumCullingTestSuite ();
+};
+
+SpectrumCullingTestSuite::SpectrumCullingTestSuite ()
+  : TestSuite ("spectrum-culling", UNIT)
+{
+  AddTestCase (new SpectrumCullingTestCase (false), TestCase::QUICK);
+  AddTestCase (new SpectrumCullingTestCase (true), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static SpectrumCullingTestSuite g_spectrumCullingTestSuite;
@@ -27,6 +27,7 @@
 #include "ns3/pointer.h"
 #include "ns3/node-container.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/three-gpp-antenna-array-model.h"
 #include "ns3/three-gpp-channel-model.h"
 #include "ns3/simple-net-device.h"
@@ -34,6 +35,8 @@
 #include "ns3/channel-condition-model.h"
 #include "ns3/three-gpp-spectrum-propagation-loss-model.h"
 #include "ns3/wifi-spectrum-value-helper.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
 
 using namespace ns3;
 
@@ -543,6 +546,251 @@ ThreeGppSpectrumPropagationLossModelTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * Test case for the ThreeGppSpectrumPropagationLossModel class.
+ * Checks that the beamforming gain computed by advancing the delay phasors
+ * from one sub-band to the next matches the one computed with a complex
+ * exponential per sub-band, on a spectrum model with many evenly spaced
+ * sub-bands.
+ */
+class ThreeGppPhasorRecurrenceTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppPhasorRecurrenceTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+};
+
+ThreeGppPhasorRecurrenceTest::ThreeGppPhasorRecurrenceTest ()
+  : TestCase ("Check the phasor recurrence of the ThreeGppSpectrumPropagationLossModel beamforming gain")
+{
+}
+
+void
+ThreeGppPhasorRecurrenceTest::DoRun ()
+{
+  Ptr<ChannelConditionModel> condModel = CreateObject<NeverLosChannelConditionModel> ();
+  Ptr<ThreeGppSpectrumPropagationLossModel> lossModel = CreateObject<ThreeGppSpectrumPropagationLossModel> ();
+  lossModel->SetChannelModelAttribute ("Frequency", DoubleValue (60e9));
+  lossModel->SetChannelModelAttribute ("Scenario", StringValue ("UMi-StreetCanyon"));
+  lossModel->SetChannelModelAttribute ("ChannelConditionModel", PointerValue (condModel));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  nodes.Get (0)->AddDevice (txDev);
+  txDev->SetNode (nodes.Get (0));
+  nodes.Get (1)->AddDevice (rxDev);
+  rxDev->SetNode (nodes.Get (1));
+
+  Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel> ();
+  txMob->SetPosition (Vector (0.0, 0.0, 10.0));
+  Ptr<MobilityModel> rxMob = CreateObject<ConstantPositionMobilityModel> ();
+  rxMob->SetPosition (Vector (60.0, 20.0, 1.5));
+  nodes.Get (0)->AggregateObject (txMob);
+  nodes.Get (1)->AggregateObject (rxMob);
+
+  Ptr<ThreeGppAntennaArrayModel> txAntenna = CreateObjectWithAttributes<ThreeGppAntennaArrayModel> ("NumColumns", UintegerValue (2), "NumRows", UintegerValue (2));
+  Ptr<ThreeGppAntennaArrayModel> rxAntenna = CreateObjectWithAttributes<ThreeGppAntennaArrayModel> ("NumColumns", UintegerValue (2), "NumRows", UintegerValue (2));
+  ThreeGppAntennaArrayModel::ComplexVector bfVector (4, std::complex<double> (0.5, 0.0));
+  txAntenna->SetBeamformingVector (bfVector);
+  rxAntenna->SetBeamformingVector (bfVector);
+  lossModel->AddDevice (txDev, txAntenna);
+  lossModel->AddDevice (rxDev, rxAntenna);
+
+  // 2.5 GHz made of 32000 sub-bands of 78.125 kHz
+  std::vector<double> centerFrequencies;
+  for (uint32_t i = 0; i < 32000; i++)
+    {
+      centerFrequencies.push_back (58.75e9 + 78125.0 * i);
+    }
+  Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (Create<SpectrumModel> (centerFrequencies));
+  (*txPsd) = 1e-12;
+  (*txPsd)[0] = 0.0;
+
+  lossModel->SetAttribute ("PhasorRecurrence", BooleanValue (false));
+  Ptr<SpectrumValue> expected = lossModel->DoCalcRxPowerSpectralDensity (txPsd, txMob, rxMob);
+  lossModel->SetAttribute ("PhasorRecurrence", BooleanValue (true));
+  Ptr<SpectrumValue> actual = lossModel->DoCalcRxPowerSpectralDensity (txPsd, txMob, rxMob);
+
+  NS_TEST_ASSERT_MSG_EQ ((*actual)[0], 0.0, "A sub-band without power must stay empty");
+  // the tolerance is relative to the strongest sub-band, deep fades are the
+  // difference of much larger terms
+  double maxRxPsd = 0;
+  for (uint32_t i = 0; i < centerFrequencies.size (); i++)
+    {
+      maxRxPsd = std::max (maxRxPsd, (*expected)[i]);
+    }
+  for (uint32_t i = 1; i < centerFrequencies.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL ((*actual)[i], (*expected)[i], 1e-9 * maxRxPsd, "Different rx PSD in sub-band " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Test case for the gain cache of the ThreeGppSpectrumPropagationLossModel class.
+ * 1) check that a cached gain gives the same rx PSD as the uncached model
+ * 2) check that the gain is recomputed when a node moves
+ * 3) check that the gain is recomputed when a node changes its velocity
+ * 4) check that the gain is recomputed when the coherence time expires
+ */
+class ThreeGppGainCacheTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppGainCacheTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+
+  /**
+   * Computes the rx PSD and checks the number of gain cache hits and misses
+   * \param lossModel the ThreeGppSpectrumPropagationLossModel object used to compute the rx PSD
+   * \param txPsd the PSD of the transmitted signal
+   * \param txMob the tx mobility model
+   * \param rxMob the rx mobility model
+   * \param hits the expected number of hits
+   * \param misses the expected number of misses
+   */
+  void CheckGainCache (Ptr<ThreeGppSpectrumPropagationLossModel> lossModel, Ptr<SpectrumValue> txPsd,
+                       Ptr<MobilityModel> txMob, Ptr<MobilityModel> rxMob, uint64_t hits, uint64_t misses);
+
+  /**
+   * Records the number of gain cache hits
+   * \param oldValue the previous value
+   * \param newValue the new value
+   */
+  void HitsTrace (uint64_t oldValue, uint64_t newValue);
+
+  /**
+   * Records the number of gain cache misses
+   * \param oldValue the previous value
+   * \param newValue the new value
+   */
+  void MissesTrace (uint64_t oldValue, uint64_t newValue);
+
+  uint64_t m_hits; //!< number of gain cache hits
+  uint64_t m_misses; //!< number of gain cache misses
+};
+
+ThreeGppGainCacheTest::ThreeGppGainCacheTest ()
+  : TestCase ("Check the gain cache of the ThreeGppSpectrumPropagationLossModel"),
+    m_hits (0),
+    m_misses (0)
+{
+}
+
+void
+ThreeGppGainCacheTest::HitsTrace (uint64_t oldValue, uint64_t newValue)
+{
+  m_hits = newValue;
+}
+
+void
+ThreeGppGainCacheTest::MissesTrace (uint64_t oldValue, uint64_t newValue)
+{
+  m_misses = newValue;
+}
+
+void
+ThreeGppGainCacheTest::CheckGainCache (Ptr<ThreeGppSpectrumPropagationLossModel> lossModel, Ptr<SpectrumValue> txPsd,
+                                       Ptr<MobilityModel> txMob, Ptr<MobilityModel> rxMob, uint64_t hits, uint64_t misses)
+{
+  Ptr<SpectrumValue> rxPsd = lossModel->DoCalcRxPowerSpectralDensity (txPsd, txMob, rxMob);
+  NS_TEST_ASSERT_MSG_EQ (m_hits, hits, "Unexpected number of gain cache hits");
+  NS_TEST_ASSERT_MSG_EQ (m_misses, misses, "Unexpected number of gain cache misses");
+
+  // the cached gain must match the one computed without the cache
+  lossModel->SetAttribute ("GainCacheCoherenceTime", TimeValue (Seconds (0)));
+  Ptr<SpectrumValue> expected = lossModel->DoCalcRxPowerSpectralDensity (txPsd, txMob, rxMob);
+  lossModel->SetAttribute ("GainCacheCoherenceTime", TimeValue (MilliSeconds (10)));
+  for (uint32_t i = 0; i < rxPsd->GetValuesN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPsd)[i], (*expected)[i], 1e-9 * (*expected)[i], "Different rx PSD in sub-band " << i);
+    }
+}
+
+void
+ThreeGppGainCacheTest::DoRun ()
+{
+  // the channel matrix is never updated
+  Ptr<ChannelConditionModel> condModel = CreateObject<AlwaysLosChannelConditionModel> ();
+  Ptr<ThreeGppSpectrumPropagationLossModel> lossModel = CreateObject<ThreeGppSpectrumPropagationLossModel> ();
+  lossModel->SetChannelModelAttribute ("Frequency", DoubleValue (2.4e9));
+  lossModel->SetChannelModelAttribute ("Scenario", StringValue ("UMa"));
+  lossModel->SetChannelModelAttribute ("ChannelConditionModel", PointerValue (condModel));
+  lossModel->SetAttribute ("GainCacheCoherenceTime", TimeValue (MilliSeconds (10)));
+  lossModel->TraceConnectWithoutContext ("GainCacheHits", MakeCallback (&ThreeGppGainCacheTest::HitsTrace, this));
+  lossModel->TraceConnectWithoutContext ("GainCacheMisses", MakeCallback (&ThreeGppGainCacheTest::MissesTrace, this));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  nodes.Get (0)->AddDevice (txDev);
+  txDev->SetNode (nodes.Get (0));
+  nodes.Get (1)->AddDevice (rxDev);
+  rxDev->SetNode (nodes.Get (1));
+
+  Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel> ();
+  txMob->SetPosition (Vector (0.0, 0.0, 10.0));
+  Ptr<ConstantVelocityMobilityModel> rxMob = CreateObject<ConstantVelocityMobilityModel> ();
+  rxMob->SetPosition (Vector (15.0, 0.0, 10.0));
+  nodes.Get (0)->AggregateObject (txMob);
+  nodes.Get (1)->AggregateObject (rxMob);
+
+  Ptr<ThreeGppAntennaArrayModel> txAntenna = CreateObjectWithAttributes<ThreeGppAntennaArrayModel> ("NumColumns", UintegerValue (2), "NumRows", UintegerValue (2));
+  Ptr<ThreeGppAntennaArrayModel> rxAntenna = CreateObjectWithAttributes<ThreeGppAntennaArrayModel> ("NumColumns", UintegerValue (2), "NumRows", UintegerValue (2));
+  ThreeGppAntennaArrayModel::ComplexVector bfVector (4, std::complex<double> (0.5, 0.0));
+  txAntenna->SetBeamformingVector (bfVector);
+  rxAntenna->SetBeamformingVector (bfVector);
+  lossModel->AddDevice (txDev, txAntenna);
+  lossModel->AddDevice (rxDev, rxAntenna);
+
+  WifiSpectrumValue5MhzFactory sf;
+  Ptr<SpectrumValue> txPsd = sf.CreateTxPowerSpectralDensity (0.1, 1);
+
+  // 1) the first call computes the gain, the second one reuses it
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 0, 1);
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 1, 1);
+
+  // 2) moving a node by more than GainCacheMaxDisplacement invalidates the gain
+  rxMob->SetPosition (Vector (15.0, 0.1, 10.0));
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 1, 2);
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 2, 2);
+
+  // 3) the Doppler term changes with the velocity of a node, the gain too
+  rxMob->SetVelocity (Vector (0.0, 0.01, 0.0));
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 2, 3);
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 3, 3);
+  // back to the previous velocity, whose gain is still cached; the Doppler term of a
+  // cached gain is frozen, so the node stays still for the next checks
+  rxMob->SetVelocity (Vector (0.0, 0.0, 0.0));
+  CheckGainCache (lossModel, txPsd, txMob, rxMob, 4, 3);
+
+  // 4) the gain is recomputed once the coherence time has expired
+  Simulator::Schedule (MilliSeconds (5), &ThreeGppGainCacheTest::CheckGainCache, this, lossModel, txPsd, txMob, rxMob, 5, 3);
+  Simulator::Schedule (MilliSeconds (11), &ThreeGppGainCacheTest::CheckGainCache, this, lossModel, txPsd, txMob, rxMob, 5, 4);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup spectrum
  *
@@ -563,6 +811,8 @@ ThreeGppChannelTestSuite::ThreeGppChannelTestSuite ()
   AddTestCase (new ThreeGppChannelMatrixComputationTest, TestCase::QUICK);
   AddTestCase (new ThreeGppChannelMatrixUpdateTest, TestCase::QUICK);
   AddTestCase (new ThreeGppSpectrumPropagationLossModelTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppPhasorRecurrenceTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppGainCacheTest, TestCase::QUICK);
 }
 
 static ThreeGppChannelTestSuite myTestSuite;